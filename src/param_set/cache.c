@@ -0,0 +1,220 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "param_set.h"
+#include "internal.h"
+
+#define CACHE_NONE -1
+
+typedef struct CACHE_ENTRY_st {
+	char *key;
+	unsigned long hash;
+	int next;			/* Next entry in the same bucket. */
+	int referenced;		/* Second chance for the clock eviction. */
+} CACHE_ENTRY;
+
+struct CACHE_st {
+	CACHE_ENTRY *entry;
+	unsigned char *payload;
+	size_t payload_size;
+	size_t capacity;
+	size_t count;
+	size_t hand;		/* Clock hand. */
+
+	int *bucket;
+	size_t bucket_mask;
+};
+
+static unsigned long cache_hash(const char *key) {
+	unsigned long hash = 2166136261UL;
+
+	while (*key != '\0') {
+		hash ^= (unsigned char)*key++;
+		hash *= 16777619UL;
+	}
+
+	return hash;
+}
+
+static int cache_find(const CACHE *cache, const char *key, unsigned long hash) {
+	int i = cache->bucket[hash & cache->bucket_mask];
+
+	while (i != CACHE_NONE) {
+		if (cache->entry[i].hash == hash && strcmp(cache->entry[i].key, key) == 0) return i;
+		i = cache->entry[i].next;
+	}
+
+	return CACHE_NONE;
+}
+
+static void cache_unlink(CACHE *cache, int i) {
+	int *link = &cache->bucket[cache->entry[i].hash & cache->bucket_mask];
+
+	while (*link != CACHE_NONE) {
+		if (*link == i) {
+			*link = cache->entry[i].next;
+			break;
+		}
+		link = &cache->entry[*link].next;
+	}
+}
+
+/**
+ * Returns a free slot. If the cache is full, an entry is evicted: the clock
+ * hand skips (and clears) recently referenced entries.
+ */
+static int cache_get_free_slot(CACHE *cache) {
+	int victim = CACHE_NONE;
+
+	if (cache->count < cache->capacity) return (int)cache->count++;
+
+	while (victim == CACHE_NONE) {
+		if (cache->entry[cache->hand].referenced) {
+			cache->entry[cache->hand].referenced = 0;
+		} else {
+			victim = (int)cache->hand;
+		}
+		cache->hand = (cache->hand + 1) % cache->capacity;
+	}
+
+	cache_unlink(cache, victim);
+	free(cache->entry[victim].key);
+	cache->entry[victim].key = NULL;
+
+	return victim;
+}
+
+int CACHE_new(size_t capacity, size_t payload_size, CACHE **cache) {
+	int res;
+	CACHE *tmp = NULL;
+	size_t buckets = 1;
+	size_t i = 0;
+
+	if (capacity == 0 || payload_size == 0 || cache == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	tmp = (CACHE*)malloc(sizeof(*tmp));
+	if (tmp == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	while (buckets < capacity) buckets <<= 1;
+
+	tmp->entry = (CACHE_ENTRY*)malloc(sizeof(*tmp->entry) * capacity);
+	tmp->payload = (unsigned char*)malloc(payload_size * capacity);
+	tmp->bucket = (int*)malloc(sizeof(*tmp->bucket) * buckets);
+	tmp->payload_size = payload_size;
+	tmp->capacity = capacity;
+	tmp->count = 0;
+	tmp->hand = 0;
+	tmp->bucket_mask = buckets - 1;
+
+	if (tmp->entry == NULL || tmp->payload == NULL || tmp->bucket == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	for (i = 0; i < buckets; i++) tmp->bucket[i] = CACHE_NONE;
+
+	*cache = tmp;
+	tmp = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	CACHE_free(tmp);
+
+	return res;
+}
+
+void CACHE_clear(CACHE *cache) {
+	size_t i = 0;
+
+	if (cache == NULL) return;
+
+	for (i = 0; i < cache->count; i++) {
+		free(cache->entry[i].key);
+	}
+
+	for (i = 0; i <= cache->bucket_mask; i++) {
+		cache->bucket[i] = CACHE_NONE;
+	}
+
+	cache->count = 0;
+	cache->hand = 0;
+}
+
+void CACHE_free(CACHE *cache) {
+	if (cache == NULL) return;
+
+	if (cache->entry != NULL && cache->bucket != NULL) CACHE_clear(cache);
+	free(cache->entry);
+	free(cache->payload);
+	free(cache->bucket);
+	free(cache);
+}
+
+int CACHE_get(CACHE *cache, const char *key, void *payload) {
+	int i;
+
+	if (cache == NULL || key == NULL || payload == NULL) return 0;
+
+	i = cache_find(cache, key, cache_hash(key));
+	if (i == CACHE_NONE) return 0;
+
+	cache->entry[i].referenced = 1;
+	memcpy(payload, cache->payload + i * cache->payload_size, cache->payload_size);
+
+	return 1;
+}
+
+int CACHE_put(CACHE *cache, const char *key, const void *payload) {
+	int i;
+	unsigned long hash;
+	char *tmp_key = NULL;
+	size_t key_len = 0;
+
+	if (cache == NULL || key == NULL || payload == NULL) return PST_INVALID_ARGUMENT;
+
+	hash = cache_hash(key);
+	i = cache_find(cache, key, hash);
+
+	if (i == CACHE_NONE) {
+		key_len = strlen(key);
+		tmp_key = (char*)malloc(key_len + 1);
+		if (tmp_key == NULL) return PST_OUT_OF_MEMORY;
+		memcpy(tmp_key, key, key_len + 1);
+
+		i = cache_get_free_slot(cache);
+		cache->entry[i].key = tmp_key;
+		cache->entry[i].hash = hash;
+		cache->entry[i].next = cache->bucket[hash & cache->bucket_mask];
+		cache->bucket[hash & cache->bucket_mask] = i;
+	}
+
+	cache->entry[i].referenced = 1;
+	memcpy(cache->payload + i * cache->payload_size, payload, cache->payload_size);
+
+	return PST_OK;
+}
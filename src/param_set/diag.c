@@ -0,0 +1,363 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "param_set.h"
+#include "internal.h"
+
+#define DIAG_NO_SOURCE -1
+#define DIAG_NO_FILE -1
+#define DIAG_KIND_COUNT (PST_DIAG_SYNTAX_MISSING_DASH + 1)
+
+typedef struct DIAG_REC_st {
+	unsigned char kind;
+	unsigned char candidate_count;
+	unsigned short candidate[PST_DIAG_MAX_CANDIDATES];
+	int source_id;
+	int file_id;		/* The file the record was read from or DIAG_NO_FILE. */
+	int priority;		/* Priority the file was read with. */
+	size_t line;
+	size_t offset;
+	size_t token;		/* Offset of the token in the string pool. */
+	size_t token_len;
+} DIAG_REC;
+
+/* Distinct strings in the string pool. ID of a string is the index. */
+typedef struct DIAG_NAMES_st {
+	size_t *at;
+	int count;
+	int size;
+	int last;
+} DIAG_NAMES;
+
+struct DIAG_LIST_st {
+	DIAG_REC *rec;
+	size_t count;
+	size_t size;
+	size_t kind_count[DIAG_KIND_COUNT];
+
+	/* All the tokens, sources and file names as NULL terminated strings. */
+	char *pool;
+	size_t pool_len;
+	size_t pool_size;
+
+	DIAG_NAMES source;
+	DIAG_NAMES file;
+
+	size_t line;
+	size_t offset;
+	int file_id;
+	int priority;
+};
+
+static int diag_pool_add(DIAG_LIST *list, const char *str, size_t len, size_t *at) {
+	if (list->pool_len + len + 1 > list->pool_size) {
+		size_t new_size = (list->pool_size == 0) ? 1024 : list->pool_size;
+		char *tmp = NULL;
+
+		while (list->pool_len + len + 1 > new_size) new_size *= 2;
+
+		tmp = (char*)realloc(list->pool, new_size);
+		if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+		list->pool = tmp;
+		list->pool_size = new_size;
+	}
+
+	memcpy(list->pool + list->pool_len, str, len);
+	list->pool[list->pool_len + len] = '\0';
+	*at = list->pool_len;
+	list->pool_len += len + 1;
+
+	return PST_OK;
+}
+
+/**
+ * Returns the index of the string in \c names or \c -1 if not found. The last
+ * one is checked first, as the same name is usually used for a long run of
+ * records.
+ */
+static int diag_find_name(const DIAG_LIST *list, const DIAG_NAMES *names, const char *str) {
+	int i;
+
+	if (names->last != -1 && strcmp(list->pool + names->at[names->last], str) == 0) return names->last;
+
+	for (i = 0; i < names->count; i++) {
+		if (strcmp(list->pool + names->at[i], str) == 0) return i;
+	}
+
+	return -1;
+}
+
+/**
+ * Returns the ID of the string in \c names, the string is added if it is not
+ * there yet. For \c NULL the ID is \c -1.
+ */
+static int diag_get_name_id(DIAG_LIST *list, DIAG_NAMES *names, const char *str, int *id) {
+	int res;
+	int i;
+
+	if (str == NULL) {
+		*id = -1;
+		return PST_OK;
+	}
+
+	i = diag_find_name(list, names, str);
+	if (i != -1) {
+		names->last = i;
+		*id = i;
+		return PST_OK;
+	}
+
+	if (names->count == names->size) {
+		int new_size = (names->size == 0) ? 4 : names->size * 2;
+		size_t *tmp = (size_t*)realloc(names->at, new_size * sizeof(*tmp));
+		if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+		names->at = tmp;
+		names->size = new_size;
+	}
+
+	res = diag_pool_add(list, str, strlen(str), &names->at[names->count]);
+	if (res != PST_OK) return res;
+
+	names->last = names->count;
+	*id = names->count++;
+
+	return PST_OK;
+}
+
+int DIAG_LIST_new(DIAG_LIST **list) {
+	DIAG_LIST *tmp = NULL;
+
+	if (list == NULL) return PST_INVALID_ARGUMENT;
+
+	tmp = (DIAG_LIST*)calloc(1, sizeof(*tmp));
+	if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+	tmp->source.last = DIAG_NO_SOURCE;
+	tmp->file.last = DIAG_NO_FILE;
+	tmp->file_id = DIAG_NO_FILE;
+	*list = tmp;
+
+	return PST_OK;
+}
+
+void DIAG_LIST_free(DIAG_LIST *list) {
+	if (list == NULL) return;
+	free(list->rec);
+	free(list->pool);
+	free(list->source.at);
+	free(list->file.at);
+	free(list);
+}
+
+void DIAG_LIST_setLocation(DIAG_LIST *list, size_t line, size_t offset) {
+	if (list == NULL) return;
+	list->line = line;
+	list->offset = offset;
+}
+
+int DIAG_LIST_setFile(DIAG_LIST *list, const char *fname, int priority) {
+	int res;
+
+	if (list == NULL) return PST_INVALID_ARGUMENT;
+
+	res = diag_get_name_id(list, &list->file, fname, &list->file_id);
+	if (res != PST_OK) return res;
+
+	list->priority = (fname != NULL) ? priority : 0;
+
+	return PST_OK;
+}
+
+int DIAG_LIST_add(DIAG_LIST *list, int kind, const char *source, const char *token, const int *candidates, int count) {
+	int res;
+	DIAG_REC *rec = NULL;
+	int source_id = DIAG_NO_SOURCE;
+	size_t token_at = 0;
+	size_t token_len = 0;
+	int i;
+
+	if (list == NULL || token == NULL || kind <= 0 || kind >= DIAG_KIND_COUNT
+			|| count < 0 || count > PST_DIAG_MAX_CANDIDATES || (count > 0 && candidates == NULL)) {
+		return PST_INVALID_ARGUMENT;
+	}
+
+	if (list->count == list->size) {
+		size_t new_size = (list->size == 0) ? 16 : list->size * 2;
+		DIAG_REC *tmp = (DIAG_REC*)realloc(list->rec, new_size * sizeof(*tmp));
+		if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+		list->rec = tmp;
+		list->size = new_size;
+	}
+
+	res = diag_get_name_id(list, &list->source, source, &source_id);
+	if (res != PST_OK) return res;
+
+	token_len = strlen(token);
+	res = diag_pool_add(list, token, token_len, &token_at);
+	if (res != PST_OK) return res;
+
+	rec = &list->rec[list->count];
+	rec->kind = (unsigned char)kind;
+	rec->candidate_count = (unsigned char)count;
+	for (i = 0; i < count; i++) {
+		rec->candidate[i] = (unsigned short)candidates[i];
+	}
+	rec->source_id = source_id;
+	rec->file_id = list->file_id;
+	rec->priority = list->priority;
+	rec->line = list->line;
+	rec->offset = list->offset;
+	rec->token = token_at;
+	rec->token_len = token_len;
+
+	list->count++;
+	list->kind_count[kind]++;
+
+	return PST_OK;
+}
+
+void DIAG_LIST_truncate(DIAG_LIST *list, size_t count) {
+	if (list == NULL) return;
+
+	/* The strings of the dropped records stay in the pool until it is compacted. */
+	while (list->count > count) {
+		list->count--;
+		list->kind_count[list->rec[list->count].kind]--;
+	}
+}
+
+int DIAG_LIST_removeFile(DIAG_LIST *list, const char *fname, const char *source, int priority, size_t before) {
+	int res;
+	DIAG_LIST tmp;
+	int source_id = DIAG_NO_SOURCE;
+	int file_id = DIAG_NO_FILE;
+	int *new_source = NULL;
+	int *new_file = NULL;
+	size_t i;
+	int j;
+
+	if (list == NULL || fname == NULL) return PST_INVALID_ARGUMENT;
+
+	memset(&tmp, 0, sizeof(tmp));
+	tmp.source.last = DIAG_NO_SOURCE;
+	tmp.file.last = DIAG_NO_FILE;
+
+	/* Nothing is recorded for an unknown file or source. */
+	file_id = diag_find_name(list, &list->file, fname);
+	if (file_id == DIAG_NO_FILE) return PST_OK;
+
+	if (source != NULL) {
+		source_id = diag_find_name(list, &list->source, source);
+		if (source_id == DIAG_NO_SOURCE) return PST_OK;
+	}
+
+	new_source = (int*)malloc((list->source.count > 0 ? list->source.count : 1) * sizeof(*new_source));
+	new_file = (int*)malloc(list->file.count * sizeof(*new_file));
+	tmp.rec = (DIAG_REC*)malloc((list->count > 0 ? list->count : 1) * sizeof(*tmp.rec));
+	if (new_source == NULL || new_file == NULL || tmp.rec == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+	tmp.size = (list->count > 0 ? list->count : 1);
+
+	/* The records that are kept are copied to a new list with a new string pool. */
+	for (j = 0; j < list->source.count; j++) {
+		res = diag_get_name_id(&tmp, &tmp.source, list->pool + list->source.at[j], &new_source[j]);
+		if (res != PST_OK) goto cleanup;
+	}
+
+	for (j = 0; j < list->file.count; j++) {
+		res = diag_get_name_id(&tmp, &tmp.file, list->pool + list->file.at[j], &new_file[j]);
+		if (res != PST_OK) goto cleanup;
+	}
+
+	for (i = 0; i < list->count; i++) {
+		DIAG_REC *rec = &list->rec[i];
+
+		if (i < before && rec->file_id == file_id && rec->source_id == source_id && rec->priority == priority) continue;
+
+		tmp.rec[tmp.count] = *rec;
+		res = diag_pool_add(&tmp, list->pool + rec->token, rec->token_len, &tmp.rec[tmp.count].token);
+		if (res != PST_OK) goto cleanup;
+
+		if (rec->source_id != DIAG_NO_SOURCE) tmp.rec[tmp.count].source_id = new_source[rec->source_id];
+		if (rec->file_id != DIAG_NO_FILE) tmp.rec[tmp.count].file_id = new_file[rec->file_id];
+		tmp.kind_count[rec->kind]++;
+		tmp.count++;
+	}
+
+	tmp.line = list->line;
+	tmp.offset = list->offset;
+	tmp.file_id = (list->file_id != DIAG_NO_FILE) ? new_file[list->file_id] : DIAG_NO_FILE;
+	tmp.priority = list->priority;
+
+	free(list->rec);
+	free(list->pool);
+	free(list->source.at);
+	free(list->file.at);
+	*list = tmp;
+	memset(&tmp, 0, sizeof(tmp));
+	res = PST_OK;
+
+cleanup:
+
+	free(tmp.rec);
+	free(tmp.pool);
+	free(tmp.source.at);
+	free(tmp.file.at);
+	free(new_source);
+	free(new_file);
+
+	return res;
+}
+
+size_t DIAG_LIST_count(const DIAG_LIST *list, int kind) {
+	if (list == NULL || kind < 0 || kind >= DIAG_KIND_COUNT) return 0;
+	return (kind == 0) ? list->count : list->kind_count[kind];
+}
+
+int DIAG_LIST_get(const DIAG_LIST *list, size_t at, PARAM_SET_DIAG *diag) {
+	const DIAG_REC *rec = NULL;
+	int i;
+
+	if (list == NULL || diag == NULL) return PST_INVALID_ARGUMENT;
+	if (at >= list->count) return PST_INDEX_OVF;
+
+	rec = &list->rec[at];
+	diag->kind = rec->kind;
+	diag->line = rec->line;
+	diag->offset = rec->offset;
+	diag->sourceId = rec->source_id;
+	diag->source = (rec->source_id == DIAG_NO_SOURCE) ? NULL : list->pool + list->source.at[rec->source_id];
+	diag->token = list->pool + rec->token;
+	diag->tokenLen = rec->token_len;
+	diag->candidateCount = rec->candidate_count;
+
+	for (i = 0; i < PST_DIAG_MAX_CANDIDATES; i++) {
+		diag->candidate[i] = (i < rec->candidate_count) ? rec->candidate[i] : -1;
+		diag->candidateName[i] = NULL;
+	}
+
+	return PST_OK;
+}
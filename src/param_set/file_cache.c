@@ -0,0 +1,663 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "param_set.h"
+#include "internal.h"
+#include "strn.h"
+
+typedef struct FILE_TOKEN_REC_st {
+	int syntax;
+	size_t line;
+	size_t offset;
+	size_t text;		/* Offsets in the string pool or FILE_TOKENS_NONE. */
+	size_t flag;
+	size_t arg;
+} FILE_TOKEN_REC;
+
+#define FILE_TOKENS_NONE ((size_t)-1)
+
+struct FILE_TOKENS_st {
+	FILE_TOKEN_REC *rec;
+	size_t count;
+	size_t size;
+
+	char *pool;
+	size_t pool_len;
+	size_t pool_size;
+};
+
+/**
+ * Tokens are stored on disk as:
+ *   magic[8] "PSTTOKS\0", version, size of the file, content hash (2 x 4 bytes),
+ *   token count, string pool size,
+ *   token count x (syntax, line, offset, text, flag, arg),
+ *   string pool.
+ * All integers are 32-bit little-endian, missing strings are 0xffffffff.
+ */
+#define TOKENS_MAGIC "PSTTOKS"
+#define TOKENS_MAGIC_SIZE 8
+#define TOKENS_VERSION 1
+#define TOKENS_HEADER_SIZE 32
+#define TOKENS_REC_SIZE 24
+#define TOKENS_NULL 0xffffffffUL
+#define TOKENS_MAX 0xfffffffeUL
+
+typedef struct FILE_CACHE_ENTRY_st {
+	char *path;
+	long size;
+	time_t mtime;
+	int isMtimeTrusted;
+	unsigned long hash[2];
+	unsigned long used;
+	FILE_TOKENS *tokens;
+} FILE_CACHE_ENTRY;
+
+struct PST_FILE_CACHE_st {
+	char *dir;
+	FILE_CACHE_ENTRY *entry;
+	size_t count;
+	size_t capacity;
+	unsigned long clock;
+
+	size_t hits;
+	size_t diskHits;
+	size_t misses;
+};
+
+int FILE_TOKENS_new(FILE_TOKENS **tokens) {
+	FILE_TOKENS *tmp = NULL;
+
+	if (tokens == NULL) return PST_INVALID_ARGUMENT;
+
+	tmp = (FILE_TOKENS*)calloc(1, sizeof(*tmp));
+	if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+	*tokens = tmp;
+
+	return PST_OK;
+}
+
+void FILE_TOKENS_free(FILE_TOKENS *tokens) {
+	if (tokens == NULL) return;
+	free(tokens->rec);
+	free(tokens->pool);
+	free(tokens);
+}
+
+static int file_tokens_pool_add(FILE_TOKENS *tokens, const char *str, size_t *at) {
+	size_t len;
+
+	if (str == NULL) {
+		*at = FILE_TOKENS_NONE;
+		return PST_OK;
+	}
+
+	len = strlen(str) + 1;
+	if (tokens->pool_len + len > tokens->pool_size) {
+		size_t new_size = (tokens->pool_size == 0) ? 1024 : tokens->pool_size;
+		char *tmp = NULL;
+
+		while (tokens->pool_len + len > new_size) new_size *= 2;
+
+		tmp = (char*)realloc(tokens->pool, new_size);
+		if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+		tokens->pool = tmp;
+		tokens->pool_size = new_size;
+	}
+
+	memcpy(tokens->pool + tokens->pool_len, str, len);
+	*at = tokens->pool_len;
+	tokens->pool_len += len;
+
+	return PST_OK;
+}
+
+int FILE_TOKENS_add(FILE_TOKENS *tokens, int syntax, size_t line, size_t offset, const char *text, const char *flag, const char *arg) {
+	int res;
+	FILE_TOKEN_REC rec;
+
+	if (tokens == NULL) return PST_INVALID_ARGUMENT;
+
+	if (tokens->count == tokens->size) {
+		size_t new_size = (tokens->size == 0) ? 32 : tokens->size * 2;
+		FILE_TOKEN_REC *tmp = (FILE_TOKEN_REC*)realloc(tokens->rec, new_size * sizeof(*tmp));
+		if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+		tokens->rec = tmp;
+		tokens->size = new_size;
+	}
+
+	rec.syntax = syntax;
+	rec.line = line;
+	rec.offset = offset;
+
+	res = file_tokens_pool_add(tokens, text, &rec.text);
+	if (res != PST_OK) return res;
+
+	res = file_tokens_pool_add(tokens, flag, &rec.flag);
+	if (res != PST_OK) return res;
+
+	res = file_tokens_pool_add(tokens, arg, &rec.arg);
+	if (res != PST_OK) return res;
+
+	tokens->rec[tokens->count++] = rec;
+
+	return PST_OK;
+}
+
+size_t FILE_TOKENS_count(const FILE_TOKENS *tokens) {
+	return (tokens == NULL) ? 0 : tokens->count;
+}
+
+int FILE_TOKENS_get(const FILE_TOKENS *tokens, size_t at, FILE_TOKEN *token) {
+	const FILE_TOKEN_REC *rec = NULL;
+
+	if (tokens == NULL || token == NULL) return PST_INVALID_ARGUMENT;
+	if (at >= tokens->count) return PST_INDEX_OVF;
+
+	rec = &tokens->rec[at];
+	token->syntax = rec->syntax;
+	token->line = rec->line;
+	token->offset = rec->offset;
+	token->text = (rec->text == FILE_TOKENS_NONE) ? NULL : tokens->pool + rec->text;
+	token->flag = (rec->flag == FILE_TOKENS_NONE) ? NULL : tokens->pool + rec->flag;
+	token->arg = (rec->arg == FILE_TOKENS_NONE) ? NULL : tokens->pool + rec->arg;
+
+	return PST_OK;
+}
+
+int FILE_TOKENS_copy(const FILE_TOKENS *tokens, FILE_TOKENS **copy) {
+	int res;
+	FILE_TOKENS *tmp = NULL;
+
+	if (tokens == NULL || copy == NULL) return PST_INVALID_ARGUMENT;
+
+	res = FILE_TOKENS_new(&tmp);
+	if (res != PST_OK) goto cleanup;
+
+	if (tokens->count > 0) {
+		tmp->rec = (FILE_TOKEN_REC*)malloc(tokens->count * sizeof(*tmp->rec));
+		if (tmp->rec == NULL) {
+			res = PST_OUT_OF_MEMORY;
+			goto cleanup;
+		}
+		memcpy(tmp->rec, tokens->rec, tokens->count * sizeof(*tmp->rec));
+		tmp->count = tokens->count;
+		tmp->size = tokens->count;
+	}
+
+	if (tokens->pool_len > 0) {
+		tmp->pool = (char*)malloc(tokens->pool_len);
+		if (tmp->pool == NULL) {
+			res = PST_OUT_OF_MEMORY;
+			goto cleanup;
+		}
+		memcpy(tmp->pool, tokens->pool, tokens->pool_len);
+		tmp->pool_len = tokens->pool_len;
+		tmp->pool_size = tokens->pool_len;
+	}
+
+	*copy = tmp;
+	tmp = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	FILE_TOKENS_free(tmp);
+
+	return res;
+}
+
+/**
+ * Computes two independent 32-bit hashes (FNV-1a and sdbm) of the file content
+ * and rewinds the file.
+ */
+static int file_cache_hash(FILE *file, unsigned long hash[2]) {
+	unsigned char buf[4096];
+	size_t len;
+	size_t i;
+	unsigned long fnv = 2166136261UL;
+	unsigned long sdbm = 0;
+
+	while ((len = fread(buf, 1, sizeof(buf), file)) > 0) {
+		for (i = 0; i < len; i++) {
+			fnv = ((fnv ^ buf[i]) * 16777619UL) & 0xffffffffUL;
+			sdbm = (buf[i] + (sdbm << 6) + (sdbm << 16) - sdbm) & 0xffffffffUL;
+		}
+	}
+
+	if (ferror(file) || fseek(file, 0, SEEK_SET) != 0) return PST_IO_ERROR;
+
+	hash[0] = fnv;
+	hash[1] = sdbm;
+
+	return PST_OK;
+}
+
+static char *file_cache_disk_path(const PST_FILE_CACHE *cache, long size, const unsigned long hash[2]) {
+	size_t len = strlen(cache->dir) + 64;
+	char *path = (char*)malloc(len);
+
+	if (path != NULL) {
+		PST_snprintf(path, len, "%s/%08lx%08lx-%lx.pst", cache->dir, hash[0], hash[1], (unsigned long)size);
+	}
+
+	return path;
+}
+
+static int file_cache_save(const PST_FILE_CACHE *cache, long size, const unsigned long hash[2], const FILE_TOKENS *tokens) {
+	int res;
+	unsigned char header[TOKENS_HEADER_SIZE];
+	unsigned char rec[TOKENS_REC_SIZE];
+	char *path = NULL;
+	FILE *file = NULL;
+	size_t i;
+
+	if (tokens->count > TOKENS_MAX / TOKENS_REC_SIZE || tokens->pool_len > TOKENS_MAX) {
+		res = PST_INDEX_OVF;
+		goto cleanup;
+	}
+
+	path = file_cache_disk_path(cache, size, hash);
+	if (path == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	file = fopen(path, "wb");
+	if (file == NULL) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	memset(header, 0, sizeof(header));
+	memcpy(header, TOKENS_MAGIC, TOKENS_MAGIC_SIZE);
+	PST_putU32(header + 8, TOKENS_VERSION);
+	PST_putU32(header + 12, (unsigned long)size);
+	PST_putU32(header + 16, hash[0]);
+	PST_putU32(header + 20, hash[1]);
+	PST_putU32(header + 24, (unsigned long)tokens->count);
+	PST_putU32(header + 28, (unsigned long)tokens->pool_len);
+
+	if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	for (i = 0; i < tokens->count; i++) {
+		const FILE_TOKEN_REC *r = &tokens->rec[i];
+
+		PST_putU32(rec, (unsigned long)r->syntax);
+		PST_putU32(rec + 4, (unsigned long)r->line);
+		PST_putU32(rec + 8, (unsigned long)r->offset);
+		PST_putU32(rec + 12, (r->text == FILE_TOKENS_NONE) ? TOKENS_NULL : (unsigned long)r->text);
+		PST_putU32(rec + 16, (r->flag == FILE_TOKENS_NONE) ? TOKENS_NULL : (unsigned long)r->flag);
+		PST_putU32(rec + 20, (r->arg == FILE_TOKENS_NONE) ? TOKENS_NULL : (unsigned long)r->arg);
+
+		if (fwrite(rec, 1, sizeof(rec), file) != sizeof(rec)) {
+			res = PST_IO_ERROR;
+			goto cleanup;
+		}
+	}
+
+	if (tokens->pool_len > 0 && fwrite(tokens->pool, 1, tokens->pool_len, file) != tokens->pool_len) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	res = (fclose(file) == 0) ? PST_OK : PST_IO_ERROR;
+	file = NULL;
+
+cleanup:
+
+	if (file != NULL) fclose(file);
+	/* Never leave a partially written entry behind. */
+	if (res != PST_OK && path != NULL) remove(path);
+	free(path);
+
+	return res;
+}
+
+static int file_cache_string(const FILE_TOKENS *tokens, unsigned long offset, size_t *at) {
+	if (offset == TOKENS_NULL) {
+		*at = FILE_TOKENS_NONE;
+		return PST_OK;
+	}
+
+	if (offset >= tokens->pool_len) return PST_INVALID_FORMAT;
+
+	*at = offset;
+	return PST_OK;
+}
+
+/**
+ * Loads the tokens stored by #file_cache_save. A missing or damaged entry is
+ * reported as an error and must be treated as a cache miss.
+ */
+static int file_cache_load(const PST_FILE_CACHE *cache, long size, const unsigned long hash[2], FILE_TOKENS **tokens) {
+	int res;
+	unsigned char header[TOKENS_HEADER_SIZE];
+	unsigned char rec[TOKENS_REC_SIZE];
+	char *path = NULL;
+	FILE *file = NULL;
+	FILE_TOKENS *tmp = NULL;
+	size_t count;
+	size_t pool_len;
+	size_t i;
+	long start;
+	long end = 0;
+	unsigned long remaining;
+
+	path = file_cache_disk_path(cache, size, hash);
+	if (path == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	file = fopen(path, "rb");
+	if (file == NULL) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	if (fread(header, 1, sizeof(header), file) != sizeof(header)
+			|| memcmp(header, TOKENS_MAGIC, TOKENS_MAGIC_SIZE) != 0
+			|| PST_getU32(header + 8) != TOKENS_VERSION
+			|| PST_getU32(header + 12) != (unsigned long)size
+			|| PST_getU32(header + 16) != hash[0]
+			|| PST_getU32(header + 20) != hash[1]) {
+		res = PST_INVALID_FORMAT;
+		goto cleanup;
+	}
+
+	count = PST_getU32(header + 24);
+	pool_len = PST_getU32(header + 28);
+
+	/* Sizes from the header must fit into the rest of the file before anything is allocated. */
+	start = ftell(file);
+	if (start < 0 || fseek(file, 0, SEEK_END) != 0 || (end = ftell(file)) < start
+			|| fseek(file, start, SEEK_SET) != 0) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	remaining = (unsigned long)(end - start);
+	if (count > remaining / TOKENS_REC_SIZE || pool_len > remaining - count * TOKENS_REC_SIZE) {
+		res = PST_INVALID_FORMAT;
+		goto cleanup;
+	}
+
+	res = FILE_TOKENS_new(&tmp);
+	if (res != PST_OK) goto cleanup;
+
+	tmp->rec = (FILE_TOKEN_REC*)malloc((count == 0 ? 1 : count) * sizeof(*tmp->rec));
+	tmp->pool = (char*)malloc(pool_len == 0 ? 1 : pool_len);
+	if (tmp->rec == NULL || tmp->pool == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+	tmp->size = count;
+	tmp->pool_size = pool_len;
+	tmp->pool_len = pool_len;
+
+	for (i = 0; i < count; i++) {
+		FILE_TOKEN_REC *r = &tmp->rec[i];
+
+		if (fread(rec, 1, sizeof(rec), file) != sizeof(rec)) {
+			res = PST_INVALID_FORMAT;
+			goto cleanup;
+		}
+
+		r->syntax = (int)PST_getU32(rec);
+		r->line = PST_getU32(rec + 4);
+		r->offset = PST_getU32(rec + 8);
+
+		if (file_cache_string(tmp, PST_getU32(rec + 12), &r->text) != PST_OK
+				|| file_cache_string(tmp, PST_getU32(rec + 16), &r->flag) != PST_OK
+				|| file_cache_string(tmp, PST_getU32(rec + 20), &r->arg) != PST_OK
+				|| (r->syntax != 0 && r->syntax != PST_DIAG_SYNTAX_UNKNOWN_CHARACTER && r->syntax != PST_DIAG_SYNTAX_MISSING_DASH)) {
+			res = PST_INVALID_FORMAT;
+			goto cleanup;
+		}
+	}
+
+	if (fread(tmp->pool, 1, pool_len, file) != pool_len || (pool_len > 0 && tmp->pool[pool_len - 1] != '\0')) {
+		res = PST_INVALID_FORMAT;
+		goto cleanup;
+	}
+	tmp->count = count;
+
+	*tokens = tmp;
+	tmp = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	if (file != NULL) fclose(file);
+	free(path);
+	FILE_TOKENS_free(tmp);
+
+	return res;
+}
+
+int PST_FILE_CACHE_new(const char *dir, size_t capacity, PST_FILE_CACHE **cache) {
+	int res;
+	PST_FILE_CACHE *tmp = NULL;
+
+	if (capacity == 0 || cache == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	tmp = (PST_FILE_CACHE*)calloc(1, sizeof(*tmp));
+	if (tmp == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	tmp->entry = (FILE_CACHE_ENTRY*)calloc(capacity, sizeof(*tmp->entry));
+	if (tmp->entry == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+	tmp->capacity = capacity;
+
+	if (dir != NULL) {
+		tmp->dir = (char*)malloc(strlen(dir) + 1);
+		if (tmp->dir == NULL) {
+			res = PST_OUT_OF_MEMORY;
+			goto cleanup;
+		}
+		strcpy(tmp->dir, dir);
+	}
+
+	*cache = tmp;
+	tmp = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	PST_FILE_CACHE_free(tmp);
+
+	return res;
+}
+
+void PST_FILE_CACHE_free(PST_FILE_CACHE *cache) {
+	size_t i;
+
+	if (cache == NULL) return;
+
+	for (i = 0; i < cache->count; i++) {
+		free(cache->entry[i].path);
+		FILE_TOKENS_free(cache->entry[i].tokens);
+	}
+
+	free(cache->entry);
+	free(cache->dir);
+	free(cache);
+}
+
+int PST_FILE_CACHE_getCounters(const PST_FILE_CACHE *cache, size_t *hits, size_t *diskHits, size_t *misses) {
+	if (cache == NULL) return PST_INVALID_ARGUMENT;
+	if (hits != NULL) *hits = cache->hits;
+	if (diskHits != NULL) *diskHits = cache->diskHits;
+	if (misses != NULL) *misses = cache->misses;
+	return PST_OK;
+}
+
+/**
+ * Returns the entry for the path. If there is none, the least recently used
+ * entry is emptied for the path or a new one is taken if the cache is not full.
+ */
+static int file_cache_get_entry(PST_FILE_CACHE *cache, const char *path, int create, FILE_CACHE_ENTRY **entry) {
+	FILE_CACHE_ENTRY *e = NULL;
+	char *tmp = NULL;
+	size_t i;
+
+	for (i = 0; i < cache->count; i++) {
+		if (strcmp(cache->entry[i].path, path) == 0) {
+			*entry = &cache->entry[i];
+			return PST_OK;
+		}
+	}
+
+	if (!create) {
+		*entry = NULL;
+		return PST_OK;
+	}
+
+	tmp = (char*)malloc(strlen(path) + 1);
+	if (tmp == NULL) return PST_OUT_OF_MEMORY;
+	strcpy(tmp, path);
+
+	if (cache->count < cache->capacity) {
+		e = &cache->entry[cache->count++];
+	} else {
+		e = &cache->entry[0];
+		for (i = 1; i < cache->count; i++) {
+			if (cache->entry[i].used < e->used) e = &cache->entry[i];
+		}
+
+		free(e->path);
+		FILE_TOKENS_free(e->tokens);
+	}
+
+	memset(e, 0, sizeof(*e));
+	e->path = tmp;
+	*entry = e;
+
+	return PST_OK;
+}
+
+int PST_FILE_CACHE_getTokens(PST_FILE_CACHE *cache, const char *fname, const FILE_TOKENS **tokens) {
+	int res;
+	struct stat st;
+	FILE *file = NULL;
+	FILE_CACHE_ENTRY *entry = NULL;
+	FILE_TOKENS *tmp = NULL;
+	unsigned long hash[2];
+	int fromDisk = 0;
+
+	if (cache == NULL || fname == NULL || tokens == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	if (stat(fname, &st) != 0) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	res = file_cache_get_entry(cache, fname, 0, &entry);
+	if (res != PST_OK) goto cleanup;
+
+	/* Unchanged file: the content is not even read. */
+	if (entry != NULL && entry->isMtimeTrusted && entry->size == (long)st.st_size && entry->mtime == st.st_mtime) {
+		entry->used = ++cache->clock;
+		cache->hits++;
+		*tokens = entry->tokens;
+		res = PST_OK;
+		goto cleanup;
+	}
+
+	file = fopen(fname, "rb");
+	if (file == NULL) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	res = file_cache_hash(file, hash);
+	if (res != PST_OK) goto cleanup;
+
+	/* Touched or rewritten, but the content is the same. */
+	if (entry != NULL && entry->size == (long)st.st_size && entry->hash[0] == hash[0] && entry->hash[1] == hash[1]) {
+		cache->hits++;
+	} else {
+		if (cache->dir != NULL && file_cache_load(cache, (long)st.st_size, hash, &tmp) == PST_OK) {
+			fromDisk = 1;
+			cache->diskHits++;
+		} else {
+			res = FILE_TOKENS_new(&tmp);
+			if (res != PST_OK) goto cleanup;
+
+			res = FILE_TOKENS_read(file, tmp);
+			if (res != PST_OK) goto cleanup;
+
+			cache->misses++;
+		}
+
+		/* Failing to store the entry on disk is not an error, it is just not cached. */
+		if (cache->dir != NULL && !fromDisk) file_cache_save(cache, (long)st.st_size, hash, tmp);
+
+		res = file_cache_get_entry(cache, fname, 1, &entry);
+		if (res != PST_OK) goto cleanup;
+
+		FILE_TOKENS_free(entry->tokens);
+		entry->tokens = tmp;
+		tmp = NULL;
+		entry->hash[0] = hash[0];
+		entry->hash[1] = hash[1];
+	}
+
+	/**
+	 * The modification time has a coarse resolution, so a file that was changed
+	 * recently may be changed again without changing the modification time. Such
+	 * a file is hashed on every read until its modification time is old enough.
+	 */
+	entry->size = (long)st.st_size;
+	entry->mtime = st.st_mtime;
+	entry->isMtimeTrusted = (difftime(time(NULL), st.st_mtime) > 2.0) ? 1 : 0;
+	entry->used = ++cache->clock;
+	*tokens = entry->tokens;
+	res = PST_OK;
+
+cleanup:
+
+	if (file != NULL) fclose(file);
+	FILE_TOKENS_free(tmp);
+
+	return res;
+}
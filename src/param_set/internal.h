@@ -31,6 +31,122 @@ extern "C" {
 
 typedef struct TASK_DEFINITION_st TASK_DEFINITION;
 typedef struct ITERATOR_st ITERATOR;
+typedef struct CACHE_st CACHE;
+typedef struct PST_SINK_st PST_SINK;
+typedef struct DIAG_LIST_st DIAG_LIST;
+typedef struct SNAPSHOT_st SNAPSHOT;
+typedef struct FILE_TOKENS_st FILE_TOKENS;
+typedef struct WATCH_st WATCH;
+typedef struct PARAM_COLD_st PARAM_COLD;
+typedef struct PARAM_SET_LAYER_st PARAM_SET_LAYER;
+typedef struct PARAM_SET_LOOKUP_st PARAM_SET_LOOKUP;
+typedef struct PARAM_SET_LOADED_st PARAM_SET_LOADED;
+
+/**
+ * Output sink used by the renderers. Depending on how the sink is initialized
+ * the output is passed to a write callback, stored into a fixed size buffer
+ * (truncated and always \c NULL terminated) or only counted (dry-run).
+ */
+struct PST_SINK_st {
+	/** Write callback. If \c NULL and \c buf is \c NULL, output is only counted. */
+	int (*write)(void *ctx, const char *data, size_t len);
+	/** Context for \c write. */
+	void *ctx;
+	/** Receiving buffer or \c NULL. */
+	char *buf;
+	/** Size of the \c buf. */
+	size_t buf_len;
+	/** Count of bytes produced (not including truncation by \c buf_len). */
+	size_t count;
+	/** The first error returned by \c write or #PST_OK. */
+	int err;
+};
+
+/**
+ * Types of the help text tokens (see #PST_HELP_TEXT).
+ */
+enum PST_HELP_TOKEN_TYPE_enum {
+	/** A word. */
+	PST_HELP_TOKEN_WORD = 0,
+	/** Indentation change (<tt>"\>nr"</tt>). */
+	PST_HELP_TOKEN_INDENT,
+	/** New line that is followed by more text. */
+	PST_HELP_TOKEN_BREAK,
+	/** New line at the end of the text. */
+	PST_HELP_TOKEN_NEWLINE,
+	/** The end of the text or a parse error message that is printed as it is. */
+	PST_HELP_TOKEN_END
+};
+
+/**
+ * A token of the help text.
+ */
+typedef struct PST_HELP_TOKEN_st {
+	/** Type of the token (see #PST_HELP_TOKEN_TYPE_enum). */
+	int type;
+	/** Indentation offset for #PST_HELP_TOKEN_INDENT. */
+	int indent;
+	/** The text of the token, always \c NULL terminated. */
+	const char *text;
+	/** The length of the \c text. */
+	size_t len;
+} PST_HELP_TOKEN;
+
+/**
+ * Help text that is tokenized once for #PST_SINK_hiprintTokens.
+ */
+typedef struct PST_HELP_TEXT_st {
+	/** Array of tokens. */
+	PST_HELP_TOKEN *token;
+	/** Count of tokens. */
+	size_t count;
+	/** Storage for the text of the tokens. */
+	char *pool;
+} PST_HELP_TEXT;
+
+/**
+ * A line of configuration file as it is replayed by #PARAM_SET_readFromFile.
+ */
+typedef struct FILE_TOKEN_st {
+	/** Syntax error (see #PARAM_SET_DIAG_KIND_enum) or \c 0. */
+	int syntax;
+	/** Line number. */
+	size_t line;
+	/** Byte offset of the line. */
+	size_t offset;
+	/** The line, only if there is a syntax error. */
+	const char *text;
+	/** Parameter name or \c NULL if nothing is added. */
+	const char *flag;
+	/** Parameter value or \c NULL. */
+	const char *arg;
+} FILE_TOKEN;
+
+/**
+ * Increments or decrements the counter in #PARAM_SET_STATS, if \c stats is not
+ * \c NULL. If \c PST_DISABLE_STATS is defined, the counters are not updated.
+ */
+#ifdef PST_DISABLE_STATS
+#	define PST_STATS_ADD(stats, counter, n)
+#	define PST_STATS_SUB(stats, counter, n)
+#else
+#	define PST_STATS_ADD(stats, counter, n) do { if ((stats) != NULL) (stats)->counter += (n); } while (0)
+#	define PST_STATS_SUB(stats, counter, n) do { if ((stats) != NULL) (stats)->counter -= (n); } while (0)
+#endif
+
+/**
+ * Reports the beginning or the end of a phase to the trace callback of the set
+ * (see #PARAM_SET_setTraceCallback), if there is one.
+ * \param set		#PARAM_SET object.
+ * \param phase	Phase (see #PARAM_SET_TRACE_PHASE_enum).
+ * \param isEnd	\c 0 at the beginning and \c 1 at the end of the phase.
+ */
+void PST_trace(const PARAM_SET *set, int phase, int isEnd);
+
+/**
+ * Returns the time of monotonic clock in microseconds.
+ */
+double PST_monotonicTime(void);
 
 int TASK_DEFINITION_new(int id, const char *name, const char *man, const char *atleastone, const char *forb, const char *ignore, TASK_DEFINITION **new);
 void TASK_DEFINITION_free(TASK_DEFINITION *obj);
@@ -77,6 +193,511 @@ int ITERATOR_set(ITERATOR *itr, PARAM_VAL *new_root, const char* source, int pri
  */
 int ITERATOR_fetch(ITERATOR *itr, const char* source, int priority, int at, PARAM_VAL **item);
 
+/**
+ * Same as #PARAM_VAL_new, but instead of copying, takes the ownership of the
+ * \c value. If the function fails, the ownership is not taken.
+ * \param value		Value as C-string allocated with \c malloc. Must not be \c NULL.
+ * \param source	Describes the source, e.g. file name or environment variable. Can be \c NULL.
+ * \param priority	Priority of the parameter, must be positive.
+ * \param newObj	Pointer to receiving pointer or pointer to existing value.
+ * \return #PST_OK when successful, error code otherwise.
+ */
+int PARAM_VAL_newOwned(char *value, const char* source, int priority, PARAM_VAL **newObj);
+
+/**
+ * Same as #PARAM_VAL_new, but \c value and \c source are only referenced and
+ * must outlive the returned object (e.g. strings mapped from a snapshot file).
+ * \param value		Value as C-string. Can be \c NULL.
+ * \param source	Describes the source, e.g. file name or environment variable. Can be \c NULL.
+ * \param priority	Priority of the parameter, must be positive.
+ * \param newObj	Pointer to receiving pointer.
+ * \return #PST_OK when successful, error code otherwise.
+ */
+int PARAM_VAL_newBorrowed(const char *value, const char* source, int priority, PARAM_VAL **newObj);
+
+/**
+ * Creates a copy of the value that shares the value and source strings with
+ * \c value through a reference count. The check status is copied. Values with
+ * borrowed strings (see #PARAM_VAL_newBorrowed) are copied. Values that share
+ * the strings must not be freed concurrently.
+ * \param value		Value to be shared.
+ * \param newObj	Pointer to receiving pointer.
+ * \return #PST_OK when successful, error code otherwise.
+ */
+int PARAM_VAL_newShared(PARAM_VAL *value, PARAM_VAL **newObj);
+
+/**
+ * Appends an existing value to the end of the parameter's value list. Unlike
+ * #PARAM_addValue, no checks are run and the status of the value is kept. The
+ * ownership is taken only if the function succeeds.
+ * \param param	#PARAM object.
+ * \param value	#PARAM_VAL object that is not linked to any list.
+ * \return #PST_OK when successful, error code otherwise.
+ */
+int PARAM_appendValue(PARAM *param, PARAM_VAL *value);
+
+/**
+ * Appends all the values of \c src to \c target. If \c target has no conversion
+ * function and checks the values with the same functions as \c src, the strings
+ * are shared (see #PARAM_VAL_newShared) and the check status is kept. Otherwise
+ * the values are added with #PARAM_addValue.
+ * \param target	#PARAM object the values are appended to.
+ * \param src		#PARAM object the values are taken from.
+ * \return #PST_OK when successful, error code otherwise.
+ */
+int PARAM_includeValues(PARAM *target, PARAM *src);
+
+/**
+ * Removes the value from the parameter's value list and frees it.
+ * \param param	#PARAM object.
+ * \param value	#PARAM_VAL object that belongs to \c param.
+ * \return #PST_OK when successful, error code otherwise.
+ */
+int PARAM_removeValue(PARAM *param, PARAM_VAL *value);
+
+/**
+ * Sets the counters the parameter and its value iterator update.
+ * \param param	#PARAM object.
+ * \param stats	Counters owned by the #PARAM_SET or \c NULL.
+ */
+void PARAM_setStats(PARAM *param, PARAM_SET_STATS *stats);
+
+/**
+ * Sets the change counter of the set. When values are added to or removed from
+ * the parameter, the counter is incremented and its new value is stored in the
+ * parameter, so it is possible to find the parameters changed since any point
+ * in time (see #TASK_SET_analyzeConsistency).
+ * \param param	#PARAM object.
+ * \param counter	Counter owned by the #PARAM_SET or \c NULL.
+ */
+void PARAM_setChangeCounter(PARAM *param, unsigned long *counter);
+
+/**
+ * Finds the parameter of the set by its name or alias. Layers of the set (see
+ * #PARAM_SET_pushLayer) are not searched.
+ * \param set		#PARAM_SET object.
+ * \param name		Name or alias of the parameter.
+ * \return The parameter or \c NULL if there is no such parameter.
+ */
+PARAM *PARAM_SET_findParameter(const PARAM_SET *set, const char *name);
+
+/**
+ * Calculates the hash of the parameter name that is kept by the #PARAM object
+ * to speed up the name lookup.
+ * \param name	Name or alias of the parameter.
+ * \return The hash of the name.
+ */
+unsigned PARAM_nameHash(const char *name);
+
+/**
+ * Releases the snapshot data (see #PARAM_SET_loadSnapshot). Snapshots linked
+ * with the \c next field are released too.
+ * \param snapshot	#SNAPSHOT object to be freed. Can be \c NULL.
+ */
+void SNAPSHOT_free(SNAPSHOT *snapshot);
+
+/**
+ * Creates a bounded cache that maps C-string keys to fixed size payloads. When
+ * the cache is full, the least recently used entries are evicted (clock algorithm).
+ * \param capacity		Maximum count of entries.
+ * \param payload_size	The size of the payload in bytes.
+ * \param cache			Pointer to receiving pointer to #CACHE object.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int CACHE_new(size_t capacity, size_t payload_size, CACHE **cache);
+
+/**
+ * Free #CACHE object.
+ * \param cache	#CACHE object to be freed.
+ */
+void CACHE_free(CACHE *cache);
+
+/**
+ * Removes all entries from the cache.
+ * \param cache	#CACHE object.
+ */
+void CACHE_clear(CACHE *cache);
+
+/**
+ * Looks up the payload by key.
+ * \param cache		#CACHE object.
+ * \param key		Key as C-string.
+ * \param payload	Buffer where the payload is copied to.
+ * \return \c 1 if the key was found, \c 0 otherwise.
+ */
+int CACHE_get(CACHE *cache, const char *key, void *payload);
+
+/**
+ * Adds or updates the payload for the key.
+ * \param cache		#CACHE object.
+ * \param key		Key as C-string, copy is made.
+ * \param payload	Payload to be copied.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int CACHE_put(CACHE *cache, const char *key, const void *payload);
+
+/**
+ * Runs \c job for every index in range <tt>[0, count)</tt> using up to \c nthreads
+ * threads, including the calling thread. Jobs are claimed one by one, so the
+ * order of execution is not defined. If the library is built without thread
+ * support or threads can not be started, the jobs are run by the calling thread.
+ * \param count		Count of jobs.
+ * \param nthreads	Maximum count of threads, must be at least \c 1.
+ * \param job		Function to run a single job with index \c i.
+ * \param ctx		Context passed to \c job.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PST_parallelFor(size_t count, int nthreads, void (*job)(void *ctx, size_t i), void *ctx);
+
+/**
+ * Computes the format and content status of a value with the control functions
+ * of the parameter (see #PARAM_addControl). Nothing is stored, so it can be called
+ * from multiple threads if the control functions are thread safe.
+ * \param param			#PARAM object.
+ * \param value			C-string value to be checked.
+ * \param formatStatus	Pointer to receiving format status.
+ * \param contentStatus	Pointer to receiving content status.
+ */
+void PARAM_runControl(const PARAM *param, const char *value, int *formatStatus, int *contentStatus);
+
+/**
+ * Looks up the format and content status of a value from the control result
+ * cache of the parameter (see #PST_CONTROL_CACHE).
+ * \param param			#PARAM object.
+ * \param value			C-string value.
+ * \param formatStatus	Pointer to receiving format status.
+ * \param contentStatus	Pointer to receiving content status.
+ * \return \c 1 if the result was found, \c 0 otherwise.
+ */
+int PARAM_lookupControlResult(PARAM *param, const char *value, int *formatStatus, int *contentStatus);
+
+/**
+ * Stores the format and content status of a value whose check is pending
+ * (see #PST_CONTROL_LAZY) and updates the control result cache of the parameter
+ * (see #PST_CONTROL_CACHE). If the value is not pending, nothing is done.
+ * \param param			#PARAM object owning the value.
+ * \param value			Pending value.
+ * \param formatStatus	Format status.
+ * \param contentStatus	Content status.
+ */
+void PARAM_storeControlResult(PARAM *param, PARAM_VAL *value, int formatStatus, int contentStatus);
+
+/**
+ * Initializes a sink that passes the output to the \c write callback. If \c write
+ * is \c NULL, the output is only counted.
+ * \param sink	#PST_SINK object.
+ * \param write	Write callback. Can be \c NULL.
+ * \param ctx	Context for \c write.
+ */
+void PST_SINK_init(PST_SINK *sink, int (*write)(void *ctx, const char *data, size_t len), void *ctx);
+
+/**
+ * Initializes a sink that stores the output into the buffer. The content of
+ * the buffer is always \c NULL terminated and the output that does not fit is
+ * discarded.
+ * \param sink		#PST_SINK object.
+ * \param buf		Receiving buffer.
+ * \param buf_len	Size of \c buf, must not be \c 0.
+ */
+void PST_SINK_initBuffer(PST_SINK *sink, char *buf, size_t buf_len);
+
+/**
+ * Writes \c len bytes to the sink. Nothing is done when the sink has failed
+ * before.
+ * \param sink	#PST_SINK object.
+ * \param data	Data to be written.
+ * \param len	Size of the \c data.
+ * \return #PST_OK if successful, the error of the sink otherwise.
+ */
+int PST_SINK_write(PST_SINK *sink, const char *data, size_t len);
+
+/**
+ * Formats the string as \c printf and writes it to the sink.
+ * \param sink		#PST_SINK object.
+ * \param format	Format string.
+ * \param ...		Extra parameters for formatting.
+ * \return The length of the formatted string. On error \c 0 is returned.
+ */
+size_t PST_SINK_printf(PST_SINK *sink, const char *format, ...);
+
+/**
+ * Checks if writing to the sink is pointless as it has failed or its buffer
+ * is full.
+ * \param sink	#PST_SINK object.
+ * \return \c 1 if no more output is accepted, \c 0 otherwise.
+ */
+int PST_SINK_isDone(const PST_SINK *sink);
+
+/**
+ * Same as #PST_snhiprintf, but writes to the sink and \c description is not
+ * a format string.
+ * \param sink			#PST_SINK object.
+ * \param indent		The size of indentation. Can be \c 0.
+ * \param headerLen		The size of the header. Available only in CO mode. Can be \c 0.
+ * \param rowLen		The overall size of the row.
+ * \param paramName		Parameter name, if NOT \NULL function works in CO mode.
+ * \param delimiter		Delimiter character used to separates parameter name from description.
+ * \param description	Text to be formatted.
+ * \return The number of characters produced. On error \c 0 is returned.
+ */
+size_t PST_SINK_hiprint(PST_SINK *sink, unsigned indent, unsigned headerLen, unsigned rowLen, const char *paramName, const char delimiter, const char *description);
+
+/**
+ * Splits the help text into tokens, so it can be rendered repeatedly with
+ * #PST_SINK_hiprintTokens without parsing it again.
+ * \param txt			Help text as for #PST_SINK_hiprint.
+ * \param help		Pointer to receiving pointer to #PST_HELP_TEXT object.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PST_HELP_TEXT_new(const char *txt, PST_HELP_TEXT **help);
+
+/**
+ * Free #PST_HELP_TEXT object.
+ * \param help	#PST_HELP_TEXT object to be freed.
+ */
+void PST_HELP_TEXT_free(PST_HELP_TEXT *help);
+
+/**
+ * Same as #PST_SINK_hiprint, but renders tokenized help text.
+ * \param sink			#PST_SINK object.
+ * \param indent		The size of indentation. Can be \c 0.
+ * \param headerLen		The size of the header. Available only in CO mode. Can be \c 0.
+ * \param rowLen		The overall size of the row.
+ * \param paramName		Parameter name, if NOT \NULL function works in CO mode.
+ * \param delimiter		Delimiter character used to separates parameter name from description.
+ * \param help			Tokenized text to be formatted.
+ * \return The number of characters produced. On error \c 0 is returned.
+ */
+size_t PST_SINK_hiprintTokens(PST_SINK *sink, unsigned indent, unsigned headerLen, unsigned rowLen, const char *paramName, const char delimiter, const PST_HELP_TEXT *help);
+
+/**
+ * Writes the help row of the parameter to the sink as #PARAM_SET_helpToString
+ * does. The help text is tokenized when it is set and the rendered row is
+ * cached for the last combination of \c indent, \c header and \c rowWidth,
+ * unless the print name is created by a function.
+ * \param param		#PARAM object.
+ * \param indent	Help text indention.
+ * \param header	The size of the header.
+ * \param rowWidth	The size of the row.
+ * \param sink		#PST_SINK object.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_helpToSink(PARAM *param, int indent, int header, int rowWidth, PST_SINK *sink);
+
+/**
+ * Creates an empty list of configuration file tokens.
+ * \param tokens	Pointer to receiving pointer to #FILE_TOKENS object.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int FILE_TOKENS_new(FILE_TOKENS **tokens);
+
+/**
+ * Free #FILE_TOKENS object.
+ * \param tokens	#FILE_TOKENS object to be freed.
+ */
+void FILE_TOKENS_free(FILE_TOKENS *tokens);
+
+/**
+ * Adds a token, copies are made from all the strings (see #FILE_TOKEN).
+ * \param tokens	#FILE_TOKENS object.
+ * \param syntax	Syntax error or \c 0.
+ * \param line		Line number.
+ * \param offset	Byte offset.
+ * \param text		The line. Can be \c NULL.
+ * \param flag		Parameter name. Can be \c NULL.
+ * \param arg		Parameter value. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int FILE_TOKENS_add(FILE_TOKENS *tokens, int syntax, size_t line, size_t offset, const char *text, const char *flag, const char *arg);
+
+/**
+ * Returns the count of tokens.
+ * \param tokens	#FILE_TOKENS object.
+ * \return Count of the tokens.
+ */
+size_t FILE_TOKENS_count(const FILE_TOKENS *tokens);
+
+/**
+ * Extracts the token. The strings are valid until the \c tokens is changed or freed.
+ * \param tokens	#FILE_TOKENS object.
+ * \param at		Index of the token.
+ * \param token		Pointer to receiving token.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int FILE_TOKENS_get(const FILE_TOKENS *tokens, size_t at, FILE_TOKEN *token);
+
+/**
+ * Creates a copy of the tokens.
+ * \param tokens	#FILE_TOKENS object.
+ * \param copy		Pointer to receiving pointer to #FILE_TOKENS object.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int FILE_TOKENS_copy(const FILE_TOKENS *tokens, FILE_TOKENS **copy);
+
+/**
+ * Reads the configuration file (see #PARAM_SET_readFromFile) into tokens.
+ * \param file		File opened for reading.
+ * \param tokens	#FILE_TOKENS object.
+ * \return #PST_OK if successful, error code otherwise. Syntax errors are stored
+ * as tokens and are not reported as errors.
+ */
+int FILE_TOKENS_read(FILE *file, FILE_TOKENS *tokens);
+
+/**
+ * Returns the tokens of the file from the cache. If the file is not in the cache
+ * or it is changed, it is read (see #FILE_TOKENS_read) and cached.
+ * \param cache		#PST_FILE_CACHE object.
+ * \param fname		File path.
+ * \param tokens	Pointer to receiving pointer to tokens owned by the cache, valid until next call.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PST_FILE_CACHE_getTokens(PST_FILE_CACHE *cache, const char *fname, const FILE_TOKENS **tokens);
+
+/**
+ * Creates a list of watched configuration files. Where available, inotify is
+ * used, otherwise the size and modification time of the files is polled.
+ * \param watch	Pointer to receiving pointer to #WATCH object.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int WATCH_new(WATCH **watch);
+
+/**
+ * Free #WATCH object.
+ * \param watch	#WATCH object to be freed.
+ */
+void WATCH_free(WATCH *watch);
+
+/**
+ * Adds a file to be watched.
+ * \param watch		#WATCH object.
+ * \param path		File path, copy is made.
+ * \param source	Source used to reload the file, copy is made. Can be \c NULL.
+ * \param priority	Priority used to reload the file.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int WATCH_add(WATCH *watch, const char *path, const char *source, int priority);
+
+/**
+ * Returns the descriptor that becomes readable when some of the files may be
+ * changed.
+ * \param watch	#WATCH object.
+ * \return The descriptor or \c -1 if the files must be polled.
+ */
+int WATCH_getDescriptor(const WATCH *watch);
+
+/**
+ * Finds the changed files (see #WATCH_popChanged).
+ * \param watch	#WATCH object.
+ */
+void WATCH_collect(WATCH *watch);
+
+/**
+ * Returns the next changed file found by #WATCH_collect and clears the state.
+ * \param watch		#WATCH object.
+ * \param path		Pointer to receiving file path.
+ * \param source	Pointer to receiving source.
+ * \param priority	Pointer to receiving priority.
+ * \return \c 1 if a changed file was returned, \c 0 otherwise.
+ */
+int WATCH_popChanged(WATCH *watch, const char **path, const char **source, int *priority);
+
+/**
+ * Stores the lowest 32 bits of \c v as little-endian.
+ * \param p	Pointer to 4 bytes.
+ * \param v	Value to be stored.
+ */
+void PST_putU32(unsigned char *p, unsigned long v);
+
+/**
+ * Reads 32-bit little-endian value.
+ * \param p	Pointer to 4 bytes.
+ * \return The value.
+ */
+unsigned long PST_getU32(const unsigned char *p);
+
+/**
+ * Creates an empty list of diagnostic records. Tokens and sources are stored in
+ * a single string pool, so adding a record rarely needs an allocation.
+ * \param list	Pointer to receiving pointer to #DIAG_LIST object.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int DIAG_LIST_new(DIAG_LIST **list);
+
+/**
+ * Free #DIAG_LIST object.
+ * \param list	#DIAG_LIST object to be freed.
+ */
+void DIAG_LIST_free(DIAG_LIST *list);
+
+/**
+ * Sets the location (line number and byte offset) in the file being parsed
+ * that is stored with the following records. Use \c 0 for both to reset.
+ * \param list		#DIAG_LIST object.
+ * \param line		Line number.
+ * \param offset	Byte offset.
+ */
+void DIAG_LIST_setLocation(DIAG_LIST *list, size_t line, size_t offset);
+
+/**
+ * Sets the file being parsed and its priority that are stored with the
+ * following records, so they can be removed when the file is reloaded.
+ * \param list		#DIAG_LIST object.
+ * \param fname		Name of the file or \c NULL to reset.
+ * \param priority	Priority the file is read with.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int DIAG_LIST_setFile(DIAG_LIST *list, const char *fname, int priority);
+
+/**
+ * Adds a diagnostic record.
+ * \param list			#DIAG_LIST object.
+ * \param kind			Kind of the record (see #PARAM_SET_DIAG_KIND_enum).
+ * \param source		Source of the token. Can be \c NULL.
+ * \param token			The token, copy is made.
+ * \param candidates	Indices of typo candidates. Can be \c NULL if \c count is \c 0.
+ * \param count			Count of \c candidates, not larger than #PST_DIAG_MAX_CANDIDATES.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int DIAG_LIST_add(DIAG_LIST *list, int kind, const char *source, const char *token, const int *candidates, int count);
+
+/**
+ * Returns the count of records.
+ * \param list	#DIAG_LIST object.
+ * \param kind	Kind of the records or \c 0 to count all records.
+ * \return Count of the records.
+ */
+size_t DIAG_LIST_count(const DIAG_LIST *list, int kind);
+
+/**
+ * Extracts the record. Field \c candidateName is not filled.
+ * \param list	#DIAG_LIST object.
+ * \param at	Index of the record.
+ * \param diag	Pointer to receiving record.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int DIAG_LIST_get(const DIAG_LIST *list, size_t at, PARAM_SET_DIAG *diag);
+
+/**
+ * Drops the records added after the first \c count records.
+ * \param list	#DIAG_LIST object.
+ * \param count	Count of records to keep.
+ */
+void DIAG_LIST_truncate(DIAG_LIST *list, size_t count);
+
+/**
+ * Removes the records that were read from the file with the source and the
+ * priority (see #DIAG_LIST_setFile), looking only at the first \c before
+ * records. The order of the other records is kept and the space of the removed
+ * tokens is reclaimed.
+ * \param list		#DIAG_LIST object.
+ * \param fname		Name of the file.
+ * \param source	Source of the records. Can be \c NULL.
+ * \param priority	Priority of the records.
+ * \param before	Count of records from the beginning of the list to check.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int DIAG_LIST_removeFile(DIAG_LIST *list, const char *fname, const char *source, int priority, size_t before);
+
 #ifdef __cplusplus
 }
 #endif
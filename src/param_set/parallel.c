@@ -0,0 +1,163 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdlib.h>
+#include "param_set.h"
+#include "internal.h"
+
+#ifndef _WIN32
+#  ifdef HAVE_CONFIG_H
+#    include "config.h"
+#  endif
+#endif
+
+#if defined(_WIN32)
+#  include <windows.h>
+#  define PST_THREADS_WIN32
+typedef HANDLE PST_THREAD;
+#elif defined(HAVE_PTHREAD_H)
+#  include <pthread.h>
+#  define PST_THREADS_PTHREAD
+typedef pthread_t PST_THREAD;
+#endif
+
+/**
+ * Shared state of the workers. The next job index is claimed under the lock,
+ * so faster workers take over the jobs that would otherwise wait for a slow one.
+ */
+typedef struct PARALLEL_st {
+	size_t count;
+	size_t next;
+	void (*job)(void *ctx, size_t i);
+	void *ctx;
+#if defined(PST_THREADS_WIN32)
+	CRITICAL_SECTION lock;
+#elif defined(PST_THREADS_PTHREAD)
+	pthread_mutex_t lock;
+#endif
+} PARALLEL;
+
+static int parallel_claim(PARALLEL *obj, size_t *i) {
+	int ret = 0;
+
+#if defined(PST_THREADS_WIN32)
+	EnterCriticalSection(&obj->lock);
+#elif defined(PST_THREADS_PTHREAD)
+	pthread_mutex_lock(&obj->lock);
+#endif
+
+	if (obj->next < obj->count) {
+		*i = obj->next++;
+		ret = 1;
+	}
+
+#if defined(PST_THREADS_WIN32)
+	LeaveCriticalSection(&obj->lock);
+#elif defined(PST_THREADS_PTHREAD)
+	pthread_mutex_unlock(&obj->lock);
+#endif
+
+	return ret;
+}
+
+static void parallel_work(PARALLEL *obj) {
+	size_t i = 0;
+
+	while (parallel_claim(obj, &i)) {
+		obj->job(obj->ctx, i);
+	}
+}
+
+#if defined(PST_THREADS_WIN32)
+static DWORD WINAPI parallel_thread(LPVOID arg) {
+	parallel_work((PARALLEL*)arg);
+	return 0;
+}
+#elif defined(PST_THREADS_PTHREAD)
+static void *parallel_thread(void *arg) {
+	parallel_work((PARALLEL*)arg);
+	return NULL;
+}
+#endif
+
+int PST_parallelFor(size_t count, int nthreads, void (*job)(void *ctx, size_t i), void *ctx) {
+	PARALLEL obj;
+#if defined(PST_THREADS_WIN32) || defined(PST_THREADS_PTHREAD)
+	PST_THREAD *threads = NULL;
+#endif
+	int started = 0;
+	int i = 0;
+
+	if (nthreads < 1 || job == NULL) return PST_INVALID_ARGUMENT;
+
+	obj.count = count;
+	obj.next = 0;
+	obj.job = job;
+	obj.ctx = ctx;
+
+	if ((size_t)nthreads > count) nthreads = (int)count;
+
+#if defined(PST_THREADS_WIN32)
+	InitializeCriticalSection(&obj.lock);
+#elif defined(PST_THREADS_PTHREAD)
+	if (pthread_mutex_init(&obj.lock, NULL) != 0) return PST_UNDEFINED_BEHAVIOUR;
+#endif
+
+#if defined(PST_THREADS_WIN32) || defined(PST_THREADS_PTHREAD)
+	if (nthreads > 1) threads = (PST_THREAD*)malloc(sizeof(*threads) * (nthreads - 1));
+
+	/* If a thread can not be started, the remaining workers take over its jobs. */
+	if (threads != NULL) {
+		for (started = 0; started < nthreads - 1; started++) {
+#	if defined(PST_THREADS_WIN32)
+			threads[started] = CreateThread(NULL, 0, parallel_thread, &obj, 0, NULL);
+			if (threads[started] == NULL) break;
+#	else
+			if (pthread_create(&threads[started], NULL, parallel_thread, &obj) != 0) break;
+#	endif
+		}
+	}
+#endif
+
+	/* The calling thread is a worker too. */
+	parallel_work(&obj);
+
+#if defined(PST_THREADS_WIN32) || defined(PST_THREADS_PTHREAD)
+	for (i = 0; i < started; i++) {
+#	if defined(PST_THREADS_WIN32)
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+#	else
+		pthread_join(threads[i], NULL);
+#	endif
+	}
+	free(threads);
+#else
+	(void)started;
+	(void)i;
+#endif
+
+#if defined(PST_THREADS_WIN32)
+	DeleteCriticalSection(&obj.lock);
+#elif defined(PST_THREADS_PTHREAD)
+	pthread_mutex_destroy(&obj.lock);
+#endif
+
+	return PST_OK;
+}
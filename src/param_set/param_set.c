@@ -29,7 +29,7 @@
 #include "strn.h"
 
 #define TYPO_SENSITIVITY 10
-#define TYPO_MAX_COUNT 5
+#define TYPO_MAX_COUNT PST_DIAG_MAX_CANDIDATES
 #define VARIABLE_IS_NOT_USED(v) ((void)(v));
 
 #ifndef _WIN32
@@ -327,91 +327,243 @@ static unsigned min_of_3(unsigned A, unsigned B,unsigned C){
 	return tmp < C ? tmp : C;
 }
 
-#define UP(m,i,j) m[i-1][j]	//del
-#define LEFT(m,i,j) m[i][j-1] //ins
-#define DIAG(m,i,j) m[i-1][j-1] //rep
-
-/*TODO refactor*/
-static int editDistance_levenshtein(const char *A, const char *B){
+/**
+ * Calculates the edit distance between \c A and \c B. Only the previous and the
+ * current column of the matrix are kept in \c m that must have room for
+ * 2 * (strlen(A) + 1) elements.
+ */
+static int editDistance_levenshtein(const char *A, const char *B, char *m){
 	unsigned lenA, lenB;
-	unsigned M_H, M_W;
-	unsigned i=0, j=0;
-	char **m;
-	unsigned rows_created = 0;
-	int edit_distance = -1;
+	unsigned i = 0, j = 0;
+	char *prev = m;
+	char *cur = NULL;
+	char *tmp = NULL;
 
 	/*Get the size of each string*/
 	lenA = (unsigned)strlen(A);//vertical
 	lenB = (unsigned)strlen(B);//horizontal
-	/*Data matrix is larger by 1 row and column*/
-	M_H = lenA+1;
-	M_W = lenB+1;
+	cur = m + lenA + 1;
 
-	/*Creating of initial matrix*/
-	m=(char**)malloc(M_H * sizeof(*m));
-	if (m == NULL) goto cleanup;
+	for (i = 0; i <= lenA; i++) prev[i] = 0xff & i;
 
-	for (i=0; i<M_H; i++){
-		m[i]=(char*)malloc(M_W * sizeof(*m[i]));
-		if (m[i] == NULL) goto cleanup;
-		m[i][0] = 0xff & i;
-		rows_created++;
+	for (j = 1; j <= lenB; j++) {
+		cur[0] = 0xff & j;
+		for (i = 1; i <= lenA; i++) {
+			if (A[i-1] == B[j-1]) cur[i] = prev[i-1];
+			else cur[i] = (0xff & min_of_3(cur[i-1], prev[i], prev[i-1])) + 1;
+		}
+
+		tmp = prev;
+		prev = cur;
+		cur = tmp;
 	}
 
-	for (j=0; j<M_W; j++) m[0][j] = 0xff & j;
+	return prev[lenA];
+}
 
-	for (j=1; j<M_W; j++){
-		for (i=1; i<M_H; i++){
-			if (A[i-1] == B[j-1]) m[i][j] = DIAG(m,i,j);
-			else m[i][j] = (0xff & min_of_3(UP(m,i,j), LEFT(m,i,j), DIAG(m,i,j))) + 1;
-		}
+static unsigned long param_set_spec_hash(const char *key, unsigned long seed) {
+	unsigned long hash = (2166136261UL ^ seed) & 0xffffffffUL;
+
+	while (*key != '\0') {
+		hash ^= (unsigned char)*key++;
+		hash = (hash * 16777619UL) & 0xffffffffUL;
 	}
-	edit_distance = m[i-1][j-1];
 
+	/* Final mix, as the seeds differ only in a few bits. */
+	hash ^= hash >> 15;
+	hash = (hash * 0x2c1b3c6dUL) & 0xffffffffUL;
+	hash ^= hash >> 12;
 
-cleanup:
-	if (m)
-		for (i=0; i<rows_created; i++) free(m[i]);
-	free(m);
+	return hash;
+}
 
-	return edit_distance;
+static unsigned param_set_spec_slot(const PARAM_SET_SPEC *spec, const char *key) {
+	unsigned bucket = (unsigned)(param_set_spec_hash(key, spec->seed) % spec->bucketCount);
+	return (unsigned)(param_set_spec_hash(key, spec->displace[bucket]) & (spec->hashSize - 1));
 }
 
-static int param_set_getParameterByName(const PARAM_SET *set, const char *name, PARAM **param){
-	int res = 0;
-	PARAM *parameter = NULL;
-	PARAM *tmp = NULL;
-	int i = 0;
+/**
+ * Returns the index of the parameter with the name or alias, \c -1 if not found.
+ */
+static int param_set_spec_find(const PARAM_SET_SPEC *spec, const char *name) {
+	const PARAM_SET_SPEC_PARAM *param = NULL;
+	int i = spec->hash[param_set_spec_slot(spec, name)];
 
-	if (set == NULL || param == NULL || name == NULL) {
-		res = PST_INVALID_ARGUMENT;
-		goto cleanup;
+	if (i < 0) return -1;
+
+	param = &spec->param[i];
+	if (strcmp(param->name, name) == 0 || (param->alias != NULL && strcmp(param->alias, name) == 0)) return i;
+
+	return -1;
+}
+
+static void param_set_loaded_free(PARAM_SET_LOADED *loaded) {
+	PARAM_SET_LOADED *next = NULL;
+
+	while (loaded != NULL) {
+		next = loaded->next;
+		free(loaded->fname);
+		free(loaded->source);
+		FILE_TOKENS_free(loaded->tokens);
+		free(loaded);
+		loaded = next;
 	}
+}
+
+static void param_set_lookup_free(PARAM_SET_LOOKUP *lookup) {
+	if (lookup == NULL) return;
+	free(lookup->bucket);
+	free(lookup->name);
+	free(lookup);
+}
+
+static int param_set_lookup_new(const PARAM_SET *set, PARAM_SET_LOOKUP **lookup) {
+	int res;
+	PARAM_SET_LOOKUP *tmp = NULL;
+	size_t *next = NULL;
+	size_t count = 0;
+	size_t len;
+	int i;
+	int n;
 
+	tmp = (PARAM_SET_LOOKUP*)calloc(1, sizeof(*tmp));
+	if (tmp == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
 
+	/* The first name found for a character is kept, as with a linear search. */
 	for (i = 0; i < set->count; i++) {
-		parameter = set->parameter[i];
-		if (parameter != NULL){
-			if (strcmp(parameter->flagName, name) == 0 || (parameter->flagAlias && strcmp(parameter->flagAlias, name) == 0)) {
-				tmp = parameter;
-				break;
+		const char *names_of_param[2];
+
+		if (set->parameter[i] == NULL) continue;
+
+		names_of_param[0] = set->parameter[i]->flagName;
+		names_of_param[1] = set->parameter[i]->flagAlias;
+
+		for (n = 0; n < 2; n++) {
+			if (names_of_param[n] == NULL) continue;
+
+			len = strlen(names_of_param[n]);
+			if (len == 1) {
+				unsigned char C = (unsigned char)names_of_param[n][0];
+				if (tmp->shortName[C] == NULL) tmp->shortName[C] = set->parameter[i];
+			} else if (set->spec == NULL) {
+				if (len > tmp->maxLen) tmp->maxLen = len;
+				count++;
 			}
 		}
 	}
 
-	if (tmp == NULL) {
-		res = PST_PARAMETER_NOT_FOUND;
+	/* Longer names are sorted by the length, keeping the order of the parameters. */
+	tmp->bucket = (size_t*)calloc(tmp->maxLen + 2, sizeof(size_t));
+	next = (size_t*)calloc(tmp->maxLen + 2, sizeof(size_t));
+	tmp->name = (PARAM_SET_NAME*)malloc((count > 0 ? count : 1) * sizeof(PARAM_SET_NAME));
+	if (tmp->bucket == NULL || next == NULL || tmp->name == NULL) {
+		res = PST_OUT_OF_MEMORY;
 		goto cleanup;
 	}
 
-	*param = parameter;
+	for (i = 0; i < set->count && count > 0; i++) {
+		if (set->parameter[i] == NULL) continue;
+
+		len = strlen(set->parameter[i]->flagName);
+		if (len != 1) tmp->bucket[len + 1]++;
+
+		if (set->parameter[i]->flagAlias == NULL) continue;
+
+		len = strlen(set->parameter[i]->flagAlias);
+		if (len != 1) tmp->bucket[len + 1]++;
+	}
+
+	for (len = 1; len < tmp->maxLen + 2; len++) {
+		tmp->bucket[len] += tmp->bucket[len - 1];
+		next[len] = tmp->bucket[len];
+	}
+
+	for (i = 0; i < set->count && count > 0; i++) {
+		const char *names_of_param[2];
+		PARAM *param = set->parameter[i];
+
+		if (param == NULL) continue;
+
+		names_of_param[0] = param->flagName;
+		names_of_param[1] = param->flagAlias;
+
+		for (n = 0; n < 2; n++) {
+			PARAM_SET_NAME *rec = NULL;
+
+			if (names_of_param[n] == NULL || (len = strlen(names_of_param[n])) == 1) continue;
+
+			rec = &tmp->name[next[len]++];
+			rec->hash = (n == 0) ? param->nameHash : param->aliasHash;
+			rec->name = names_of_param[n];
+			rec->param = param;
+		}
+	}
+
+	*lookup = tmp;
+	tmp = NULL;
 	res = PST_OK;
 
 cleanup:
 
+	free(next);
+	param_set_lookup_free(tmp);
+
 	return res;
 }
 
+/**
+ * Finds the parameter by name or alias. The length of the name is returned
+ * as it is measured anyway.
+ */
+static PARAM* param_set_lookup_find(const PARAM_SET *set, const char *name, size_t *name_len) {
+	const PARAM_SET_LOOKUP *lookup = set->lookup;
+	size_t len = strlen(name);
+	size_t i;
+	unsigned hash;
+	int at;
+
+	if (name_len != NULL) *name_len = len;
+
+	if (len == 1) return lookup->shortName[(unsigned char)name[0]];
+
+	if (set->spec != NULL) {
+		at = param_set_spec_find(set->spec, name);
+		return (at >= 0) ? set->parameter[at] : NULL;
+	}
+
+	if (len > lookup->maxLen) return NULL;
+
+	hash = PARAM_nameHash(name);
+	for (i = lookup->bucket[len]; i < lookup->bucket[len + 1]; i++) {
+		const PARAM_SET_NAME *rec = &lookup->name[i];
+		if (rec->hash == hash && memcmp(rec->name, name, len) == 0) return rec->param;
+	}
+
+	return NULL;
+}
+
+PARAM *PARAM_SET_findParameter(const PARAM_SET *set, const char *name) {
+	if (set == NULL || name == NULL) return NULL;
+	return param_set_lookup_find(set, name, NULL);
+}
+
+static int param_set_getParameterByName(const PARAM_SET *set, const char *name, PARAM **param){
+	PARAM *tmp = NULL;
+
+	if (set == NULL || param == NULL || name == NULL) return PST_INVALID_ARGUMENT;
+
+	PST_STATS_ADD(set->stats, nameLookups, 1);
+
+	tmp = param_set_lookup_find(set, name, NULL);
+	if (tmp == NULL) return PST_PARAMETER_NOT_FOUND;
+
+	*param = tmp;
+	return PST_OK;
+}
+
 typedef struct TYPO_st {
 	char *name;
 	int difference;
@@ -483,12 +635,14 @@ static int param_set_analyze_similarity(PARAM_SET *set, const char *str, int sen
 		 * compared with input string. If alias exists select the one that is more
 		 * similar.
 		 */
-		name_edit_distance = editDistance_levenshtein(array[i]->flagName, str);
+		name_edit_distance = editDistance_levenshtein(array[i]->flagName, str, set->editColumns);
+		PST_STATS_ADD(set->stats, editDistances, 1);
 		name_len = (unsigned)strlen(array[i]->flagName);
 		name_difference = (name_edit_distance * 100) / name_len;
 
 		if (array[i]->flagAlias) {
-			alias_edit_distance = editDistance_levenshtein(array[i]->flagAlias, str);
+			alias_edit_distance = editDistance_levenshtein(array[i]->flagAlias, str, set->editColumns);
+			PST_STATS_ADD(set->stats, editDistances, 1);
 			alias_len = (unsigned)strlen(array[i]->flagAlias);
 			alias_difference = (alias_edit_distance * 100) / alias_len;
 		}
@@ -533,25 +687,83 @@ static int param_set_analyze_similarity(PARAM_SET *set, const char *str, int sen
 	return (typo_count > 0 && typo_count <= max_count) ? 1 : 0;
 }
 
-int param_set_add_typo_from_list(PARAM_SET *set, const char *typo, const char *source, TYPO *typo_list, size_t typo_list_len) {
+/**
+ * Result of the typo analysis of an unknown name that is remembered by the set.
+ */
+typedef struct TYPO_MEMO_st {
+	int isTypo;
+	int count;
+	int candidate[TYPO_MAX_COUNT];
+} TYPO_MEMO;
+
+/**
+ * Allocates the scratch area of the typo analysis when it is needed for the
+ * first time: the list of all the parameters and two columns of the edit
+ * distance matrix of the longest name. As the parameters of the set do not
+ * change, the area is reused until the set is freed.
+ */
+static int param_set_typo_scratch(PARAM_SET *set) {
 	int res;
-	size_t i = 0;
+	TYPO *typo_list = NULL;
+	char *columns = NULL;
+	size_t len = 0;
+	size_t tmp;
+	int i;
 
-	if (set == NULL || typo == NULL || typo_list == NULL || typo_list_len == 0) {
-		res = PST_INVALID_ARGUMENT;
+	if (set->typoList != NULL) return PST_OK;
+
+	for (i = 0; i < set->count; i++) {
+		tmp = strlen(set->parameter[i]->flagName);
+		if (tmp > len) len = tmp;
+
+		if (set->parameter[i]->flagAlias != NULL) {
+			tmp = strlen(set->parameter[i]->flagAlias);
+			if (tmp > len) len = tmp;
+		}
+	}
+
+	typo_list = (TYPO*)malloc((set->count > 0 ? set->count : 1) * sizeof(*typo_list));
+	columns = (char*)malloc(2 * (len + 1));
+	if (typo_list == NULL || columns == NULL) {
+		res = PST_OUT_OF_MEMORY;
 		goto cleanup;
 	}
 
-	res = PARAM_addValue(set->typos, typo, source, 1);
+	set->typoList = typo_list;
+	set->editColumns = columns;
+	typo_list = NULL;
+	columns = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	free(typo_list);
+	free(columns);
+
+	return res;
+}
+
+static int param_set_analyze_unknown(PARAM_SET *set, const char *name, TYPO_MEMO *memo) {
+	int res;
+	int i;
+
+	/* The same unknown names tend to repeat, e.g. in configuration files of other versions. */
+	if (set->typoMemo != NULL && CACHE_get(set->typoMemo, name, memo)) return PST_OK;
+
+	res = param_set_typo_scratch(set);
 	if (res != PST_OK) goto cleanup;
 
+	memo->isTypo = param_set_analyze_similarity(set, name, TYPO_SENSITIVITY, TYPO_MAX_COUNT, set->typoList);
+	memo->count = 0;
+	for (i = 0; memo->isTypo && i < set->count && memo->count < TYPO_MAX_COUNT; i++) {
+		if (set->typoList[i].isTypo) memo->candidate[memo->count++] = i;
+	}
 
-	for (i = 0; i < typo_list_len; i++) {
-		if (typo_list[i].isTypo) {
-			res = PARAM_addValue(set->typos, typo_list[i].name, typo, 0);
-			if (res != PST_OK) goto cleanup;
-		}
+	/* Failing to remember the result is not an error. */
+	if (set->typoMemo == NULL && CACHE_new(PARAM_SET_TYPO_MEMO_SIZE, sizeof(TYPO_MEMO), &set->typoMemo) != PST_OK) {
+		set->typoMemo = NULL;
 	}
+	if (set->typoMemo != NULL) CACHE_put(set->typoMemo, name, memo);
 
 	res = PST_OK;
 
@@ -560,24 +772,38 @@ cleanup:
 	return res;
 }
 
-static int bunch_of_flags_get_unknown_count(PARAM_SET *set, const char *bunch_of_flags) {
+/**
+ * Adds the name that is not known by the set to the list of typos, if it is
+ * similar to some known names, or to the list of unknown parameters.
+ * \return #PST_OK, #PST_PARAMETER_IS_TYPO or #PST_PARAMETER_IS_UNKNOWN if successful,
+ * error code otherwise.
+ */
+static int param_set_add_unknown(PARAM_SET *set, const char *name, const char *source) {
 	int res;
-	char str_flg[2] = {255,0};
+	TYPO_MEMO memo;
+
+	res = param_set_analyze_unknown(set, name, &memo);
+	if (res != PST_OK) return res;
+
+	if (memo.isTypo) {
+		res = DIAG_LIST_add(set->diag, PST_DIAG_TYPO, source, name, memo.candidate, memo.count);
+		return (res == PST_OK) ? PST_PARAMETER_IS_TYPO : res;
+	}
+
+	res = DIAG_LIST_add(set->diag, PST_DIAG_UNKNOWN, source, name, NULL, 0);
+	return (res == PST_OK) ? PST_PARAMETER_IS_UNKNOWN : res;
+}
+
+static int bunch_of_flags_get_unknown_count(PARAM_SET *set, const char *bunch_of_flags) {
 	int itr = 0;
-	PARAM *tmp = NULL;
 	int unknowns = 0;
 
 	if (set == 0 || bunch_of_flags == NULL) {
 		return 100;
 	}
 
-	while ((str_flg[0] = bunch_of_flags[itr++]) != '\0') {
-		res = param_set_getParameterByName(set, str_flg, &tmp);
-		if (res != PST_OK && res != PST_PARAMETER_NOT_FOUND) {
-			return 100;
-		}
-
-		if (res == PST_PARAMETER_NOT_FOUND) {
+	while (bunch_of_flags[itr] != '\0') {
+		if (set->lookup->shortName[(unsigned char)bunch_of_flags[itr++]] == NULL) {
 			unknowns++;
 		}
 	}
@@ -585,32 +811,22 @@ static int bunch_of_flags_get_unknown_count(PARAM_SET *set, const char *bunch_of
 	return unknowns;
 }
 
-static int param_set_add_typo_or_unknown(PARAM_SET *set, TYPO *typo_list, const char *source, const char *param, const char *arg) {
+static int param_set_add_typo_or_unknown(PARAM_SET *set, const char *source, const char *param, const char *arg) {
 	int res;
 
-	if (set == NULL || typo_list == NULL) {
+	if (set == NULL) {
 		res = PST_INVALID_ARGUMENT;
 		goto cleanup;
 	}
 
 	if (param != NULL) {
-		if (param_set_analyze_similarity(set, param, TYPO_SENSITIVITY, TYPO_MAX_COUNT, typo_list)) {
-			res = param_set_add_typo_from_list(set, param, source, typo_list, set->count);
-			if (res != PST_OK) goto cleanup;
-		} else {
-			res = PARAM_addValue(set->unknown, param, source, PST_PRIORITY_VALID_BASE);
-			if (res != PST_OK && res != PST_PARAMETER_IS_UNKNOWN && res != PST_PARAMETER_IS_TYPO) goto cleanup;
-		}
+		res = param_set_add_unknown(set, param, source);
+		if (res != PST_PARAMETER_IS_TYPO && res != PST_PARAMETER_IS_UNKNOWN) goto cleanup;
 	}
 
 	if (arg != NULL) {
-		if (param_set_analyze_similarity(set, arg, TYPO_SENSITIVITY, TYPO_MAX_COUNT, typo_list)) {
-			res = param_set_add_typo_from_list(set, arg, source, typo_list, set->count);
-			if (res != PST_OK) goto cleanup;
-		} else {
-			res = PARAM_addValue(set->unknown, arg, source, PST_PRIORITY_VALID_BASE);
-			if (res != PST_OK && res != PST_PARAMETER_IS_UNKNOWN && res != PST_PARAMETER_IS_TYPO) goto cleanup;
-		}
+		res = param_set_add_unknown(set, arg, source);
+		if (res != PST_PARAMETER_IS_TYPO && res != PST_PARAMETER_IS_UNKNOWN) goto cleanup;
 	}
 
 	res = PST_OK;
@@ -626,25 +842,20 @@ cleanup:
  * --long <arg>	- long parameter with argument.
  * -i <arg>		- short parameter with argument.
  * -vxn			- bunch of flags.
+ * If onlyMarked is set, values are added only to the marked parameters (see
+ * PARAM_SET_reloadFromFile), unknown parameters are recorded as usual.
  * @param param - parameter.
  * @param arg
  * @param set
  */
-static int param_set_addRawParameter(const char *param, const char *arg, const char *source, PARAM_SET *set, int priority){
+static int param_set_addRawParameter(const char *param, const char *arg, const char *source, PARAM_SET *set, int priority, int onlyMarked){
 	int res;
 	const char *flag = NULL;
 	unsigned len;
-	TYPO *typo_list = NULL;
 	int unknown_count = 0;
+	PARAM *known = NULL;
 	len = (unsigned)strlen(param);
 
-	typo_list = (TYPO*) malloc(set->count * sizeof(*typo_list));
-	if (typo_list == NULL) {
-		res = PST_OUT_OF_MEMORY;
-		goto cleanup;
-	}
-
-
 	if (param[0] == '-' && param[1] != 0) {
 		flag = param + (param[1] == '-' ? 2 : 1);
 
@@ -653,7 +864,13 @@ static int param_set_addRawParameter(const char *param, const char *arg, const c
 		 * the argument. Otherwise it must be bunch of flags.
 		 */
 		if ((strncmp("--", param, 2) == 0 && len >= 3) || (param[0] == '-' && len == 2)) {
-			res = PARAM_SET_add(set, flag, arg, source, priority);
+			known = onlyMarked ? param_set_lookup_find(set, flag, NULL) : NULL;
+
+			if (known == NULL) {
+				res = PARAM_SET_add(set, flag, arg, source, priority);
+			} else {
+				res = known->isMarked ? PARAM_addValue(known, arg, source, priority) : PST_OK;
+			}
 			if (res != PST_OK && res != PST_PARAMETER_IS_UNKNOWN && res != PST_PARAMETER_IS_TYPO) {
 				goto cleanup;
 			}
@@ -664,7 +881,7 @@ static int param_set_addRawParameter(const char *param, const char *arg, const c
 			/**
 			 * If bunch of flags have an argument it must be a typo or unknown parameter.
 			 */
-			res = param_set_add_typo_or_unknown(set, typo_list, source, NULL, arg);
+			res = param_set_add_typo_or_unknown(set, source, NULL, arg);
 			if (res != PST_OK) goto cleanup;
 
 			/**
@@ -676,20 +893,27 @@ static int param_set_addRawParameter(const char *param, const char *arg, const c
 
 			if (unknown_count < 3) {
 				while ((str_flg[0] = flag[itr++]) != '\0') {
-					res = PARAM_SET_add(set, str_flg, NULL, source, priority);
+					known = set->lookup->shortName[(unsigned char)str_flg[0]];
+
+					/* Known flags are added directly, the rest is checked for typos. */
+					if (known != NULL) {
+						res = (!onlyMarked || known->isMarked) ? PARAM_addValue(known, NULL, source, priority) : PST_OK;
+					} else {
+						res = PARAM_SET_add(set, str_flg, NULL, source, priority);
+					}
 					if (res != PST_OK && res != PST_PARAMETER_IS_UNKNOWN && res != PST_PARAMETER_IS_TYPO) {
 						goto cleanup;
 					}
 				}
 			} else {
-				res = param_set_add_typo_or_unknown(set, typo_list, source, flag, NULL);
+				res = param_set_add_typo_or_unknown(set, source, flag, NULL);
 				if (res != PST_OK) goto cleanup;
 			}
 
 		}
 	}
 	else{
-		res = param_set_add_typo_or_unknown(set, typo_list, source, param, arg);
+		res = param_set_add_typo_or_unknown(set, source, param, arg);
 		if (res != PST_OK) goto cleanup;
 		goto cleanup;
 	}
@@ -698,11 +922,35 @@ static int param_set_addRawParameter(const char *param, const char *arg, const c
 
 cleanup:
 
-	if (typo_list != NULL) free(typo_list);
-
 	return res;
 }
 
+/**
+ * Marks the parameters the token adds values to, as param_set_addRawParameter
+ * does.
+ */
+static void param_set_mark_token_params(PARAM_SET *set, const char *param) {
+	const char *flag = NULL;
+	PARAM *known = NULL;
+	size_t len;
+	int i;
+
+	if (param == NULL || param[0] != '-' || param[1] == 0) return;
+
+	len = strlen(param);
+	flag = param + (param[1] == '-' ? 2 : 1);
+
+	if ((strncmp("--", param, 2) == 0 && len >= 3) || len == 2) {
+		known = param_set_lookup_find(set, flag, NULL);
+		if (known != NULL) known->isMarked = 1;
+	} else if (bunch_of_flags_get_unknown_count(set, flag) < 3) {
+		for (i = 0; flag[i] != '\0'; i++) {
+			known = set->lookup->shortName[(unsigned char)flag[i]];
+			if (known != NULL) known->isMarked = 1;
+		}
+	}
+}
+
 static int isComment(const char *line) {
 	int i = 0;
 	int C;
@@ -717,6 +965,192 @@ static int isComment(const char *line) {
 	return 0;
 }
 
+/**
+ * Iterates over the parameter of the set and the parameters with the same name
+ * in the layers of the set (see #PARAM_SET_pushLayer).
+ */
+typedef struct LAYER_ITR_st {
+	const PARAM_SET_LAYER *layer;	/* The next layer. */
+	const char *name;
+	PARAM *param;					/* The current parameter. */
+	int offset;						/* Priority offset of the current parameter. */
+} LAYER_ITR;
+
+static void layer_itr_init(LAYER_ITR *itr, const PARAM_SET *set, PARAM *param) {
+	itr->layer = set->layer;
+	itr->name = param->flagName;
+	itr->param = param;
+	itr->offset = 0;
+}
+
+/**
+ * Moves to the next layer that has the parameter. Returns 0 if there are no
+ * more layers.
+ */
+static int layer_itr_next(LAYER_ITR *itr) {
+	PARAM *tmp = NULL;
+
+	while (itr->layer != NULL) {
+		const PARAM_SET_LAYER *layer = itr->layer;
+
+		itr->layer = layer->next;
+		if (param_set_getParameterByName(layer->set, itr->name, &tmp) == PST_OK) {
+			itr->param = tmp;
+			itr->offset = layer->offset;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Converts the priority of the layered view to the priority of the values in
+ * the layer with the given offset. Returns 0 if none of the layer values can
+ * match the priority.
+ */
+static int layer_priority(int priority, int offset, int *layer_priority) {
+	int p;
+
+	if (offset == 0 || priority <= PST_PRIORITY_NONE) {
+		*layer_priority = priority;
+	} else if (priority <= PST_PRIORITY_VALID_ROOF) {
+		p = priority - offset;
+		if (p < PST_PRIORITY_VALID_BASE || p > PST_PRIORITY_VALID_ROOF) return 0;
+		*layer_priority = p;
+	} else if (priority < PST_PRIORITY_LOWER_THAN) {
+		p = priority - PST_PRIORITY_HIGHER_THAN - offset;
+		if (p > PST_PRIORITY_VALID_ROOF) return 0;
+		*layer_priority = (p < PST_PRIORITY_VALID_BASE) ? PST_PRIORITY_NONE : PST_PRIORITY_HIGHER_THAN + p;
+	} else {
+		p = priority - PST_PRIORITY_LOWER_THAN - offset;
+		if (p <= PST_PRIORITY_VALID_BASE) return 0;
+		*layer_priority = (p > PST_PRIORITY_VALID_ROOF) ? PST_PRIORITY_NONE : PST_PRIORITY_LOWER_THAN + p;
+	}
+
+	return 1;
+}
+
+/**
+ * Resolves #PST_PRIORITY_HIGHEST and #PST_PRIORITY_LOWEST to the highest or the
+ * lowest priority of all the values in the layered view.
+ */
+static void param_set_layered_priority(const PARAM_SET *set, PARAM *param, int priority, int *resolved) {
+	LAYER_ITR itr;
+	int found = 0;
+	int p = 0;
+
+	*resolved = priority;
+	if (priority != PST_PRIORITY_HIGHEST && priority != PST_PRIORITY_LOWEST) return;
+
+	layer_itr_init(&itr, set, param);
+	do {
+		if (itr.param->arg == NULL || PARAM_VAL_getPriority(itr.param->arg, priority, &p) != PST_OK) continue;
+		p += itr.offset;
+
+		if (!found || (priority == PST_PRIORITY_HIGHEST && p > *resolved) || (priority == PST_PRIORITY_LOWEST && p < *resolved)) {
+			*resolved = p;
+			found = 1;
+		}
+	} while (layer_itr_next(&itr));
+}
+
+/**
+ * Counts the values of the parameter including the values in the layers.
+ */
+static int param_set_layered_count(const PARAM_SET *set, PARAM *param, const char *source, int priority, int *count) {
+	int res;
+	LAYER_ITR itr;
+	int resolved = 0;
+	int p = 0;
+	int sub_count = 0;
+	int sum = 0;
+
+	if (set->layer == NULL) return PARAM_getValueCount(param, source, priority, count);
+
+	param_set_layered_priority(set, param, priority, &resolved);
+
+	layer_itr_init(&itr, set, param);
+	do {
+		if (!layer_priority(resolved, itr.offset, &p)) continue;
+
+		res = PARAM_getValueCount(itr.param, source, p, &sub_count);
+		if (res != PST_OK) return res;
+
+		sum += sub_count;
+	} while (layer_itr_next(&itr));
+
+	*count = sum;
+	return PST_OK;
+}
+
+/**
+ * Finds the parameter that holds the value at the position \c at of the layered
+ * view of \c param. Returns the parameter, the priority and the index to be used
+ * with the parameter and the priority offset of its values.
+ */
+static int param_set_layered_find(const PARAM_SET *set, PARAM *param, const char *source, int priority, int at,
+		PARAM **owner, int *owner_priority, int *owner_at, int *offset) {
+	int res;
+	LAYER_ITR itr;
+	int resolved = 0;
+	int p = 0;
+	int count = 0;
+	int sum = 0;
+	int has_values = 0;
+
+	if (set->layer == NULL) {
+		*owner = param;
+		*owner_priority = priority;
+		*owner_at = at;
+		*offset = 0;
+		return PST_OK;
+	}
+
+	if (at < PST_INDEX_LAST) return PST_INVALID_ARGUMENT;
+
+	param_set_layered_priority(set, param, priority, &resolved);
+
+	*owner = NULL;
+	layer_itr_init(&itr, set, param);
+	do {
+		if (itr.param->arg != NULL) has_values = 1;
+		if (!layer_priority(resolved, itr.offset, &p)) continue;
+
+		res = PARAM_getValueCount(itr.param, source, p, &count);
+		if (res != PST_OK) return res;
+		if (count == 0) continue;
+
+		if (at == PST_INDEX_LAST || sum + count > at) {
+			*owner = itr.param;
+			*owner_priority = p;
+			*owner_at = (at == PST_INDEX_LAST) ? PST_INDEX_LAST : at - sum;
+			*offset = itr.offset;
+			if (at != PST_INDEX_LAST) break;
+		}
+
+		sum += count;
+	} while (layer_itr_next(&itr));
+
+	if (*owner == NULL) return has_values ? PST_PARAMETER_VALUE_NOT_FOUND : PST_PARAMETER_EMPTY;
+
+	return PST_OK;
+}
+
+/**
+ * Returns 1 if the parameter or the parameter in any layer has values.
+ */
+static int param_set_layered_is_set(const PARAM_SET *set, PARAM *param) {
+	LAYER_ITR itr;
+
+	layer_itr_init(&itr, set, param);
+	do {
+		if (itr.param->argCount > 0) return 1;
+	} while (layer_itr_next(&itr));
+
+	return 0;
+}
+
 int param_set_getParameterByConstraints(PARAM_SET *set, const char *names, const char *source, int priority, int at, PARAM **param, int *index, int *value_c_before) {
 	int res = PST_UNKNOWN_ERROR;
 	const char *pName = NULL;
@@ -743,7 +1177,7 @@ int param_set_getParameterByConstraints(PARAM_SET *set, const char *names, const
 		res = param_set_getParameterByName(set, buf, &parameter);
 		if (res != PST_OK) goto cleanup;;
 
-		res = PARAM_getValueCount(parameter, source, priority, &count);
+		res = param_set_layered_count(set, parameter, source, priority, &count);
 		if (res != PST_OK) goto cleanup;
 
 		if (count != 0) {
@@ -782,27 +1216,101 @@ cleanup:
 	return res;
 }
 
-int PARAM_SET_new(const char *names, PARAM_SET **set){
+/**
+ * Creates a #PARAM_SET with room for \c paramCount parameters that are not
+ * created yet.
+ */
+static int param_set_new_empty(int paramCount, PARAM_SET **set) {
 	int res;
 	PARAM_SET *tmp = NULL;
 	PARAM **tmp_param = NULL;
-	PARAM *tmp_typo = NULL;
-	PARAM *tmp_unknwon = NULL;
-	PARAM *tmp_syntax = NULL;
-	const char *pName = NULL;
-	int paramCount = 0;
-	int i = 0;
-	char mem = 0;
-	char buf[1024];
-	char alias[1024];
-	int flags = 0;
+	DIAG_LIST *tmp_diag = NULL;
 
-	if (set == NULL || names == NULL) {
-		res = PST_INVALID_ARGUMENT;
+	/**
+	 * Create empty objects.
+	 */
+	tmp = (PARAM_SET*)malloc(sizeof(*tmp));
+	if (tmp == NULL) {
+		res = PST_OUT_OF_MEMORY;
 		goto cleanup;
 	}
 
-	/**
+	tmp->count = 0;
+	tmp->parameter = NULL;
+	tmp->diag = NULL;
+	tmp->snapshot = NULL;
+	tmp->fileCache = NULL;
+	tmp->watch = NULL;
+	tmp->loaded = NULL;
+	tmp->spec = NULL;
+	tmp->lookup = NULL;
+	tmp->typoMemo = NULL;
+	tmp->typoList = NULL;
+	tmp->editColumns = NULL;
+	tmp->changeCount = 0;
+	tmp->allChanged = 0;
+	tmp->stats = NULL;
+	tmp->trace = NULL;
+	tmp->traceCtx = NULL;
+	tmp->layer = NULL;
+	tmp->lastLayer = NULL;
+
+	tmp_param = (PARAM**)calloc(paramCount > 0 ? paramCount : 1, sizeof(PARAM*));
+	if (tmp_param == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	/**
+	 * Initialize the list to hold typos, unknown parameters and syntax errors.
+	 */
+	res = DIAG_LIST_new(&tmp_diag);
+	if (res != PST_OK) goto cleanup;
+
+#ifndef PST_DISABLE_STATS
+	tmp->stats = (PARAM_SET_STATS*)calloc(1, sizeof(PARAM_SET_STATS));
+	if (tmp->stats == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+#endif
+
+	tmp->count = paramCount;
+	tmp->parameter = tmp_param;
+	tmp->diag = tmp_diag;
+	tmp_diag = NULL;
+	tmp_param = NULL;
+
+	*set = tmp;
+	tmp = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	DIAG_LIST_free(tmp_diag);
+	PARAM_SET_free(tmp);
+	free(tmp_param);
+
+	return res;
+}
+
+int PARAM_SET_new(const char *names, PARAM_SET **set){
+	int res;
+	PARAM_SET *tmp = NULL;
+	const char *pName = NULL;
+	int paramCount = 0;
+	int i = 0;
+	char mem = 0;
+	char buf[1024];
+	char alias[1024];
+	int flags = 0;
+
+	if (set == NULL || names == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	/**
 	 * Calculate the parameter count.
 	 */
 	while (names[i]){
@@ -814,76 +1322,363 @@ int PARAM_SET_new(const char *names, PARAM_SET **set){
 		i++;
 	}
 
+	res = param_set_new_empty(paramCount, &tmp);
+	if (res != PST_OK) goto cleanup;
+
 	/**
-	 * Create empty objects.
+	 * Add parameters to the list.
 	 */
-	tmp = (PARAM_SET*)malloc(sizeof(*tmp));
-	if (tmp == NULL) {
+	i = 0;
+	pName = names;
+	while ((pName = getParametersName(pName, buf, alias, sizeof(buf), &flags)) != NULL){
+		res = PARAM_new(buf, alias[0] ? alias : NULL, flags, PST_PRSCMD_DEFAULT, &tmp->parameter[i]);
+		if (res != PST_OK) goto cleanup;
+		PARAM_setStats(tmp->parameter[i], tmp->stats);
+		PARAM_setChangeCounter(tmp->parameter[i], &tmp->changeCount);
+		i++;
+	}
+
+	res = param_set_lookup_new(tmp, &tmp->lookup);
+	if (res != PST_OK) goto cleanup;
+
+	*set = tmp;
+	tmp = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	PARAM_SET_free(tmp);
+
+	return res;
+}
+
+typedef struct SPEC_KEY_st {
+	const char *key;
+	int index;
+	unsigned bucket;
+} SPEC_KEY;
+
+typedef struct SPEC_BUCKET_st {
+	unsigned bucket;
+	int size;
+} SPEC_BUCKET;
+
+static int spec_bucket_compare(const void *a, const void *b) {
+	const SPEC_BUCKET *A = (const SPEC_BUCKET*)a;
+	const SPEC_BUCKET *B = (const SPEC_BUCKET*)b;
+	if (A->size != B->size) return (A->size < B->size) ? 1 : -1;
+	return (A->bucket < B->bucket) ? -1 : (A->bucket > B->bucket);
+}
+
+/**
+ * Builds the perfect hash (hash and displace). Keys are split into buckets by
+ * the first hash. Starting from the largest bucket, a displacement is searched
+ * that maps all the keys in the bucket to free slots.
+ */
+static int param_set_spec_build_hash(SPEC_KEY *key, int key_count, unsigned long *seed,
+		unsigned *bucketCount, unsigned short **displace, unsigned *hashSize, short **hash) {
+	int res;
+	unsigned size = 8;
+	unsigned buckets = 0;
+	unsigned long s = 0;
+	unsigned short *tmp_displace = NULL;
+	short *tmp_hash = NULL;
+	SPEC_BUCKET *order = NULL;
+	unsigned *slot = NULL;
+	int i, k, n;
+	unsigned b;
+
+	while (size < (unsigned)key_count * 2) size *= 2;
+	buckets = (key_count / 2 > 0) ? (unsigned)(key_count / 2) : 1;
+
+	order = (SPEC_BUCKET*)malloc(sizeof(*order) * buckets);
+	slot = (unsigned*)malloc(sizeof(*slot) * (key_count > 0 ? key_count : 1));
+	tmp_displace = (unsigned short*)malloc(sizeof(*tmp_displace) * buckets);
+	if (order == NULL || slot == NULL || tmp_displace == NULL) {
 		res = PST_OUT_OF_MEMORY;
 		goto cleanup;
 	}
 
-	tmp->parameter = NULL;
-	tmp->typos = NULL;
-	tmp->unknown = NULL;
-	tmp->syntax = NULL;
+	for (; size <= 0x8000; size *= 2) {
+		free(tmp_hash);
+		tmp_hash = (short*)malloc(sizeof(*tmp_hash) * size);
+		if (tmp_hash == NULL) {
+			res = PST_OUT_OF_MEMORY;
+			goto cleanup;
+		}
 
-	tmp_param = (PARAM**)calloc(paramCount, sizeof(PARAM*));
-	if (tmp == NULL) {
+		for (s = 0; s < 64; s++) {
+			int is_ok = 1;
+
+			for (b = 0; b < size; b++) tmp_hash[b] = -1;
+			for (b = 0; b < buckets; b++) {
+				order[b].bucket = b;
+				order[b].size = 0;
+				tmp_displace[b] = 0;
+			}
+
+			for (i = 0; i < key_count; i++) {
+				key[i].bucket = (unsigned)(param_set_spec_hash(key[i].key, s) % buckets);
+				order[key[i].bucket].size++;
+			}
+
+			qsort(order, buckets, sizeof(*order), spec_bucket_compare);
+
+			for (b = 0; b < buckets && order[b].size > 0 && is_ok; b++) {
+				unsigned long d;
+				int is_placed = 0;
+
+				for (d = 1; d <= 0xffff && !is_placed; d++) {
+					n = 0;
+					is_placed = 1;
+
+					for (i = 0; i < key_count && is_placed; i++) {
+						if (key[i].bucket != order[b].bucket) continue;
+
+						slot[n] = (unsigned)(param_set_spec_hash(key[i].key, d) & (size - 1));
+						if (tmp_hash[slot[n]] != -1) is_placed = 0;
+						for (k = 0; k < n && is_placed; k++) {
+							if (slot[k] == slot[n]) is_placed = 0;
+						}
+						n++;
+					}
+
+					if (!is_placed) continue;
+
+					n = 0;
+					for (i = 0; i < key_count; i++) {
+						if (key[i].bucket != order[b].bucket) continue;
+						tmp_hash[slot[n++]] = (short)key[i].index;
+					}
+					tmp_displace[order[b].bucket] = (unsigned short)d;
+				}
+
+				if (!is_placed) is_ok = 0;
+			}
+
+			if (is_ok) {
+				*seed = s;
+				*bucketCount = buckets;
+				*displace = tmp_displace;
+				*hashSize = size;
+				*hash = tmp_hash;
+				tmp_displace = NULL;
+				tmp_hash = NULL;
+				res = PST_OK;
+				goto cleanup;
+			}
+		}
+	}
+
+	res = PST_INDEX_OVF;
+
+cleanup:
+
+	free(order);
+	free(slot);
+	free(tmp_displace);
+	free(tmp_hash);
+
+	return res;
+}
+
+int PARAM_SET_SPEC_new(const char *names, PARAM_SET_SPEC **spec) {
+	int res;
+	PARAM_SET_SPEC *tmp = NULL;
+	PARAM_SET_SPEC_PARAM *param = NULL;
+	SPEC_KEY *key = NULL;
+	unsigned short *displace = NULL;
+	short *hash = NULL;
+	const char *pName = NULL;
+	int paramCount = 0;
+	int key_count = 0;
+	int i = 0;
+	int k = 0;
+	char mem = 0;
+	char buf[1024];
+	char alias[1024];
+	int flags = 0;
+
+	if (spec == NULL || names == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	/* Parameter names are parsed exactly as by PARAM_SET_new. */
+	while (names[i]){
+		if (names[i] == '{') mem = names[i];
+		else if (mem == '{' && names[i] == '}'){
+			paramCount++;
+			mem = 0;
+		}
+		i++;
+	}
+
+	if (paramCount > 0x7fff) {
+		res = PST_INDEX_OVF;
+		goto cleanup;
+	}
+
+	tmp = (PARAM_SET_SPEC*)calloc(1, sizeof(*tmp));
+	param = (PARAM_SET_SPEC_PARAM*)calloc(paramCount > 0 ? paramCount : 1, sizeof(*param));
+	key = (SPEC_KEY*)malloc(sizeof(*key) * (paramCount > 0 ? paramCount * 2 : 1));
+	if (tmp == NULL || param == NULL || key == NULL) {
 		res = PST_OUT_OF_MEMORY;
 		goto cleanup;
 	}
 
-	/**
-	 * Initialize two special parameters to hold and extract unknown parameters.
-	 */
-	res = PARAM_new("unknown", NULL, 0, PST_PRSCMD_NONE, &tmp_unknwon);
-	if (res != PST_OK) goto cleanup;
+	tmp->version = PARAM_SET_SPEC_VERSION;
+	tmp->param = param;
 
-	res = PARAM_new("typo", NULL, 0, PST_PRSCMD_NONE, &tmp_typo);
-	if (res != PST_OK) goto cleanup;
+	i = 0;
+	pName = names;
+	while (i < paramCount && (pName = getParametersName(pName, buf, alias, sizeof(buf), &flags)) != NULL){
+		char *tmp_name = (char*)malloc(strlen(buf) + 1);
+		char *tmp_alias = alias[0] ? (char*)malloc(strlen(alias) + 1) : NULL;
+
+		param[i].name = tmp_name;
+		param[i].alias = tmp_alias;
+		tmp->count = i + 1;
+		if (tmp_name == NULL || (alias[0] && tmp_alias == NULL)) {
+			res = PST_OUT_OF_MEMORY;
+			goto cleanup;
+		}
 
-	res = PARAM_new("syntax", NULL, 0, PST_PRSCMD_NONE, &tmp_syntax);
-	if (res != PST_OK) goto cleanup;
+		strcpy(tmp_name, buf);
+		if (tmp_alias != NULL) strcpy(tmp_alias, alias);
+		param[i].constraints = flags;
+		param[i].parsingOptions = PST_PRSCMD_DEFAULT;
+		i++;
+	}
+
+	/* As with linear search, a name used more than once refers to the first parameter. */
+	for (i = 0; i < tmp->count; i++) {
+		const char *names_of_param[2];
+		int n;
+
+		names_of_param[0] = param[i].name;
+		names_of_param[1] = param[i].alias;
+
+		for (n = 0; n < 2; n++) {
+			int is_duplicate = 0;
 
-	res = PARAM_setObjectExtractor(tmp_typo, NULL);
+			if (names_of_param[n] == NULL) continue;
+
+			for (k = 0; k < key_count && !is_duplicate; k++) {
+				if (strcmp(key[k].key, names_of_param[n]) == 0) is_duplicate = 1;
+			}
+
+			if (is_duplicate) continue;
+
+			key[key_count].key = names_of_param[n];
+			key[key_count].index = i;
+			key_count++;
+		}
+	}
+
+	res = param_set_spec_build_hash(key, key_count, &tmp->seed, &tmp->bucketCount, &displace, &tmp->hashSize, &hash);
 	if (res != PST_OK) goto cleanup;
 
-	res = PARAM_setObjectExtractor(tmp_unknwon, NULL);
+	tmp->displace = displace;
+	tmp->hash = hash;
+	param = NULL;
+
+	*spec = tmp;
+	tmp = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	free(key);
+	PARAM_SET_SPEC_free(tmp);
+
+	return res;
+}
+
+void PARAM_SET_SPEC_free(PARAM_SET_SPEC *spec) {
+	int i;
+
+	if (spec == NULL) return;
+
+	if (spec->param != NULL) {
+		for (i = 0; i < spec->count; i++) {
+			free((void*)spec->param[i].name);
+			free((void*)spec->param[i].alias);
+		}
+	}
+
+	free((void*)spec->param);
+	free((void*)spec->displace);
+	free((void*)spec->hash);
+	free(spec);
+}
+
+static int param_set_spec_is_valid(const PARAM_SET_SPEC *spec) {
+	int i;
+
+	if (spec->version != PARAM_SET_SPEC_VERSION || spec->count < 0 || (spec->count > 0 && spec->param == NULL)
+			|| spec->hashSize == 0 || (spec->hashSize & (spec->hashSize - 1)) != 0 || spec->hash == NULL
+			|| spec->bucketCount == 0 || spec->displace == NULL) {
+		return 0;
+	}
+
+	/* Every name must be found, otherwise the lookup table does not match. */
+	for (i = 0; i < spec->count; i++) {
+		int at;
+
+		if (spec->param[i].name == NULL) return 0;
+
+		at = param_set_spec_find(spec, spec->param[i].name);
+		if (at < 0 || at > i) return 0;
+
+		if (spec->param[i].alias != NULL) {
+			at = param_set_spec_find(spec, spec->param[i].alias);
+			if (at < 0 || at > i) return 0;
+		}
+	}
+
+	return 1;
+}
+
+int PARAM_SET_newFromSpec(const PARAM_SET_SPEC *spec, PARAM_SET **set) {
+	int res;
+	PARAM_SET *tmp = NULL;
+	int i = 0;
+
+	if (spec == NULL || set == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	if (!param_set_spec_is_valid(spec)) {
+		res = PST_INVALID_FORMAT;
+		goto cleanup;
+	}
+
+	res = param_set_new_empty(spec->count, &tmp);
 	if (res != PST_OK) goto cleanup;
 
-	tmp->count = paramCount;
-	tmp->parameter = tmp_param;
-	tmp->typos = tmp_typo;
-	tmp->syntax = tmp_syntax;
-	tmp->unknown = tmp_unknwon;
-	tmp_typo = NULL;
-	tmp_unknwon = NULL;
-	tmp_param = NULL;
-	tmp_syntax = NULL;
+	for (i = 0; i < spec->count; i++) {
+		const PARAM_SET_SPEC_PARAM *param = &spec->param[i];
 
-	/**
-	 * Add parameters to the list.
-	 */
-	i = 0;
-	pName = names;
-	while ((pName = getParametersName(pName, buf, alias, sizeof(buf), &flags)) != NULL){
-		res = PARAM_new(buf, alias[0] ? alias : NULL, flags, PST_PRSCMD_DEFAULT, &tmp->parameter[i]);
+		res = PARAM_new(param->name, param->alias, param->constraints, param->parsingOptions, &tmp->parameter[i]);
 		if (res != PST_OK) goto cleanup;
-		i++;
+		PARAM_setStats(tmp->parameter[i], tmp->stats);
+		PARAM_setChangeCounter(tmp->parameter[i], &tmp->changeCount);
 	}
 
+	tmp->spec = spec;
+
+	res = param_set_lookup_new(tmp, &tmp->lookup);
+	if (res != PST_OK) goto cleanup;
+
 	*set = tmp;
 	tmp = NULL;
 	res = PST_OK;
 
 cleanup:
 
-	PARAM_free(tmp_unknwon);
-	PARAM_free(tmp_typo);
-	PARAM_free(tmp_syntax);
 	PARAM_SET_free(tmp);
-	free(tmp_param);
 
 	return res;
 }
@@ -901,9 +1696,21 @@ void PARAM_SET_free(PARAM_SET *set){
 		PARAM_free(array[i]);
 	free(set->parameter);
 
-	PARAM_free(set->typos);
-	PARAM_free(set->unknown);
-	PARAM_free(set->syntax);
+	DIAG_LIST_free(set->diag);
+	SNAPSHOT_free(set->snapshot);
+	WATCH_free(set->watch);
+	param_set_loaded_free(set->loaded);
+	param_set_lookup_free(set->lookup);
+	CACHE_free(set->typoMemo);
+	free(set->typoList);
+	free(set->editColumns);
+	free(set->stats);
+
+	while (set->layer != NULL) {
+		PARAM_SET_LAYER *next = set->layer->next;
+		free(set->layer);
+		set->layer = next;
+	}
 
 	free(set);
 	return;
@@ -938,6 +1745,26 @@ int PARAM_SET_addControl(PARAM_SET *set, const char *names,
 
 
 
+int PARAM_SET_setConverter(PARAM_SET *set, const char *names, int (*convert)(const char*, char*, size_t*)) {
+	int res;
+	PARAM *tmp = NULL;
+	const char *pName = NULL;
+	char buf[1024];
+
+	if (set == NULL || names == NULL) return PST_INVALID_ARGUMENT;
+
+	pName = names;
+	while ((pName = extract_next_name(pName, isValidNameChar, buf, sizeof(buf), NULL)) != NULL) {
+		res = param_set_getParameterByName(set, buf, &tmp);
+		if (res != PST_OK) return res;
+
+		res = PARAM_setConverter(tmp, convert);
+		if (res != PST_OK) return res;
+	}
+
+	return PST_OK;
+}
+
 static int param_set_set_print_name(PARAM_SET *set, const char *names,
 							int (*param_setPrintName)(PARAM *param, const char *constv, const char* (*getPrintName)(PARAM *param, char *buf, unsigned buf_len)),
 							const char *constv, const char* (*getPrintName)(PARAM *param, char *buf, unsigned buf_len)){
@@ -995,55 +1822,56 @@ int PARAM_SET_setHelpText(PARAM_SET *set, const char *names, const char *arg, co
 	return PST_OK;
 }
 
-char* PARAM_SET_helpToString(const PARAM_SET *set, const char *names, int indent, int header, int rowWidth, char *buf, size_t buf_len) {
+static int param_set_help_to_sink(const PARAM_SET *set, const char *names, int indent, int header, int rowWidth, PST_SINK *sink) {
 	int res;
 	const char *pName = NULL;
 	char nameBuf[1024];
-	size_t count = 0;
-
-	if (set == NULL || names == NULL || header == 0 || buf == NULL) return NULL;
 
 	pName = names;
 	while ((pName = extract_next_name(pName, isValidNameChar, nameBuf, sizeof(nameBuf), NULL)) != NULL) {
 		PARAM *tmp = NULL;
-		const char *name = NULL;
-		const char *alias = NULL;
-		const char *arg = NULL;
-		char param_name_combo[256];
-		const char *param_name = NULL;
-
-		if (count > buf_len) return NULL;
 
 		res = param_set_getParameterByName(set, nameBuf, &tmp);
-		if (res != PST_OK) return NULL;
+		if (res != PST_OK) return res;
 
-		name = PARAM_getPrintName(tmp);
-		alias = PARAM_getPrintNameAlias(tmp);
-		arg = PARAM_getHelpArg(tmp);
+		res = PARAM_helpToSink(tmp, indent, header, rowWidth, sink);
+		if (res != PST_OK) return res;
+	}
 
+	return PST_OK;
+}
 
-		if (alias == NULL) {
-			PST_snprintf(param_name_combo, sizeof(param_name_combo), "%s%s%s", name, (arg ? " " : ""), (arg ? arg : ""));
-			param_name = param_name_combo;
-		} else {
-			PST_snprintf(param_name_combo, sizeof(param_name_combo), "%s, %s%s%s", name, alias, (arg ? " " : ""), (arg ? arg : ""));
-			param_name = param_name_combo;
-		}
+char* PARAM_SET_helpToString(const PARAM_SET *set, const char *names, int indent, int header, int rowWidth, char *buf, size_t buf_len) {
+	PST_SINK sink;
 
-		count += PST_snhiprintf(buf + count, buf_len - count, rowWidth, indent, header, param_name, '-', "%s", PARAM_getHelpText(tmp));
-		count += PST_snprintf(buf + count, buf_len - count, "\n");
-	}
+	if (set == NULL || names == NULL || header == 0 || buf == NULL || buf_len == 0) return NULL;
+
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	if (param_set_help_to_sink(set, names, indent, header, rowWidth, &sink) != PST_OK) return NULL;
 
 	return buf;
 }
 
-int PARAM_SET_setWildcardExpander(PARAM_SET *set, const char *names,
-		const char* charList,
-		void *ctx,
-		void (*ctx_free)(void*),
-		int (*expand_wildcard)(PARAM_VAL *param_value, void *ctx, int *value_shift)){
+int PARAM_SET_helpToSink(const PARAM_SET *set, const char *names, int indent, int header, int rowWidth, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count) {
 	int res;
-	PARAM *tmp = NULL;
+	PST_SINK sink;
+
+	if (set == NULL || names == NULL || header == 0) return PST_INVALID_ARGUMENT;
+
+	PST_SINK_init(&sink, write, ctx);
+	res = param_set_help_to_sink(set, names, indent, header, rowWidth, &sink);
+	if (count != NULL) *count = sink.count;
+
+	return res;
+}
+
+int PARAM_SET_setWildcardExpander(PARAM_SET *set, const char *names,
+		const char* charList,
+		void *ctx,
+		void (*ctx_free)(void*),
+		int (*expand_wildcard)(PARAM_VAL *param_value, void *ctx, int *value_shift)){
+	int res;
+	PARAM *tmp = NULL;
 	const char *pName = NULL;
 	char buf[1024];
 
@@ -1078,24 +1906,40 @@ int PARAM_SET_setParseOptions(PARAM_SET *set, const char *names, int options){
 		if (res != PST_OK) return res;
 	}
 
+	/* Typo analysis depends on PST_PRSCMD_NO_TYPOS, so the remembered results are dropped. */
+	if (set->typoMemo != NULL) CACHE_clear(set->typoMemo);
+
+	return PST_OK;
+}
+
+int PARAM_SET_setControlOptions(PARAM_SET *set, const char *names, int options){
+	int res;
+	PARAM *tmp = NULL;
+	const char *pName = NULL;
+	char buf[1024];
+
+	if (set == NULL || names == NULL) return PST_INVALID_ARGUMENT;
+
+	pName = names;
+	while ((pName = extract_next_name(pName, isValidNameChar, buf, sizeof(buf), NULL)) != NULL) {
+		res = param_set_getParameterByName(set, buf, &tmp);
+		if (res != PST_OK) return res;
+
+		res = PARAM_setControlOptions(tmp, options);
+		if (res != PST_OK) return res;
+	}
+
 	return PST_OK;
 }
 
 int PARAM_SET_add(PARAM_SET *set, const char *name, const char *value, const char *source, int priority) {
 	int res;
 	PARAM *param = NULL;
-	TYPO *typo_list = NULL;
 	if (set == NULL || name == NULL) {
 		res = PST_INVALID_ARGUMENT;
 		goto cleanup;
 	}
 
-	typo_list = (TYPO*) malloc(set->count * sizeof(*typo_list));
-	if (typo_list == NULL) {
-		res = PST_OUT_OF_MEMORY;
-		goto cleanup;
-	}
-
 	res = param_set_getParameterByName(set, name, &param);
 	if (res == PST_PARAMETER_NOT_FOUND) {
 		/**
@@ -1103,26 +1947,14 @@ int PARAM_SET_add(PARAM_SET *set, const char *name, const char *value, const cha
 		 * is found push it to the typo list. If not a typo, push it to the unknown
 		 * list and if unknown flag has argument, push it too.
 		 */
-
-		/* Analyze similarity and */
-		if (param_set_analyze_similarity(set, name, TYPO_SENSITIVITY, TYPO_MAX_COUNT, typo_list)) {
-			res = param_set_add_typo_from_list(set, name, source, typo_list, set->count);
-			if (res != PST_OK) goto cleanup;
-
-			res = PST_PARAMETER_IS_TYPO;
-			goto cleanup;
-		} else {
-			res = PARAM_addValue(set->unknown, name, source, PST_PRIORITY_VALID_BASE);
+		res = param_set_add_unknown(set, name, source);
+		if (res == PST_PARAMETER_IS_UNKNOWN && value != NULL) {
+			res = DIAG_LIST_add(set->diag, PST_DIAG_UNKNOWN, source, value, NULL, 0);
 			if (res != PST_OK) goto cleanup;
 
-			if (value != NULL) {
-				res = PARAM_addValue(set->unknown, value, source, PST_PRIORITY_VALID_BASE);
-				if (res != PST_OK) goto cleanup;
-			}
-
 			res = PST_PARAMETER_IS_UNKNOWN;
-			goto cleanup;
 		}
+		goto cleanup;
 	} else if (res != PST_OK) {
 		goto cleanup;
 	}
@@ -1134,8 +1966,6 @@ int PARAM_SET_add(PARAM_SET *set, const char *name, const char *value, const cha
 
 cleanup:
 
-	if (typo_list != NULL) free(typo_list);
-
 	return res;
 }
 
@@ -1145,6 +1975,7 @@ int PARAM_SET_getObjExtended(PARAM_SET *set, const char *name, const char *sourc
 	void *extras[2] = {NULL, NULL};
 	int virtual_at = 0;
 	int values_before_target;
+	int offset = 0;
 
 	if (set == NULL || name == NULL || obj == NULL) {
 		res = PST_INVALID_ARGUMENT;
@@ -1162,6 +1993,9 @@ int PARAM_SET_getObjExtended(PARAM_SET *set, const char *name, const char *sourc
 		goto cleanup;
 	}
 
+	res = param_set_layered_find(set, param, source, priority, virtual_at, &param, &priority, &virtual_at, &offset);
+	if (res != PST_OK) goto cleanup;
+
 	extras[0] = set;
 	extras[1] = ctx;
 
@@ -1189,6 +2023,7 @@ int PARAM_SET_getStr(PARAM_SET *set, const char *name, const char *source, int p
 	PARAM_VAL *val = NULL;
 	int virtual_at = 0;
 	int values_before_target;
+	int offset = 0;
 
 
 	if (set == NULL || name == NULL || value == NULL) {
@@ -1207,6 +2042,9 @@ int PARAM_SET_getStr(PARAM_SET *set, const char *name, const char *source, int p
 		goto cleanup;
 	}
 
+	res = param_set_layered_find(set, param, source, priority, virtual_at, &param, &priority, &virtual_at, &offset);
+	if (res != PST_OK) goto cleanup;
+
 	res = PARAM_getValue(param, source, priority, virtual_at, &val);
 	if (res != PST_OK) goto cleanup;
 
@@ -1227,6 +2065,7 @@ cleanup:
 int PARAM_SET_getAtr(PARAM_SET *set, const char *name, const char *source, int priority, int at, PARAM_ATR *atr) {
 	int res;
 	PARAM *param = NULL;
+	int offset = 0;
 
 	if (set == NULL || name == NULL || atr == NULL) {
 		res = PST_INVALID_ARGUMENT;
@@ -1236,9 +2075,14 @@ int PARAM_SET_getAtr(PARAM_SET *set, const char *name, const char *source, int p
 	res = param_set_getParameterByName(set, name, &param);
 	if (res != PST_OK) goto cleanup;
 
+	res = param_set_layered_find(set, param, source, priority, at, &param, &priority, &at, &offset);
+	if (res != PST_OK) goto cleanup;
+
 	res = PARAM_getAtr(param, source, priority, at, atr);
 	if (res != PST_OK) goto cleanup;
 
+	atr->priority += offset;
+
 	res = PST_OK;
 
 cleanup:
@@ -1374,7 +2218,7 @@ int PARAM_SET_getValueCount(PARAM_SET *set, const char *names, const char *sourc
 			res = param_set_getParameterByName(set, buf, &param);
 			if (res != PST_OK) return res;
 
-			res = PARAM_getValueCount(param, source, priority, &sub_count);
+			res = param_set_layered_count(set, param, source, priority, &sub_count);
 			if (res != PST_OK) goto cleanup;
 
 			C+= sub_count;
@@ -1384,7 +2228,7 @@ int PARAM_SET_getValueCount(PARAM_SET *set, const char *names, const char *sourc
 		 * If parameter name list is NOT specified, count all parameters.
 		 */
 		for (i = 0; i < set->count; i++) {
-			res = PARAM_getValueCount(set->parameter[i], source, priority, &sub_count);
+			res = param_set_layered_count(set, set->parameter[i], source, priority, &sub_count);
 			if (res != PST_OK) goto cleanup;
 
 			C += sub_count;
@@ -1415,7 +2259,7 @@ static int param_set_count_parameters_set_by_name(const PARAM_SET *set, const ch
 		res = param_set_getParameterByName(set, buf, &tmp);
 		if (res != PST_OK && res != PST_PARAMETER_EMPTY) return res;
 
-		if (tmp->argCount > 0) set_c++;
+		if (param_set_layered_is_set(set, tmp)) set_c++;
 		else uset_c++;
 	}
 
@@ -1451,6 +2295,89 @@ int PARAM_SET_isOneOfSetByName(const PARAM_SET *set, const char *names){
 	return (set_count > 0) ? 1 : 0;
 }
 
+typedef struct VALIDATION_JOB_st {
+	PARAM *param;
+	PARAM_VAL *value;
+	int formatStatus;
+	int contentStatus;
+} VALIDATION_JOB;
+
+static void param_set_run_validation_job(void *ctx, size_t i) {
+	VALIDATION_JOB *job = ((VALIDATION_JOB*)ctx) + i;
+	PARAM_runControl(job->param, job->value->cstr_value, &job->formatStatus, &job->contentStatus);
+}
+
+int PARAM_SET_validateAll(PARAM_SET *set, int nthreads) {
+	int res;
+	int i = 0;
+	size_t n = 0;
+	size_t count = 0;
+	PARAM_VAL *value = NULL;
+	VALIDATION_JOB *jobs = NULL;
+
+	if (set == NULL || nthreads < 1) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	for (i = 0; i < set->count; i++) {
+		count += set->parameter[i]->pendingCount;
+	}
+
+	if (count == 0) {
+		res = PST_OK;
+		goto cleanup;
+	}
+
+	jobs = (VALIDATION_JOB*)malloc(sizeof(*jobs) * count);
+	if (jobs == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	/* Cached results are applied right away, the rest is run in parallel. */
+	for (i = 0; i < set->count; i++) {
+		PARAM *param = set->parameter[i];
+
+		for (value = param->arg; value != NULL; value = value->next) {
+			if (!value->isPending) continue;
+
+			if (PARAM_lookupControlResult(param, value->cstr_value, &jobs[n].formatStatus, &jobs[n].contentStatus)) {
+				PARAM_storeControlResult(param, value, jobs[n].formatStatus, jobs[n].contentStatus);
+				continue;
+			}
+
+			jobs[n].param = param;
+			jobs[n].value = value;
+			n++;
+		}
+	}
+
+	/**
+	 * Checks are run in parallel but the results are stored afterwards by the
+	 * calling thread in the order of the values.
+	 */
+	PST_trace(set, PST_TRACE_VALIDATE, 0);
+	res = PST_parallelFor(n, nthreads, param_set_run_validation_job, jobs);
+	PST_trace(set, PST_TRACE_VALIDATE, 1);
+	if (res != PST_OK) goto cleanup;
+
+	PST_STATS_ADD(set->stats, validatorCalls, n);
+
+	count = n;
+	for (n = 0; n < count; n++) {
+		PARAM_storeControlResult(jobs[n].param, jobs[n].value, jobs[n].formatStatus, jobs[n].contentStatus);
+	}
+
+	res = PST_OK;
+
+cleanup:
+
+	free(jobs);
+
+	return res;
+}
+
 int PARAM_SET_isFormatOK(const PARAM_SET *set){
 	int res;
 	int i = 0;
@@ -1511,86 +2438,691 @@ int PARAM_SET_isConstraintViolation(const PARAM_SET *set){
 }
 
 int PARAM_SET_isTypoFailure(const PARAM_SET *set){
-	int count = 0;
-	PARAM_getValueCount(set->typos, NULL, PST_PRIORITY_NONE, &count);
-	return count > 0 ? 1 : 0;
+	return DIAG_LIST_count(set->diag, PST_DIAG_TYPO) > 0 ? 1 : 0;
 }
 
 int PARAM_SET_isUnknown(const PARAM_SET *set){
-	int count = 0;
-	PARAM_getValueCount(set->unknown, NULL, PST_PRIORITY_NONE, &count);
-	return count > 0 ? 1 : 0;
+	return DIAG_LIST_count(set->diag, PST_DIAG_UNKNOWN) > 0 ? 1 : 0;
 }
 
 int PARAM_SET_isSyntaxError(const PARAM_SET *set){
-	int count = 0;
-	PARAM_getValueCount(set->syntax, NULL, PST_PRIORITY_NONE, &count);
-	return count > 0 ? 1 : 0;
+	return (DIAG_LIST_count(set->diag, PST_DIAG_SYNTAX_UNKNOWN_CHARACTER)
+			+ DIAG_LIST_count(set->diag, PST_DIAG_SYNTAX_MISSING_DASH)) > 0 ? 1 : 0;
 }
 
-int PARAM_SET_readFromFile(PARAM_SET *set, const char *fname, const char* source, int priority) {
+int PARAM_SET_getDiagnosticCount(const PARAM_SET *set, size_t *count) {
+	if (set == NULL || count == NULL) return PST_INVALID_ARGUMENT;
+	*count = DIAG_LIST_count(set->diag, 0);
+	return PST_OK;
+}
+
+int PARAM_SET_getDiagnostic(const PARAM_SET *set, size_t at, PARAM_SET_DIAG *diag) {
+	int res;
+	int i;
+
+	if (set == NULL || diag == NULL) return PST_INVALID_ARGUMENT;
+
+	res = DIAG_LIST_get(set->diag, at, diag);
+	if (res != PST_OK) return res;
+
+	for (i = 0; i < diag->candidateCount; i++) {
+		if (diag->candidate[i] < 0 || diag->candidate[i] >= set->count) return PST_UNKNOWN_ERROR;
+		diag->candidateName[i] = PARAM_getPrintName(set->parameter[diag->candidate[i]]);
+	}
+
+	return PST_OK;
+}
+
+int PARAM_SET_getStats(const PARAM_SET *set, PARAM_SET_STATS *stats) {
+	if (set == NULL || stats == NULL) return PST_INVALID_ARGUMENT;
+
+	if (set->stats != NULL) {
+		*stats = *set->stats;
+	} else {
+		memset(stats, 0, sizeof(*stats));
+	}
+
+	return PST_OK;
+}
+
+int PARAM_SET_resetStats(PARAM_SET *set) {
+	size_t string_bytes = 0;
+
+	if (set == NULL) return PST_INVALID_ARGUMENT;
+
+	/* The strings are still held, so stringBytes is not a cumulative counter. */
+	if (set->stats != NULL) {
+		string_bytes = set->stats->stringBytes;
+		memset(set->stats, 0, sizeof(*set->stats));
+		set->stats->stringBytes = string_bytes;
+	}
+
+	return PST_OK;
+}
+
+int FILE_TOKENS_read(FILE *file, FILE_TOKENS *tokens) {
 	int res;
-	FILE *file = NULL;
 	char line[1024];
 	char flag[1024];
 	char arg[1024];
-	char buf[1024];
 	size_t line_nr = 0;
-	size_t error_count = 0;
 	size_t read_count = 0;
+	long offset = 0;
+	int syntax = 0;
+
+	if (file == NULL || tokens == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	do {
+		offset = ftell(file);
+		res = read_line(file, line, sizeof(line), &line_nr, &read_count);
+		if (res == EOF && read_count == 0) break;
+
+		if (isComment(line)) continue;
+
+		flag[0] = '\0';
+		arg[0] = '\0';
+		syntax = 0;
+		res = parse_key_value_pair(line, flag, arg, sizeof(flag));
+		if (res == PST_INVALID_FORMAT) {
+			syntax = PST_DIAG_SYNTAX_UNKNOWN_CHARACTER;
+		} else if (flag[0] != '-' && flag[0] != '\0') {
+			syntax = PST_DIAG_SYNTAX_MISSING_DASH;
+		} else if (res != PST_OK) {
+			goto cleanup;
+		}
+
+		if (syntax == 0 && flag[0] == '\0' && arg[0] == '\0') continue;
+
+		res = FILE_TOKENS_add(tokens, syntax, line_nr, (offset < 0) ? 0 : (size_t)offset,
+				(syntax != 0) ? line : NULL,
+				(flag[0] != '\0' || arg[0] != '\0') ? flag : NULL,
+				(flag[0] != '\0' && arg[0] != '\0') ? arg : NULL);
+		if (res != PST_OK) goto cleanup;
+	} while (read_count != 0);
+
+	res = PST_OK;
+
+cleanup:
+
+	return res;
+}
+
+int PARAM_SET_setFileCache(PARAM_SET *set, PST_FILE_CACHE *cache) {
+	if (set == NULL) return PST_INVALID_ARGUMENT;
+	set->fileCache = cache;
+	return PST_OK;
+}
+
+/**
+ * Returns the tokens of the file, from the file cache if the set has one. If
+ * the tokens are not owned by the cache, they are also returned as \c owned.
+ */
+static int param_set_get_file_tokens(PARAM_SET *set, const char *fname, FILE_TOKENS **owned, const FILE_TOKENS **tokens) {
+	int res;
+	FILE *file = NULL;
+	FILE_TOKENS *tmp = NULL;
+
+	if (set->fileCache != NULL) {
+		res = PST_FILE_CACHE_getTokens(set->fileCache, fname, tokens);
+		if (res != PST_OK) goto cleanup;
+
+		*owned = NULL;
+	} else {
+		file = fopen(fname, "rb");
+		if (file == NULL) {
+			res = PST_IO_ERROR;
+			goto cleanup;
+		}
+
+		res = FILE_TOKENS_new(&tmp);
+		if (res != PST_OK) goto cleanup;
+
+		res = FILE_TOKENS_read(file, tmp);
+		if (res != PST_OK) goto cleanup;
+
+		*tokens = tmp;
+		*owned = tmp;
+		tmp = NULL;
+	}
+
+	res = PST_OK;
+
+cleanup:
+
+	if (file != NULL) fclose(file);
+	FILE_TOKENS_free(tmp);
+
+	return res;
+}
+
+/**
+ * Adds the parameters from the tokens as they were read from the file. Syntax
+ * errors are counted with \c error_count. If \c onlyMarked is set, the values
+ * are added only to the marked parameters.
+ */
+static int param_set_replay_tokens(PARAM_SET *set, const char *fname, const FILE_TOKENS *tokens, const char *source, int priority, int onlyMarked, size_t *error_count) {
+	int res;
+	FILE_TOKEN token;
+	size_t count = 0;
+	size_t i = 0;
+
+	/* Records are bound to the file, so they can be replaced when it is reloaded. */
+	res = DIAG_LIST_setFile(set->diag, fname, priority);
+	if (res != PST_OK) goto cleanup;
+
+	count = FILE_TOKENS_count(tokens);
+	for (i = 0; i < count; i++) {
+		res = FILE_TOKENS_get(tokens, i, &token);
+		if (res != PST_OK) goto cleanup;
+
+		/* Typos, unknown parameters and syntax errors found on this line refer to it. */
+		DIAG_LIST_setLocation(set->diag, token.line, token.offset);
+
+		if (token.syntax != 0) {
+			res = DIAG_LIST_add(set->diag, token.syntax, source, token.text, NULL, 0);
+			if (res != PST_OK) goto cleanup;
+			(*error_count)++;
+		}
+
+		if (token.flag == NULL) continue;
+
+		res = param_set_addRawParameter(token.flag, token.arg, source, set, priority, onlyMarked);
+		if (res != PST_OK) goto cleanup;
+	}
+
+	res = PST_OK;
+
+cleanup:
+
+	DIAG_LIST_setLocation(set->diag, 0, 0);
+	DIAG_LIST_setFile(set->diag, NULL, 0);
+
+	return res;
+}
+
+int PARAM_SET_readFromFile(PARAM_SET *set, const char *fname, const char* source, int priority) {
+	int res;
+	FILE_TOKENS *owned = NULL;
+	const FILE_TOKENS *tokens = NULL;
+	size_t error_count = 0;
 
 	if (fname == NULL || set == NULL) {
 		res = PST_INVALID_ARGUMENT;
 		goto cleanup;
 	}
 
-	file = fopen(fname, "rb");
-	if (file == NULL) {
-		res = PST_IO_ERROR;
+	PST_trace(set, PST_TRACE_READ_FILE, 0);
+
+	/* The file is parsed first and then replayed, so the parsing can be cached. */
+	PST_trace(set, PST_TRACE_FILE_IO, 0);
+	res = param_set_get_file_tokens(set, fname, &owned, &tokens);
+	PST_trace(set, PST_TRACE_FILE_IO, 1);
+	if (res != PST_OK) goto cleanup;
+
+	PST_trace(set, PST_TRACE_FILE_PARSE, 0);
+	res = param_set_replay_tokens(set, fname, tokens, source, priority, 0, &error_count);
+	PST_trace(set, PST_TRACE_FILE_PARSE, 1);
+	if (res != PST_OK) goto cleanup;
+
+	res = (error_count == 0) ? PST_OK : PST_INVALID_FORMAT;
+
+cleanup:
+
+	FILE_TOKENS_free(owned);
+	if (fname != NULL && set != NULL) PST_trace(set, PST_TRACE_READ_FILE, 1);
+	return res;
+}
+
+/**
+ * Name of a parameter as used in environment variables.
+ */
+typedef struct ENV_NAME_st {
+	const char *name;
+	PARAM *param;
+	int order;
+} ENV_NAME;
+
+static int env_name_compare(const void *a, const void *b) {
+	const ENV_NAME *A = (const ENV_NAME*)a;
+	const ENV_NAME *B = (const ENV_NAME*)b;
+	int res = strcmp(A->name, B->name);
+
+	if (res != 0) return res;
+	return (A->order > B->order) - (A->order < B->order);
+}
+
+static char *env_name_normalize(char *dst, const char *src) {
+	char *ret = dst;
+
+	while (*src != '\0') {
+		*dst++ = (*src == '-') ? '_' : (char)toupper(0xff & *src);
+		src++;
+	}
+	*dst = '\0';
+
+	return ret;
+}
+
+/**
+ * Finds the parameter that is mapped to \c key with length \c len. If there
+ * are multiple, the one that is defined first is returned.
+ */
+static PARAM *env_name_find(const ENV_NAME *table, size_t count, const char *key, size_t len) {
+	size_t lo = 0;
+	size_t hi = count;
+
+	/* Lower bound of the key. */
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		int res = strncmp(table[mid].name, key, len);
+
+		if (res < 0) lo = mid + 1;
+		else hi = mid;
+	}
+
+	/* The exact match is sorted before the names that have the key as a prefix. */
+	if (lo < count && strncmp(table[lo].name, key, len) == 0 && table[lo].name[len] == '\0') return table[lo].param;
+
+	return NULL;
+}
+
+#ifdef _WIN32
+#	define PST_ENVIRON _environ
+#else
+extern char **environ;
+#	define PST_ENVIRON environ
+#endif
+
+int PARAM_SET_readFromEnv(PARAM_SET *set, const char *prefix, const char *source, int priority) {
+	int res;
+	ENV_NAME *table = NULL;
+	char *names = NULL;
+	char *pName = NULL;
+	char **env = NULL;
+	size_t count = 0;
+	size_t names_len = 0;
+	size_t prefix_len = 0;
+	int i;
+
+	if (set == NULL || prefix == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	/* Table of the names and aliases sorted for binary search. */
+	for (i = 0; i < set->count; i++) {
+		names_len += strlen(set->parameter[i]->flagName) + 1;
+		if (set->parameter[i]->flagAlias != NULL) names_len += strlen(set->parameter[i]->flagAlias) + 1;
+	}
+
+	table = (ENV_NAME*)malloc(sizeof(*table) * (set->count * 2 + 1));
+	names = (char*)malloc(names_len + 1);
+	if (table == NULL || names == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	pName = names;
+	for (i = 0; i < set->count; i++) {
+		PARAM *param = set->parameter[i];
+
+		table[count].name = env_name_normalize(pName, param->flagName);
+		table[count].param = param;
+		table[count].order = (int)count;
+		pName += strlen(pName) + 1;
+		count++;
+
+		if (param->flagAlias != NULL) {
+			table[count].name = env_name_normalize(pName, param->flagAlias);
+			table[count].param = param;
+			table[count].order = (int)count;
+			pName += strlen(pName) + 1;
+			count++;
+		}
+	}
+
+	qsort(table, count, sizeof(*table), env_name_compare);
+
+	prefix_len = strlen(prefix);
+	for (env = PST_ENVIRON; env != NULL && *env != NULL; env++) {
+		const char *var = *env;
+		const char *value = NULL;
+		PARAM *param = NULL;
+
+		if (strncmp(var, prefix, prefix_len) != 0) continue;
+
+		value = strchr(var + prefix_len, '=');
+		if (value == NULL || value == var + prefix_len) continue;
+
+		PST_STATS_ADD(set->stats, nameLookups, 1);
+		param = env_name_find(table, count, var + prefix_len, (size_t)(value - var - prefix_len));
+		if (param == NULL) continue;
+
+		res = PARAM_addValue(param, PARAM_isParseOptionSet(param, PST_PRSCMD_HAS_NO_VALUE) ? NULL : value + 1, source, priority);
+		if (res != PST_OK) goto cleanup;
+	}
+
+	res = PST_OK;
+
+cleanup:
+
+	free(table);
+	free(names);
+
+	return res;
+}
+
+static int param_val_is_same_value(const PARAM_VAL *A, const PARAM_VAL *B) {
+	if (A->cstr_value == NULL || B->cstr_value == NULL) return A->cstr_value == B->cstr_value;
+	return strcmp(A->cstr_value, B->cstr_value) == 0;
+}
+
+static int param_val_is_from(const PARAM_VAL *value, const char *source, int priority) {
+	if (value->priority != priority) return 0;
+	if (value->source == NULL || source == NULL) return value->source == source;
+	return strcmp(value->source, source) == 0;
+}
+
+/**
+ * Returns the value at position \c at or \c NULL.
+ */
+static PARAM_VAL* param_val_skip(PARAM_VAL *value, int at) {
+	while (value != NULL && at-- > 0) value = value->next;
+	return value;
+}
+
+/**
+ * Removes all values of the parameter from position \c at. If \c source is
+ * not \c NULL or \c priority is not #PST_PRIORITY_NONE, only the values before
+ * \c at matching both are removed instead.
+ */
+static int param_remove_values(PARAM *param, int at, int before, const char *source, int priority) {
+	int res;
+	PARAM_VAL *value = NULL;
+	PARAM_VAL *next = NULL;
+	int i = 0;
+
+	value = before ? param->arg : param_val_skip(param->arg, at);
+
+	for (i = 0; value != NULL && (!before || i < at); i++) {
+		next = value->next;
+
+		if (!before || param_val_is_from(value, source, priority)) {
+			res = PARAM_removeValue(param, value);
+			if (res != PST_OK) return res;
+		}
+
+		value = next;
+	}
+
+	return PST_OK;
+}
+
+static int str_is_same(const char *A, const char *B) {
+	if (A == NULL || B == NULL) return A == B;
+	return strcmp(A, B) == 0;
+}
+
+/**
+ * Compares the tokens without their location, so a line that is only moved
+ * is the same.
+ */
+static int file_token_is_same(const FILE_TOKENS *A, size_t a, const FILE_TOKENS *B, size_t b) {
+	FILE_TOKEN tokA;
+	FILE_TOKEN tokB;
+
+	if (FILE_TOKENS_get(A, a, &tokA) != PST_OK || FILE_TOKENS_get(B, b, &tokB) != PST_OK) return 0;
+
+	return tokA.syntax == tokB.syntax && str_is_same(tokA.text, tokB.text)
+			&& str_is_same(tokA.flag, tokB.flag) && str_is_same(tokA.arg, tokB.arg);
+}
+
+static PARAM_SET_LOADED* param_set_find_loaded(const PARAM_SET *set, const char *fname, const char *source, int priority) {
+	PARAM_SET_LOADED *loaded = NULL;
+
+	for (loaded = set->loaded; loaded != NULL; loaded = loaded->next) {
+		if (loaded->priority == priority && strcmp(loaded->fname, fname) == 0 && str_is_same(loaded->source, source)) break;
+	}
+
+	return loaded;
+}
+
+/**
+ * Keeps the tokens for the next reload of the file. If \c owned is not \c NULL,
+ * it is taken over, otherwise a copy of \c tokens is made.
+ */
+static int param_set_remember_loaded(PARAM_SET *set, const char *fname, const char *source, int priority,
+		FILE_TOKENS **owned, const FILE_TOKENS *tokens) {
+	int res;
+	PARAM_SET_LOADED *loaded = NULL;
+	PARAM_SET_LOADED *tmp = NULL;
+	FILE_TOKENS *copy = NULL;
+
+	if (*owned != NULL) {
+		copy = *owned;
+		*owned = NULL;
+	} else {
+		res = FILE_TOKENS_copy(tokens, &copy);
+		if (res != PST_OK) goto cleanup;
+	}
+
+	loaded = param_set_find_loaded(set, fname, source, priority);
+	if (loaded == NULL) {
+		tmp = (PARAM_SET_LOADED*)calloc(1, sizeof(*tmp));
+		if (tmp == NULL) {
+			res = PST_OUT_OF_MEMORY;
+			goto cleanup;
+		}
+
+		tmp->priority = priority;
+		tmp->fname = (char*)malloc(strlen(fname) + 1);
+		tmp->source = (source != NULL) ? (char*)malloc(strlen(source) + 1) : NULL;
+		if (tmp->fname == NULL || (source != NULL && tmp->source == NULL)) {
+			res = PST_OUT_OF_MEMORY;
+			goto cleanup;
+		}
+		strcpy(tmp->fname, fname);
+		if (source != NULL) strcpy(tmp->source, source);
+
+		tmp->next = set->loaded;
+		set->loaded = tmp;
+		loaded = tmp;
+		tmp = NULL;
+	}
+
+	FILE_TOKENS_free(loaded->tokens);
+	loaded->tokens = copy;
+	copy = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	FILE_TOKENS_free(copy);
+	param_set_loaded_free(tmp);
+
+	return res;
+}
+
+/**
+ * Marks the parameters that the changed part of the file refers to. Lines that
+ * are the same at the beginning and at the end of the file are skipped.
+ */
+static void param_set_mark_changed_tokens(PARAM_SET *set, const FILE_TOKENS *old_tokens, const FILE_TOKENS *new_tokens) {
+	size_t old_count = FILE_TOKENS_count(old_tokens);
+	size_t new_count = FILE_TOKENS_count(new_tokens);
+	size_t head = 0;
+	size_t tail = 0;
+	size_t i;
+	FILE_TOKEN token;
+
+	while (head < old_count && head < new_count && file_token_is_same(old_tokens, head, new_tokens, head)) head++;
+
+	while (tail < old_count - head && tail < new_count - head
+			&& file_token_is_same(old_tokens, old_count - tail - 1, new_tokens, new_count - tail - 1)) tail++;
+
+	for (i = head; i < old_count - tail; i++) {
+		if (FILE_TOKENS_get(old_tokens, i, &token) == PST_OK) param_set_mark_token_params(set, token.flag);
+	}
+
+	for (i = head; i < new_count - tail; i++) {
+		if (FILE_TOKENS_get(new_tokens, i, &token) == PST_OK) param_set_mark_token_params(set, token.flag);
+	}
+}
+
+int PARAM_SET_reloadFromFile(PARAM_SET *set, const char *fname, const char* source, int priority,
+		void (*onChange)(void *ctx, PARAM_SET *set, const char *name), void *ctx, int *changed) {
+	int res;
+	FILE_TOKENS *owned = NULL;
+	const FILE_TOKENS *tokens = NULL;
+	PARAM_SET_LOADED *loaded = NULL;
+	size_t error_count = 0;
+	size_t diag_count = 0;
+	int *before = NULL;
+	int change_count = 0;
+	int i = 0;
+
+	if (fname == NULL || set == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = param_set_get_file_tokens(set, fname, &owned, &tokens);
+	if (res != PST_OK) goto cleanup;
+
+	before = (int*)malloc(sizeof(*before) * (set->count > 0 ? set->count : 1));
+	if (before == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	/**
+	 * If the file is reloaded before, only the parameters that the changed
+	 * tokens refer to are updated. Otherwise all the values from the source are
+	 * compared with the file.
+	 */
+	loaded = param_set_find_loaded(set, fname, source, priority);
+	if (loaded != NULL) param_set_mark_changed_tokens(set, loaded->tokens, tokens);
+
+	for (i = 0; i < set->count; i++) {
+		before[i] = set->parameter[i]->argCount;
+	}
+
+	/**
+	 * The file is added as usual, so all the parsing rules apply. After that the
+	 * new values are at the end of the list and can be compared with the old ones.
+	 * Typos, unknown parameters and syntax errors are recorded again from the new
+	 * file and replace the old records of the file only if this succeeds.
+	 */
+	diag_count = DIAG_LIST_count(set->diag, 0);
+	res = param_set_replay_tokens(set, fname, tokens, source, priority, loaded != NULL, &error_count);
+	if (res == PST_OK) res = DIAG_LIST_removeFile(set->diag, fname, source, priority, diag_count);
+	if (res != PST_OK) {
+		for (i = 0; i < set->count; i++) {
+			param_remove_values(set->parameter[i], before[i], 0, NULL, PST_PRIORITY_NONE);
+		}
+		DIAG_LIST_truncate(set->diag, diag_count);
 		goto cleanup;
 	}
 
-	do {
-		res = read_line(file, line, sizeof(line), &line_nr, &read_count);
-		if (res == EOF && read_count == 0) break;
+	for (i = 0; i < set->count; i++) {
+		PARAM *param = set->parameter[i];
+		PARAM_VAL *old_value = param->arg;
+		PARAM_VAL *new_value = param_val_skip(param->arg, before[i]);
+		int n = 0;
+		int is_same = 1;
 
-		if (isComment(line)) continue;
+		if (loaded != NULL && !param->isMarked) continue;
 
-		flag[0] = '\0';
-		arg[0] = '\0';
-		res = parse_key_value_pair(line, flag, arg, sizeof(flag));
-		if (res == PST_INVALID_FORMAT) {
-			PST_snprintf(buf, sizeof(buf), "Syntax error at line %4i. Unknown character. '%.60s'.\n", line_nr, line);
-			PARAM_addValue(set->syntax, buf, source, priority);
-			error_count++;
-		} else if (flag[0] != '-' && flag[0] != '\0') {
-			PST_snprintf(buf, sizeof(buf) , "Syntax error at line %4i. Missing character '-'. '%.60s'.\n", line_nr, line);
-			PARAM_addValue(set->syntax, buf, source, priority);
-			error_count++;
-		} else if (res != PST_OK) {
-			goto cleanup;
-		}
+		/* Compare the old values from the source, in order, with the new ones. */
+		for (n = 0; n < before[i]; n++, old_value = old_value->next) {
+			if (!param_val_is_from(old_value, source, priority)) continue;
 
-		if (flag[0] == '\0' && arg[0] == '\0') continue;
+			if (new_value == NULL || !param_val_is_same_value(old_value, new_value)) {
+				is_same = 0;
+				break;
+			}
+			new_value = new_value->next;
+		}
+		if (new_value != NULL) is_same = 0;
 
-		if (flag[0] != '\0' && arg[0] != '\0') {
-			res = param_set_addRawParameter(flag, arg, source, set, priority);
+		if (is_same) {
+			res = param_remove_values(param, before[i], 0, NULL, PST_PRIORITY_NONE);
 			if (res != PST_OK) goto cleanup;
 		} else {
-			res = param_set_addRawParameter(flag, NULL, source, set, priority);
+			res = param_remove_values(param, before[i], 1, source, priority);
 			if (res != PST_OK) goto cleanup;
+
+			change_count++;
+			if (onChange != NULL) onChange(ctx, set, param->flagName);
 		}
+	}
 
-	} while (read_count != 0);
+	res = param_set_remember_loaded(set, fname, source, priority, &owned, tokens);
+	if (res != PST_OK) goto cleanup;
 
+	if (changed != NULL) *changed = change_count;
 	res = (error_count == 0) ? PST_OK : PST_INVALID_FORMAT;
 
 cleanup:
 
-	if (file) fclose(file);
+	if (set != NULL) {
+		for (i = 0; i < set->count; i++) set->parameter[i]->isMarked = 0;
+	}
+
+	free(before);
+	FILE_TOKENS_free(owned);
 	return res;
 }
 
+int PARAM_SET_watchFile(PARAM_SET *set, const char *fname, const char* source, int priority) {
+	int res;
+
+	if (set == NULL || fname == NULL) return PST_INVALID_ARGUMENT;
+	if (priority < PST_PRIORITY_VALID_BASE) return PST_PRIORITY_NEGATIVE;
+	if (priority > PST_PRIORITY_VALID_ROOF) return PST_PRIORITY_TOO_LARGE;
+
+	if (set->watch == NULL) {
+		res = WATCH_new(&set->watch);
+		if (res != PST_OK) return res;
+	}
+
+	return WATCH_add(set->watch, fname, source, priority);
+}
+
+int PARAM_SET_getWatchDescriptor(const PARAM_SET *set, int *fd) {
+	if (set == NULL || fd == NULL) return PST_INVALID_ARGUMENT;
+	*fd = WATCH_getDescriptor(set->watch);
+	return PST_OK;
+}
+
+int PARAM_SET_processWatches(PARAM_SET *set, void (*onChange)(void *ctx, PARAM_SET *set, const char *name), void *ctx, int *changed) {
+	int res;
+	int first_error = PST_OK;
+	int change_count = 0;
+	int count = 0;
+	const char *fname = NULL;
+	const char *source = NULL;
+	int priority = 0;
+
+	if (set == NULL) return PST_INVALID_ARGUMENT;
+
+	WATCH_collect(set->watch);
+
+	/* A file that can not be reloaded keeps its values, others are still reloaded. */
+	while (WATCH_popChanged(set->watch, &fname, &source, &priority)) {
+		res = PARAM_SET_reloadFromFile(set, fname, source, priority, onChange, ctx, &count);
+		if (res == PST_OK || res == PST_INVALID_FORMAT) change_count += count;
+		if (res != PST_OK && first_error == PST_OK) first_error = res;
+	}
+
+	if (changed != NULL) *changed = change_count;
+
+	return first_error;
+}
+
 int PARAM_SET_readFromCMD(PARAM_SET *set, int argc, char **argv, const char *source, int priority) {
 	int res;
 	int i = 0;
@@ -1611,7 +3143,7 @@ int PARAM_SET_readFromCMD(PARAM_SET *set, int argc, char **argv, const char *sou
 				arg = argv[++i];
 		}
 
-		res = param_set_addRawParameter(tmp, arg, source, set, priority);
+		res = param_set_addRawParameter(tmp, arg, source, set, priority, 0);
 		if (res != PST_OK) goto cleanup;
 	}
 
@@ -1662,7 +3194,6 @@ static int is_flag_set(int field, int flag) {
 static int get_parameter_from_token(PARAM_SET *set, const char *token, int *token_type, PARAM **param) {
 	PARAM *tmp = NULL;
 	int type = TOKEN_UNKNOW;
-	int res = 0;
 	size_t len = 0;
 
 	if (set == NULL || token == NULL || param == NULL) return PST_INVALID_ARGUMENT;
@@ -1670,22 +3201,21 @@ static int get_parameter_from_token(PARAM_SET *set, const char *token, int *toke
 	if (token[0] != '-') {
 		type = TOKEN_IS_VALUE;
 	} else {
-		res = param_set_getParameterByName(set, remove_dashes(token), &tmp);
-		if (res != PST_OK && res != PST_PARAMETER_NOT_FOUND) return res;
+		/* The name is measured by the lookup, as the dashes are removed the same way. */
+		PST_STATS_ADD(set->stats, nameLookups, 1);
+		tmp = param_set_lookup_find(set, remove_dashes(token), &len);
 
 		type = 0;
 
-		if (res == PST_OK && !PARAM_isParseOptionSet(tmp, PST_PRSCMD_HAS_NO_FLAG)) {
+		if (tmp != NULL && !PARAM_isParseOptionSet(tmp, PST_PRSCMD_HAS_NO_FLAG)) {
 			type |= TOKEN_MATCHES_PARAMETER;
 		}
 
 		type |= (token[0] == '-' && token[1] == '-') ? TOKEN_HAS_DOUBLE_DASH : TOKEN_HAS_DASH;
 
-		len = strlen(token) - (type & TOKEN_HAS_DASH ? 1 : 2);
 		if (len == 0) type |= TOKEN_FLAG_LEN_0;
 		else if (len == 1) type |= TOKEN_FLAG_LEN_1;
-		else if (len > 1) type |= TOKEN_FLAG_LEN_N;
-		else return PST_INVALID_FORMAT;
+		else type |= TOKEN_FLAG_LEN_N;
 	}
 
 	*param = tmp;
@@ -1847,7 +3377,6 @@ cleanup:
 
 int PARAM_SET_parseCMD(PARAM_SET *set, int argc, char **argv, const char *source, int priority) {
 	int res;
-	TYPO *typo_helper = NULL;
 	int i = 0;
 	char *token = NULL;
 	int token_type = 0;
@@ -1861,6 +3390,7 @@ int PARAM_SET_parseCMD(PARAM_SET *set, int argc, char **argv, const char *source
 	PARAM *opened_parameter = NULL;
 	size_t value_counter = 0;
 	COLLECTORS *collector = NULL;
+	int traced_phase = 0;
 
 
 	if (set == NULL || argc == 0 || argv == NULL) {
@@ -1868,11 +3398,8 @@ int PARAM_SET_parseCMD(PARAM_SET *set, int argc, char **argv, const char *source
 		goto cleanup;
 	}
 
-	typo_helper = (TYPO*) malloc(set->count * sizeof(*typo_helper));
-	if (typo_helper == NULL) {
-		res = PST_OUT_OF_MEMORY;
-		goto cleanup;
-	}
+	PST_trace(set, PST_TRACE_PARSE_CMD, 0);
+	PST_trace(set, traced_phase = PST_TRACE_TOKENIZE, 0);
 
 	res = COLLECTORS_new(set, &collector);
 	if (res != PST_OK) goto cleanup;
@@ -1959,17 +3486,24 @@ int PARAM_SET_parseCMD(PARAM_SET *set, int argc, char **argv, const char *source
 			 * If it does, break. If it does not add typo or unknown.
 			 */
 			if (TOKEN_IS_BUNCH_OF_FLAGS_PARAM(token_type)) {
-				res = param_set_addRawParameter(token, NULL, source, set, priority);
+				res = param_set_addRawParameter(token, NULL, source, set, priority, 0);
 				if (res != PST_OK) goto cleanup;
 				continue;
-			} else if (COLLECTORS_add(collector, token_type, source, priority, token) > 0) {
-				continue;
 			} else {
+				int is_collected;
+
+				PST_trace(set, PST_TRACE_COLLECTORS, 0);
+				is_collected = COLLECTORS_add(collector, token_type, source, priority, token) > 0;
+				PST_trace(set, PST_TRACE_COLLECTORS, 1);
+				if (is_collected) continue;
+
+				PST_trace(set, PST_TRACE_TYPOS, 0);
 				if (TOKEN_IS_NULL_HAS_DOUBLE_DASH(token_type) || TOKEN_IS_NULL_HAS_DASH(token_type)) {
-					res = param_set_add_typo_or_unknown(set, typo_helper, source, token, NULL);
+					res = param_set_add_typo_or_unknown(set, source, token, NULL);
 				} else {
-					res = param_set_add_typo_or_unknown(set, typo_helper, source, remove_dashes(token), NULL);
+					res = param_set_add_typo_or_unknown(set, source, remove_dashes(token), NULL);
 				}
+				PST_trace(set, PST_TRACE_TYPOS, 1);
 				if (res != PST_OK) goto cleanup;
 				continue;
 			}
@@ -1977,9 +3511,12 @@ int PARAM_SET_parseCMD(PARAM_SET *set, int argc, char **argv, const char *source
 		}
 	}
 
+	PST_trace(set, PST_TRACE_TOKENIZE, 1);
+
 	/**
 	 * Expand wildcards when enabled and configured.
 	 */
+	PST_trace(set, traced_phase = PST_TRACE_WILDCARDS, 0);
 	for (i = 0; i < set->count; i++) {
 		if (PARAM_isParseOptionSet(set->parameter[i], PST_PRSCMD_EXPAND_WILDCARD)) {
 			res = PARAM_expandWildcard(set->parameter[i], NULL);
@@ -1991,28 +3528,82 @@ int PARAM_SET_parseCMD(PARAM_SET *set, int argc, char **argv, const char *source
 
 cleanup:
 
-	if (typo_helper != NULL) free(typo_helper);
 	COLLECTORS_free(collector);
 
+	/* Close the phase that was interrupted (or the last one) and the whole parsing. */
+	if (traced_phase != 0) {
+		PST_trace(set, traced_phase, 1);
+		PST_trace(set, PST_TRACE_PARSE_CMD, 1);
+	}
+
 	return res;
 }
 #undef dpgprint
 
+typedef struct PARSE_MANY_st {
+	const PARAM_SET_SPEC *spec;
+	int (*configure)(void *ctx, PARAM_SET *set);
+	void *ctx;
+	PARAM_SET_CMD *cmd;
+	const char *source;
+	int priority;
+} PARSE_MANY;
+
+static void param_set_run_parse_job(void *ctx, size_t i) {
+	int res;
+	PARSE_MANY *job = (PARSE_MANY*)ctx;
+	PARAM_SET_CMD *cmd = &job->cmd[i];
+
+	cmd->set = NULL;
+
+	res = PARAM_SET_newFromSpec(job->spec, &cmd->set);
+	if (res != PST_OK) goto cleanup;
+
+	if (job->configure != NULL) {
+		res = job->configure(job->ctx, cmd->set);
+		if (res != PST_OK) goto cleanup;
+	}
+
+	res = PARAM_SET_parseCMD(cmd->set, cmd->argc, cmd->argv, job->source, job->priority);
+	if (res != PST_OK) goto cleanup;
+
+	res = PST_OK;
+
+cleanup:
+
+	cmd->result = res;
+}
+
+int PARAM_SET_parseMany(const PARAM_SET_SPEC *spec, int (*configure)(void *ctx, PARAM_SET *set), void *ctx,
+		PARAM_SET_CMD *cmd, size_t count, const char *source, int priority, int nthreads) {
+	PARSE_MANY job;
+
+	if (spec == NULL || (cmd == NULL && count > 0) || nthreads < 1) return PST_INVALID_ARGUMENT;
+
+	job.spec = spec;
+	job.configure = configure;
+	job.ctx = ctx;
+	job.cmd = cmd;
+	job.source = source;
+	job.priority = priority;
+
+	return PST_parallelFor(count, nthreads, param_set_run_parse_job, &job);
+}
+
 int PARAM_SET_IncludeSet(PARAM_SET *target, PARAM_SET *src) {
 	int res;
 	int i;
-	int n;
-	PARAM_VAL *param_value = NULL;
 	PARAM *target_param = NULL;
 
-	if (target == NULL || src == NULL) {
+	if (target == NULL || src == NULL || target == src) {
 		res = PST_INVALID_ARGUMENT;
 		goto cleanup;
 	}
 
 	/**
 	 * Scan the source set for parameters. If there is a parameter with the same
-	 * name and it has values, add those values to the target set.
+	 * name and it has values, add those values to the target set. As both
+	 * parameters are known, the name is resolved once and typos are not checked.
 	 */
 	for (i = 0; i < src->count; i++) {
 		/**
@@ -2035,13 +3626,8 @@ int PARAM_SET_IncludeSet(PARAM_SET *target, PARAM_SET *src) {
 		/**
 		 * The target has the parameter with the same name. Include all values.
 		 */
-		n = 0;
-		while (PARAM_getValue(src->parameter[i], NULL, PST_PRIORITY_NONE, n, &param_value) == PST_OK) {
-			res = PARAM_SET_add(target, src->parameter[i]->flagName, param_value->cstr_value, param_value->source, param_value->priority);
-			if (res != PST_OK) 	goto cleanup;
-
-			n++;
-		}
+		res = PARAM_includeValues(target_param, src->parameter[i]);
+		if (res != PST_OK) goto cleanup;
 	}
 
 	res = PST_OK;
@@ -2051,9 +3637,64 @@ cleanup:
 	return res;
 }
 
-static size_t param_value_add_errorstring_to_buf(PARAM *parameter, PARAM_VAL *invalid, const char *prefix, const char* (*getErrString)(int), char *buf, size_t buf_len) {
+int PARAM_SET_pushLayer(PARAM_SET *target, PARAM_SET *src, int priority_offset) {
+	PARAM_SET_LAYER *layer = NULL;
+
+	if (target == NULL || src == NULL || target == src) return PST_INVALID_ARGUMENT;
+	if (priority_offset < PST_PRIORITY_VALID_BASE) return PST_PRIORITY_NEGATIVE;
+	if (priority_offset > PST_PRIORITY_VALID_ROOF) return PST_PRIORITY_TOO_LARGE;
+
+	layer = (PARAM_SET_LAYER*)malloc(sizeof(PARAM_SET_LAYER));
+	if (layer == NULL) return PST_OUT_OF_MEMORY;
+
+	layer->set = src;
+	layer->offset = priority_offset;
+	layer->next = NULL;
+
+	if (target->lastLayer == NULL) {
+		target->layer = layer;
+	} else {
+		target->lastLayer->next = layer;
+	}
+	target->lastLayer = layer;
+	target->allChanged = ++target->changeCount;
+
+	return PST_OK;
+}
+
+int PARAM_SET_removeLayer(PARAM_SET *target, PARAM_SET *src) {
+	PARAM_SET_LAYER *layer = NULL;
+	PARAM_SET_LAYER *prev = NULL;
+	PARAM_SET_LAYER *match = NULL;
+	PARAM_SET_LAYER *match_prev = NULL;
+
+	if (target == NULL || src == NULL) return PST_INVALID_ARGUMENT;
+
+	/* Remove the most recently pushed layer of src. */
+	for (layer = target->layer; layer != NULL; prev = layer, layer = layer->next) {
+		if (layer->set == src) {
+			match = layer;
+			match_prev = prev;
+		}
+	}
+
+	if (match == NULL) return PST_INVALID_ARGUMENT;
+
+	if (match_prev == NULL) {
+		target->layer = match->next;
+	} else {
+		match_prev->next = match->next;
+	}
+	if (target->lastLayer == match) target->lastLayer = match_prev;
+	target->allChanged = ++target->changeCount;
+
+	free(match);
+
+	return PST_OK;
+}
+
+static void param_value_add_errorstring_to_sink(PARAM *parameter, PARAM_VAL *invalid, const char *prefix, const char* (*getErrString)(int), PST_SINK *sink) {
 	int res;
-	size_t count = 0;
 	const char *value = NULL;
 	const char *source = NULL;
 	int formatStatus = 0;
@@ -2062,34 +3703,34 @@ static size_t param_value_add_errorstring_to_buf(PARAM *parameter, PARAM_VAL *in
 
 	use_prefix = prefix == NULL ? "" : prefix;
 
-	if (parameter == NULL || invalid == NULL || buf == NULL || buf_len == 0) return 0;
+	if (parameter == NULL || invalid == NULL || sink == NULL) return;
 	/**
 	 * Extract error codes, if not set exit the function.
 	 */
 	res = PARAM_VAL_getErrors(invalid, &formatStatus, &contentStatus);
-	if (res != PST_OK) return 0;
+	if (res != PST_OK) return;
 
-	if (formatStatus == 0 && contentStatus == 0) return 0;
+	if (formatStatus == 0 && contentStatus == 0) return;
 
 	res = PARAM_VAL_extract(invalid, &value, &source, NULL);
-	if (res != PST_OK) return 0;
+	if (res != PST_OK) return;
 
 
-	count += PST_snprintf(buf + count, buf_len - count, "%s", use_prefix);
+	PST_SINK_printf(sink, "%s", use_prefix);
 	/**
 	 * Add Error string or error code.
 	 */
 	if (getErrString != NULL) {
 		if (formatStatus != 0) {
-			count += PST_snprintf(buf + count, buf_len - count, "%s.", getErrString(formatStatus));
+			PST_SINK_printf(sink, "%s.", getErrString(formatStatus));
 		} else {
-			count += PST_snprintf(buf + count, buf_len - count, "%s.", getErrString(contentStatus));
+			PST_SINK_printf(sink, "%s.", getErrString(contentStatus));
 		}
 	} else {
 		if (formatStatus != 0) {
-			count += PST_snprintf(buf + count, buf_len - count, "Error: 0x%0x.", formatStatus);
+			PST_SINK_printf(sink, "Error: 0x%0x.", formatStatus);
 		} else {
-			count += PST_snprintf(buf + count, buf_len - count, "Error: 0x%0x.", contentStatus);
+			PST_SINK_printf(sink, "Error: 0x%0x.", contentStatus);
 		}
 	}
 
@@ -2097,37 +3738,30 @@ static size_t param_value_add_errorstring_to_buf(PARAM *parameter, PARAM_VAL *in
 	 * Add the source, if NULL not included.
 	 */
 	if (source != NULL) {
-		count += PST_snprintf(buf + count, buf_len - count, " Parameter (from '%s') ", source);
+		PST_SINK_printf(sink, " Parameter (from '%s') ", source);
 	} else {
-		count += PST_snprintf(buf + count, buf_len - count, " Parameter ");
+		PST_SINK_printf(sink, " Parameter ");
 	}
 
 	/**
 	 * Add the parameter and its value.
 	 */
-	count += PST_snprintf(buf + count, buf_len - count, "%s '%s'.",
+	PST_SINK_printf(sink, "%s '%s'.",
 							PARAM_getPrintName(parameter),
 							value != NULL ? value : ""
 							);
 
 
 
-	count += PST_snprintf(buf + count, buf_len - count, "\n");
-
-	return count;
+	PST_SINK_printf(sink, "\n");
 }
 
-char* PARAM_SET_invalidParametersToString(const PARAM_SET *set, const char *prefix, const char* (*getErrString)(int), char *buf, size_t buf_len) {
+static int param_set_invalid_parameters_to_sink(const PARAM_SET *set, const char *prefix, const char* (*getErrString)(int), PST_SINK *sink) {
 	int res;
 	int i = 0;
 	int n = 0;
 	PARAM *parameter = NULL;
 	PARAM_VAL *invalid = NULL;
-	size_t count = 0;
-
-	if (set == NULL || buf == NULL || buf_len == 0) {
-		return NULL;
-	}
 
 	/**
 	 * Scan all parameter values for errors.
@@ -2146,155 +3780,219 @@ char* PARAM_SET_invalidParametersToString(const PARAM_SET *set, const char *pref
 
 			if (res == PST_PARAMETER_EMPTY || res == PST_PARAMETER_VALUE_NOT_FOUND) continue;
 
-			if (res != PST_OK) return NULL;
-			count += param_value_add_errorstring_to_buf(parameter, invalid, prefix, getErrString, buf + count, buf_len - count);
+			if (res != PST_OK) return res;
+			param_value_add_errorstring_to_sink(parameter, invalid, prefix, getErrString, sink);
 		} else {
 			while (PARAM_getInvalid(parameter, NULL, PST_PRIORITY_NONE, n++, &invalid) == PST_OK) {
-				count += param_value_add_errorstring_to_buf(parameter, invalid, prefix, getErrString, buf + count, buf_len - count);
+				param_value_add_errorstring_to_sink(parameter, invalid, prefix, getErrString, sink);
 
-				if (count >= buf_len - 1) return buf;
+				if (PST_SINK_isDone(sink)) return sink->err;
 			}
 		}
 	}
 
-	buf[buf_len - 1] = '\0';
+	return sink->err;
+}
+
+char* PARAM_SET_invalidParametersToString(const PARAM_SET *set, const char *prefix, const char* (*getErrString)(int), char *buf, size_t buf_len) {
+	PST_SINK sink;
+
+	if (set == NULL || buf == NULL || buf_len == 0) {
+		return NULL;
+	}
+
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	if (param_set_invalid_parameters_to_sink(set, prefix, getErrString, &sink) != PST_OK) return NULL;
+
 	return buf;
 }
 
-char* PARAM_SET_unknownsToString(const PARAM_SET *set, const char *prefix, char *buf, size_t buf_len) {
+int PARAM_SET_invalidParametersToSink(const PARAM_SET *set, const char *prefix, const char* (*getErrString)(int), int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count) {
+	int res;
+	PST_SINK sink;
+
+	if (set == NULL) return PST_INVALID_ARGUMENT;
+
+	PST_SINK_init(&sink, write, ctx);
+	res = param_set_invalid_parameters_to_sink(set, prefix, getErrString, &sink);
+	if (count != NULL) *count = sink.count;
+
+	return res;
+}
+
+static int param_set_unknowns_to_sink(const PARAM_SET *set, const char *prefix, PST_SINK *sink) {
 	int res;
 	const char *use_prefix = NULL;
-	int i = 0;
-	PARAM_VAL *unknown = NULL;
-	const char *name = NULL;
-	const char *source = NULL;
-	size_t count = 0;
+	size_t i = 0;
+	PARAM_SET_DIAG diag;
+
+	use_prefix = prefix == NULL ? "" : prefix;
+
+	for (i = 0; i < DIAG_LIST_count(set->diag, 0); i++) {
+		res = DIAG_LIST_get(set->diag, i, &diag);
+		if (res != PST_OK) return res;
+		if (diag.kind != PST_DIAG_UNKNOWN) continue;
+
+		PST_SINK_printf(sink, "%sUnknown parameter '%s'", use_prefix, diag.token);
+		if (diag.source != NULL) PST_SINK_printf(sink, " from '%s'", diag.source);
+		PST_SINK_printf(sink, ".\n");
+		if (PST_SINK_isDone(sink)) break;
+	}
+
+	return sink->err;
+}
 
+char* PARAM_SET_unknownsToString(const PARAM_SET *set, const char *prefix, char *buf, size_t buf_len) {
+	PST_SINK sink;
 
 	if (set == NULL || buf == NULL || buf_len == 0) {
 		return NULL;
 	}
 
-	if (set->unknown->argCount == 0) {
+	if (DIAG_LIST_count(set->diag, PST_DIAG_UNKNOWN) == 0) {
 		buf[0] = '\0';
 		return NULL;
 	}
 
-	use_prefix = prefix == NULL ? "" : prefix;
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	if (param_set_unknowns_to_sink(set, prefix, &sink) != PST_OK) return NULL;
+
+	return buf;
+}
 
-	for (i = 0; i < set->unknown->argCount; i++) {
-		res = PARAM_getValue(set->unknown, NULL, PST_PRIORITY_NONE, i, &unknown);
-		if (res != PST_OK) return NULL;
+int PARAM_SET_unknownsToSink(const PARAM_SET *set, const char *prefix, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count) {
+	int res;
+	PST_SINK sink;
 
-		res = PARAM_VAL_extract(unknown, &name, &source, NULL);
-		if (res != PST_OK) return NULL;
+	if (set == NULL) return PST_INVALID_ARGUMENT;
 
-		count += PST_snprintf(buf + count, buf_len - count, "%sUnknown parameter '%s'", use_prefix, name);
-		if (source != NULL) count += PST_snprintf(buf + count, buf_len - count, " from '%s'", source);
-		count += PST_snprintf(buf + count, buf_len - count, ".\n");
-		if (count >= buf_len - 1) return buf;
-	}
+	PST_SINK_init(&sink, write, ctx);
+	res = param_set_unknowns_to_sink(set, prefix, &sink);
+	if (count != NULL) *count = sink.count;
 
-	buf[buf_len - 1] = '\0';
-	return buf;
+	return res;
 }
 
-char* PARAM_SET_syntaxErrorsToString(const PARAM_SET *set, const char *prefix, char *buf, size_t buf_len) {
+static int param_set_syntax_errors_to_sink(const PARAM_SET *set, const char *prefix, PST_SINK *sink) {
 	int res;
 	const char *use_prefix = NULL;
-	int i = 0;
-	PARAM_VAL *syntax_error = NULL;
-	const char *name = NULL;
-	const char *source = NULL;
-	size_t count = 0;
+	size_t i = 0;
+	PARAM_SET_DIAG diag;
+
+	use_prefix = prefix == NULL ? "" : prefix;
+
+	for (i = 0; i < DIAG_LIST_count(set->diag, 0); i++) {
+		res = DIAG_LIST_get(set->diag, i, &diag);
+		if (res != PST_OK) return res;
+
+		if (diag.kind == PST_DIAG_SYNTAX_UNKNOWN_CHARACTER) {
+			PST_SINK_printf(sink, "%sSyntax error at line %4i. Unknown character. '%.60s'.\n", use_prefix, (int)diag.line, diag.token);
+		} else if (diag.kind == PST_DIAG_SYNTAX_MISSING_DASH) {
+			PST_SINK_printf(sink, "%sSyntax error at line %4i. Missing character '-'. '%.60s'.\n", use_prefix, (int)diag.line, diag.token);
+		} else {
+			continue;
+		}
+		if (PST_SINK_isDone(sink)) break;
+	}
+
+	return sink->err;
+}
 
+char* PARAM_SET_syntaxErrorsToString(const PARAM_SET *set, const char *prefix, char *buf, size_t buf_len) {
+	PST_SINK sink;
 
 	if (set == NULL || buf == NULL || buf_len == 0) {
 		return NULL;
 	}
 
-	if (set->syntax->argCount == 0) {
+	if (!PARAM_SET_isSyntaxError(set)) {
 		buf[0] = '\0';
 		return NULL;
 	}
 
-	use_prefix = prefix == NULL ? "" : prefix;
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	if (param_set_syntax_errors_to_sink(set, prefix, &sink) != PST_OK) return NULL;
+
+	return buf;
+}
 
-	for (i = 0; i < set->syntax->argCount; i++) {
-		res = PARAM_getValue(set->syntax, NULL, PST_PRIORITY_NONE, i, &syntax_error);
-		if (res != PST_OK) return NULL;
+int PARAM_SET_syntaxErrorsToSink(const PARAM_SET *set, const char *prefix, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count) {
+	int res;
+	PST_SINK sink;
 
-		res = PARAM_VAL_extract(syntax_error, &name, &source, NULL);
-		if (res != PST_OK) return NULL;
+	if (set == NULL) return PST_INVALID_ARGUMENT;
 
-		count += PST_snprintf(buf + count, buf_len - count, "%s%s", use_prefix, name);
-		if (count >= buf_len - 1) return buf;
-	}
+	PST_SINK_init(&sink, write, ctx);
+	res = param_set_syntax_errors_to_sink(set, prefix, &sink);
+	if (count != NULL) *count = sink.count;
 
-	buf[buf_len - 1] = '\0';
-	return buf;
+	return res;
 }
 
-char* PARAM_SET_typosToString(PARAM_SET *set, const char *prefix, char *buf, size_t buf_len) {
+static int param_set_typos_to_sink(PARAM_SET *set, const char *prefix, PST_SINK *sink) {
 	int res;
 	const char *use_prefix = NULL;
-	PARAM_VAL *typo = NULL;
-	int i = 0;
-	const char *name = NULL;
-	const char *source = NULL;
-	int similar_count = 0;
+	size_t i = 0;
 	int n = 0;
-	const char *similar = NULL;
-	size_t count = 0;
+	PARAM_SET_DIAG diag;
+
+	use_prefix = prefix == NULL ? "" : prefix;
+
+	for (i = 0; i < DIAG_LIST_count(set->diag, 0); i++) {
+		res = PARAM_SET_getDiagnostic(set, i, &diag);
+		if (res != PST_OK) return res;
+		if (diag.kind != PST_DIAG_TYPO) continue;
+
+		for (n = 0; n < diag.candidateCount; n++) {
+			PST_SINK_printf(sink, "%sDid You mean '%s' instead of '%s'.\n",
+						use_prefix,
+						diag.candidateName[n],
+						diag.token);
+			if (PST_SINK_isDone(sink)) return sink->err;
+		}
+	}
+
+	return sink->err;
+}
+
+char* PARAM_SET_typosToString(PARAM_SET *set, const char *prefix, char *buf, size_t buf_len) {
+	PST_SINK sink;
 
 	if (set == NULL || buf == NULL || buf_len == 0) {
 		return NULL;
 	}
 
-	if (set->typos->argCount == 0) {
+	if (!PARAM_SET_isTypoFailure(set)) {
 		buf[0] = '\0';
 		return NULL;
 	}
 
-	use_prefix = prefix == NULL ? "" : prefix;
-
-	while (PARAM_getValue(set->typos, NULL, 1, i, &typo) == PST_OK) {
-		res = PARAM_VAL_extract(typo, &name, &source, NULL);
-		if (res != PST_OK) return NULL;
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	if (param_set_typos_to_sink(set, prefix, &sink) != PST_OK) return NULL;
 
-		res = PARAM_getValueCount(set->typos, name, 0, &similar_count);
-		if (res != PST_OK) return NULL;
-
-		for (n = 0; n < similar_count; n++) {
-			PARAM *param = NULL;
-
-			res = PARAM_getObject(set->typos, name, 0, n, NULL, (void**)&similar);
-			if (res != PST_OK || similar == NULL) return NULL;
+	return buf;
+}
 
-			res = param_set_getParameterByName(set, similar, &param);
-			if (res != PST_OK || param == NULL) return NULL;
+int PARAM_SET_typosToSink(PARAM_SET *set, const char *prefix, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count) {
+	int res;
+	PST_SINK sink;
 
-			count += PST_snprintf(buf + count, buf_len - count, "%sDid You mean '%s' instead of '%s'.\n",
-						use_prefix,
-						PARAM_getPrintName(param),
-						name);
-			if (count >= buf_len - 1) return buf;
-		}
+	if (set == NULL) return PST_INVALID_ARGUMENT;
 
-		i++;
-	}
+	PST_SINK_init(&sink, write, ctx);
+	res = param_set_typos_to_sink(set, prefix, &sink);
+	if (count != NULL) *count = sink.count;
 
-	return buf;
+	return res;
 }
 
-char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len) {
+static int param_set_to_sink(PARAM_SET *set, PST_SINK *sink) {
 	int res;
 	const size_t row_len = 80;
 	const size_t nr_field_len = 5;
 	const size_t source_field_len = 15;
 	const size_t prio_field_len = 4;
 	const size_t value_field_len = (row_len - 9 - source_field_len - nr_field_len - prio_field_len);
-	size_t count = 0;
 	int i = 0;
 	int n = 0;
 	PARAM_VAL *param_value = NULL;
@@ -2305,10 +4003,6 @@ char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len) {
 	char null_value[256];
 	char null_source[256];
 
-	if (set == NULL || buf == NULL || buf_len == 0) {
-		return NULL;
-	}
-
 	/* Generate constants for heading strings. */
 	PST_snprintf(nr_header, sizeof(nr_header), "%*snr", ((nr_field_len - 2)/2), "");
 	PST_snprintf(value_header, sizeof(value_header), "%*svalue", ((value_field_len - 5)/2), "");
@@ -2319,7 +4013,7 @@ char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len) {
 	PST_snprintf(null_source, sizeof(null_source), "%*s-", source_field_len / 2 - 1, "");
 
 	/* Print header. */
-	count += PST_snprintf(buf + count, buf_len - count, "%*s   %-*s   %-*s   %*s\n",
+	PST_SINK_printf(sink, "%*s   %-*s   %-*s   %*s\n",
 			nr_field_len, nr_header,
 			value_field_len, value_header,
 			source_field_len, source_header,
@@ -2327,7 +4021,7 @@ char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len) {
 
 	/* Cycle through parameters. */
 	for (i = 0; i < set->count; i++) {
-		count += PST_snprintf(buf + count, buf_len - count, "\n'%s' (%i):\n",
+		PST_SINK_printf(sink, "\n'%s' (%i):\n",
 				set->parameter[i]->flagName, set->parameter[i]->argCount);
 
 		/* Cycle through values. */
@@ -2345,7 +4039,7 @@ char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len) {
 			int first = 1;
 
 			res = PARAM_VAL_extract(param_value, &value, &source, &priority);
-			if (res != PST_OK) return NULL;
+			if (res != PST_OK) return res;
 
 			value_len = (value == NULL) ? 0 : strlen(value);
 			source_len = (source == NULL) ? 0 : strlen(source);
@@ -2404,7 +4098,7 @@ char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len) {
 				}
 
 				if (first) {
-					count += PST_snprintf(buf + count, buf_len - count, "%*i) | %c%-.*s%c%*s | %c%-*.*s%c%*s | %*i\n",
+					PST_SINK_printf(sink, "%*i) | %c%-.*s%c%*s | %c%-*.*s%c%*s | %*i\n",
 							nr_field_len - 1,
 							n + 1,
 							first_value_quote,
@@ -2422,7 +4116,7 @@ char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len) {
 							prio_field_len,
 							priority);
 				} else {
-					count += PST_snprintf(buf + count, buf_len - count, "%*s | %c%-.*s%c%*s | %c%-*.*s%c%*s | %*s\n",
+					PST_SINK_printf(sink, "%*s | %c%-.*s%c%*s | %c%-*.*s%c%*s | %*s\n",
 							nr_field_len,
 							"",
 							first_value_quote,
@@ -2451,38 +4145,83 @@ char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len) {
 			n++;
 		}
 	}
-	count += PST_snprintf(buf + count, buf_len - count, "\n");
+	PST_SINK_printf(sink, "\n");
+
+	return sink->err;
+}
+
+char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len) {
+	PST_SINK sink;
+
+	if (set == NULL || buf == NULL || buf_len == 0) {
+		return NULL;
+	}
+
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	if (param_set_to_sink(set, &sink) != PST_OK) return NULL;
 
-	buf[buf_len - 1] = '\0';
 	return buf;
 }
 
-char* PARAM_SET_constraintErrorToString(const PARAM_SET *set, const char *prefix, char *buf, size_t buf_len) {
+int PARAM_SET_toSink(PARAM_SET *set, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count) {
+	int res;
+	PST_SINK sink;
+
+	if (set == NULL) return PST_INVALID_ARGUMENT;
+
+	PST_SINK_init(&sink, write, ctx);
+	res = param_set_to_sink(set, &sink);
+	if (count != NULL) *count = sink.count;
+
+	return res;
+}
+
+static int param_set_constraint_errors_to_sink(const PARAM_SET *set, const char *prefix, PST_SINK *sink) {
 	int i;
-	size_t count = 0;
 	PARAM *parameter = NULL;
 	char tmp[1024];
 	char *p = NULL;
 
-	if (set == NULL || buf == NULL || buf_len == 0) {
-		return NULL;
-	}
-
 	for (i = 0; i < set->count; i++) {
 		tmp[0] = '\0';
 		parameter = set->parameter[i];
 		p = PARAM_constraintErrorToString(parameter, prefix, tmp, sizeof(tmp));
 
 		if (p != NULL && p[0] != '\0') {
-			count += PST_snprintf(buf + count, buf_len - count, "%s", p);
-			if (count >= buf_len - 1) return buf;
+			PST_SINK_write(sink, p, strlen(p));
+			if (PST_SINK_isDone(sink)) break;
 		}
 	}
 
-	buf[buf_len - 1] = '\0';
+	return sink->err;
+}
+
+char* PARAM_SET_constraintErrorToString(const PARAM_SET *set, const char *prefix, char *buf, size_t buf_len) {
+	PST_SINK sink;
+
+	if (set == NULL || buf == NULL || buf_len == 0) {
+		return NULL;
+	}
+
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	if (param_set_constraint_errors_to_sink(set, prefix, &sink) != PST_OK) return NULL;
+
 	return buf;
 }
 
+int PARAM_SET_constraintErrorToSink(const PARAM_SET *set, const char *prefix, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count) {
+	int res;
+	PST_SINK sink;
+
+	if (set == NULL) return PST_INVALID_ARGUMENT;
+
+	PST_SINK_init(&sink, write, ctx);
+	res = param_set_constraint_errors_to_sink(set, prefix, &sink);
+	if (count != NULL) *count = sink.count;
+
+	return res;
+}
+
 const char* PARAM_SET_errorToString(int err) {
 	switch(err) {
 	case PST_OK:
@@ -2534,6 +4273,8 @@ const char* PARAM_SET_errorToString(int err) {
 		return "PARAM object value conversion is skipped.";
 	case PST_ALIAS_NOT_SPECIFIED:
 		return "PARAM object alias does not exist.";
+	case PST_SNAPSHOT_INCOMPATIBLE:
+		return "PARAM_SET snapshot is incompatible.";
 	case PST_UNKNOWN_ERROR:
 		return "PARAM_SET unknown error.";
 	}
@@ -114,6 +114,9 @@ enum PARAM_SET_ERR_enum {
 	/** Parameter alias is not specified and it is not possible to work with it. */
 	PST_ALIAS_NOT_SPECIFIED,
 
+	/** Snapshot is corrupted, has unsupported version or does not match the #PARAM_SET (see #PARAM_SET_loadSnapshot). */
+	PST_SNAPSHOT_INCOMPATIBLE,
+
 	/** Unknown error. */
 	PST_UNKNOWN_ERROR,
 };
@@ -124,6 +127,122 @@ enum PARAM_SET_ERR_enum {
  */
 typedef struct PARAM_SET_st PARAM_SET;
 
+/**
+ * Cache of parsed configuration files (see #PST_FILE_CACHE_new).
+ */
+typedef struct PST_FILE_CACHE_st PST_FILE_CACHE;
+
+/**
+ * Immutable copy of the parameters and values of a #PARAM_SET (see #PARAM_SET_freeze).
+ */
+typedef struct PST_FROZEN_SET_st PST_FROZEN_SET;
+
+/**
+ * Publisher of #PST_FROZEN_SET objects to concurrent readers (see #PST_PUBLISHER_new).
+ */
+typedef struct PST_PUBLISHER_st PST_PUBLISHER;
+
+/**
+ * Maximum count of typo candidates stored with a diagnostic record.
+ */
+#define PST_DIAG_MAX_CANDIDATES 5
+
+/**
+ * Kinds of the diagnostic records collected by #PARAM_SET (see #PARAM_SET_getDiagnostic).
+ */
+enum PARAM_SET_DIAG_KIND_enum {
+	/** Unknown token that looks like a typo of one or more parameters. */
+	PST_DIAG_TYPO = 1,
+	/** Unknown parameter or value. */
+	PST_DIAG_UNKNOWN,
+	/** Configuration file line contains an unknown character. */
+	PST_DIAG_SYNTAX_UNKNOWN_CHARACTER,
+	/** Configuration file line is missing a character '-' in front of the parameter. */
+	PST_DIAG_SYNTAX_MISSING_DASH
+};
+
+/**
+ * Diagnostic record describing a typo, an unknown parameter or a syntax error.
+ * All the pointers refer to the memory owned by #PARAM_SET and are valid until
+ * the set is modified or freed.
+ */
+typedef struct PARAM_SET_DIAG_st {
+	/** Kind of the record (see #PARAM_SET_DIAG_KIND_enum). */
+	int kind;
+	/** Line number in the configuration file or \c 0 if not read from file. */
+	size_t line;
+	/** Byte offset where reading of the line started or \c 0 if not read from file. */
+	size_t offset;
+	/** Source ID, unique for each different \c source in the set or \c -1 if \c source is \c NULL. */
+	int sourceId;
+	/** Source of the token. Can be \c NULL. */
+	const char *source;
+	/** The token: unknown name, value or the whole line in case of a syntax error. */
+	const char *token;
+	/** The length of the \c token. */
+	size_t tokenLen;
+	/** Count of typo candidates. */
+	int candidateCount;
+	/** Indices of the candidate parameters in the order they are defined in #PARAM_SET_new. */
+	int candidate[PST_DIAG_MAX_CANDIDATES];
+	/** Print names of the candidate parameters (see #PARAM_SET_setPrintName). */
+	const char *candidateName[PST_DIAG_MAX_CANDIDATES];
+} PARAM_SET_DIAG;
+
+/**
+ * Phases reported to the trace callback (see #PARAM_SET_setTraceCallback).
+ * Phases can be nested, e.g. #PST_TRACE_TYPOS is reported inside #PST_TRACE_TOKENIZE
+ * for every unknown token.
+ */
+enum PARAM_SET_TRACE_PHASE_enum {
+	/** The whole #PARAM_SET_parseCMD. */
+	PST_TRACE_PARSE_CMD = 1,
+	/** Analyzing the command-line tokens and adding the values. */
+	PST_TRACE_TOKENIZE,
+	/** Adding a token to the collectors (see #PST_PRSCMD_COLLECT_LOOSE_VALUES). */
+	PST_TRACE_COLLECTORS,
+	/** Checking if unknown token is a typo. */
+	PST_TRACE_TYPOS,
+	/** Expanding the wildcards (see #PST_PRSCMD_EXPAND_WILDCARD). */
+	PST_TRACE_WILDCARDS,
+	/** The whole #PARAM_SET_readFromFile. */
+	PST_TRACE_READ_FILE,
+	/** Reading and tokenizing the file (or loading it from the cache). */
+	PST_TRACE_FILE_IO,
+	/** Adding the values read from the file. */
+	PST_TRACE_FILE_PARSE,
+	/** Deferred format and content checks of #PARAM_SET_validateAll. */
+	PST_TRACE_VALIDATE,
+	/** The whole #TASK_SET_analyzeConsistency. */
+	PST_TRACE_ANALYZE_TASKS,
+	/** Calculating the consistency of each task. */
+	PST_TRACE_TASK_SCORING,
+	/** Sorting the tasks by consistency. */
+	PST_TRACE_TASK_SORTING
+};
+
+/**
+ * Counters collected by the #PARAM_SET (see #PARAM_SET_getStats). The counters
+ * are cumulative since the set was created or #PARAM_SET_resetStats was called,
+ * except \c stringBytes that is the current size of the strings.
+ */
+typedef struct PARAM_SET_STATS_st {
+	/** Count of parameter lookups by name. */
+	unsigned long nameLookups;
+	/** Count of edit distance computations made to detect typos. */
+	unsigned long editDistances;
+	/** Count of values allocated. */
+	unsigned long valuesAllocated;
+	/** Count of bytes held in value and source strings, strings mapped by #PARAM_SET_loadSnapshot are not counted. */
+	size_t stringBytes;
+	/** Count of times the value iterator could not be reused and was reset (see #PARAM_SET_getStr). */
+	unsigned long iteratorResets;
+	/** Count of format and content check invocations (see #PARAM_SET_addControl). */
+	unsigned long validatorCalls;
+	/** Count of values expanded by the wildcard expander. */
+	unsigned long wildcardExpansions;
+} PARAM_SET_STATS;
+
 /**
  * \return A constant pointer to a constant string describing the
  * version number of the package.
@@ -154,6 +273,86 @@ int PARAM_SET_new(const char *names, PARAM_SET **set);
  */
 void PARAM_SET_free(PARAM_SET *set);
 
+/**
+ * Version of the #PARAM_SET_SPEC structure.
+ */
+#define PARAM_SET_SPEC_VERSION 1
+
+/**
+ * A parameter in the #PARAM_SET_SPEC.
+ */
+typedef struct PARAM_SET_SPEC_PARAM_st {
+	/** Name of the parameter. */
+	const char *name;
+
+	/** Alias of the parameter or \c NULL. */
+	const char *alias;
+
+	/** Constraints (see [PARAM_CONSTRAINTS](@ref PARAM_CONSTRAINTS_enum)). */
+	int constraints;
+
+	/** Parsing options (see [PARAM_PARSE_OPTIONS](@ref PARAM_PARSE_OPTIONS_enum)). */
+	int parsingOptions;
+} PARAM_SET_SPEC_PARAM;
+
+/**
+ * Parameter specification of #PARAM_SET_new that is already parsed. It is
+ * usually generated as C source with the \c paramset-gen tool at build time,
+ * but can also be created with #PARAM_SET_SPEC_new. Names and aliases are
+ * indexed with a perfect hash table, so that a parameter is found by name with
+ * a single comparison.
+ */
+typedef struct PARAM_SET_SPEC_st {
+	/** Must be #PARAM_SET_SPEC_VERSION. */
+	int version;
+
+	/** Count of parameters. */
+	int count;
+
+	/** Parameters. */
+	const PARAM_SET_SPEC_PARAM *param;
+
+	/** Seed of the hash function that selects the bucket of a name. */
+	unsigned long seed;
+
+	/** Count of buckets. */
+	unsigned bucketCount;
+
+	/** Seed of the hash function for each bucket. */
+	const unsigned short *displace;
+
+	/** Size of \c hash, a power of two. */
+	unsigned hashSize;
+
+	/** Index of the parameter for every hash value of name or alias, \c -1 if not used. */
+	const short *hash;
+} PARAM_SET_SPEC;
+
+/**
+ * Parses the parameter names as #PARAM_SET_new and creates the #PARAM_SET_SPEC
+ * with the name lookup table.
+ * \param	names	Pointer to parameter names.
+ * \param	spec	Pointer to receiving pointer to #PARAM_SET_SPEC object.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_SPEC_new(const char *names, PARAM_SET_SPEC **spec);
+
+/**
+ * Frees the #PARAM_SET_SPEC created by #PARAM_SET_SPEC_new.
+ * \param	spec	#PARAM_SET_SPEC object.
+ */
+void PARAM_SET_SPEC_free(PARAM_SET_SPEC *spec);
+
+/**
+ * Same as #PARAM_SET_new, but the parameters are created from the #PARAM_SET_SPEC
+ * and the spec is used to look up the parameters by name.
+ * \param	spec	#PARAM_SET_SPEC object, must not be freed before the set.
+ * \param	set		Pointer to receiving pointer to #PARAM_SET object.
+ * \return #PST_OK if successful, error code otherwise. If the spec is not valid
+ * #PST_INVALID_FORMAT is returned.
+ */
+int PARAM_SET_newFromSpec(const PARAM_SET_SPEC *spec, PARAM_SET **set);
+
 /**
  * Adds several optional functions to a set of parameters. Each function takes
  * one parameter as C-string value (must not fail if is \c NULL). All the
@@ -212,6 +411,22 @@ int PARAM_SET_addControl(PARAM_SET *set, const char *names,
 		int (*convert)(const char*, char*, unsigned),
 		int (*extractObject)(void **, const char *, void**));
 
+/**
+ * Sets the conversion function that writes the converted value to the storage
+ * owned by the library, so the size of the value is not limited and no extra
+ * copy is made. When set, it is used instead of \c convert given to
+ * #PARAM_SET_addControl. See #PARAM_setConverter for details.
+ *
+ * <tt>int (*convert)(const char *value, char *buf, size_t *buf_len)</tt>
+ *
+ * \param	set				#PARAM_SET object.
+ * \param	names			List of names to set the function for.
+ * \param	convert			Function for value conversion. Can be \c NULL to remove it.
+ * \return #PST_OK if successful, error code otherwise.
+ * \see #PARAM_SET_addControl.
+ */
+int PARAM_SET_setConverter(PARAM_SET *set, const char *names, int (*convert)(const char*, char*, size_t*));
+
 /**
  * Alters the way the parameter is represented in (error)
  * messages, help text and returned by #PARAM_getPrintName.
@@ -278,7 +493,10 @@ int PARAM_SET_setHelpText(PARAM_SET *set, const char *names, const char *arg, co
  * Generates help text for parameters. Before any help text
  * can be generated it must be configured for all the parameters with function
  * #PARAM_SET_setHelpText. The way the parameter is represented can be modified
- * with #PARAM_SET_setPrintName function.
+ * with #PARAM_SET_setPrintName function. The help text is parsed once when it
+ * is set and the rendered row of each parameter is cached for the last used
+ * \c indent, \c header and \c rowWidth, unless the print name is created by a
+ * function.
  *
  * \param	set			#PARAM_SET object.
  * \param	names		List of names to generate help for.
@@ -291,6 +509,26 @@ int PARAM_SET_setHelpText(PARAM_SET *set, const char *names, const char *arg, co
  */
 char* PARAM_SET_helpToString(const PARAM_SET *set, const char *names, int indent, int header, int rowWidth, char *buf, size_t buf_len);
 
+/**
+ * Same as #PARAM_SET_helpToString, but instead of filling a fixed size buffer
+ * the help text is streamed to the \c write callback piece by piece, so there
+ * is no limit on the size of the output. To write into a file use #PST_writeToFile.
+ * If \c write is \c NULL, nothing is written and only the exact size of the
+ * output is calculated (dry-run), e.g. to allocate a buffer large enough.
+ *
+ * \param	set			#PARAM_SET object.
+ * \param	names		List of names to generate help for.
+ * \param	indent		Help text indention.
+ * \param	header		The size of the header (see #PARAM_SET_helpToString).
+ * \param	rowWidth	The size of the row.
+ * \param	write		Write callback that returns #PST_OK on success. Can be \c NULL.
+ * \param	ctx			Context for \c write.
+ * \param	count		Pointer to receiving count of bytes produced, not including terminating \c NULL. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise. If \c write fails, its
+ * return value is returned and the output is stopped.
+ */
+int PARAM_SET_helpToSink(const PARAM_SET *set, const char *names, int indent, int header, int rowWidth, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count);
+
 /**
  * Appends value to the set. Invalid value format or content is not handled
  * as error, but the state is saved. Internal format, content or count errors can
@@ -481,6 +719,21 @@ int PARAM_SET_isSetByName(const PARAM_SET *set, const char *names);
  */
 int PARAM_SET_isOneOfSetByName(const PARAM_SET *set, const char *names);
 
+/**
+ * Runs the format and content check for every value whose check is pending
+ * (see #PST_CONTROL_LAZY and #PARAM_SET_setControlOptions) using up to \c nthreads
+ * threads. The results are stored in the order of the values, so the outcome
+ * does not depend on the thread count. If the library is built without thread
+ * support, all checks are run by the calling thread.
+ *
+ * \param	set			#PARAM_SET object.
+ * \param	nthreads	Maximum count of threads used, including the calling thread. Must be at least \c 1.
+ * \return #PST_OK if successful, error code otherwise.
+ * \attention Control functions (see #PARAM_SET_addControl) of the pending values
+ * must be thread safe if \c nthreads is greater than \c 1.
+ */
+int PARAM_SET_validateAll(PARAM_SET *set, int nthreads);
+
 /**
  * Controls if the format and content of the parameters are OK.
  * \param	set		#PARAM_SET object.
@@ -544,6 +797,73 @@ int PARAM_SET_isSyntaxError(const PARAM_SET *set);
  */
 int PARAM_SET_isUnknown(const PARAM_SET *set);
 
+/**
+ * Returns the count of diagnostic records (typos, unknown parameters and syntax
+ * errors) collected by the set. The records are stored in compact form and
+ * the text is formatted only when requested (e.g. #PARAM_SET_typosToString).
+ * \param	set		#PARAM_SET object.
+ * \param	count	Pointer to receiving count.
+ * \return #PST_OK if successful, error code otherwise.
+ * \see #PARAM_SET_getDiagnostic.
+ */
+int PARAM_SET_getDiagnosticCount(const PARAM_SET *set, size_t *count);
+
+/**
+ * Extracts a diagnostic record. Records are ordered as they were collected.
+ * \param	set		#PARAM_SET object.
+ * \param	at		Index of the record.
+ * \param	diag	Pointer to receiving record.
+ * \return #PST_OK if successful, error code otherwise. If \c at is out of range
+ * #PST_INDEX_OVF is returned.
+ */
+int PARAM_SET_getDiagnostic(const PARAM_SET *set, size_t at, PARAM_SET_DIAG *diag);
+
+/**
+ * Extracts the counters collected by the set. Counting can be removed entirely
+ * by building the library with \c PST_DISABLE_STATS defined (<tt>./configure --disable-stats</tt>
+ * or <tt>CCEXTRA=/DPST_DISABLE_STATS</tt> with nmake), in that case all the counters
+ * are zero.
+ * \param	set		#PARAM_SET object.
+ * \param	stats	Pointer to receiving counters.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_getStats(const PARAM_SET *set, PARAM_SET_STATS *stats);
+
+/**
+ * Sets all the counters returned by #PARAM_SET_getStats to zero, except
+ * \c stringBytes that reports the strings still held by the set.
+ * \param	set		#PARAM_SET object.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_resetStats(PARAM_SET *set);
+
+/**
+ * Sets the callback that is called at the beginning and at the end of the
+ * phases listed in #PARAM_SET_TRACE_PHASE_enum. The timestamp is taken from a
+ * monotonic clock in microseconds (with fractional part), so the events can be
+ * written directly as \c B and \c E events of the Chrome trace format.
+ *
+ * \code{.c}
+ * static void trace(void *ctx, int phase, int isEnd, double timestamp) {
+ *     fprintf((FILE*)ctx, "{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": 1},\n",
+ *         PARAM_SET_tracePhaseToString(phase), isEnd ? 'E' : 'B', timestamp);
+ * }
+ * \endcode
+ *
+ * \param	set		#PARAM_SET object.
+ * \param	trace	Callback or \c NULL to disable tracing.
+ * \param	ctx		Context for the callback.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_setTraceCallback(PARAM_SET *set, void (*trace)(void *ctx, int phase, int isEnd, double timestamp), void *ctx);
+
+/**
+ * Returns the name of the trace phase (see #PARAM_SET_TRACE_PHASE_enum).
+ * \param	phase	Trace phase.
+ * \return Constant string.
+ */
+const char* PARAM_SET_tracePhaseToString(int phase);
+
 /**
  * Reads parameter values from file into predefined #PARAM_SET. File must be
  * formatted one parameter (and its possible value) per line. To add a comment '<tt>#</tt>'
@@ -567,6 +887,167 @@ int PARAM_SET_isUnknown(const PARAM_SET *set);
  */
 int PARAM_SET_readFromFile(PARAM_SET *set, const char *fname, const char* source, int priority);
 
+/**
+ * Reads parameter values from the environment variables. A variable
+ * <tt>\<prefix\>\<NAME\></tt> is mapped to the parameter whose name or alias
+ * is \c NAME, when converted to upper case and '<tt>-</tt>' is replaced with
+ * '<tt>_</tt>'. For example with prefix \c "MYAPP_" the variable \c MYAPP_LOG_LEVEL
+ * sets the parameter \c log-level. The environment is scanned once and variables
+ * with the prefix that do not match any parameter are ignored (no typo or unknown
+ * parameter is recorded). A parameter with #PST_PRSCMD_HAS_NO_VALUE is added
+ * without a value.
+ *
+ * \param	set			#PARAM_SET object.
+ * \param	prefix		Prefix of the variables, can be empty string.
+ * \param	source		Source description, can be \c NULL.
+ * \param	priority	Priority that can be #PST_PRIORITY_VALID_BASE (<tt>0</tt>) or higher.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_readFromEnv(PARAM_SET *set, const char *prefix, const char *source, int priority);
+
+/**
+ * Creates a cache for parsed configuration files. When a #PARAM_SET has a cache
+ * (see #PARAM_SET_setFileCache), #PARAM_SET_readFromFile does not parse a file
+ * that has not changed since it was cached, but the stored key-value pairs are
+ * added the same way as they were read. A file is considered unchanged when its
+ * size and modification time are the same or when its content has the same hash.
+ *
+ * If \c dir is specified, the parsed files are also stored in that directory,
+ * named by the content hash, so that they can be reused by other processes. The
+ * directory must exist.
+ *
+ * \param	dir			Directory for the cache files. Can be \c NULL to cache only in memory.
+ * \param	capacity	Maximum count of files kept in memory, must not be \c 0.
+ * \param	cache		Pointer to the receiving pointer to #PST_FILE_CACHE object.
+ * \return #PST_OK if successful, error code otherwise.
+ * \note The cache is not thread safe. It must outlive all the sets using it.
+ */
+int PST_FILE_CACHE_new(const char *dir, size_t capacity, PST_FILE_CACHE **cache);
+
+/**
+ * Free #PST_FILE_CACHE object.
+ * \param	cache		#PST_FILE_CACHE object.
+ */
+void PST_FILE_CACHE_free(PST_FILE_CACHE *cache);
+
+/**
+ * Returns the counts of reads served from memory, served from the cache
+ * directory and the files that had to be parsed.
+ * \param	cache		#PST_FILE_CACHE object.
+ * \param	hits		Pointer to receiving count of reads served from memory. Can be \c NULL.
+ * \param	diskHits	Pointer to receiving count of reads served from the cache directory. Can be \c NULL.
+ * \param	misses		Pointer to receiving count of parsed files. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PST_FILE_CACHE_getCounters(const PST_FILE_CACHE *cache, size_t *hits, size_t *diskHits, size_t *misses);
+
+/**
+ * Sets the cache used by #PARAM_SET_readFromFile. The cache is not owned by
+ * the set and can be shared by multiple sets.
+ * \param	set			#PARAM_SET object.
+ * \param	cache		#PST_FILE_CACHE object or \c NULL to disable caching.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_setFileCache(PARAM_SET *set, PST_FILE_CACHE *cache);
+
+/**
+ * Reloads the parameter values read from a file with #PARAM_SET_readFromFile
+ * with the same \c source and \c priority. The file is read as usual and the
+ * values of each parameter are compared with the old values with the same source
+ * and priority. If they differ, the old values are removed and the new values are
+ * kept (appended to the end of the list), otherwise the new values are discarded
+ * and the old values are kept untouched. For every changed parameter \c onChange
+ * is called after its values are updated.
+ *
+ * \param	set			#PARAM_SET object.
+ * \param	fname		File path.
+ * \param	source		Source description as c-string. Should be unique for the file. Can be \c NULL.
+ * \param	priority	Priority that can be #PST_PRIORITY_VALID_BASE (<tt>0</tt>) or higher.
+ * \param	onChange	Function called with the name of every changed parameter. Can be \c NULL.
+ * \param	ctx			Context for \c onChange.
+ * \param	changed		Pointer to receiving count of changed parameters. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise. If file format is invalid,
+ * #PST_INVALID_FORMAT is returned, but the values are updated. On other errors
+ * the values and the diagnostic records are not changed.
+ * \note Typos, unknown parameters and syntax errors read from \c fname with the
+ * same \c source and \c priority are replaced by the ones found in the new
+ * content. Records from other inputs, even with the same \c source, are kept. The first reload compares all the
+ * values of \c source, later reloads only update the parameters referenced by the
+ * lines that differ from the previously loaded content.
+ */
+int PARAM_SET_reloadFromFile(PARAM_SET *set, const char *fname, const char* source, int priority,
+		void (*onChange)(void *ctx, PARAM_SET *set, const char *name), void *ctx, int *changed);
+
+/**
+ * Adds a file to the list of files that are reloaded by #PARAM_SET_processWatches
+ * when they are changed. The file is not read, use #PARAM_SET_readFromFile to do
+ * the initial read.
+ *
+ * \param	set			#PARAM_SET object.
+ * \param	fname		File path.
+ * \param	source		Source description as c-string (see #PARAM_SET_reloadFromFile). Can be \c NULL.
+ * \param	priority	Priority that can be #PST_PRIORITY_VALID_BASE (<tt>0</tt>) or higher.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_watchFile(PARAM_SET *set, const char *fname, const char* source, int priority);
+
+/**
+ * Returns a file descriptor that becomes readable when some of the watched files
+ * (see #PARAM_SET_watchFile) may be changed. It can be used with \c poll or
+ * \c select to call #PARAM_SET_processWatches only when needed. The descriptor
+ * is available only on systems with inotify.
+ *
+ * \param	set			#PARAM_SET object.
+ * \param	fd			Pointer to receiving descriptor. If it is \c -1, #PARAM_SET_processWatches
+ *						must be called periodically.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_getWatchDescriptor(const PARAM_SET *set, int *fd);
+
+/**
+ * Reloads the watched files (see #PARAM_SET_watchFile) that are changed with
+ * #PARAM_SET_reloadFromFile.
+ *
+ * \param	set			#PARAM_SET object.
+ * \param	onChange	Function called with the name of every changed parameter. Can be \c NULL.
+ * \param	ctx			Context for \c onChange.
+ * \param	changed		Pointer to receiving count of changed parameters. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise. If a file can not be
+ * reloaded, the rest of the files are still reloaded and the first error is returned.
+ */
+int PARAM_SET_processWatches(PARAM_SET *set, void (*onChange)(void *ctx, PARAM_SET *set, const char *name), void *ctx, int *changed);
+
+/**
+ * Saves all parameter values of the #PARAM_SET with their source, priority and
+ * check results into a binary snapshot file that can be loaded with
+ * #PARAM_SET_loadSnapshot to skip parsing and checking at startup. Pending checks
+ * (see #PST_CONTROL_LAZY) are run before saving.
+ *
+ * \param	set			#PARAM_SET object.
+ * \param	fname		File path.
+ * \return #PST_OK if successful, error code otherwise. If file can not be written,
+ * #PST_IO_ERROR is returned.
+ * \see #PARAM_SET_loadSnapshot.
+ */
+int PARAM_SET_saveSnapshot(PARAM_SET *set, const char *fname);
+
+/**
+ * Loads the parameter values from the snapshot file created by #PARAM_SET_saveSnapshot.
+ * The #PARAM_SET must define all the parameters present in the snapshot (usually
+ * it is configured the same way as the saved set). Values are appended to the
+ * existing values with the stored source, priority and check results, the checks
+ * are not run again. Where possible, the file is memory mapped and the values
+ * refer to the mapped data that is kept until the set is freed.
+ *
+ * \param	set			#PARAM_SET object.
+ * \param	fname		File path.
+ * \return #PST_OK if successful, error code otherwise. If the file is not a valid
+ * snapshot or has unsupported version, #PST_SNAPSHOT_INCOMPATIBLE is returned.
+ * If the set does not contain a parameter from the snapshot, #PST_PARAMETER_NOT_FOUND
+ * is returned. On error the set is not changed.
+ */
+int PARAM_SET_loadSnapshot(PARAM_SET *set, const char *fname);
+
 /**
  * Reads parameter values from command line into predefined #PARAM_SET. Parameters
  * are stored in internal data structures where one parameter can have multiple values.
@@ -624,6 +1105,57 @@ int PARAM_SET_readFromCMD(PARAM_SET *set, int argc, char **argv, const char *sou
  */
 int PARAM_SET_parseCMD(PARAM_SET *set, int argc, char **argv, const char *source, int priority);
 
+/**
+ * A command line parsed by #PARAM_SET_parseMany and the outcome of the parsing.
+ */
+typedef struct PARAM_SET_CMD_st {
+	/** Count of command line strings. */
+	int argc;
+
+	/** Array of command line strings. */
+	char **argv;
+
+	/**
+	 * The set that contains the parsed values and the diagnostics (see
+	 * #PARAM_SET_getDiagnostic). Must be freed by the caller. Is \c NULL if the
+	 * set could not be created.
+	 */
+	PARAM_SET *set;
+
+	/** #PST_OK if the set was configured and the command line parsed, error code otherwise. */
+	int result;
+} PARAM_SET_CMD;
+
+/**
+ * Parses many command lines against the same parameter specification using up
+ * to \c nthreads threads. For every command line a #PARAM_SET is created from
+ * the shared \c spec (see #PARAM_SET_newFromSpec), configured with the
+ * \c configure function and then given to #PARAM_SET_parseCMD. The command
+ * lines are handed out to the threads one by one, so a thread that finishes
+ * early takes over the command lines that would otherwise wait for a slow one.
+ * If the library is built without thread support, all command lines are parsed
+ * by the calling thread.
+ *
+ * The results are stored into \c cmd: \c set and \c result of every element
+ * are overwritten. Failure to parse a single command line does not stop the
+ * parsing of the others.
+ *
+ * \param	spec		#PARAM_SET_SPEC object that is not changed, must not be freed before the sets.
+ * \param	configure	Function that configures the set (controls, parse options etc.), can be \c NULL.
+ * \param	ctx			Context given to \c configure.
+ * \param	cmd			Array of command lines.
+ * \param	count		Count of elements in \c cmd.
+ * \param	source		Source description as c-string. Can be \c NULL.
+ * \param	priority	Priority that can be #PST_PRIORITY_VALID_BASE (<tt>0</tt>) or higher.
+ * \param	nthreads	Maximum count of threads used, including the calling thread. Must be at least \c 1.
+ * \return #PST_OK if all command lines were processed, error code otherwise.
+ * The outcome of each command line is in #PARAM_SET_CMD.result.
+ * \attention \c configure and the functions it sets (control, converter,
+ * wildcard expander etc.) must be thread safe if \c nthreads is greater than \c 1.
+ */
+int PARAM_SET_parseMany(const PARAM_SET_SPEC *spec, int (*configure)(void *ctx, PARAM_SET *set), void *ctx,
+		PARAM_SET_CMD *cmd, size_t count, const char *source, int priority, int nthreads);
+
 /**
  * Specifies the parsing options ([PARAM_PARSE_OPTIONS](@ref PARAM_PARSE_OPTIONS_enum)) used
  * by #PARAM_SET_parseCMD.
@@ -636,12 +1168,30 @@ int PARAM_SET_parseCMD(PARAM_SET *set, int argc, char **argv, const char *source
  */
 int PARAM_SET_setParseOptions(PARAM_SET *set, const char *names, int options);
 
+/**
+ * Specifies the control options ([PARAM_CONTROL_OPTIONS](@ref PARAM_CONTROL_OPTIONS_enum))
+ * that affect when the functions set with #PARAM_SET_addControl are applied. With
+ * #PST_CONTROL_LAZY the format and content of a value is checked on first access
+ * or in a batch by #PARAM_SET_isFormatOK and #PARAM_SET_invalidParametersToString.
+ *
+ * \param set			#PARAM_SET object.
+ * \param names			Parameter name list.
+ * \param options		Control options.
+ * \return #PST_OK if successful, error code otherwise.
+ * \see #PARAM_SET_addControl and #PARAM_setControlOptions.
+ */
+int PARAM_SET_setControlOptions(PARAM_SET *set, const char *names, int options);
+
 /**
  * Extracts all parameters from \c src known to \c target and appends all the
- * values to the target #PARAM_SET. Values are added via #PARAM_SET_add and all
- * check and extract functions that are used are from the target set. After
- * successful operation both sets <b>must be freed separately</b> and operations applied
- * to each set fo not affect the other one.
+ * values to the target #PARAM_SET. All check and extract functions that are used
+ * are from the target set. If the parameter in \c target has no conversion
+ * function and the same format and content check functions as in \c src, the
+ * values are appended with their check status and the strings are shared with
+ * \c src through a reference count. Otherwise the values are added as with
+ * #PARAM_SET_add. After successful operation both sets <b>must be freed separately</b>
+ * and operations applied to each set do not affect the other one, but the sets
+ * must not be freed concurrently.
  *
  * \param	target			Target #PARAM_SET.
  * \param	src				Source #PARAM_SET.
@@ -649,6 +1199,51 @@ int PARAM_SET_setParseOptions(PARAM_SET *set, const char *names, int options);
  */
 int PARAM_SET_IncludeSet(PARAM_SET *target, PARAM_SET *src);
 
+/**
+ * Makes the values of \c src visible through the value getters of \c target
+ * without copying them. The layers are appended to the end of the list of layers
+ * and the values of a parameter are seen in order: the values of \c target first,
+ * followed by the values of each layer in the order the layers were pushed. Only
+ * parameters known to both sets are visible and the layers of \c src itself
+ * are not.
+ *
+ * The values of the layer keep their check and extract functions from \c src.
+ * The priority of every value of the layer is seen as its priority plus
+ * \c priority_offset, so a stack of defaults, site, user and command-line sets
+ * can be combined with increasing offsets and queried with #PST_PRIORITY_HIGHEST.
+ *
+ * Layers are seen by #PARAM_SET_getStr, #PARAM_SET_getObj, #PARAM_SET_getObjExtended,
+ * #PARAM_SET_getAtr, #PARAM_SET_getValueCount, #PARAM_SET_isSetByName and
+ * #PARAM_SET_isOneOfSetByName. The validation, typo and unknown parameter
+ * functions and the string representations of \c target use only the values
+ * of \c target.
+ *
+ * \c src is not owned by \c target and must not be freed before it is removed
+ * with #PARAM_SET_removeLayer or \c target is freed.
+ *
+ * \param	target			Target #PARAM_SET.
+ * \param	src				The #PARAM_SET to be added as a layer.
+ * \param	priority_offset	Offset added to the priority of the values of \c src.
+ *							Must be in range of #PST_PRIORITY_VALID_BASE and #PST_PRIORITY_VALID_ROOF.
+ * \return #PST_OK if successful, error code otherwise.
+ * \see #PARAM_SET_IncludeSet to copy the values.
+ */
+int PARAM_SET_pushLayer(PARAM_SET *target, PARAM_SET *src, int priority_offset);
+
+/**
+ * Removes the most recently pushed layer of \c src from \c target. See
+ * #PARAM_SET_pushLayer.
+ *
+ * Layers are meant for a short stack of sets (e.g. defaults, site, user and
+ * command-line) and the list of layers is searched linearly.
+ *
+ * \param	target			Target #PARAM_SET.
+ * \param	src				The #PARAM_SET to be removed.
+ * \return #PST_OK if successful, #PST_INVALID_ARGUMENT if \c src is not a layer
+ * of \c target, error code otherwise.
+ */
+int PARAM_SET_removeLayer(PARAM_SET *target, PARAM_SET *src);
+
 /**
  * Generates #PARAM_SET string representation for debugging.
  * \param	set		#PARAM_SET object.
@@ -658,6 +1253,16 @@ int PARAM_SET_IncludeSet(PARAM_SET *target, PARAM_SET *src);
  */
 char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len);
 
+/**
+ * Streaming version of #PARAM_SET_toString (see #PARAM_SET_helpToSink).
+ * \param	set		#PARAM_SET object.
+ * \param	write	Write callback. If \c NULL, output is only counted.
+ * \param	ctx		Context for \c write.
+ * \param	count	Pointer to receiving count of bytes produced. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_toSink(PARAM_SET *set, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count);
+
 /**
  * Generates typo failure report.
  * \param	set		#PARAM_SET object.
@@ -669,6 +1274,18 @@ char* PARAM_SET_toString(PARAM_SET *set, char *buf, size_t buf_len);
  */
 char* PARAM_SET_typosToString(PARAM_SET *set, const char *prefix, char *buf, size_t buf_len);
 
+/**
+ * Streaming version of #PARAM_SET_typosToString (see #PARAM_SET_helpToSink).
+ * If there are no typos, nothing is written.
+ * \param	set		#PARAM_SET object.
+ * \param	prefix	Prefix to each typo failure string. Can be \c NULL.
+ * \param	write	Write callback. If \c NULL, output is only counted.
+ * \param	ctx		Context for \c write.
+ * \param	count	Pointer to receiving count of bytes produced. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_typosToSink(PARAM_SET *set, const char *prefix, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count);
+
 /**
  * Generates unknown parameter report.
  * \param set		#PARAM_SET object.
@@ -680,6 +1297,18 @@ char* PARAM_SET_typosToString(PARAM_SET *set, const char *prefix, char *buf, siz
  */
 char* PARAM_SET_unknownsToString(const PARAM_SET *set, const char *prefix, char *buf, size_t buf_len);
 
+/**
+ * Streaming version of #PARAM_SET_unknownsToString (see #PARAM_SET_helpToSink).
+ * If there are no unknown parameters, nothing is written.
+ * \param set		#PARAM_SET object.
+ * \param prefix	Prefix to each unknown failure string. Can be \c NULL.
+ * \param write		Write callback. If \c NULL, output is only counted.
+ * \param ctx		Context for \c write.
+ * \param count		Pointer to receiving count of bytes produced. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_unknownsToSink(const PARAM_SET *set, const char *prefix, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count);
+
 /**
  * Generates a string from invalid parameter list (see #PARAM_SET_addControl).
  * By default error strings generated contain only error code. To make the messages
@@ -696,6 +1325,18 @@ char* PARAM_SET_unknownsToString(const PARAM_SET *set, const char *prefix, char
  */
 char* PARAM_SET_invalidParametersToString(const PARAM_SET *set, const char *prefix, const char* (*getErrString)(int), char *buf, size_t buf_len);
 
+/**
+ * Streaming version of #PARAM_SET_invalidParametersToString (see #PARAM_SET_helpToSink).
+ * \param	set				#PARAM_SET object.
+ * \param	prefix			Prefix for each failure string. Can be \c NULL.
+ * \param	getErrString	Function pointer to make error codes to string. Can be \c NULL.
+ * \param	write			Write callback. If \c NULL, output is only counted.
+ * \param	ctx				Context for \c write.
+ * \param	count			Pointer to receiving count of bytes produced. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_invalidParametersToSink(const PARAM_SET *set, const char *prefix, const char* (*getErrString)(int), int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count);
+
 /**
  * Generates constraint error report. See #PARAM_CONSTRAINTS and #PARAM_SET_new.
  * \param	set				#PARAM_SET object.
@@ -706,6 +1347,17 @@ char* PARAM_SET_invalidParametersToString(const PARAM_SET *set, const char *pref
  */
 char* PARAM_SET_constraintErrorToString(const PARAM_SET *set, const char *prefix, char *buf, size_t buf_len);
 
+/**
+ * Streaming version of #PARAM_SET_constraintErrorToString (see #PARAM_SET_helpToSink).
+ * \param	set				#PARAM_SET object.
+ * \param	prefix			Prefix for each constraint error string. Can be \c NULL.
+ * \param	write			Write callback. If \c NULL, output is only counted.
+ * \param	ctx				Context for \c write.
+ * \param	count			Pointer to receiving count of bytes produced. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_constraintErrorToSink(const PARAM_SET *set, const char *prefix, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count);
+
 /**
  * Converts PST_* error codes to string.
  * \param err	Error code from #PARAM_SET_ERR_enum.
@@ -713,6 +1365,148 @@ char* PARAM_SET_constraintErrorToString(const PARAM_SET *set, const char *prefix
  */
 const char* PARAM_SET_errorToString(int err);
 
+/**
+ * Creates an immutable copy of the parameters and their values. Pending format
+ * and content checks are run before the copy is made (see #PARAM_SET_validateAll).
+ * The copy does not refer to the set, so the set can be changed or freed
+ * afterwards. All functions reading #PST_FROZEN_SET can be called by multiple
+ * threads at the same time. The values are stored in arrays, so getting the
+ * value at any position without source constraint and with #PST_PRIORITY_NONE or
+ * #PST_PRIORITY_HIGHEST does not depend on the count of the values.
+ *
+ * \param	set			#PARAM_SET object.
+ * \param	frozen		Pointer to the receiving pointer to #PST_FROZEN_SET object.
+ * \return #PST_OK if successful, error code otherwise.
+ * \see #PST_PUBLISHER_publish.
+ */
+int PARAM_SET_freeze(PARAM_SET *set, PST_FROZEN_SET **frozen);
+
+/**
+ * Free #PST_FROZEN_SET object. A set that is published must not be freed, as
+ * it is freed by the #PST_PUBLISHER.
+ * \param	frozen		#PST_FROZEN_SET object.
+ */
+void PST_FROZEN_SET_free(PST_FROZEN_SET *frozen);
+
+/**
+ * Same as #PARAM_SET_getStr, but the value is read from #PST_FROZEN_SET and
+ * \c name must be a single parameter name or alias.
+ * \param	frozen		#PST_FROZEN_SET object.
+ * \param	name		Parameter name or alias.
+ * \param	source		Constraint for the source, can be \c NULL.
+ * \param	priority	Priority of the value or #PST_PRIORITY_NONE, #PST_PRIORITY_LOWEST, #PST_PRIORITY_HIGHEST.
+ * \param	at			Index of the value or #PST_INDEX_LAST.
+ * \param	value		Pointer to the receiving pointer to the value. The value belongs to \c frozen.
+ * \return #PST_OK if successful, error code otherwise. If the value has failed
+ * the format or content check, the value is returned with #PST_PARAMETER_INVALID_FORMAT.
+ */
+int PST_FROZEN_SET_getStr(const PST_FROZEN_SET *frozen, const char *name, const char *source, int priority, int at, const char **value);
+
+/**
+ * Same as #PARAM_SET_getValueCount, but the values are counted in #PST_FROZEN_SET
+ * and \c name must be a single parameter name or alias.
+ * \param	frozen		#PST_FROZEN_SET object.
+ * \param	name		Parameter name or alias.
+ * \param	source		Constraint for the source, can be \c NULL.
+ * \param	priority	Priority of the values or #PST_PRIORITY_NONE, #PST_PRIORITY_LOWEST, #PST_PRIORITY_HIGHEST.
+ * \param	count		Pointer to the receiving count of values.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PST_FROZEN_SET_getValueCount(const PST_FROZEN_SET *frozen, const char *name, const char *source, int priority, int *count);
+
+/**
+ * Checks if the parameter has at least one value in #PST_FROZEN_SET.
+ * \param	frozen		#PST_FROZEN_SET object.
+ * \param	name		Parameter name or alias.
+ * \return 1 if set, 0 otherwise.
+ */
+int PST_FROZEN_SET_isSet(const PST_FROZEN_SET *frozen, const char *name);
+
+/**
+ * Creates a publisher that hands out the current #PST_FROZEN_SET to concurrent
+ * readers. A writer builds or updates a private #PARAM_SET, freezes it and
+ * publishes the result with #PST_PUBLISHER_publish. A reader gets the current
+ * set with #PST_PUBLISHER_enter and must call #PST_PUBLISHER_leave when it
+ * does not use the set anymore. Readers never wait for the writer and never
+ * see a set that is being updated.
+ *
+ * A replaced set is freed when every reader that could have got it has left
+ * (epoch based reclamation). Each reader thread needs its own reader slot
+ * (see #PST_PUBLISHER_addReader).
+ *
+ * If the library is built without atomic operations, readers take a lock that
+ * is shared with the writer.
+ *
+ * \param	maxReaders	Maximum count of reader slots, must not be \c 0.
+ * \param	pub			Pointer to the receiving pointer to #PST_PUBLISHER object.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PST_PUBLISHER_new(size_t maxReaders, PST_PUBLISHER **pub);
+
+/**
+ * Frees #PST_PUBLISHER object and all the sets it holds. There must be no
+ * readers using the publisher.
+ * \param	pub			#PST_PUBLISHER object.
+ */
+void PST_PUBLISHER_free(PST_PUBLISHER *pub);
+
+/**
+ * Reserves a reader slot for the calling thread.
+ * \param	pub			#PST_PUBLISHER object.
+ * \param	reader		Pointer to the receiving reader slot index.
+ * \return #PST_OK if successful, #PST_OUT_OF_MEMORY if all slots are in use,
+ * error code otherwise.
+ */
+int PST_PUBLISHER_addReader(PST_PUBLISHER *pub, size_t *reader);
+
+/**
+ * Releases the reader slot reserved with #PST_PUBLISHER_addReader.
+ * \param	pub			#PST_PUBLISHER object.
+ * \param	reader		Reader slot index.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PST_PUBLISHER_removeReader(PST_PUBLISHER *pub, size_t reader);
+
+/**
+ * Makes \c frozen the current set. The ownership is taken only if the function
+ * succeeds. The set that was current before is freed when no reader can use it.
+ * Only one thread may publish at a time. A set that is already owned by the
+ * publisher can not be published again.
+ * \param	pub			#PST_PUBLISHER object.
+ * \param	frozen		#PST_FROZEN_SET object.
+ * \return #PST_OK if successful, #PST_INVALID_ARGUMENT if \c frozen is the current
+ * set or a replaced set not freed yet, error code otherwise.
+ */
+int PST_PUBLISHER_publish(PST_PUBLISHER *pub, PST_FROZEN_SET *frozen);
+
+/**
+ * Returns the current set. The set stays valid until #PST_PUBLISHER_leave is
+ * called with the same reader slot.
+ * \param	pub			#PST_PUBLISHER object.
+ * \param	reader		Reader slot index.
+ * \param	frozen		Pointer to the receiving pointer to #PST_FROZEN_SET object. Is \c NULL if nothing is published.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PST_PUBLISHER_enter(PST_PUBLISHER *pub, size_t reader, const PST_FROZEN_SET **frozen);
+
+/**
+ * Ends the use of the set returned by #PST_PUBLISHER_enter.
+ * \param	pub			#PST_PUBLISHER object.
+ * \param	reader		Reader slot index.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PST_PUBLISHER_leave(PST_PUBLISHER *pub, size_t reader);
+
+/**
+ * Frees the replaced sets that no reader can use anymore. It is done by
+ * #PST_PUBLISHER_publish too, but can be called after readers have left to
+ * release the memory earlier.
+ * \param	pub			#PST_PUBLISHER object.
+ * \param	pending		Pointer to the receiving count of sets not freed yet. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PST_PUBLISHER_reclaim(PST_PUBLISHER *pub, size_t *pending);
+
 /**
  * Generates syntax error report.
  * \param	set				#PARAM_SET object.
@@ -724,6 +1518,18 @@ const char* PARAM_SET_errorToString(int err);
  */
 char* PARAM_SET_syntaxErrorsToString(const PARAM_SET *set, const char *prefix, char *buf, size_t buf_len);
 
+/**
+ * Streaming version of #PARAM_SET_syntaxErrorsToString (see #PARAM_SET_helpToSink).
+ * If there are no syntax errors, nothing is written.
+ * \param	set				#PARAM_SET object.
+ * \param	prefix			Prefix for each syntax error string. Can be \c NULL.
+ * \param	write			Write callback. If \c NULL, output is only counted.
+ * \param	ctx				Context for \c write.
+ * \param	count			Pointer to receiving count of bytes produced. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_SET_syntaxErrorsToSink(const PARAM_SET *set, const char *prefix, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count);
+
 /**
  * Separates names from a string. A function \c isValidNameChar
  * must be defined to separate valid name characters from the separators.
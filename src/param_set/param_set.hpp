@@ -0,0 +1,392 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#ifndef PARAM_SET_HPP
+#define	PARAM_SET_HPP
+
+#if __cplusplus < 201703L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#	error "param_set.hpp requires C++17."
+#endif
+
+#include <charconv>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "param_set.h"
+
+/**
+ * \file param_set.hpp
+ * Header-only C++17 layer on top of the C API. #paramset::ParamSet owns the
+ * #PARAM_SET and string values are returned as \c std::string_view to the
+ * buffers stored in the set, so no copies are made. The views stay valid until
+ * the value is removed or the set is destroyed.
+ *
+ * \code{.cpp}
+ * constexpr auto schema = paramset::Schema<>()
+ *     .param("h", "help")
+ *     .param("i", "input", paramset::Values::Multiple)
+ *     .param("v", paramset::Values::Multiple);
+ *
+ * paramset::ParamSet set(schema.c_str());
+ * set.parseCmd(argc, argv);
+ *
+ * for (std::string_view input : set.values("i")) { ... }
+ * int verbosity = set.count("v");
+ * auto level = set.get<int>("level");
+ * \endcode
+ */
+
+namespace paramset {
+
+/**
+ * Exception thrown for the error codes returned by the C API.
+ */
+class Error : public std::runtime_error {
+public:
+	explicit Error(int code)
+		: std::runtime_error(PARAM_SET_errorToString(code)), code_(code) {}
+
+	/** Returns the error code (see #PARAM_SET_ERR_enum). */
+	int code() const noexcept { return code_; }
+
+private:
+	int code_;
+};
+
+/**
+ * Throws #paramset::Error if \c res is not #PST_OK.
+ */
+inline void check(int res) {
+	if (res != PST_OK) throw Error(res);
+}
+
+/**
+ * Value count constraint of a parameter in #paramset::Schema.
+ */
+enum class Values {
+	/** Single value (<tt>{name}</tt>). */
+	Single,
+
+	/** Multiple values (<tt>{name}*</tt>). */
+	Multiple,
+
+	/** Single value for each priority level (<tt>{name}></tt>). */
+	SinglePerPriority
+};
+
+/**
+ * Compile-time builder of the parameter names string given to #PARAM_SET_new.
+ * All the methods are \c constexpr and return a new builder, so the schema can
+ * be composed in a \c constexpr variable. Exceeding the capacity \c N is
+ * reported as a compile error in a constant expression.
+ */
+template <std::size_t N = 1024>
+class Schema {
+public:
+	constexpr Schema() : buf_{}, len_(0) {}
+
+	/** Adds a parameter with an alias. */
+	constexpr Schema param(std::string_view name, std::string_view alias, Values values = Values::Single) const {
+		Schema tmp(*this);
+		tmp.append("{");
+		tmp.append(name);
+		if (!alias.empty()) {
+			tmp.append("|");
+			tmp.append(alias);
+		}
+		tmp.append("}");
+		if (values == Values::Multiple) tmp.append("*");
+		else if (values == Values::SinglePerPriority) tmp.append(">");
+		return tmp;
+	}
+
+	/** Adds a parameter without an alias. */
+	constexpr Schema param(std::string_view name, Values values = Values::Single) const {
+		return param(name, std::string_view(), values);
+	}
+
+	/** Returns the names string for #PARAM_SET_new. */
+	constexpr const char *c_str() const { return buf_; }
+
+	/** Returns the names string as view. */
+	constexpr std::string_view view() const { return std::string_view(buf_, len_); }
+
+private:
+	constexpr void append(std::string_view str) {
+		if (len_ + str.size() >= N) throw std::length_error("paramset::Schema capacity exceeded.");
+		for (std::size_t i = 0; i < str.size(); i++) buf_[len_++] = str[i];
+		buf_[len_] = '\0';
+	}
+
+	char buf_[N];
+	std::size_t len_;
+};
+
+namespace detail {
+template <class T> struct is_optional : std::false_type {};
+template <class T> struct is_optional<std::optional<T> > : std::true_type {};
+template <class T> struct dependent_false : std::false_type {};
+}
+
+class ValueRange;
+
+/**
+ * Move-only owner of the #PARAM_SET. Names given to the methods are the same
+ * as for the C functions, e.g. <tt>"i,input"</tt> can be used where multiple
+ * names are accepted.
+ */
+class ParamSet {
+public:
+	/** Creates the set with #PARAM_SET_new. */
+	explicit ParamSet(const char *names) : set_(nullptr) {
+		check(PARAM_SET_new(names, &set_));
+	}
+
+	/** Creates the set with #PARAM_SET_newFromSpec. */
+	explicit ParamSet(const PARAM_SET_SPEC &spec) : set_(nullptr) {
+		check(PARAM_SET_newFromSpec(&spec, &set_));
+	}
+
+	/** Takes the ownership of an existing #PARAM_SET. */
+	static ParamSet adopt(PARAM_SET *set) noexcept {
+		return ParamSet(set);
+	}
+
+	ParamSet(const ParamSet &) = delete;
+	ParamSet &operator=(const ParamSet &) = delete;
+
+	ParamSet(ParamSet &&other) noexcept : set_(std::exchange(other.set_, nullptr)) {}
+
+	ParamSet &operator=(ParamSet &&other) noexcept {
+		if (this != &other) {
+			PARAM_SET_free(set_);
+			set_ = std::exchange(other.set_, nullptr);
+		}
+		return *this;
+	}
+
+	~ParamSet() { PARAM_SET_free(set_); }
+
+	/** Returns the #PARAM_SET for the C API. */
+	PARAM_SET *get() const noexcept { return set_; }
+
+	/** Releases the ownership of the #PARAM_SET. */
+	PARAM_SET *release() noexcept { return std::exchange(set_, nullptr); }
+
+	explicit operator bool() const noexcept { return set_ != nullptr; }
+
+	/** See #PARAM_SET_add. */
+	void add(const char *name, const char *value, const char *source = nullptr, int priority = PST_PRIORITY_VALID_BASE) {
+		check(PARAM_SET_add(set_, name, value, source, priority));
+	}
+
+	/** See #PARAM_SET_parseCMD. */
+	void parseCmd(int argc, char **argv, const char *source = nullptr, int priority = PST_PRIORITY_VALID_BASE) {
+		check(PARAM_SET_parseCMD(set_, argc, argv, source, priority));
+	}
+
+	/** See #PARAM_SET_readFromFile. */
+	void readFromFile(const char *fname, const char *source = nullptr, int priority = PST_PRIORITY_VALID_BASE) {
+		check(PARAM_SET_readFromFile(set_, fname, source, priority));
+	}
+
+	/** See #PARAM_SET_isSetByName. */
+	bool isSet(const char *names) const noexcept {
+		return PARAM_SET_isSetByName(set_, names) != 0;
+	}
+
+	/** See #PARAM_SET_getValueCount. */
+	int count(const char *names, const char *source = nullptr, int priority = PST_PRIORITY_NONE) const {
+		int count = 0;
+		check(PARAM_SET_getValueCount(set_, names, source, priority, &count));
+		return count;
+	}
+
+	/**
+	 * Returns the view of the value stored in the set, or \c std::nullopt if
+	 * there is no value with the given constraints. A parameter without
+	 * a value (e.g. a flag) gives an empty view. By default the last value with
+	 * the highest priority is returned. Use #PST_PRIORITY_NONE to index over
+	 * all the values (see #PARAM_SET_getStr).
+	 */
+	std::optional<std::string_view> find(const char *name, int at = PST_INDEX_LAST,
+			const char *source = nullptr, int priority = PST_PRIORITY_HIGHEST) const {
+		char *value = nullptr;
+		int res = PARAM_SET_getStr(set_, name, source, priority, at, &value);
+
+		if (res == PST_PARAMETER_EMPTY || res == PST_PARAMETER_VALUE_NOT_FOUND) return std::nullopt;
+		check(res);
+
+		return value != nullptr ? std::string_view(value) : std::string_view();
+	}
+
+	/** Same as #find, but throws #paramset::Error if the value is missing. */
+	std::string_view str(const char *name, int at = PST_INDEX_LAST,
+			const char *source = nullptr, int priority = PST_PRIORITY_HIGHEST) const {
+		char *value = nullptr;
+		check(PARAM_SET_getStr(set_, name, source, priority, at, &value));
+		return value != nullptr ? std::string_view(value) : std::string_view();
+	}
+
+	/**
+	 * Returns the value converted to \c T, the conversion is selected at compile time:
+	 *  + \c bool - if the parameter is set (#PARAM_SET_isSetByName).
+	 *  + \c std::string_view - view to the stored value.
+	 *  + \c std::string - copy of the value.
+	 *  + integer and floating point types - parsed from the value, \c std::invalid_argument
+	 *    is thrown if the whole value is not a number.
+	 *  + pointer types - object from #PARAM_SET_getObj.
+	 *  + \c std::optional<U> - same as \c U, but \c std::nullopt if the value is missing.
+	 */
+	template <class T>
+	T get(const char *name, int at = PST_INDEX_LAST,
+			const char *source = nullptr, int priority = PST_PRIORITY_HIGHEST) const {
+		if constexpr (detail::is_optional<T>::value) {
+			using U = typename T::value_type;
+
+			if constexpr (std::is_same<U, bool>::value) {
+				return T(isSet(name));
+			} else if constexpr (std::is_pointer<U>::value) {
+				void *obj = nullptr;
+				int res = PARAM_SET_getObj(set_, name, source, priority, at, &obj);
+
+				if (res == PST_PARAMETER_EMPTY || res == PST_PARAMETER_VALUE_NOT_FOUND) return std::nullopt;
+				check(res);
+				return T(static_cast<U>(obj));
+			} else {
+				std::optional<std::string_view> value = find(name, at, source, priority);
+
+				if (!value) return std::nullopt;
+				return T(convert<U>(*value));
+			}
+		} else if constexpr (std::is_same<T, bool>::value) {
+			return isSet(name);
+		} else if constexpr (std::is_pointer<T>::value) {
+			void *obj = nullptr;
+			check(PARAM_SET_getObj(set_, name, source, priority, at, &obj));
+			return static_cast<T>(obj);
+		} else {
+			return convert<T>(str(name, at, source, priority));
+		}
+	}
+
+	/**
+	 * Returns a range over the values with the given constraints, to be used
+	 * in range-based \c for loop. Elements are \c std::string_view.
+	 */
+	ValueRange values(const char *names, const char *source = nullptr, int priority = PST_PRIORITY_NONE) const;
+
+private:
+	explicit ParamSet(PARAM_SET *set) noexcept : set_(set) {}
+
+	template <class T>
+	static T convert(std::string_view value) {
+		if constexpr (std::is_same<T, std::string_view>::value) {
+			return value;
+		} else if constexpr (std::is_same<T, std::string>::value) {
+			return std::string(value);
+		} else if constexpr (std::is_integral<T>::value) {
+			T out = 0;
+			const char *end = value.data() + value.size();
+			std::from_chars_result res = std::from_chars(value.data(), end, out);
+
+			if (res.ec == std::errc::result_out_of_range) throw std::out_of_range("paramset: value is out of range.");
+			if (res.ec != std::errc() || res.ptr != end) throw std::invalid_argument("paramset: value is not an integer.");
+			return out;
+		} else if constexpr (std::is_floating_point<T>::value) {
+			/* Stored values are NUL terminated, strtod is used as from_chars for floating point is not available everywhere. */
+			std::string tmp(value);
+			char *end = nullptr;
+			long double out = std::strtold(tmp.c_str(), &end);
+
+			if (tmp.empty() || end != tmp.c_str() + tmp.size()) throw std::invalid_argument("paramset: value is not a number.");
+			return static_cast<T>(out);
+		} else {
+			static_assert(detail::dependent_false<T>::value, "paramset::ParamSet::get: unsupported type.");
+		}
+	}
+
+	PARAM_SET *set_;
+};
+
+/**
+ * Range over the values of the parameters (see #paramset::ParamSet::values).
+ */
+class ValueRange {
+public:
+	class iterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = std::string_view;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const std::string_view *;
+		using reference = std::string_view;
+
+		iterator(const ValueRange *range, int at) : range_(range), at_(at) {}
+
+		std::string_view operator*() const {
+			char *value = nullptr;
+			check(PARAM_SET_getStr(range_->set_, range_->names_, range_->source_, range_->priority_, at_, &value));
+			return value != nullptr ? std::string_view(value) : std::string_view();
+		}
+
+		iterator &operator++() { at_++; return *this; }
+		iterator operator++(int) { iterator tmp(*this); at_++; return tmp; }
+
+		bool operator==(const iterator &other) const { return at_ == other.at_; }
+		bool operator!=(const iterator &other) const { return at_ != other.at_; }
+
+	private:
+		const ValueRange *range_;
+		int at_;
+	};
+
+	ValueRange(PARAM_SET *set, const char *names, const char *source, int priority)
+		: set_(set), names_(names), source_(source), priority_(priority), count_(0) {
+		check(PARAM_SET_getValueCount(set_, names_, source_, priority_, &count_));
+	}
+
+	iterator begin() const { return iterator(this, 0); }
+	iterator end() const { return iterator(this, count_); }
+
+	/** Count of values in the range. */
+	std::size_t size() const noexcept { return static_cast<std::size_t>(count_); }
+	bool empty() const noexcept { return count_ == 0; }
+
+private:
+	PARAM_SET *set_;
+	const char *names_;
+	const char *source_;
+	int priority_;
+	int count_;
+};
+
+inline ValueRange ParamSet::values(const char *names, const char *source, int priority) const {
+	return ValueRange(set_, names, source, priority);
+}
+
+} /* namespace paramset */
+
+#endif	/* PARAM_SET_HPP */
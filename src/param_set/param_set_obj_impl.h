@@ -31,6 +31,12 @@ extern "C" {
 /** Maximum task count. */
 #define TASK_DEFINITION_MAX_COUNT 64
 
+/** The size of the buffer given to the custom print name functions. */
+#define PARAM_PRINT_NAME_BUF_LEN 256
+
+/* Maximum count of unknown names remembered by the set. */
+#define PARAM_SET_TYPO_MEMO_SIZE 256
+
 /**
  * Parameter value data structure that contains the data and information about its
  * status, priority and source. Data is hold as a linked list of values.
@@ -42,6 +48,9 @@ struct PARAM_VAL_st{
 	int priority;				/* Priority level constraint. */
 	int formatStatus;			/* Format status. */
 	int contentStatus;			/* Content status. */
+	int isPending;				/* Format and content check is deferred (see PST_CONTROL_LAZY). */
+	int isBorrowed;				/* Value and source are not owned (e.g. mapped from a snapshot). */
+	size_t *refCount;			/* Count of values sharing value and source or NULL if not shared. */
 
 	PARAM_VAL *previous;		/* Link to the previous value. */
 	PARAM_VAL *next;			/* Link to the next value. */
@@ -53,19 +62,93 @@ struct PARAM_VAL_st{
  * linked list of values.
  */
 
+/**
+ * Parameter data that most parameters do not use. It is allocated on demand,
+ * when a help text, a custom print name or a wildcard expander is set.
+ */
+struct PARAM_COLD_st {
+	char *helpArg;				/* Parameters argument description. */
+	char *helpText;				/* The help text for a parameter. */
+	PST_HELP_TEXT *helpTokens;	/* Tokenized help text or NULL. */
+	char *helpRow;				/* Cached help row or NULL (see PARAM_helpToSink). */
+	size_t helpRowLen;			/* Length of helpRow. */
+	int helpRowIndent;			/* Indentation, header and row width of helpRow. */
+	int helpRowHeader;
+	int helpRowWidth;
+	char *print_name;			/* Constant print name or NULL for the default. */
+	char *print_name_alias;		/* Constant print name of the alias or NULL for the default. */
+
+	/**
+	 * Function \c getPrintName is used to return string representation of the
+	 * parameter. If set, the buffer print_name_buf of size #PARAM_PRINT_NAME_BUF_LEN
+	 * is given to the function. It is not meant to be used directly.
+	 */
+	const char* (*getPrintName)(PARAM *param, char *buf, unsigned buf_len);
+	const char* (*getPrintNameAlias)(PARAM *param, char *buf, unsigned buf_len);
+	char *print_name_buf;
+	char *print_name_alias_buf;
+
+	/**
+	 * A function to expand tokens that contain wildcard character (WC) to array of
+	 * new values. Characters '?' and '*' are WC. The first argument is the param_value
+	 * that contains the WC. Argument ctx is for additional data structure used and
+	 * value_shift is a return parameter that must contain how many values were extracted.
+	 *
+	 * expand_wildcard function must not remove param_value from the linked list
+	 * as it is done by higher level functions. New values must be appended right
+	 * after the param_value.
+	 *
+	 * Function must return PST_OK
+	 *
+	 * The function can be activated by manual call to PARAM_expandWildcard or by
+	 * setting PST_PRSCMD_EXPAND_WILDCARD for the parameter and calling
+	 * PARAM_SET_parseCMD.
+	 */
+	int (*expand_wildcard)(PARAM_VAL *param_value, void *ctx, int *value_shift);
+
+	/**
+	 * Additional context for expand_wildcard.
+	 */
+	void *expand_wildcard_ctx;
+
+	/**
+	 * List of characters the is used to identify the string that needs wildcard
+	 * processor to convert it.
+	 */
+	const char *expand_wildcard_char;
+
+	/**
+	 * An optional expaned wildcard ctx object.
+	 */
+	void (*expand_wildcard_free)(void *);
+};
+
+/**
+ * The fields used by the name lookup and when values are added come first, so
+ * that on 64-bit targets they fit into a single cache line. The name is stored
+ * right after its default print name prefix ("--"), see #PARAM_new.
+ */
 struct PARAM_st{
 	char *flagName;					/* The name of the parameter. */
 	char *flagAlias;				/* The alias for the parameter. */
-	char *helpArg;				/* Parameters argument description. */
-	char *helpText;				/* The help text for a parameter. */
+	PARAM_VAL *arg;		/* Linked list of parameter values. */
+	PARAM_VAL *last_element;	/* The last value in list. */
+	unsigned nameHash;				/* Hash of flagName (see PARAM_nameHash). */
+	unsigned aliasHash;				/* Hash of flagAlias or 0. */
 	int constraints;			/* Constraint If there is more than 1 parameter allowed. For validity check. */
-	int highestPriority;			/* Highest priority of inserted values. */
 	int parsing_options;			/* Some options used when parsing variables. */
+	int control_options;			/* Options that affect when value controls are applied. */
 	int argCount;					/* Count of all arguments in chain. */
+	int pendingCount;				/* Count of values with deferred format and content check. */
+	int highestPriority;			/* Highest priority of inserted values. */
+	unsigned long changed;			/* Value of the change counter when the values last changed. */
+	unsigned long *changeCount;		/* Change counter of the set or NULL (see PARAM_setChangeCounter). */
+	int isMarked;					/* Values are replayed to the parameter (see PARAM_SET_reloadFromFile). */
 
-	PARAM_VAL *last_element;	/* The last value in list. */
-	PARAM_VAL *arg;		/* Linked list of parameter values. */
 	ITERATOR *itr;
+	PARAM_SET_STATS *stats;			/* Counters of the set the parameter belongs to or NULL. */
+	CACHE *control_cache;			/* Optional cache for format and content check results. */
+	PARAM_COLD *cold;				/* Rarely used data or NULL. */
 
 	/**
 	 * A function to extract object from the parameter.
@@ -88,6 +171,17 @@ struct PARAM_st{
 	 */
 	int (*convert)(const char *str, char *buf, unsigned buf_len);
 
+	/**
+	 * Function convertSized has the same purpose as convert but is able to report
+	 * the size of the result, so the library can allocate the storage for the value.
+	 * str - c-string value that belongs to PARAM_VAL object.
+	 * buf - NULL to get the size or storage of size *buf_len to write the value to.
+	 * buf_len - size of the value including terminating '\0'.
+	 * Returns #PST_OK if successful, #PST_PARAM_CONVERT_NOT_PERFORMED to use str
+	 * as it is and error code otherwise. If set, convert is not used.
+	 */
+	int (*convertSized)(const char *str, char *buf, size_t *buf_len);
+
 	/**
 	 * Function \c controlFormat takes input as raw parameter and performs format
 	 * check.
@@ -103,54 +197,6 @@ struct PARAM_st{
 	 * Returns 0 if content ok, error code otherwise.
 	 */
 	int (*controlContent)(const char *str);
-
-	/**
-	 * This buffer and its size is fed to the abstract function getPrintName.
-	 * It is not meant to be used directly.
-	 */
-	char print_name_buf[256];
-	char print_name_alias_buf[256];
-
-	/**
-	 * Function \c getPrintName is used to return string representation of the
-	 * parameter.
-	 */
-	const char* (*getPrintName)(PARAM *param, char *buf, unsigned buf_len);
-	const char* (*getPrintNameAlias)(PARAM *param, char *buf, unsigned buf_len);
-
-	/**
-	 * A function to expand tokens that contain wildcard character (WC) to array of
-	 * new values. Characters '?' and '*' are WC. The first argument is the param_value
-	 * that contains the WC. Argument ctx is for additional data structure used and
-	 * value_shift is a return parameter that must contain how many values were extracted.
-	 *
-	 * expand_wildcard function must not remove param_value from the linked list
-	 * as it is done by higher level functions. New values must be appended right
-	 * after the param_value.
-	 *
-	 * Function must return PST_OK
-	 *
-	 * The function can be activated by manual call to PARAM_expandWildcard or by
-	 * setting PST_PRSCMD_EXPAND_WILDCARD for the parameter and calling
-	 * PARAM_SET_parseCMD.
-	 */
-	int (*expand_wildcard)(PARAM_VAL *param_value, void *ctx, int *value_shift);
-
-	/**
-	 * Additional context for expand_wildcard.
-	 */
-	void *expand_wildcard_ctx;
-
-	/**
-	 * List of characters the is used to identify the string that needs wildcard
-	 * processor to convert it.
-	 */
-	const char *expand_wildcard_char;
-
-	/**
-	 * An optional expaned wildcard ctx object.
-	 */
-	void (*expand_wildcard_free)(void *);
 };
 
 
@@ -165,9 +211,95 @@ struct PARAM_SET_st {
 
 	/* List of parameters. */
 	PARAM **parameter;
-	PARAM *typos;
-	PARAM *unknown;
-	PARAM *syntax;
+
+	/* Typos, unknown parameters and syntax errors. */
+	DIAG_LIST *diag;
+
+	/* Loaded snapshots referenced by the values. */
+	SNAPSHOT *snapshot;
+
+	/* Cache used to read configuration files, not owned. */
+	PST_FILE_CACHE *fileCache;
+
+	/* Files reloaded by PARAM_SET_processWatches. */
+	WATCH *watch;
+
+	/* Tokens of the files as they were last reloaded, see PARAM_SET_reloadFromFile. */
+	PARAM_SET_LOADED *loaded;
+
+	/* Specification the set is created from, used to look up the parameters. */
+	const PARAM_SET_SPEC *spec;
+
+	/* Name lookup tables built when the set is created. */
+	PARAM_SET_LOOKUP *lookup;
+
+	/* Memo of unknown names and their typo candidates or NULL, see param_set_add_unknown. */
+	CACHE *typoMemo;
+
+	/* Scratch area of the typo analysis or NULL, see param_set_typo_scratch. */
+	struct TYPO_st *typoList;
+	char *editColumns;
+
+	/* Incremented when values of a parameter are added or removed. Shared with the parameters. */
+	unsigned long changeCount;
+
+	/* Value of changeCount when the visible values of all parameters changed (see PARAM_SET_pushLayer). */
+	unsigned long allChanged;
+
+	/* Counters, NULL if PST_DISABLE_STATS is defined. Shared with the parameters. */
+	PARAM_SET_STATS *stats;
+
+	/* Trace callback and its context, see PARAM_SET_setTraceCallback. */
+	void (*trace)(void *ctx, int phase, int isEnd, double timestamp);
+	void *traceCtx;
+
+	/* Sets whose values are visible through the getters, see PARAM_SET_pushLayer. */
+	PARAM_SET_LAYER *layer;
+	PARAM_SET_LAYER *lastLayer;
+};
+
+/**
+ * A name or alias in the length bucketed table of #PARAM_SET_LOOKUP.
+ */
+typedef struct PARAM_SET_NAME_st {
+	unsigned hash;				/* Hash of the name (see PARAM_nameHash). */
+	const char *name;
+	PARAM *param;
+} PARAM_SET_NAME;
+
+/**
+ * Name lookup tables of the set. Parameters with a single character name or
+ * alias are found directly by the character. Longer names are grouped by the
+ * length, unless the set is created from a specification that has its own hash
+ * table. If a name is used more than once, the first parameter is found.
+ */
+struct PARAM_SET_LOOKUP_st {
+	PARAM *shortName[256];		/* Parameters by single character name or alias. */
+	size_t maxLen;				/* Length of the longest name in the table. */
+	size_t *bucket;				/* Names of length n are name[bucket[n]] ... name[bucket[n + 1] - 1]. */
+	PARAM_SET_NAME *name;		/* Names and aliases longer than one character. */
+};
+
+/**
+ * A set pushed on top of another set with #PARAM_SET_pushLayer. The set is not
+ * owned by the layer.
+ */
+struct PARAM_SET_LAYER_st {
+	PARAM_SET *set;
+	int offset;
+	PARAM_SET_LAYER *next;
+};
+
+/**
+ * Tokens of a file reloaded with #PARAM_SET_reloadFromFile. The next reload of
+ * the same file, source and priority is compared with them.
+ */
+struct PARAM_SET_LOADED_st {
+	char *fname;
+	char *source;
+	int priority;
+	FILE_TOKENS *tokens;
+	PARAM_SET_LOADED *next;
 };
 
 struct TASK_st{
@@ -189,8 +321,21 @@ struct TASK_DEFINITION_st{
 	int isConsistent;
 	int isAnalyzed;
 	double consistency;
+
+	/* The set and its change counter the consistency is calculated for. */
+	PARAM_SET *analyzedSet;
+	unsigned long analyzedVersion;
 };
 
+/**
+ * A parameter referenced by the task definition \c task of #TASK_SET. The
+ * references of the same parameter are kept together.
+ */
+typedef struct TASK_SET_REF_st {
+	PARAM *param;
+	size_t task;
+} TASK_SET_REF;
+
 struct TASK_SET_st {
 	TASK_DEFINITION *array[TASK_DEFINITION_MAX_COUNT];
 	size_t count;
@@ -203,6 +348,14 @@ struct TASK_SET_st {
 	size_t index[TASK_DEFINITION_MAX_COUNT];
 
 	int isAnalyzed;
+
+	/* Change counter of set_used and sensitivity of the last analysis. */
+	unsigned long version;
+	double sensitivity;
+
+	/* Parameters referenced by the tasks or NULL before the first analysis. */
+	TASK_SET_REF *ref;
+	size_t refCount;
 };
 
 struct ITERATOR_st {
@@ -211,6 +364,7 @@ struct ITERATOR_st {
 	const char *source;
 	int priority;
 	int i;
+	PARAM_SET_STATS *stats;
 };
 
 #ifdef	__cplusplus
@@ -71,7 +71,7 @@ cleanup:
 	return res;
 }
 
-int PARAM_VAL_new(const char *value, const char* source, int priority, PARAM_VAL **newObj) {
+static int param_val_new(const char *value, char *owned_value, const char* source, int priority, PARAM_VAL **newObj) {
 	int res;
 	PARAM_VAL *tmp = NULL;
 	char *tmp_value = NULL;
@@ -103,11 +103,14 @@ int PARAM_VAL_new(const char *value, const char* source, int priority, PARAM_VAL
 	tmp->source = NULL;
 	tmp->formatStatus= PST_FORMAT_STATUS_OK;
 	tmp->contentStatus = PST_CONTENT_STATUS_OK;
+	tmp->isPending = 0;
+	tmp->isBorrowed = 0;
+	tmp->refCount = NULL;
 	tmp->next = NULL;
 	tmp->previous = NULL;
 	tmp->priority = priority;
 
-	if (value != NULL){
+	if (owned_value == NULL && value != NULL){
 		tmp_value = new_string(value);
 		if (tmp_value == NULL) {
 			res = PST_OUT_OF_MEMORY;
@@ -123,9 +126,6 @@ int PARAM_VAL_new(const char *value, const char* source, int priority, PARAM_VAL
 		}
 	}
 
-	tmp->cstr_value = tmp_value;
-	tmp->source = tmp_source;
-
 	/**
 	 * If receiving pointer is NULL, initialize it. If receiving pointer is not
 	 * NULL iterate through linked list and append the value to the end.
@@ -140,6 +140,10 @@ int PARAM_VAL_new(const char *value, const char* source, int priority, PARAM_VAL
 		if (res != PST_OK) goto cleanup;
 	}
 
+	/* Value is owned by the object only if everything else succeeded. */
+	tmp->cstr_value = (owned_value != NULL) ? owned_value : tmp_value;
+	tmp->source = tmp_source;
+
 	tmp = NULL;
 	tmp_value = NULL;
 	tmp_source = NULL;
@@ -154,6 +158,66 @@ cleanup:
 	return res;
 }
 
+int PARAM_VAL_new(const char *value, const char* source, int priority, PARAM_VAL **newObj) {
+	return param_val_new(value, NULL, source, priority, newObj);
+}
+
+int PARAM_VAL_newOwned(char *value, const char* source, int priority, PARAM_VAL **newObj) {
+	if (value == NULL) return PST_INVALID_ARGUMENT;
+	return param_val_new(NULL, value, source, priority, newObj);
+}
+
+int PARAM_VAL_newBorrowed(const char *value, const char* source, int priority, PARAM_VAL **newObj) {
+	int res;
+	PARAM_VAL *tmp = NULL;
+
+	if (newObj == NULL) return PST_INVALID_ARGUMENT;
+
+	res = param_val_new(NULL, NULL, NULL, priority, &tmp);
+	if (res != PST_OK) return res;
+
+	tmp->cstr_value = (char*)value;
+	tmp->source = (char*)source;
+	tmp->isBorrowed = 1;
+	*newObj = tmp;
+
+	return PST_OK;
+}
+
+int PARAM_VAL_newShared(PARAM_VAL *value, PARAM_VAL **newObj) {
+	int res;
+	PARAM_VAL *tmp = NULL;
+
+	if (value == NULL || newObj == NULL) return PST_INVALID_ARGUMENT;
+
+	/* Borrowed strings may not outlive the original value, so those are copied. */
+	if (value->isBorrowed) {
+		res = param_val_new(value->cstr_value, NULL, value->source, value->priority, &tmp);
+		if (res != PST_OK) return res;
+	} else {
+		if (value->refCount == NULL) {
+			value->refCount = (size_t*)malloc(sizeof(size_t));
+			if (value->refCount == NULL) return PST_OUT_OF_MEMORY;
+			*value->refCount = 1;
+		}
+
+		res = param_val_new(NULL, NULL, NULL, value->priority, &tmp);
+		if (res != PST_OK) return res;
+
+		tmp->cstr_value = value->cstr_value;
+		tmp->source = value->source;
+		tmp->refCount = value->refCount;
+		(*value->refCount)++;
+	}
+
+	tmp->formatStatus = value->formatStatus;
+	tmp->contentStatus = value->contentStatus;
+	tmp->isPending = value->isPending;
+	*newObj = tmp;
+
+	return PST_OK;
+}
+
 void PARAM_VAL_free(PARAM_VAL *rootValue) {
 	PARAM_VAL *next = NULL;
 	PARAM_VAL *to_be_freed = NULL;
@@ -165,8 +229,13 @@ void PARAM_VAL_free(PARAM_VAL *rootValue) {
 	do {
 		to_be_freed = next;
 		next = next->next;
-		free(to_be_freed->cstr_value);
-		free(to_be_freed->source);
+		if (to_be_freed->refCount != NULL && --(*to_be_freed->refCount) > 0) {
+			/* The strings are still used by other values. */
+		} else if (!to_be_freed->isBorrowed) {
+			free(to_be_freed->cstr_value);
+			free(to_be_freed->source);
+			free(to_be_freed->refCount);
+		}
 		free(to_be_freed);
 	} while (next != NULL);
 
@@ -379,6 +448,10 @@ cleanup:
 	return res;
 }
 
+int PARAM_VAL_isPriorityMatch(int prio, int current) {
+	return prio_compare_if_match(prio, current);
+}
+
 int PARAM_VAL_getElementCount(PARAM_VAL *rootValue, const char *source, int prio, int *count) {
 	return param_val_get_element_count(rootValue, source, prio, PARAM_VAL_getElement, count);
 }
@@ -576,6 +649,7 @@ int ITERATOR_new(PARAM_VAL *root, ITERATOR **itr) {
 	tmp->i = 0;
 	tmp->source = NULL;
 	tmp->priority = PST_PRIORITY_NONE;
+	tmp->stats = NULL;
 
 	*itr = tmp;
 	tmp = NULL;
@@ -593,6 +667,8 @@ static int ITERATOR_canBeUsedToFetch(ITERATOR *itr, const char* source, int prio
 	if (source != NULL && strcmp(source, itr->source) != 0) return 0;
 	if (itr->priority != priority) return 0;
 	if (at < itr->i) return 0;
+	/* The last value has no position to continue from. */
+	if (itr->i == PST_INDEX_LAST && at != PST_INDEX_LAST) return 0;
 	return 1;
 }
 
@@ -609,6 +685,7 @@ int ITERATOR_fetch(ITERATOR *itr, const char* source, int priority, int at, PARA
 
 	/* If iterator is not suitable, reset its "pointer". */
 	if (!ITERATOR_canBeUsedToFetch(itr, source, priority, at)) {
+		PST_STATS_ADD(itr->stats, iteratorResets, 1);
 		res = ITERATOR_set(itr, NULL, source, priority, at);
 		if (res != PST_OK) goto cleanup;
 	}
@@ -171,6 +171,15 @@ int PARAM_VAL_extract(PARAM_VAL *rootValue, const char **value, const char **sou
  */
 int PARAM_VAL_getElementCount(PARAM_VAL *rootValue, const char *source, int prio, int *count);
 
+/**
+ * Checks if the priority of a value matches the priority constraint.
+ * \param	prio		Priority constraint that is a real priority or based on
+ *						#PST_PRIORITY_HIGHER_THAN or #PST_PRIORITY_LOWER_THAN.
+ * \param	current		Priority of the value.
+ * \return 1 if the priority matches, 0 otherwise.
+ */
+int PARAM_VAL_isPriorityMatch(int prio, int current);
+
 /**
  * Counts the invalid values with given constraints. If there are no values matching the
  * constraints, <tt>0</tt> is returned.
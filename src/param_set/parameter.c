@@ -31,6 +31,11 @@
 #define VARIABLE_IS_NOT_USED(v) ((void)(v));
 #define WILDCAR_EXPANDER_DEF_CHAR "*?"
 
+/* Maximum count of cached format and content check results (see PST_CONTROL_CACHE). */
+#ifndef PARAM_CONTROL_CACHE_SIZE
+#	define PARAM_CONTROL_CACHE_SIZE 256
+#endif
+
 static char *new_string(const char *str) {
 	char *tmp = NULL;
 	if (str == NULL) return NULL;
@@ -46,6 +51,76 @@ static int param_constraint_isFlagSet(const PARAM *obj, int state) {
 	return 0;
 }
 
+void PARAM_runControl(const PARAM *param, const char *value, int *formatStatus, int *contentStatus) {
+	int format = FORMAT_OK;
+	int content = 0;
+
+	if (param == NULL || formatStatus == NULL || contentStatus == NULL) return;
+
+	if (param->controlFormat)
+		format = param->controlFormat(value);
+	if (format == FORMAT_OK && param->controlContent)
+		content = param->controlContent(value);
+
+	*formatStatus = format;
+	*contentStatus = content;
+}
+
+int PARAM_lookupControlResult(PARAM *param, const char *value, int *formatStatus, int *contentStatus) {
+	int status[2];
+
+	if (param == NULL || param->control_cache == NULL || formatStatus == NULL || contentStatus == NULL) return 0;
+	if (!CACHE_get(param->control_cache, value, status)) return 0;
+
+	*formatStatus = status[0];
+	*contentStatus = status[1];
+	return 1;
+}
+
+void PARAM_storeControlResult(PARAM *param, PARAM_VAL *value, int formatStatus, int contentStatus) {
+	int status[2];
+
+	if (param == NULL || value == NULL || !value->isPending) return;
+
+	value->isPending = 0;
+	value->formatStatus = formatStatus;
+	value->contentStatus = contentStatus;
+	param->pendingCount--;
+
+	/* Failing to cache the result is not an error. */
+	if (param->control_cache != NULL) {
+		status[0] = formatStatus;
+		status[1] = contentStatus;
+		CACHE_put(param->control_cache, value->cstr_value, status);
+	}
+}
+
+static void param_value_control(PARAM *param, PARAM_VAL *value) {
+	int formatStatus = 0;
+	int contentStatus = 0;
+
+	if (param == NULL || value == NULL || !value->isPending) return;
+
+	if (!PARAM_lookupControlResult(param, value->cstr_value, &formatStatus, &contentStatus)) {
+		PARAM_runControl(param, value->cstr_value, &formatStatus, &contentStatus);
+		PST_STATS_ADD(param->stats, validatorCalls, 1);
+	}
+
+	PARAM_storeControlResult(param, value, formatStatus, contentStatus);
+}
+
+static void param_control_pending_values(PARAM *param) {
+	PARAM_VAL *value = NULL;
+
+	if (param == NULL || param->pendingCount == 0) return;
+
+	value = param->arg;
+	while (value != NULL && param->pendingCount > 0) {
+		param_value_control(param, value);
+		value = value->next;
+	}
+}
+
 static int param_get_value(PARAM *param, const char *source, int prio, int at,
 		int (*value_getter)(PARAM_VAL *, const char*, int, int, PARAM_VAL**),
 		PARAM_VAL **value) {
@@ -65,7 +140,13 @@ static int param_get_value(PARAM *param, const char *source, int prio, int at,
 	if (value_getter == NULL) {
 		res = ITERATOR_fetch(param->itr, source, prio, at, &tmp);
 		if (res != PST_OK) goto cleanup;
+
+		/* Value returned to the user must have its format and content checked. */
+		param_value_control(param, tmp);
 	} else {
+		/* Value getter may filter by status, so all pending values must be checked. */
+		param_control_pending_values(param);
+
 		res = value_getter(param->arg, source, prio, at, &tmp);
 		if (res != PST_OK) goto cleanup;
 	}
@@ -112,25 +193,112 @@ static int wrapper_returnStr(void **extra, const char* str, void** obj){
 	return PST_OK;
 }
 
-static const char* wrapper_returnConstantPrintName(PARAM *param, char *buf, unsigned buf_len){
-	VARIABLE_IS_NOT_USED(buf);
-	VARIABLE_IS_NOT_USED(buf_len);
-	if (param == NULL) return NULL;
-	return param->print_name_buf;
+/**
+ * Allocates a copy of the name with the prefix "--" in front of it, so that the
+ * default print name ("-x" or "--name") shares the storage with the name. The
+ * returned pointer points to the name and must be freed with #param_name_free.
+ */
+static char* param_name_new(const char *name) {
+	size_t len = strlen(name);
+	char *tmp = NULL;
+
+	tmp = (char*)malloc(len + 3);
+	if (tmp == NULL) return NULL;
+
+	tmp[0] = '-';
+	tmp[1] = '-';
+	memcpy(tmp + 2, name, len + 1);
+
+	return tmp + 2;
+}
+
+static void param_name_free(char *name) {
+	if (name != NULL) free(name - 2);
 }
 
-static const char* wrapper_returnConstantPrintNameAlias(PARAM *param, char *buf, unsigned buf_len){
-	VARIABLE_IS_NOT_USED(buf);
-	VARIABLE_IS_NOT_USED(buf_len);
-	if (param == NULL) return NULL;
-	return param->print_name_alias_buf;
+static const char* param_name_default_print_name(const char *name) {
+	return (name[0] != '\0' && name[1] == '\0') ? name - 1 : name - 2;
+}
+
+unsigned PARAM_nameHash(const char *name) {
+	unsigned long hash = 2166136261UL;
+
+	if (name == NULL) return 0;
+
+	while (*name != '\0') {
+		hash ^= (unsigned char)*name++;
+		hash = (hash * 16777619UL) & 0xffffffffUL;
+	}
+
+	return (unsigned)hash;
+}
+
+/**
+ * Returns the cold data of the parameter. It is allocated when used for the
+ * first time. Returns NULL if out of memory.
+ */
+static PARAM_COLD* param_get_cold(PARAM *param) {
+	PARAM_COLD *tmp = NULL;
+
+	if (param->cold != NULL) return param->cold;
+
+	tmp = (PARAM_COLD*)malloc(sizeof(*tmp));
+	if (tmp == NULL) return NULL;
+
+	tmp->helpArg = NULL;
+	tmp->helpText = NULL;
+	tmp->helpTokens = NULL;
+	tmp->helpRow = NULL;
+	tmp->helpRowLen = 0;
+	tmp->helpRowIndent = 0;
+	tmp->helpRowHeader = 0;
+	tmp->helpRowWidth = 0;
+	tmp->print_name = NULL;
+	tmp->print_name_alias = NULL;
+	tmp->getPrintName = NULL;
+	tmp->getPrintNameAlias = NULL;
+	tmp->print_name_buf = NULL;
+	tmp->print_name_alias_buf = NULL;
+	tmp->expand_wildcard = NULL;
+	tmp->expand_wildcard_ctx = NULL;
+	tmp->expand_wildcard_char = WILDCAR_EXPANDER_DEF_CHAR;
+	tmp->expand_wildcard_free = NULL;
+
+	param->cold = tmp;
+	return tmp;
+}
+
+/**
+ * Drops the cached help row, as the help text or the print name has changed.
+ */
+static void param_help_row_clear(PARAM_COLD *cold) {
+	free(cold->helpRow);
+	cold->helpRow = NULL;
+	cold->helpRowLen = 0;
+}
+
+static void param_cold_free(PARAM_COLD *cold) {
+	if (cold == NULL) return;
+
+	free(cold->helpArg);
+	free(cold->helpText);
+	PST_HELP_TEXT_free(cold->helpTokens);
+	free(cold->helpRow);
+	free(cold->print_name);
+	free(cold->print_name_alias);
+	free(cold->print_name_buf);
+	free(cold->print_name_alias_buf);
+
+	if (cold->expand_wildcard_ctx != NULL && cold->expand_wildcard_free != NULL) {
+		cold->expand_wildcard_free(cold->expand_wildcard_ctx);
+	}
+
+	free(cold);
 }
 
 int PARAM_new(const char *flagName, const char *flagAlias, int constraints, int pars_opt, PARAM **newObj){
 	int res;
 	PARAM *tmp = NULL;
-	char *tmpFlagName = NULL;
-	char *tmpAlias = NULL;
 
 	if (flagName == NULL || newObj == NULL) {
 		res = PST_INVALID_ARGUMENT;
@@ -145,77 +313,62 @@ int PARAM_new(const char *flagName, const char *flagAlias, int constraints, int
 
 	tmp->flagName = NULL;
 	tmp->flagAlias = NULL;
-	tmp->helpArg = NULL;
-	tmp->helpText = NULL;
 	tmp->arg = NULL;
 	tmp->last_element = NULL;
-	tmp->itr = NULL;
-	tmp->highestPriority = 0;
+	tmp->nameHash = PARAM_nameHash(flagName);
+	tmp->aliasHash = PARAM_nameHash(flagAlias);
 	tmp->constraints = constraints;
 	tmp->parsing_options = pars_opt;
+	tmp->control_options = PST_CONTROL_DEFAULT;
 	tmp->argCount = 0;
+	tmp->pendingCount = 0;
+	tmp->highestPriority = 0;
+	tmp->changed = 0;
+	tmp->changeCount = NULL;
+	tmp->isMarked = 0;
+	tmp->itr = NULL;
+	tmp->stats = NULL;
+	tmp->control_cache = NULL;
+	tmp->cold = NULL;
 	tmp->controlFormat = NULL;
 	tmp->controlContent = NULL;
 	tmp->convert = NULL;
+	tmp->convertSized = NULL;
 	tmp->extractObject = wrapper_returnStr;
-	tmp->expand_wildcard = NULL;
-	tmp->expand_wildcard_ctx = NULL;
-	tmp->expand_wildcard_free = NULL;
-	tmp->expand_wildcard_char = WILDCAR_EXPANDER_DEF_CHAR;
-	tmp->getPrintName = wrapper_returnConstantPrintName;
-	tmp->getPrintNameAlias = wrapper_returnConstantPrintNameAlias;
-	tmp->print_name_buf[0] = '\0';
-	tmp->print_name_alias_buf[0] = '\0';
-	PST_snprintf(tmp->print_name_buf, sizeof(tmp->print_name_buf), "%s%s", (strlen(flagName) == 1 ? "-" : "--"), flagName);
-
 
-	tmpFlagName = new_string(flagName);
-	if (tmpFlagName == NULL) {
+	tmp->flagName = param_name_new(flagName);
+	if (tmp->flagName == NULL) {
 		res = PST_OUT_OF_MEMORY;
 		goto cleanup;
 	}
 
-
 	if (flagAlias) {
-		tmpAlias = new_string(flagAlias);
-		if (tmpAlias == NULL) {
+		tmp->flagAlias = param_name_new(flagAlias);
+		if (tmp->flagAlias == NULL) {
 			res = PST_OUT_OF_MEMORY;
 			goto cleanup;
 		}
-
-		PST_snprintf(tmp->print_name_alias_buf, sizeof(tmp->print_name_alias_buf), "%s%s", (strlen(flagAlias) == 1 ? "-" : "--"), flagAlias);
 	}
 
-	tmp->flagAlias = tmpAlias;
-	tmp->flagName = tmpFlagName;
 	*newObj = tmp;
-
-	tmpAlias = NULL;
-	tmpFlagName = NULL;
 	tmp = NULL;
 
 	res = PST_OK;
 
 cleanup:
 
-	free(tmpFlagName);
-	free(tmpAlias);
 	PARAM_free(tmp);
 	return res;
 }
 
 void PARAM_free(PARAM *param) {
 	if (param == NULL) return;
-	free(param->flagName);
-	free(param->flagAlias);
+	param_name_free(param->flagName);
+	param_name_free(param->flagAlias);
 	if (param->itr) ITERATOR_free(param->itr);
 	if (param->arg) PARAM_VAL_free(param->arg);
-	if (param->helpText != NULL) free(param->helpText);
-	if (param->helpArg != NULL) free(param->helpArg);
-
-	if (param->expand_wildcard_ctx != NULL && param->expand_wildcard_free != NULL) {
-		param->expand_wildcard_free(param->expand_wildcard_ctx);
-	}
+	CACHE_free(param->control_cache);
+	param_cold_free(param->cold);
 
 	free(param);
 }
@@ -229,9 +382,89 @@ int PARAM_addControl(PARAM *param,
 	param->controlFormat = controlFormat;
 	param->controlContent = controlContent;
 	param->convert = convert;
+
+	/* Cached results are not valid for the new control functions. */
+	CACHE_clear(param->control_cache);
+	return PST_OK;
+}
+
+int PARAM_setControlOptions(PARAM *param, int options) {
+	int res;
+
+	if (param == NULL) return PST_INVALID_ARGUMENT;
+
+	if ((options & PST_CONTROL_CACHE) && param->control_cache == NULL) {
+		res = CACHE_new(PARAM_CONTROL_CACHE_SIZE, 2 * sizeof(int), &param->control_cache);
+		if (res != PST_OK) return res;
+	} else if (!(options & PST_CONTROL_CACHE)) {
+		CACHE_free(param->control_cache);
+		param->control_cache = NULL;
+	}
+
+	param->control_options = options;
+
+	/* Values deferred so far are checked when lazy checking is turned off. */
+	if (!(options & PST_CONTROL_LAZY)) param_control_pending_values(param);
+
 	return PST_OK;
 }
 
+int PARAM_isControlOptionSet(PARAM *param, int option) {
+	if (param == NULL) return 0;
+	return (param->control_options & option) == option;
+}
+
+int PARAM_setConverter(PARAM *param, int (*convert)(const char*, char*, size_t*)) {
+	if (param == NULL) return PST_INVALID_ARGUMENT;
+
+	param->convertSized = convert;
+	return PST_OK;
+}
+
+static int param_convert_sized(PARAM *param, const char *value, char **converted) {
+	int res;
+	size_t len = 0;
+	size_t size = 0;
+	char *tmp = NULL;
+
+	/* Get the size first. */
+	res = param->convertSized(value, NULL, &len);
+	if (res != PST_OK) goto cleanup;
+
+	if (len == 0) {
+		res = PST_UNDEFINED_BEHAVIOUR;
+		goto cleanup;
+	}
+
+	size = len;
+	tmp = (char*)malloc(size);
+	if (tmp == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	res = param->convertSized(value, tmp, &len);
+	if (res != PST_OK) goto cleanup;
+
+	/* Do not trust the converter to stay within the size it asked for. */
+	if (len == 0 || len > size) {
+		res = PST_PARAMETER_INVALID_FORMAT;
+		goto cleanup;
+	}
+	tmp[len - 1] = '\0';
+
+	*converted = tmp;
+	tmp = NULL;
+
+	res = PST_OK;
+
+cleanup:
+
+	free(tmp);
+
+	return res;
+}
+
 static int is_flag_set(int field, int flag) {
 	if (((field & flag) == flag) ||
 			(field == PST_PRSCMD_NONE && flag == PST_PRSCMD_NONE)) return 1;
@@ -268,76 +501,296 @@ int PARAM_setObjectExtractor(PARAM *param, int (*extractObject)(void **, const c
 	return PST_OK;
 }
 
-int PARAM_setPrintName(PARAM *param, const char *constv, const char* (*getPrintName)(PARAM *param, char *buf, unsigned buf_len)) {
-	if (param == NULL || (getPrintName == NULL && constv == NULL)) return PST_INVALID_ARGUMENT;
-
+/**
+ * Sets the constant print name or the function to create one. The buffer given
+ * to the function is allocated here, so the getter does not have to fail.
+ */
+static int param_set_print_name(const char *constv, const char* (*getPrintName)(PARAM *param, char *buf, unsigned buf_len),
+		char **print_name, const char* (**cold_getPrintName)(PARAM *param, char *buf, unsigned buf_len), char **print_name_buf) {
+	char *tmp = NULL;
 
 	if (constv != NULL) {
-		param->getPrintName = wrapper_returnConstantPrintName;
-		PST_strncpy(param->print_name_buf, constv, sizeof(param->print_name_buf));
+		tmp = new_string(constv);
+		if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+		free(*print_name);
+		*print_name = tmp;
+		*cold_getPrintName = NULL;
 	} else {
-		param->getPrintName = getPrintName;
+		if (*print_name_buf == NULL) {
+			*print_name_buf = (char*)malloc(PARAM_PRINT_NAME_BUF_LEN);
+			if (*print_name_buf == NULL) return PST_OUT_OF_MEMORY;
+			(*print_name_buf)[0] = '\0';
+		}
+
+		*cold_getPrintName = getPrintName;
 	}
 
 	return PST_OK;
 }
 
+int PARAM_setPrintName(PARAM *param, const char *constv, const char* (*getPrintName)(PARAM *param, char *buf, unsigned buf_len)) {
+	PARAM_COLD *cold = NULL;
+
+	if (param == NULL || (getPrintName == NULL && constv == NULL)) return PST_INVALID_ARGUMENT;
+
+	cold = param_get_cold(param);
+	if (cold == NULL) return PST_OUT_OF_MEMORY;
+
+	param_help_row_clear(cold);
+	return param_set_print_name(constv, getPrintName, &cold->print_name, &cold->getPrintName, &cold->print_name_buf);
+}
+
 int PARAM_setPrintNameAlias(PARAM *param, const char *constv, const char* (*getPrintNameAlias)(PARAM *param, char *buf, unsigned buf_len)) {
+	PARAM_COLD *cold = NULL;
+
 	if (param == NULL || (getPrintNameAlias == NULL && constv == NULL)) return PST_INVALID_ARGUMENT;
 	if (param->flagAlias == NULL) return PST_ALIAS_NOT_SPECIFIED;
 
-	if (constv != NULL) {
-		param->getPrintNameAlias = wrapper_returnConstantPrintNameAlias;
-		PST_strncpy(param->print_name_alias_buf, constv, sizeof(param->print_name_alias_buf));
-	} else {
-		param->getPrintNameAlias = getPrintNameAlias;
-	}
+	cold = param_get_cold(param);
+	if (cold == NULL) return PST_OUT_OF_MEMORY;
 
-	return PST_OK;
+	param_help_row_clear(cold);
+	return param_set_print_name(constv, getPrintNameAlias, &cold->print_name_alias, &cold->getPrintNameAlias, &cold->print_name_alias_buf);
 }
 
 const char* PARAM_getPrintName(PARAM *obj) {
 	if (obj == NULL) return NULL;
-	return obj->getPrintName(obj, obj->print_name_buf, sizeof(obj->print_name_buf));
+	if (obj->cold != NULL) {
+		if (obj->cold->getPrintName != NULL) return obj->cold->getPrintName(obj, obj->cold->print_name_buf, PARAM_PRINT_NAME_BUF_LEN);
+		if (obj->cold->print_name != NULL) return obj->cold->print_name;
+	}
+	return param_name_default_print_name(obj->flagName);
 }
 
 const char* PARAM_getPrintNameAlias(PARAM *obj) {
 	if (obj == NULL || obj->flagAlias == NULL) return NULL;
-	return obj->getPrintNameAlias(obj, obj->print_name_alias_buf, sizeof(obj->print_name_alias_buf));
+	if (obj->cold != NULL) {
+		if (obj->cold->getPrintNameAlias != NULL) return obj->cold->getPrintNameAlias(obj, obj->cold->print_name_alias_buf, PARAM_PRINT_NAME_BUF_LEN);
+		if (obj->cold->print_name_alias != NULL) return obj->cold->print_name_alias;
+	}
+	return param_name_default_print_name(obj->flagAlias);
 }
 
 int PARAM_setHelpText(PARAM *param, const char *txt) {
+	int res;
+	PARAM_COLD *cold = NULL;
+	char *tmp = NULL;
+	PST_HELP_TEXT *tokens = NULL;
+
 	if (param == NULL || txt == NULL) return PST_INVALID_ARGUMENT;
-	if (param->helpText != NULL) free(param->helpText);
-	param->helpText = new_string(txt);
-	if (param->helpText == NULL) return PST_OUT_OF_MEMORY;
+
+	cold = param_get_cold(param);
+	if (cold == NULL) return PST_OUT_OF_MEMORY;
+
+	tmp = new_string(txt);
+	if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+	/* The help text is parsed once, not every time the help is rendered. */
+	res = PST_HELP_TEXT_new(txt, &tokens);
+	if (res != PST_OK) {
+		free(tmp);
+		return res;
+	}
+
+	free(cold->helpText);
+	PST_HELP_TEXT_free(cold->helpTokens);
+	cold->helpText = tmp;
+	cold->helpTokens = tokens;
+	param_help_row_clear(cold);
 	return PST_OK;
 }
 
 int PARAM_setHelpArg(PARAM *param, const char *arg) {
+	PARAM_COLD *cold = NULL;
+	char *tmp = NULL;
+
 	if (param == NULL || arg == NULL) return PST_INVALID_ARGUMENT;
-	if (param->helpArg != NULL) free(param->helpArg);
-	param->helpArg = new_string(arg);
-	if (param->helpArg == NULL) return PST_OUT_OF_MEMORY;
+
+	cold = param_get_cold(param);
+	if (cold == NULL) return PST_OUT_OF_MEMORY;
+
+	tmp = new_string(arg);
+	if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+	free(cold->helpArg);
+	cold->helpArg = tmp;
+	param_help_row_clear(cold);
 	return PST_OK;
 }
 
 const char* PARAM_getHelpText(PARAM *obj) {
-	if (obj == NULL) return NULL;
-	return obj->helpText;
+	if (obj == NULL || obj->cold == NULL) return NULL;
+	return obj->cold->helpText;
 }
 
 const char* PARAM_getHelpArg(PARAM *obj) {
-	if (obj == NULL) return NULL;
-	return obj->helpArg;
+	if (obj == NULL || obj->cold == NULL) return NULL;
+	return obj->cold->helpArg;
+}
+
+/**
+ * Growing buffer the help row is rendered into before it is cached.
+ */
+typedef struct HELP_ROW_st {
+	char *buf;
+	size_t len;
+	size_t size;
+} HELP_ROW;
+
+static int help_row_write(void *ctx, const char *data, size_t len) {
+	HELP_ROW *row = (HELP_ROW*)ctx;
+
+	if (row->len + len > row->size) {
+		size_t size = row->size == 0 ? 256 : row->size;
+		char *tmp = NULL;
+
+		while (size < row->len + len) size *= 2;
+		tmp = (char*)realloc(row->buf, size);
+		if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+		row->buf = tmp;
+		row->size = size;
+	}
+
+	memcpy(row->buf + row->len, data, len);
+	row->len += len;
+	return PST_OK;
+}
+
+static void param_help_row_render(PARAM *param, int indent, int header, int rowWidth, PST_SINK *sink) {
+	const char *name = NULL;
+	const char *alias = NULL;
+	const char *arg = NULL;
+	char param_name_combo[256];
+
+	name = PARAM_getPrintName(param);
+	alias = PARAM_getPrintNameAlias(param);
+	arg = PARAM_getHelpArg(param);
+
+	if (alias == NULL) {
+		PST_snprintf(param_name_combo, sizeof(param_name_combo), "%s%s%s", name, (arg ? " " : ""), (arg ? arg : ""));
+	} else {
+		PST_snprintf(param_name_combo, sizeof(param_name_combo), "%s, %s%s%s", name, alias, (arg ? " " : ""), (arg ? arg : ""));
+	}
+
+	if (param->cold != NULL && param->cold->helpTokens != NULL) {
+		PST_SINK_hiprintTokens(sink, indent, header, rowWidth, param_name_combo, '-', param->cold->helpTokens);
+	} else {
+		PST_SINK_hiprint(sink, indent, header, rowWidth, param_name_combo, '-', "(null)");
+	}
+	PST_SINK_printf(sink, "\n");
+}
+
+int PARAM_helpToSink(PARAM *param, int indent, int header, int rowWidth, PST_SINK *sink) {
+	PARAM_COLD *cold = NULL;
+	PST_SINK row_sink;
+	HELP_ROW row = {NULL, 0, 0};
+
+	if (param == NULL || sink == NULL) return PST_INVALID_ARGUMENT;
+
+	cold = param->cold;
+
+	/* The print name created by a function may change, so the row is not cached. */
+	if (cold == NULL || cold->helpTokens == NULL || cold->getPrintName != NULL || cold->getPrintNameAlias != NULL) {
+		param_help_row_render(param, indent, header, rowWidth, sink);
+		return sink->err;
+	}
+
+	if (cold->helpRow == NULL || cold->helpRowIndent != indent || cold->helpRowHeader != header || cold->helpRowWidth != rowWidth) {
+		PST_SINK_init(&row_sink, help_row_write, &row);
+		param_help_row_render(param, indent, header, rowWidth, &row_sink);
+		if (row_sink.err != PST_OK) {
+			free(row.buf);
+			return row_sink.err;
+		}
+
+		free(cold->helpRow);
+		cold->helpRow = row.buf;
+		cold->helpRowLen = row.len;
+		cold->helpRowIndent = indent;
+		cold->helpRowHeader = header;
+		cold->helpRowWidth = rowWidth;
+	}
+
+	return PST_SINK_write(sink, cold->helpRow, cold->helpRowLen);
+}
+
+static void param_changed(PARAM *param) {
+	param->changed = (param->changeCount != NULL) ? ++(*param->changeCount) : param->changed + 1;
+}
+
+/**
+ * Appends the value to the end of the list of values. Note that the value is
+ * not controlled.
+ */
+#ifndef PST_DISABLE_STATS
+/**
+ * Returns the count of bytes of the value and source strings held by the value.
+ * Borrowed strings are not counted.
+ */
+static size_t param_value_string_bytes(const PARAM_VAL *value) {
+	if (value->isBorrowed) return 0;
+	return (value->cstr_value != NULL ? strlen(value->cstr_value) + 1 : 0)
+			+ (value->source != NULL ? strlen(value->source) + 1 : 0);
+}
+
+static size_t param_list_string_bytes(const PARAM_VAL *value) {
+	size_t bytes = 0;
+
+	for (; value != NULL; value = value->next) bytes += param_value_string_bytes(value);
+
+	return bytes;
+}
+#endif
+
+static int param_link_value(PARAM *param, PARAM_VAL *newValue) {
+	int res;
+	PARAM_VAL *pLastValue = NULL;
+
+	if (param->arg == NULL) {
+		/* If iterator is not initialized, do it. Otherwise its root is outdated. */
+		if (param->itr == NULL) {
+			res = ITERATOR_new(newValue, &param->itr);
+			if (res != PST_OK) return res;
+			param->itr->stats = param->stats;
+		} else {
+			res = ITERATOR_set(param->itr, newValue, NULL, PST_PRIORITY_NONE, 0);
+			if (res != PST_OK) return res;
+		}
+		param->arg = newValue;
+	} else{
+		if (param->last_element == NULL) {
+			res = PARAM_VAL_getElement(param->arg, NULL, PST_PRIORITY_NONE, PST_INDEX_LAST, &pLastValue);
+			if (res != PST_OK) return res;
+		} else {
+			pLastValue = param->last_element;
+		}
+
+		/* The last element must exist and its next value must be NULL. */
+		if (pLastValue == NULL || pLastValue->next != NULL) return PST_UNDEFINED_BEHAVIOUR;
+
+		newValue->previous = pLastValue;
+		pLastValue->next = newValue;
+	}
+	param->last_element = newValue;
+	param->argCount++;
+	param_changed(param);
+
+	PST_STATS_ADD(param->stats, valuesAllocated, 1);
+	PST_STATS_ADD(param->stats, stringBytes, param_value_string_bytes(newValue));
+
+	if (param->highestPriority < newValue->priority)
+		param->highestPriority = newValue->priority;
+
+	return PST_OK;
 }
 
 int PARAM_addValue(PARAM *param, const char *value, const char* source, int prio) {
 	int res;
 	PARAM_VAL *newValue = NULL;
-	PARAM_VAL *pLastValue = NULL;
-	ITERATOR *tmpItr = NULL;
 	const char *arg = NULL;
+	char *converted = NULL;
 	char buf[1024];
 
 	if (param == NULL) {
@@ -345,8 +798,16 @@ int PARAM_addValue(PARAM *param, const char *value, const char* source, int prio
 		goto cleanup;
 	}
 
-	/* If conversion function exists convert the argument. */
-	if (param->convert) {
+	/**
+	 * If conversion function exists convert the argument. Sized conversion writes
+	 * directly to the storage that is given over to the new value.
+	 */
+	if (param->convertSized && value != NULL) {
+		res = param_convert_sized(param, value, &converted);
+		if (res != PST_OK && res != PST_PARAM_CONVERT_NOT_PERFORMED) goto cleanup;
+
+		arg = value;
+	} else if (param->convert) {
 		res = param->convert(value, buf, sizeof(buf));
 		if (res != PST_OK && res != PST_PARAM_CONVERT_NOT_PERFORMED) goto cleanup;
 
@@ -355,54 +816,78 @@ int PARAM_addValue(PARAM *param, const char *value, const char* source, int prio
 		arg = value;
 	}
 
-	/* Create new object and check the format. */
-	res = PARAM_VAL_new(arg, source, prio, &newValue);
+	/* Create new object. */
+	if (converted != NULL) {
+		res = PARAM_VAL_newOwned(converted, source, prio, &newValue);
+		if (res != PST_OK) goto cleanup;
+		converted = NULL;
+	} else {
+		res = PARAM_VAL_new(arg, source, prio, &newValue);
+		if (res != PST_OK) goto cleanup;
+	}
+
+	res = param_link_value(param, newValue);
 	if (res != PST_OK) goto cleanup;
 
-	if (param->controlFormat)
-		newValue->formatStatus = param->controlFormat(arg);
-	if (newValue->formatStatus == FORMAT_OK && param->controlContent)
-		newValue->contentStatus = param->controlContent(arg);
+	/* Check the format and content, unless it is deferred until the value is used. */
+	newValue->isPending = 1;
+	param->pendingCount++;
+	if (!(param->control_options & PST_CONTROL_LAZY)) param_value_control(param, newValue);
 
-	if (param->arg == NULL) {
-		param->arg = newValue;
-		/* If iterator is not initialized, do it.*/
-		if (param->itr == NULL) {
-			res = ITERATOR_new(param->arg, &tmpItr);
-			if (res != PST_OK) goto cleanup;
+	newValue = NULL;
+	res = PST_OK;
 
-			param->itr = tmpItr;
-			tmpItr = NULL;
-		}
-	} else{
-		if (param->last_element == NULL) {
-			res = PARAM_VAL_getElement(param->arg, NULL, PST_PRIORITY_NONE, PST_INDEX_LAST, &pLastValue);
+cleanup:
+
+	PARAM_VAL_free(newValue);
+	free(converted);
+
+	return res;
+}
+
+int PARAM_appendValue(PARAM *param, PARAM_VAL *value) {
+	if (param == NULL || value == NULL || value->next != NULL || value->previous != NULL) return PST_INVALID_ARGUMENT;
+	return param_link_value(param, value);
+}
+
+int PARAM_includeValues(PARAM *target, PARAM *src) {
+	int res;
+	PARAM_VAL *value = NULL;
+	PARAM_VAL *newValue = NULL;
+	int shared;
+
+	if (target == NULL || src == NULL || target == src) return PST_INVALID_ARGUMENT;
+
+	shared = target->convert == NULL && target->convertSized == NULL
+		&& target->controlFormat == src->controlFormat
+		&& target->controlContent == src->controlContent;
+
+	for (value = src->arg; value != NULL; value = value->next) {
+		if (!shared) {
+			res = PARAM_addValue(target, value->cstr_value, value->source, value->priority);
 			if (res != PST_OK) goto cleanup;
-		} else {
-			pLastValue = param->last_element;
+			continue;
 		}
 
-		/* The last element must exist and its next value must be NULL. */
-		if (pLastValue == NULL || pLastValue->next != NULL) {
-			res = PST_UNDEFINED_BEHAVIOUR;
-			goto cleanup;
+		res = PARAM_VAL_newShared(value, &newValue);
+		if (res != PST_OK) goto cleanup;
+
+		res = param_link_value(target, newValue);
+		if (res != PST_OK) goto cleanup;
+
+		if (newValue->isPending) {
+			target->pendingCount++;
+			if (!(target->control_options & PST_CONTROL_LAZY)) param_value_control(target, newValue);
 		}
-		newValue->previous = pLastValue;
-		pLastValue->next = newValue;
-	}
-	param->last_element = newValue;
-	param->argCount++;
 
-	if (param->highestPriority < prio)
-		param->highestPriority = prio;
+		newValue = NULL;
+	}
 
-	newValue = NULL;
 	res = PST_OK;
 
 cleanup:
 
 	PARAM_VAL_free(newValue);
-	ITERATOR_free(tmpItr);
 
 	return res;
 }
@@ -476,10 +961,13 @@ int PARAM_clearAll(PARAM *param) {
 		goto cleanup;
 	}
 
+	PST_STATS_SUB(param->stats, stringBytes, param_list_string_bytes(param->arg));
 	PARAM_VAL_free(param->arg);
 	param->arg = NULL;
 	param->argCount = 0;
+	param->pendingCount = 0;
 	param->last_element = NULL;
+	param_changed(param);
 	res = PST_OK;
 
 cleanup:
@@ -527,8 +1015,11 @@ int PARAM_clearValue(PARAM *param, const char *source, int prio, int at) {
 	if (res != PST_OK) goto cleanup;
 
 	if (param->last_element == pop) param->last_element = pop->previous;
+	if (pop->isPending) param->pendingCount--;
 
 	param->argCount--;
+	param_changed(param);
+	PST_STATS_SUB(param->stats, stringBytes, param_value_string_bytes(pop));
 	PARAM_VAL_free(pop);
 
 	res = PST_OK;
@@ -537,6 +1028,42 @@ cleanup:
 	return res;
 }
 
+int PARAM_removeValue(PARAM *param, PARAM_VAL *value) {
+	if (param == NULL || value == NULL) return PST_INVALID_ARGUMENT;
+	if (value->previous == NULL && param->arg != value) return PST_INVALID_ARGUMENT;
+
+	if (value->previous != NULL) value->previous->next = value->next;
+	else param->arg = value->next;
+	if (value->next != NULL) value->next->previous = value->previous;
+
+	if (param->last_element == value) param->last_element = value->previous;
+	if (value->isPending) param->pendingCount--;
+	param->argCount--;
+	param_changed(param);
+
+	value->previous = NULL;
+	value->next = NULL;
+	PST_STATS_SUB(param->stats, stringBytes, param_value_string_bytes(value));
+	PARAM_VAL_free(value);
+
+	if (param->itr != NULL && param->arg != NULL) {
+		return ITERATOR_set(param->itr, param->arg, param->itr->source, param->itr->priority, 0);
+	}
+
+	return PST_OK;
+}
+
+void PARAM_setStats(PARAM *param, PARAM_SET_STATS *stats) {
+	if (param == NULL) return;
+	param->stats = stats;
+	if (param->itr != NULL) param->itr->stats = stats;
+}
+
+void PARAM_setChangeCounter(PARAM *param, unsigned long *counter) {
+	if (param == NULL) return;
+	param->changeCount = counter;
+}
+
 int PARAM_getInvalid(PARAM *param, const char *source, int prio, int at, PARAM_VAL **value) {
 	return param_get_value(param, source, prio, at, PARAM_VAL_getInvalid, value);
 }
@@ -554,6 +1081,7 @@ int PARAM_getValueCount(PARAM *param, const char *source, int prio, int *count)
 }
 
 int PARAM_getInvalidCount(PARAM *param, const char *source, int prio, int *count) {
+	param_control_pending_values(param);
 	return param_get_value_count(param, source, prio, PARAM_VAL_getInvalidCount, count);
 }
 
@@ -664,15 +1192,21 @@ cleanup:
 }
 
 int PARAM_setWildcardExpander(PARAM *param, const char* charList, void *ctx, void (*ctx_free)(void*), int (*expand_wildcard)(PARAM_VAL *param_value, void *ctx, int *value_shift)) {
+	PARAM_COLD *cold = NULL;
+
 	if (param == NULL || expand_wildcard == NULL) return PST_INVALID_ARGUMENT;
-	param->expand_wildcard = expand_wildcard;
-	param->expand_wildcard_ctx = ctx;
-	param->expand_wildcard_free = ctx_free;
+
+	cold = param_get_cold(param);
+	if (cold == NULL) return PST_OUT_OF_MEMORY;
+
+	cold->expand_wildcard = expand_wildcard;
+	cold->expand_wildcard_ctx = ctx;
+	cold->expand_wildcard_free = ctx_free;
 
 	if (charList != NULL) {
-		param->expand_wildcard_char = charList;
+		cold->expand_wildcard_char = charList;
 	} else {
-		param->expand_wildcard_char = WILDCAR_EXPANDER_DEF_CHAR;
+		cold->expand_wildcard_char = WILDCAR_EXPANDER_DEF_CHAR;
 	}
 
 	return PST_OK;
@@ -685,6 +1219,7 @@ int PARAM_expandWildcard(PARAM *param, int *count) {
 	int parameter_shif_correction = 0;
 	int expanded_count = 0;
 	int counter = 0;
+	int counted = 0;
 	PARAM_VAL *value = NULL;
 	PARAM_VAL *pop = NULL;
 
@@ -694,7 +1229,7 @@ int PARAM_expandWildcard(PARAM *param, int *count) {
 		goto cleanup;
 	}
 
-	if (param->expand_wildcard == NULL) {
+	if (param->cold == NULL || param->cold->expand_wildcard == NULL) {
 		res = PST_PARAMETER_UNIMPLEMENTED_WILDCARD;
 		goto cleanup;
 	}
@@ -703,6 +1238,10 @@ int PARAM_expandWildcard(PARAM *param, int *count) {
 		res = PARAM_getValueCount(param, NULL, PST_PRIORITY_NONE, &initial_count);
 		if (res != PST_OK) goto cleanup;
 
+		/* The expanded values are counted after the expansion, see cleanup. */
+		PST_STATS_SUB(param->stats, stringBytes, param_list_string_bytes(param->arg));
+		counted = 1;
+
 		for (i = 0; i < initial_count; i++) {
 			int absIndex = i + parameter_shif_correction;
 
@@ -710,18 +1249,19 @@ int PARAM_expandWildcard(PARAM *param, int *count) {
 			if (res != PST_OK) goto cleanup;
 
 			/* Check if there are wildcard characters. If not goto next value. */
-			if (strpbrk(value->cstr_value, param->expand_wildcard_char) == NULL) continue;
+			if (value->cstr_value == NULL || strpbrk(value->cstr_value, param->cold->expand_wildcard_char) == NULL) continue;
 
 			expanded_count = 0;
-			res = param->expand_wildcard(value, param->expand_wildcard_ctx, &expanded_count);
+			res = param->cold->expand_wildcard(value, param->cold->expand_wildcard_ctx, &expanded_count);
 			if (res != PST_OK) goto cleanup;
 
 			res = PARAM_VAL_popElement(&value, NULL, PST_PRIORITY_NONE, 0, &pop);
 			if (res != PST_OK) goto cleanup;
-
+			if (pop->isPending) param->pendingCount--;
 
 			param->argCount += expanded_count - 1;
 			param->arg = value;
+			param_changed(param);
 
 			res = param_reser_iterator_if_needed_after_pop(param, absIndex);
 			if (res != PST_OK) goto cleanup;
@@ -729,6 +1269,7 @@ int PARAM_expandWildcard(PARAM *param, int *count) {
 			PARAM_VAL_free(pop);
 			parameter_shif_correction += -1 + expanded_count;
 			counter += expanded_count;
+			PST_STATS_ADD(param->stats, wildcardExpansions, expanded_count);
 			pop = NULL;
 
 		}
@@ -740,6 +1281,9 @@ int PARAM_expandWildcard(PARAM *param, int *count) {
 
 cleanup:
 
+	if (counted) {
+		PST_STATS_ADD(param->stats, stringBytes, param_list_string_bytes(param->arg));
+	}
 	PARAM_VAL_free(pop);
 
 	return res;
@@ -34,10 +34,6 @@ extern "C" {
  */
 typedef struct PARAM_st PARAM;
 
-typedef enum PARAM_PARSE_OPTIONS_enum PARAM_PARSE_OPTIONS;
-
-typedef enum PARAM_CONSTRAINTS_enum PARAM_CONSTRAINTS;
-
 typedef struct PARAM_ATR_st PARAM_ATR;
 
 
@@ -52,6 +48,8 @@ enum PARAM_CONSTRAINTS_enum {
 	PARAM_INVALID_CONSTRAINT = 0x8000,
 };
 
+typedef enum PARAM_CONSTRAINTS_enum PARAM_CONSTRAINTS;
+
 /**
  * Object to be used with function #PARAM_SET_getAtr to get details
  * about parameter value.
@@ -406,6 +404,40 @@ enum PARAM_PARSE_OPTIONS_enum {
 	PST_PRSCMD_COLLECT_LIMITER_MAX_MASK = 0xffff0000
 };
 
+typedef enum PARAM_PARSE_OPTIONS_enum PARAM_PARSE_OPTIONS;
+
+/**
+ * Options that affect when the value controls (format and content check, see
+ * #PARAM_addControl) are applied. Note that value conversion is always performed
+ * when the value is added.
+ */
+enum PARAM_CONTROL_OPTIONS_enum {
+	/** Format and content of a value are checked when the value is added. */
+	PST_CONTROL_DEFAULT = 0x0000,
+
+	/**
+	 * Format and content check is deferred until the value is accessed for the
+	 * first time (e.g. #PARAM_getValue, #PARAM_getAtr, #PARAM_getObject) or until the
+	 * check results are requested (#PARAM_getInvalid and #PARAM_getInvalidCount).
+	 * Values that are never accessed are never checked. Note that in combination
+	 * with #PST_PRSCMD_FORMAT_CONTROL_ONLY_FOR_LAST_HIGHST_PRIORITY_VALUE functions
+	 * #PARAM_SET_isFormatOK and #PARAM_SET_invalidParametersToString check only the
+	 * value that is actually used, shadowed values are left unchecked.
+	 */
+	PST_CONTROL_LAZY = 0x0001,
+
+	/**
+	 * Results of the format and content check are cached per parameter and keyed
+	 * by the value, so a repeated value is not checked again. The cache is bounded,
+	 * the least recently used results are evicted. Use only when the result of the
+	 * check depends on the value alone. The cache is cleared when control functions
+	 * are changed (see #PARAM_addControl).
+	 */
+	PST_CONTROL_CACHE = 0x0002
+};
+
+typedef enum PARAM_CONTROL_OPTIONS_enum PARAM_CONTROL_OPTIONS;
+
 /**
  * Creates a new and empty parameter.
  *
@@ -463,6 +495,28 @@ void PARAM_free(PARAM *param);
  */
 int PARAM_addControl(PARAM *param, int (*controlFormat)(const char *), int (*controlContent)(const char *), int (*convert)(const char*, char*, unsigned));
 
+/**
+ * Sets a conversion function that, unlike \c convert of #PARAM_addControl, is
+ * not limited by the size of an internal buffer. The converted value is written
+ * directly to the storage that is owned by the new parameter value, so no extra
+ * copy is made. If set, \c convert of #PARAM_addControl is not used.
+ *
+ * <tt>int (*convert)(const char *value, char *buf, size_t *buf_len)</tt>
+ *
+ * The function is called twice for a value. First \c buf is \c NULL and the
+ * function must store the size of the converted value, including the terminating
+ * \c NULL character, to \c buf_len. Then it is called with \c buf that has at
+ * least the size requested. Return #PST_OK if conversion is successful or
+ * #PST_PARAM_CONVERT_NOT_PERFORMED (on the first call) to use the original value.
+ * Any other error code will break adding the value. The function is not called
+ * for \c NULL values.
+ *
+ * \param	param		#PARAM object.
+ * \param	convert		Function for parameter value conversion. Can be \c NULL to remove it.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_setConverter(PARAM *param, int (*convert)(const char*, char*, size_t*));
+
 /**
  * Checks if parse option or a group is set (can be concatenated together
  * with '|').
@@ -487,6 +541,27 @@ int PARAM_isParseOptionSet(PARAM *param, int state);
  */
 int PARAM_setParseOption(PARAM *param, int option);
 
+/**
+ * Specifies options ([PARAM_CONTROL_OPTIONS](@ref PARAM_CONTROL_OPTIONS_enum)) that
+ * affect when the value controls set with #PARAM_addControl are applied. When
+ * #PST_CONTROL_LAZY is removed, all deferred checks are performed immediately.
+ *
+ * \param param		#PARAM object.
+ * \param options	Control options.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int PARAM_setControlOptions(PARAM *param, int options);
+
+/**
+ * Checks if control option or a group of options is set.
+ *
+ * \param param		#PARAM object.
+ * \param option	Control options to be checked.
+ * \return \c 1 if all the options are set, \c 0 otherwise.
+ * \see #PARAM_setControlOptions.
+ */
+int PARAM_isControlOptionSet(PARAM *param, int option);
+
 /**
  * Sets object extractor to the parameter that implements #PARAM_getObject.
  *
@@ -511,7 +586,8 @@ int PARAM_setObjectExtractor(PARAM *param, int (*extractObject)(void **, const c
 /**
  * Appends value to the parameter. Invalid value format or content is not handled
  * as error, but the state is saved. Internal format or content errors can be
- * detected - see #PARAM_getInvalid.
+ * detected - see #PARAM_getInvalid. If #PST_CONTROL_LAZY is set, the format and
+ * content check is deferred (see #PARAM_setControlOptions).
  *
  * \param	param		#PARAM object.
  * \param	value		Parameter value as C-string. Can be \c NULL.
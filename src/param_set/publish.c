@@ -0,0 +1,720 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "param_set.h"
+#include "param_value.h"
+#include "param_set_obj_impl.h"
+
+#ifndef _WIN32
+#  ifdef HAVE_CONFIG_H
+#    include "config.h"
+#  endif
+#endif
+
+#if defined(_WIN32)
+#  include <windows.h>
+#  define PST_ATOMIC_WIN32
+#  define PST_LOCK_WIN32
+#elif defined(HAVE_PTHREAD_H)
+#  include <pthread.h>
+#  define PST_LOCK_PTHREAD
+#  if defined(HAVE_ATOMIC_BUILTINS)
+#    define PST_ATOMIC_BUILTINS
+#  endif
+#elif defined(HAVE_ATOMIC_BUILTINS)
+#  define PST_ATOMIC_BUILTINS
+#endif
+
+/* Without atomic operations the readers take the lock of the writer. */
+#if !defined(PST_ATOMIC_WIN32) && !defined(PST_ATOMIC_BUILTINS)
+#  define PST_ATOMIC_LOCKED
+#endif
+
+#define PUBLISHER_CACHE_LINE 64
+
+/**
+ * A value of a frozen parameter. The strings are kept in the pool of the set.
+ */
+typedef struct FROZEN_VALUE_st {
+	const char *value;
+	const char *source;
+	int priority;
+	int isInvalid;
+} FROZEN_VALUE;
+
+typedef struct FROZEN_PARAM_st {
+	char *name;
+	char *alias;
+
+	/* Values in the order they were added. */
+	FROZEN_VALUE *value;
+	int count;
+
+	/* Indexes of the values with the highest priority. */
+	int *highest;
+	int highestCount;
+	int highestPriority;
+	int lowestPriority;
+} FROZEN_PARAM;
+
+struct PST_FROZEN_SET_st {
+	int count;
+	FROZEN_PARAM *param;
+
+	/* Values, highest priority indexes and strings of all the parameters. */
+	FROZEN_VALUE *value;
+	int *highest;
+	char *pool;
+
+	/* Open addressing table of parameter indexes (-1 for empty) by name and alias. */
+	unsigned hashSize;
+	int *hash;
+
+	/* Epoch when the set was replaced and the link to the next replaced set. */
+	long retireEpoch;
+	PST_FROZEN_SET *retired;
+};
+
+/**
+ * Reader slot is 0 when the reader is not using any set, otherwise it holds the
+ * epoch that was current when the reader entered. Each slot is in its own cache
+ * line, so readers do not slow each other down.
+ */
+typedef struct READER_SLOT_st {
+	volatile long epoch;
+	int used;
+	char pad[PUBLISHER_CACHE_LINE - sizeof(long) - sizeof(int)];
+} READER_SLOT;
+
+struct PST_PUBLISHER_st {
+	PST_FROZEN_SET * volatile current;
+	volatile long epoch;
+	READER_SLOT *slot;
+	size_t maxReaders;
+	PST_FROZEN_SET *retired;
+	size_t retiredCount;
+#if defined(PST_LOCK_WIN32)
+	CRITICAL_SECTION lock;
+#elif defined(PST_LOCK_PTHREAD)
+	pthread_mutex_t lock;
+#endif
+};
+
+static void publisher_lock(PST_PUBLISHER *pub) {
+#if defined(PST_LOCK_WIN32)
+	EnterCriticalSection(&pub->lock);
+#elif defined(PST_LOCK_PTHREAD)
+	pthread_mutex_lock(&pub->lock);
+#else
+	(void)pub;
+#endif
+}
+
+static void publisher_unlock(PST_PUBLISHER *pub) {
+#if defined(PST_LOCK_WIN32)
+	LeaveCriticalSection(&pub->lock);
+#elif defined(PST_LOCK_PTHREAD)
+	pthread_mutex_unlock(&pub->lock);
+#else
+	(void)pub;
+#endif
+}
+
+/* All atomic operations are sequentially consistent. */
+static long atomic_load_long(volatile long *p) {
+#if defined(PST_ATOMIC_WIN32)
+	return InterlockedCompareExchange((LONG volatile*)p, 0, 0);
+#elif defined(PST_ATOMIC_BUILTINS)
+	return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#else
+	return *p;
+#endif
+}
+
+static void atomic_store_long(volatile long *p, long v) {
+#if defined(PST_ATOMIC_WIN32)
+	InterlockedExchange((LONG volatile*)p, v);
+#elif defined(PST_ATOMIC_BUILTINS)
+	__atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+#else
+	*p = v;
+#endif
+}
+
+static long atomic_increment_long(volatile long *p) {
+#if defined(PST_ATOMIC_WIN32)
+	return InterlockedIncrement((LONG volatile*)p);
+#elif defined(PST_ATOMIC_BUILTINS)
+	return __atomic_add_fetch(p, 1L, __ATOMIC_SEQ_CST);
+#else
+	return ++(*p);
+#endif
+}
+
+static PST_FROZEN_SET *atomic_load_set(PST_FROZEN_SET * volatile *p) {
+#if defined(PST_ATOMIC_WIN32)
+	return (PST_FROZEN_SET*)InterlockedCompareExchangePointer((PVOID volatile*)p, NULL, NULL);
+#elif defined(PST_ATOMIC_BUILTINS)
+	return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#else
+	return *p;
+#endif
+}
+
+static PST_FROZEN_SET *atomic_exchange_set(PST_FROZEN_SET * volatile *p, PST_FROZEN_SET *v) {
+#if defined(PST_ATOMIC_WIN32)
+	return (PST_FROZEN_SET*)InterlockedExchangePointer((PVOID volatile*)p, v);
+#elif defined(PST_ATOMIC_BUILTINS)
+	return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+#else
+	PST_FROZEN_SET *old = *p;
+	*p = v;
+	return old;
+#endif
+}
+
+static char *new_string(const char *str) {
+	char *tmp = NULL;
+	if (str == NULL) return NULL;
+	tmp = (char*)malloc(strlen(str) + 1);
+	if (tmp == NULL) return NULL;
+	return strcpy(tmp, str);
+}
+
+static int frozen_find(const PST_FROZEN_SET *frozen, const char *name) {
+	unsigned mask = frozen->hashSize - 1;
+	unsigned h = PARAM_nameHash(name) & mask;
+	int i;
+
+	while ((i = frozen->hash[h]) >= 0) {
+		const FROZEN_PARAM *param = &frozen->param[i];
+
+		if (strcmp(param->name, name) == 0 || (param->alias != NULL && strcmp(param->alias, name) == 0)) return i;
+		h = (h + 1) & mask;
+	}
+
+	return -1;
+}
+
+static void frozen_hash_add(PST_FROZEN_SET *frozen, const char *name, int at) {
+	unsigned mask = frozen->hashSize - 1;
+	unsigned h = 0;
+
+	/* The first parameter with the name is found, as PARAM_SET does. */
+	if (name == NULL || frozen_find(frozen, name) >= 0) return;
+
+	h = PARAM_nameHash(name) & mask;
+	while (frozen->hash[h] >= 0) h = (h + 1) & mask;
+	frozen->hash[h] = at;
+}
+
+static size_t frozen_string_size(const char *str) {
+	return (str == NULL) ? 0 : strlen(str) + 1;
+}
+
+static const char *frozen_string_copy(const char *str, char **pool) {
+	char *tmp = *pool;
+
+	if (str == NULL) return NULL;
+
+	strcpy(tmp, str);
+	*pool += strlen(str) + 1;
+
+	return tmp;
+}
+
+/**
+ * Copies the values of the parameter to the arrays of the set, starting from
+ * the given positions, and finds the values with the highest priority.
+ */
+static void frozen_copy_values(FROZEN_PARAM *param, const PARAM_VAL *src, FROZEN_VALUE *value, int *highest, char **pool) {
+	int i;
+
+	param->value = value;
+	param->highest = highest;
+	param->count = 0;
+	param->highestCount = 0;
+	param->highestPriority = 0;
+	param->lowestPriority = 0;
+
+	for (; src != NULL; src = src->next) {
+		FROZEN_VALUE *v = &value[param->count];
+
+		v->value = frozen_string_copy(src->cstr_value, pool);
+		v->source = frozen_string_copy(src->source, pool);
+		v->priority = src->priority;
+		v->isInvalid = src->formatStatus != 0 || src->contentStatus != 0;
+
+		if (param->count == 0 || v->priority > param->highestPriority) param->highestPriority = v->priority;
+		if (param->count == 0 || v->priority < param->lowestPriority) param->lowestPriority = v->priority;
+		param->count++;
+	}
+
+	for (i = 0; i < param->count; i++) {
+		if (value[i].priority == param->highestPriority) highest[param->highestCount++] = i;
+	}
+}
+
+int PARAM_SET_freeze(PARAM_SET *set, PST_FROZEN_SET **frozen) {
+	int res;
+	PST_FROZEN_SET *tmp = NULL;
+	const PARAM_VAL *val = NULL;
+	size_t valueCount = 0;
+	size_t poolSize = 0;
+	size_t at = 0;
+	char *pool = NULL;
+	unsigned i;
+
+	if (set == NULL || frozen == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = PARAM_SET_validateAll(set, 1);
+	if (res != PST_OK) goto cleanup;
+
+	tmp = (PST_FROZEN_SET*)calloc(1, sizeof(*tmp));
+	if (tmp == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	/* The values of all parameters are stored in the same arrays. */
+	for (i = 0; i < (unsigned)set->count; i++) {
+		for (val = set->parameter[i]->arg; val != NULL; val = val->next) {
+			valueCount++;
+			poolSize += frozen_string_size(val->cstr_value) + frozen_string_size(val->source);
+		}
+	}
+
+	if (valueCount > INT_MAX) {
+		res = PST_INDEX_OVF;
+		goto cleanup;
+	}
+
+	/* At least half of the table is empty, as every parameter can have an alias. */
+	for (tmp->hashSize = 8; tmp->hashSize < (unsigned)set->count * 4; tmp->hashSize *= 2);
+
+	tmp->param = (FROZEN_PARAM*)calloc(set->count > 0 ? set->count : 1, sizeof(*tmp->param));
+	tmp->hash = (int*)malloc(tmp->hashSize * sizeof(*tmp->hash));
+	tmp->value = (FROZEN_VALUE*)malloc((valueCount > 0 ? valueCount : 1) * sizeof(*tmp->value));
+	tmp->highest = (int*)malloc((valueCount > 0 ? valueCount : 1) * sizeof(*tmp->highest));
+	tmp->pool = (char*)malloc(poolSize > 0 ? poolSize : 1);
+	if (tmp->param == NULL || tmp->hash == NULL || tmp->value == NULL || tmp->highest == NULL || tmp->pool == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	for (i = 0; i < tmp->hashSize; i++) tmp->hash[i] = -1;
+
+	pool = tmp->pool;
+	for (tmp->count = 0; tmp->count < set->count; tmp->count++) {
+		const PARAM *param = set->parameter[tmp->count];
+		FROZEN_PARAM *copy = &tmp->param[tmp->count];
+
+		copy->name = new_string(param->flagName);
+		copy->alias = new_string(param->flagAlias);
+		if (copy->name == NULL || (param->flagAlias != NULL && copy->alias == NULL)) {
+			tmp->count++;
+			res = PST_OUT_OF_MEMORY;
+			goto cleanup;
+		}
+
+		frozen_copy_values(copy, param->arg, tmp->value + at, tmp->highest + at, &pool);
+		at += copy->count;
+	}
+
+	for (i = 0; i < (unsigned)tmp->count; i++) {
+		frozen_hash_add(tmp, tmp->param[i].name, (int)i);
+		frozen_hash_add(tmp, tmp->param[i].alias, (int)i);
+	}
+
+	*frozen = tmp;
+	tmp = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	PST_FROZEN_SET_free(tmp);
+
+	return res;
+}
+
+void PST_FROZEN_SET_free(PST_FROZEN_SET *frozen) {
+	int i;
+
+	if (frozen == NULL) return;
+
+	if (frozen->param != NULL) {
+		for (i = 0; i < frozen->count; i++) {
+			free(frozen->param[i].name);
+			free(frozen->param[i].alias);
+		}
+	}
+
+	free(frozen->param);
+	free(frozen->value);
+	free(frozen->highest);
+	free(frozen->pool);
+	free(frozen->hash);
+	free(frozen);
+}
+
+static int frozen_get_param(const PST_FROZEN_SET *frozen, const char *name, const FROZEN_PARAM **param) {
+	int i;
+
+	if (frozen == NULL || name == NULL) return PST_INVALID_ARGUMENT;
+
+	i = frozen_find(frozen, name);
+	if (i < 0) return PST_PARAMETER_NOT_FOUND;
+
+	*param = &frozen->param[i];
+	return PST_OK;
+}
+
+/**
+ * Finds the value at position \c at that matches the constraints, the same way
+ * as #PARAM_VAL_getElement does. If \c value is \c NULL, only the matching values
+ * are counted. Without a source constraint, values of any priority and values
+ * with the highest priority are indexed directly, other constraints are checked
+ * for every value.
+ */
+static int frozen_get_value(const FROZEN_PARAM *param, const char *source, int priority, int at,
+		const FROZEN_VALUE **value, int *count) {
+	const FROZEN_VALUE *last = NULL;
+	const FROZEN_VALUE *v = NULL;
+	int prio = priority;
+	int n = 0;
+	int i;
+
+	if (priority <= PST_PRIORITY_NOTDEFINED || priority >= PST_PRIORITY_FIELD_OUT_OF_RANGE || at < PST_INDEX_LAST) {
+		return PST_INVALID_ARGUMENT;
+	}
+
+	if (priority == PST_PRIORITY_HIGHEST) {
+		prio = param->highestPriority;
+	} else if (priority == PST_PRIORITY_LOWEST) {
+		prio = param->lowestPriority;
+	}
+
+	if (source == NULL && (prio == PST_PRIORITY_NONE || priority == PST_PRIORITY_HIGHEST)) {
+		n = (prio == PST_PRIORITY_NONE) ? param->count : param->highestCount;
+		if (count != NULL) *count = n;
+		if (value == NULL) return PST_OK;
+
+		if (at == PST_INDEX_LAST) at = n - 1;
+		if (at < 0 || at >= n) return PST_PARAMETER_VALUE_NOT_FOUND;
+
+		*value = &param->value[(prio == PST_PRIORITY_NONE) ? at : param->highest[at]];
+		return PST_OK;
+	}
+
+	for (i = 0; i < param->count; i++) {
+		v = &param->value[i];
+
+		if ((prio == PST_PRIORITY_NONE || PARAM_VAL_isPriorityMatch(prio, v->priority))
+				&& (source == NULL || (v->source != NULL && strcmp(source, v->source) == 0))) {
+			if (value != NULL && n == at) {
+				*value = v;
+				return PST_OK;
+			}
+
+			last = v;
+			n++;
+		}
+	}
+
+	if (count != NULL) *count = n;
+	if (value == NULL) return PST_OK;
+
+	if (at == PST_INDEX_LAST && last != NULL) {
+		*value = last;
+		return PST_OK;
+	}
+
+	return PST_PARAMETER_VALUE_NOT_FOUND;
+}
+
+int PST_FROZEN_SET_getStr(const PST_FROZEN_SET *frozen, const char *name, const char *source, int priority, int at, const char **value) {
+	int res;
+	const FROZEN_PARAM *param = NULL;
+	const FROZEN_VALUE *val = NULL;
+
+	if (value == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = frozen_get_param(frozen, name, &param);
+	if (res != PST_OK) goto cleanup;
+
+	if (param->count == 0) {
+		res = PST_PARAMETER_EMPTY;
+		goto cleanup;
+	}
+
+	res = frozen_get_value(param, source, priority, at, &val, NULL);
+	if (res != PST_OK) goto cleanup;
+
+	*value = val->value;
+	res = val->isInvalid ? PST_PARAMETER_INVALID_FORMAT : PST_OK;
+
+cleanup:
+
+	return res;
+}
+
+int PST_FROZEN_SET_getValueCount(const PST_FROZEN_SET *frozen, const char *name, const char *source, int priority, int *count) {
+	int res;
+	const FROZEN_PARAM *param = NULL;
+
+	if (count == NULL) return PST_INVALID_ARGUMENT;
+
+	res = frozen_get_param(frozen, name, &param);
+	if (res != PST_OK) return res;
+
+	if (param->count == 0) {
+		*count = 0;
+		return PST_OK;
+	}
+
+	return frozen_get_value(param, source, priority, 0, NULL, count);
+}
+
+int PST_FROZEN_SET_isSet(const PST_FROZEN_SET *frozen, const char *name) {
+	const FROZEN_PARAM *param = NULL;
+
+	if (frozen_get_param(frozen, name, &param) != PST_OK) return 0;
+	return param->count > 0;
+}
+
+int PST_PUBLISHER_new(size_t maxReaders, PST_PUBLISHER **pub) {
+	int res;
+	PST_PUBLISHER *tmp = NULL;
+
+	if (maxReaders == 0 || pub == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	tmp = (PST_PUBLISHER*)malloc(sizeof(*tmp));
+	if (tmp == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	tmp->current = NULL;
+	tmp->epoch = 1;
+	tmp->maxReaders = maxReaders;
+	tmp->retired = NULL;
+	tmp->retiredCount = 0;
+
+	tmp->slot = (READER_SLOT*)calloc(maxReaders, sizeof(*tmp->slot));
+	if (tmp->slot == NULL) {
+		free(tmp);
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+#if defined(PST_LOCK_WIN32)
+	InitializeCriticalSection(&tmp->lock);
+#elif defined(PST_LOCK_PTHREAD)
+	if (pthread_mutex_init(&tmp->lock, NULL) != 0) {
+		free(tmp->slot);
+		free(tmp);
+		res = PST_UNDEFINED_BEHAVIOUR;
+		goto cleanup;
+	}
+#endif
+
+	*pub = tmp;
+	res = PST_OK;
+
+cleanup:
+
+	return res;
+}
+
+void PST_PUBLISHER_free(PST_PUBLISHER *pub) {
+	PST_FROZEN_SET *next = NULL;
+
+	if (pub == NULL) return;
+
+	while (pub->retired != NULL) {
+		next = pub->retired->retired;
+		PST_FROZEN_SET_free(pub->retired);
+		pub->retired = next;
+	}
+
+	PST_FROZEN_SET_free(pub->current);
+
+#if defined(PST_LOCK_WIN32)
+	DeleteCriticalSection(&pub->lock);
+#elif defined(PST_LOCK_PTHREAD)
+	pthread_mutex_destroy(&pub->lock);
+#endif
+
+	free(pub->slot);
+	free(pub);
+}
+
+int PST_PUBLISHER_addReader(PST_PUBLISHER *pub, size_t *reader) {
+	size_t i;
+	int res = PST_OUT_OF_MEMORY;
+
+	if (pub == NULL || reader == NULL) return PST_INVALID_ARGUMENT;
+
+	publisher_lock(pub);
+	for (i = 0; i < pub->maxReaders; i++) {
+		if (!pub->slot[i].used) {
+			pub->slot[i].used = 1;
+			atomic_store_long(&pub->slot[i].epoch, 0);
+			*reader = i;
+			res = PST_OK;
+			break;
+		}
+	}
+	publisher_unlock(pub);
+
+	return res;
+}
+
+int PST_PUBLISHER_removeReader(PST_PUBLISHER *pub, size_t reader) {
+	if (pub == NULL || reader >= pub->maxReaders) return PST_INVALID_ARGUMENT;
+
+	publisher_lock(pub);
+	atomic_store_long(&pub->slot[reader].epoch, 0);
+	pub->slot[reader].used = 0;
+	publisher_unlock(pub);
+
+	return PST_OK;
+}
+
+/**
+ * Frees the replaced sets that were replaced before the oldest epoch a reader
+ * entered in. Must be called with the lock held.
+ */
+static void publisher_reclaim(PST_PUBLISHER *pub) {
+	long oldest = LONG_MAX;
+	long e = 0;
+	size_t i;
+	PST_FROZEN_SET **p = NULL;
+	PST_FROZEN_SET *tmp = NULL;
+
+	for (i = 0; i < pub->maxReaders; i++) {
+		e = atomic_load_long(&pub->slot[i].epoch);
+		if (e != 0 && e < oldest) oldest = e;
+	}
+
+	/* A reader that entered in the epoch the set was replaced, sees the new set. */
+	p = &pub->retired;
+	while (*p != NULL) {
+		if ((*p)->retireEpoch <= oldest) {
+			tmp = *p;
+			*p = tmp->retired;
+			PST_FROZEN_SET_free(tmp);
+			pub->retiredCount--;
+		} else {
+			p = &(*p)->retired;
+		}
+	}
+}
+
+int PST_PUBLISHER_publish(PST_PUBLISHER *pub, PST_FROZEN_SET *frozen) {
+	PST_FROZEN_SET *old = NULL;
+
+	if (pub == NULL || frozen == NULL) return PST_INVALID_ARGUMENT;
+
+	publisher_lock(pub);
+
+	/* A set already owned by the publisher would be replaced and freed twice. */
+	for (old = pub->retired; old != NULL && old != frozen; old = old->retired);
+	if (old != NULL || frozen == atomic_load_set(&pub->current)) {
+		publisher_unlock(pub);
+		return PST_INVALID_ARGUMENT;
+	}
+
+	old = atomic_exchange_set(&pub->current, frozen);
+
+	if (old != NULL) {
+		old->retireEpoch = atomic_increment_long(&pub->epoch);
+		old->retired = pub->retired;
+		pub->retired = old;
+		pub->retiredCount++;
+	}
+
+	publisher_reclaim(pub);
+	publisher_unlock(pub);
+
+	return PST_OK;
+}
+
+int PST_PUBLISHER_enter(PST_PUBLISHER *pub, size_t reader, const PST_FROZEN_SET **frozen) {
+	READER_SLOT *slot = NULL;
+
+	if (pub == NULL || reader >= pub->maxReaders || frozen == NULL) return PST_INVALID_ARGUMENT;
+	slot = &pub->slot[reader];
+
+#ifdef PST_ATOMIC_LOCKED
+	publisher_lock(pub);
+#endif
+
+	/**
+	 * The epoch is announced before the set is loaded. If the writer has not
+	 * seen the announcement, the set it replaced is not visible anymore.
+	 */
+	atomic_store_long(&slot->epoch, atomic_load_long(&pub->epoch));
+	*frozen = atomic_load_set(&pub->current);
+
+#ifdef PST_ATOMIC_LOCKED
+	publisher_unlock(pub);
+#endif
+
+	return PST_OK;
+}
+
+int PST_PUBLISHER_leave(PST_PUBLISHER *pub, size_t reader) {
+	if (pub == NULL || reader >= pub->maxReaders) return PST_INVALID_ARGUMENT;
+
+#ifdef PST_ATOMIC_LOCKED
+	publisher_lock(pub);
+#endif
+
+	atomic_store_long(&pub->slot[reader].epoch, 0);
+
+#ifdef PST_ATOMIC_LOCKED
+	publisher_unlock(pub);
+#endif
+
+	return PST_OK;
+}
+
+int PST_PUBLISHER_reclaim(PST_PUBLISHER *pub, size_t *pending) {
+	if (pub == NULL) return PST_INVALID_ARGUMENT;
+
+	publisher_lock(pub);
+	publisher_reclaim(pub);
+	if (pending != NULL) *pending = pub->retiredCount;
+	publisher_unlock(pub);
+
+	return PST_OK;
+}
@@ -0,0 +1,507 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "param_set.h"
+#include "param_set_obj_impl.h"
+
+#ifndef _WIN32
+#  ifdef HAVE_CONFIG_H
+#    include "config.h"
+#  endif
+#endif
+
+#if !defined(_WIN32) && defined(HAVE_SYS_MMAN_H)
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  define PST_SNAPSHOT_MMAP
+#endif
+
+/**
+ * Snapshot file layout. All integers are 32-bit little-endian and all references
+ * to strings are offsets relative to the string table, so the file can be used
+ * directly from any address.
+ *
+ * Header (32 bytes):
+ *   magic[8] "PSTSNAP\0", version, parameter count, value count,
+ *   string table offset, string table size, reserved.
+ * Parameter records (8 bytes each):
+ *   name, value count.
+ * Value records (24 bytes each, grouped by parameter in the same order):
+ *   value, source, priority, format status, content status, reserved.
+ * String table:
+ *   NULL terminated strings.
+ */
+#define SNAPSHOT_MAGIC "PSTSNAP"
+#define SNAPSHOT_MAGIC_SIZE 8
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_HEADER_SIZE 32
+#define SNAPSHOT_PARAM_SIZE 8
+#define SNAPSHOT_VALUE_SIZE 24
+#define SNAPSHOT_NULL 0xffffffffUL
+#define SNAPSHOT_MAX 0xfffffffeUL
+
+struct SNAPSHOT_st {
+	unsigned char *data;
+	size_t size;
+	int isMapped;
+	SNAPSHOT *next;
+};
+
+typedef struct SNAPSHOT_STRINGS_st {
+	unsigned char *buf;
+	size_t len;
+	size_t size;
+} SNAPSHOT_STRINGS;
+
+static void snapshot_put_i32(unsigned char *p, int v) {
+	PST_putU32(p, (unsigned long)v & 0xffffffffUL);
+}
+
+static int snapshot_get_i32(const unsigned char *p) {
+	unsigned long v = PST_getU32(p);
+	return (v & 0x80000000UL) ? -(int)((~v & 0xffffffffUL) + 1) : (int)v;
+}
+
+static int snapshot_strings_add(SNAPSHOT_STRINGS *str, const char *s, unsigned long *offset) {
+	size_t len;
+
+	if (s == NULL) {
+		*offset = SNAPSHOT_NULL;
+		return PST_OK;
+	}
+
+	len = strlen(s) + 1;
+	if (str->len + len > SNAPSHOT_MAX) return PST_INDEX_OVF;
+
+	if (str->len + len > str->size) {
+		size_t new_size = (str->size == 0) ? 4096 : str->size;
+		unsigned char *tmp = NULL;
+
+		while (str->len + len > new_size) new_size *= 2;
+
+		tmp = (unsigned char*)realloc(str->buf, new_size);
+		if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+		str->buf = tmp;
+		str->size = new_size;
+	}
+
+	memcpy(str->buf + str->len, s, len);
+	*offset = (unsigned long)str->len;
+	str->len += len;
+
+	return PST_OK;
+}
+
+int PARAM_SET_saveSnapshot(PARAM_SET *set, const char *fname) {
+	int res;
+	SNAPSHOT_STRINGS strings = {NULL, 0, 0};
+	unsigned char *records = NULL;
+	unsigned char header[SNAPSHOT_HEADER_SIZE];
+	size_t records_size = 0;
+	size_t value_count = 0;
+	size_t n = 0;
+	int i;
+	FILE *file = NULL;
+
+	if (set == NULL || fname == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	/* Values are stored with their final status, so deferred checks must be done now. */
+	res = PARAM_SET_validateAll(set, 1);
+	if (res != PST_OK) goto cleanup;
+
+	for (i = 0; i < set->count; i++) {
+		value_count += (size_t)set->parameter[i]->argCount;
+	}
+
+	if (value_count > SNAPSHOT_MAX / SNAPSHOT_VALUE_SIZE) {
+		res = PST_INDEX_OVF;
+		goto cleanup;
+	}
+
+	records_size = (size_t)set->count * SNAPSHOT_PARAM_SIZE + value_count * SNAPSHOT_VALUE_SIZE;
+	records = (unsigned char*)calloc(records_size == 0 ? 1 : records_size, 1);
+	if (records == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	for (i = 0; i < set->count; i++) {
+		PARAM *param = set->parameter[i];
+		unsigned char *p = records + (size_t)i * SNAPSHOT_PARAM_SIZE;
+		unsigned long offset = 0;
+
+		res = snapshot_strings_add(&strings, param->flagName, &offset);
+		if (res != PST_OK) goto cleanup;
+
+		PST_putU32(p, offset);
+		PST_putU32(p + 4, (unsigned long)param->argCount);
+	}
+
+	n = 0;
+	for (i = 0; i < set->count; i++) {
+		PARAM_VAL *value = set->parameter[i]->arg;
+		const char *last_source = NULL;
+		unsigned long last_source_offset = SNAPSHOT_NULL;
+
+		for (; value != NULL; value = value->next, n++) {
+			unsigned char *p = records + (size_t)set->count * SNAPSHOT_PARAM_SIZE + n * SNAPSHOT_VALUE_SIZE;
+			unsigned long offset = 0;
+
+			res = snapshot_strings_add(&strings, value->cstr_value, &offset);
+			if (res != PST_OK) goto cleanup;
+			PST_putU32(p, offset);
+
+			/* Consecutive values usually share the source. */
+			if (value->source == NULL || last_source == NULL || strcmp(value->source, last_source) != 0) {
+				res = snapshot_strings_add(&strings, value->source, &last_source_offset);
+				if (res != PST_OK) goto cleanup;
+				last_source = value->source;
+			}
+			PST_putU32(p + 4, last_source_offset);
+
+			snapshot_put_i32(p + 8, value->priority);
+			snapshot_put_i32(p + 12, value->formatStatus);
+			snapshot_put_i32(p + 16, value->contentStatus);
+			PST_putU32(p + 20, 0);
+		}
+	}
+
+	if (n != value_count || SNAPSHOT_HEADER_SIZE + records_size + strings.len > SNAPSHOT_MAX) {
+		res = (n != value_count) ? PST_UNDEFINED_BEHAVIOUR : PST_INDEX_OVF;
+		goto cleanup;
+	}
+
+	memset(header, 0, sizeof(header));
+	memcpy(header, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+	PST_putU32(header + 8, SNAPSHOT_VERSION);
+	PST_putU32(header + 12, (unsigned long)set->count);
+	PST_putU32(header + 16, (unsigned long)value_count);
+	PST_putU32(header + 20, (unsigned long)(SNAPSHOT_HEADER_SIZE + records_size));
+	PST_putU32(header + 24, (unsigned long)strings.len);
+
+	file = fopen(fname, "wb");
+	if (file == NULL) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	if (fwrite(header, 1, sizeof(header), file) != sizeof(header)
+			|| fwrite(records, 1, records_size, file) != records_size
+			|| fwrite(strings.buf, 1, strings.len, file) != strings.len) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	res = (fclose(file) == 0) ? PST_OK : PST_IO_ERROR;
+	file = NULL;
+
+cleanup:
+
+	if (file != NULL) fclose(file);
+	free(records);
+	free(strings.buf);
+
+	return res;
+}
+
+static int snapshot_open(const char *fname, SNAPSHOT **snapshot) {
+	int res;
+	SNAPSHOT *tmp = NULL;
+#ifdef PST_SNAPSHOT_MMAP
+	int fd = -1;
+	struct stat st;
+	void *data = MAP_FAILED;
+#else
+	FILE *file = NULL;
+	long size = 0;
+#endif
+
+	tmp = (SNAPSHOT*)calloc(1, sizeof(*tmp));
+	if (tmp == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+#ifdef PST_SNAPSHOT_MMAP
+	fd = open(fname, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	if (st.st_size < SNAPSHOT_HEADER_SIZE || (unsigned long)st.st_size > SNAPSHOT_MAX) {
+		res = PST_SNAPSHOT_INCOMPATIBLE;
+		goto cleanup;
+	}
+
+	/* Private writable mapping: pages are copied only if the values are modified. */
+	data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	tmp->data = (unsigned char*)data;
+	tmp->size = (size_t)st.st_size;
+	tmp->isMapped = 1;
+#else
+	file = fopen(fname, "rb");
+	if (file == NULL || fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+
+	if (size < SNAPSHOT_HEADER_SIZE || (unsigned long)size > SNAPSHOT_MAX) {
+		res = PST_SNAPSHOT_INCOMPATIBLE;
+		goto cleanup;
+	}
+
+	tmp->data = (unsigned char*)malloc((size_t)size);
+	if (tmp->data == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+	tmp->size = (size_t)size;
+
+	if (fread(tmp->data, 1, tmp->size, file) != tmp->size) {
+		res = PST_IO_ERROR;
+		goto cleanup;
+	}
+#endif
+
+	*snapshot = tmp;
+	tmp = NULL;
+	res = PST_OK;
+
+cleanup:
+
+#ifdef PST_SNAPSHOT_MMAP
+	if (fd >= 0) close(fd);
+#else
+	if (file != NULL) fclose(file);
+#endif
+	SNAPSHOT_free(tmp);
+
+	return res;
+}
+
+void SNAPSHOT_free(SNAPSHOT *snapshot) {
+	while (snapshot != NULL) {
+		SNAPSHOT *next = snapshot->next;
+
+#ifdef PST_SNAPSHOT_MMAP
+		if (snapshot->isMapped) munmap(snapshot->data, snapshot->size);
+		else free(snapshot->data);
+#else
+		free(snapshot->data);
+#endif
+		free(snapshot);
+		snapshot = next;
+	}
+}
+
+/**
+ * Returns a string from the string table or \c NULL. Validity of the string
+ * table (it ends with \c NULL) is checked before.
+ */
+static int snapshot_get_string(const unsigned char *strings, size_t strings_size, unsigned long offset, int allowNull, const char **str) {
+	if (offset == SNAPSHOT_NULL && allowNull) {
+		*str = NULL;
+		return PST_OK;
+	}
+
+	if (offset >= strings_size) return PST_SNAPSHOT_INCOMPATIBLE;
+
+	*str = (const char*)(strings + offset);
+	return PST_OK;
+}
+
+/**
+ * Removes the first \c linked values appended by #PARAM_SET_loadSnapshot, so the
+ * set is left unchanged when appending fails.
+ */
+static void snapshot_remove_values(const unsigned char *data, size_t param_count, PARAM **target, PARAM_VAL **values, size_t linked) {
+	size_t i;
+	size_t k;
+	size_t n = 0;
+
+	for (i = 0; i < param_count && n < linked; i++) {
+		size_t count = PST_getU32(data + SNAPSHOT_HEADER_SIZE + i * SNAPSHOT_PARAM_SIZE + 4);
+
+		for (k = 0; k < count && n < linked; k++, n++) {
+			PARAM_removeValue(target[i], values[n]);
+			values[n] = NULL;
+		}
+	}
+}
+
+int PARAM_SET_loadSnapshot(PARAM_SET *set, const char *fname) {
+	int res;
+	SNAPSHOT *snapshot = NULL;
+	const unsigned char *data = NULL;
+	const unsigned char *strings = NULL;
+	size_t param_count = 0;
+	size_t value_count = 0;
+	size_t strings_offset = 0;
+	size_t strings_size = 0;
+	size_t records_end = 0;
+	size_t total = 0;
+	size_t i = 0;
+	size_t n = 0;
+	PARAM **target = NULL;
+	PARAM_VAL **values = NULL;
+
+	if (set == NULL || fname == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	res = snapshot_open(fname, &snapshot);
+	if (res != PST_OK) goto cleanup;
+
+	/* Validate the header and the layout. */
+	data = snapshot->data;
+	if (memcmp(data, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) != 0 || PST_getU32(data + 8) != SNAPSHOT_VERSION) {
+		res = PST_SNAPSHOT_INCOMPATIBLE;
+		goto cleanup;
+	}
+
+	param_count = PST_getU32(data + 12);
+	value_count = PST_getU32(data + 16);
+	strings_offset = PST_getU32(data + 20);
+	strings_size = PST_getU32(data + 24);
+
+	if (param_count > snapshot->size / SNAPSHOT_PARAM_SIZE || value_count > snapshot->size / SNAPSHOT_VALUE_SIZE) {
+		res = PST_SNAPSHOT_INCOMPATIBLE;
+		goto cleanup;
+	}
+
+	records_end = SNAPSHOT_HEADER_SIZE + param_count * SNAPSHOT_PARAM_SIZE + value_count * SNAPSHOT_VALUE_SIZE;
+	if (strings_offset != records_end || strings_size > snapshot->size || strings_offset + strings_size != snapshot->size
+			|| (strings_size > 0 && data[snapshot->size - 1] != '\0')) {
+		res = PST_SNAPSHOT_INCOMPATIBLE;
+		goto cleanup;
+	}
+	strings = data + strings_offset;
+
+	/* Resolve the parameters before anything is changed. */
+	target = (PARAM**)calloc(param_count == 0 ? 1 : param_count, sizeof(*target));
+	values = (PARAM_VAL**)calloc(value_count == 0 ? 1 : value_count, sizeof(*values));
+	if (target == NULL || values == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+
+	for (i = 0; i < param_count; i++) {
+		const unsigned char *p = data + SNAPSHOT_HEADER_SIZE + i * SNAPSHOT_PARAM_SIZE;
+		const char *name = NULL;
+		int k;
+
+		res = snapshot_get_string(strings, strings_size, PST_getU32(p), 0, &name);
+		if (res != PST_OK) goto cleanup;
+
+		total += PST_getU32(p + 4);
+
+		/* Usually the set is defined the same way, so check the same position first. */
+		if (i < (size_t)set->count && strcmp(set->parameter[i]->flagName, name) == 0) {
+			target[i] = set->parameter[i];
+		} else {
+			for (k = 0; k < set->count; k++) {
+				if (strcmp(set->parameter[k]->flagName, name) == 0) {
+					target[i] = set->parameter[k];
+					break;
+				}
+			}
+		}
+
+		if (target[i] == NULL) {
+			res = PST_PARAMETER_NOT_FOUND;
+			goto cleanup;
+		}
+	}
+
+	if (total != value_count) {
+		res = PST_SNAPSHOT_INCOMPATIBLE;
+		goto cleanup;
+	}
+
+	/* Create values that refer to the strings in the snapshot. */
+	for (n = 0; n < value_count; n++) {
+		const unsigned char *p = data + SNAPSHOT_HEADER_SIZE + param_count * SNAPSHOT_PARAM_SIZE + n * SNAPSHOT_VALUE_SIZE;
+		const char *value = NULL;
+		const char *source = NULL;
+
+		res = snapshot_get_string(strings, strings_size, PST_getU32(p), 1, &value);
+		if (res != PST_OK) goto cleanup;
+
+		res = snapshot_get_string(strings, strings_size, PST_getU32(p + 4), 1, &source);
+		if (res != PST_OK) goto cleanup;
+
+		res = PARAM_VAL_newBorrowed(value, source, snapshot_get_i32(p + 8), &values[n]);
+		if (res != PST_OK) {
+			if (res == PST_PRIORITY_NEGATIVE || res == PST_PRIORITY_TOO_LARGE) res = PST_SNAPSHOT_INCOMPATIBLE;
+			goto cleanup;
+		}
+
+		values[n]->formatStatus = snapshot_get_i32(p + 12);
+		values[n]->contentStatus = snapshot_get_i32(p + 16);
+	}
+
+	n = 0;
+	for (i = 0; i < param_count; i++) {
+		size_t count = PST_getU32(data + SNAPSHOT_HEADER_SIZE + i * SNAPSHOT_PARAM_SIZE + 4);
+		size_t k;
+
+		for (k = 0; k < count; k++, n++) {
+			res = PARAM_appendValue(target[i], values[n]);
+			if (res != PST_OK) {
+				snapshot_remove_values(data, param_count, target, values, n);
+				goto cleanup;
+			}
+		}
+	}
+
+	/* The set keeps the snapshot until it is freed, as the values refer to it. */
+	snapshot->next = set->snapshot;
+	set->snapshot = snapshot;
+	snapshot = NULL;
+
+	for (n = 0; n < value_count; n++) values[n] = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	if (values != NULL) {
+		for (n = 0; n < value_count; n++) PARAM_VAL_free(values[n]);
+	}
+	free(values);
+	free(target);
+	SNAPSHOT_free(snapshot);
+
+	return res;
+}
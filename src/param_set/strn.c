@@ -23,6 +23,7 @@
 #include <limits.h>
 #include <ctype.h>
 #include "strn.h"
+#include "internal.h"
 
 
 static size_t param_set_vsnprintf(char *buf, size_t n, const char *format, va_list va){
@@ -73,6 +74,112 @@ cleanup:
 	return ret;
 }
 
+void PST_SINK_init(PST_SINK *sink, int (*write)(void *ctx, const char *data, size_t len), void *ctx) {
+	if (sink == NULL) return;
+	sink->write = write;
+	sink->ctx = ctx;
+	sink->buf = NULL;
+	sink->buf_len = 0;
+	sink->count = 0;
+	sink->err = PST_OK;
+}
+
+void PST_SINK_initBuffer(PST_SINK *sink, char *buf, size_t buf_len) {
+	if (sink == NULL) return;
+	PST_SINK_init(sink, NULL, NULL);
+	if (buf == NULL || buf_len == 0) return;
+	sink->buf = buf;
+	sink->buf_len = buf_len;
+	sink->buf[0] = '\0';
+}
+
+int PST_SINK_write(PST_SINK *sink, const char *data, size_t len) {
+	int res;
+
+	if (sink == NULL || (data == NULL && len > 0)) return PST_INVALID_ARGUMENT;
+	if (sink->err != PST_OK || len == 0) return sink->err;
+
+	if (sink->buf != NULL) {
+		/* Append as much as fits, the buffer is always NULL terminated. */
+		if (sink->count < sink->buf_len - 1) {
+			size_t free_space = sink->buf_len - 1 - sink->count;
+			size_t n = len < free_space ? len : free_space;
+
+			memcpy(sink->buf + sink->count, data, n);
+			sink->buf[sink->count + n] = '\0';
+		}
+	} else if (sink->write != NULL) {
+		res = sink->write(sink->ctx, data, len);
+		if (res != PST_OK) {
+			sink->err = res;
+			return res;
+		}
+	}
+
+	sink->count += len;
+	return PST_OK;
+}
+
+size_t PST_SINK_printf(PST_SINK *sink, const char *format, ...) {
+	va_list va;
+	char small[1024];
+	char *large = NULL;
+	char *str = small;
+	int len = 0;
+
+	if (sink == NULL || format == NULL || sink->err != PST_OK) return 0;
+
+	/* Most of the strings fit into the stack buffer, only the long ones are allocated. */
+	va_start(va, format);
+#ifdef _WIN32
+	len = _vscprintf(format, va);
+	va_end(va);
+	va_start(va, format);
+	if (len >= 0 && (size_t)len < sizeof(small)) vsnprintf_s(small, sizeof(small), _TRUNCATE, format, va);
+#else
+	len = vsnprintf(small, sizeof(small), format, va);
+#endif
+	va_end(va);
+
+	if (len < 0) {
+		sink->err = PST_INVALID_FORMAT;
+		return 0;
+	}
+
+	if ((size_t)len >= sizeof(small)) {
+		large = (char*)malloc((size_t)len + 1);
+		if (large == NULL) {
+			sink->err = PST_OUT_OF_MEMORY;
+			return 0;
+		}
+
+		va_start(va, format);
+#ifdef _WIN32
+		vsnprintf_s(large, (size_t)len + 1, _TRUNCATE, format, va);
+#else
+		vsnprintf(large, (size_t)len + 1, format, va);
+#endif
+		va_end(va);
+		str = large;
+	}
+
+	PST_SINK_write(sink, str, (size_t)len);
+	free(large);
+
+	return (sink->err == PST_OK) ? (size_t)len : 0;
+}
+
+int PST_SINK_isDone(const PST_SINK *sink) {
+	if (sink == NULL || sink->err != PST_OK) return 1;
+	return sink->buf != NULL && sink->count >= sink->buf_len - 1;
+}
+
+int PST_writeToFile(void *ctx, const char *data, size_t len) {
+	if (ctx == NULL || data == NULL) return PST_INVALID_ARGUMENT;
+	if (fwrite(data, 1, len, (FILE*)ctx) != len) return PST_IO_ERROR;
+	return PST_OK;
+}
+
 /**
  * This function is token parser for #PST_vsnhiprintf. It breaks string to words,
  * striping all whitespace (new line character is interpreted as individual token!).
@@ -178,29 +285,64 @@ static size_t parseNextToken(char *buf, size_t buf_len, const char *str, int* in
 	return n;
 }
 
-size_t PST_vsnhiprintf(char *buf, size_t buf_len, unsigned indent, unsigned headerLen, unsigned rowLen, const char *paramName, const char delimiter, const char *txt, va_list va) {
-	char *description = NULL;
-	int calculated = 0;
-	size_t current_row_len = 0;
+/**
+ * Returns the type of the token extracted by #parseNextToken (see
+ * #PST_HELP_TOKEN_TYPE_enum).
+ */
+static int hiprint_token_type(const char *word, size_t word_len, int indent, const char *next) {
+	if (next == NULL) return PST_HELP_TOKEN_END;
+	if (indent != -1) return PST_HELP_TOKEN_INDENT;
+	if (word_len > 0 && *word == '\n') return (*next != '\0') ? PST_HELP_TOKEN_BREAK : PST_HELP_TOKEN_NEWLINE;
+	return PST_HELP_TOKEN_WORD;
+}
+
+/**
+ * State of the help text renderer.
+ */
+typedef struct HIPRINT_st {
+	PST_SINK *sink;
+	unsigned indent;
+	unsigned rowLen;
+	size_t current_row_len;
+	size_t count;
+	int spaceNeeded;
+	int ioffs;
+} HIPRINT;
+
+static size_t hiprint_write(PST_SINK *sink, const char *str, size_t len) {
+	return (PST_SINK_write(sink, str, len) == PST_OK) ? len : 0;
+}
+
+static size_t hiprint_spaces(PST_SINK *sink, size_t n) {
+	static const char spaces[] = "                                ";
 	size_t count = 0;
+
+	while (n > 0) {
+		size_t len = n < sizeof(spaces) - 1 ? n : sizeof(spaces) - 1;
+		count += hiprint_write(sink, spaces, len);
+		n -= len;
+	}
+
+	return count;
+}
+
+static int hiprint_begin(HIPRINT *hp, PST_SINK *sink, unsigned indent, unsigned headerLen, unsigned rowLen, const char *paramName, const char delimiter) {
+	int calculated = 0;
 	size_t c = 0;
-	int spaceNeeded = 0;
-	const char *next = NULL;
-	int ioffs = 0;
 
-	if (buf == NULL || buf_len == 0 || txt == NULL ||
+	if (sink == NULL ||
 		(indent >= rowLen) ||
 		(indent >= headerLen && paramName != NULL) ||
 		(headerLen >= rowLen && paramName != NULL)) {
 		return 0;
 	}
 
-	/* Create buff value for preprocessing. */
-	description = (char*)malloc(buf_len * sizeof(*description));
-	if (description == NULL) return 0;
-
-	param_set_vsnprintf(description, buf_len, txt, va);
-	buf[buf_len - 1] = 0;
+	hp->sink = sink;
+	hp->rowLen = rowLen;
+	hp->current_row_len = 0;
+	hp->count = 0;
+	hp->spaceNeeded = 0;
+	hp->ioffs = 0;
 
 	if (headerLen > 0 && paramName != NULL) {
 		/* Get calculated size of the header, if it is too large insert a line break. */
@@ -208,79 +350,217 @@ size_t PST_vsnhiprintf(char *buf, size_t buf_len, unsigned indent, unsigned head
 		calculated = calculated < 0 ? 0 : calculated;
 
 		/* Print the header of the help row (indentation, parameter, delimiter and description. */
-		count += PST_snprintf(buf + count, buf_len - count, "%*s%s%*s", indent, "", paramName, calculated, "");
-		current_row_len = count;
-		if (current_row_len > (headerLen - 3)) {
-			c = PST_snprintf(buf + count, buf_len - count, "\n%*s %c ", headerLen - 3, "", delimiter);
-			count += c;
-			current_row_len = c - 1;
-			spaceNeeded = 0;
+		hp->count += PST_SINK_printf(sink, "%*s%s%*s", indent, "", paramName, calculated, "");
+		hp->current_row_len = hp->count;
+		if (hp->current_row_len > (headerLen - 3)) {
+			c = PST_SINK_printf(sink, "\n%*s %c ", headerLen - 3, "", delimiter);
+			hp->count += c;
+			hp->current_row_len = c - 1;
 		} else {
-			c = PST_snprintf(buf + count, buf_len - count, " %c ", delimiter);
-			current_row_len += c;
-			count += c;
-			spaceNeeded = 0;
+			c = PST_SINK_printf(sink, " %c ", delimiter);
+			hp->current_row_len += c;
+			hp->count += c;
 		}
-		indent = headerLen;
+		hp->indent = headerLen;
 	} else {
-		c = PST_snprintf(buf + count, buf_len - count, "%*s", indent, "");
-		current_row_len += c;
-		count += c;
-		spaceNeeded = 0;
+		c = hiprint_spaces(sink, indent);
+		hp->current_row_len += c;
+		hp->count += c;
+		hp->indent = indent;
 	}
 
+	return 1;
+}
+
+static void hiprint_token(HIPRINT *hp, int type, const char *word, size_t word_len, int offs) {
+	size_t c = 0;
+
+	switch (type) {
+		case PST_HELP_TOKEN_END:
+			/* Parse error is printed as it is. */
+			if (word_len != 0) hp->count += hiprint_write(hp->sink, word, word_len);
+			return;
+		case PST_HELP_TOKEN_INDENT:
+			hp->ioffs = offs;
+			if ((int)hp->indent + hp->ioffs < 0) hp->ioffs = -(int)hp->indent;
+			else if (hp->indent + hp->ioffs >= hp->rowLen) {
+				hp->ioffs = hp->rowLen - 1 - hp->indent;
+			}
+			return;
+		case PST_HELP_TOKEN_BREAK:
+			/**
+			 * If word is a new line character followed by more text, force the
+			 * print function to change the line and handle indentation.
+			 */
+			hp->spaceNeeded = 0;
+			hp->current_row_len = hp->rowLen + 1;
+			word = "";
+			word_len = 0;
+			break;
+		case PST_HELP_TOKEN_NEWLINE:
+			hp->spaceNeeded = 0;
+			break;
+		default:
+			break;
+	}
+
+	if (hp->current_row_len + word_len + (hp->spaceNeeded ? 1 : 0) > hp->rowLen) {
+		c = hiprint_write(hp->sink, "\n", 1);
+		c += hiprint_spaces(hp->sink, hp->indent + hp->ioffs);
+		c += hiprint_write(hp->sink, word, word_len);
+		hp->count += c;
+		hp->current_row_len = c - 1;
+		/* In case of empty string, the space is not needed. */
+		if (word_len > 0) hp->spaceNeeded = 1;
+		return;
+	}
+
+	c = hp->spaceNeeded ? hiprint_write(hp->sink, " ", 1) : 0;
+	c += hiprint_write(hp->sink, word, word_len);
+	hp->spaceNeeded = 1;
+	hp->current_row_len += c;
+	hp->count += c;
+}
+
+size_t PST_SINK_hiprint(PST_SINK *sink, unsigned indent, unsigned headerLen, unsigned rowLen, const char *paramName, const char delimiter, const char *description) {
+	HIPRINT hp;
+	const char *next = NULL;
+
+	if (description == NULL || !hiprint_begin(&hp, sink, indent, headerLen, rowLen, paramName, delimiter)) return 0;
 
 	next = description;
-	while (next != NULL) {
+	while (next != NULL && !PST_SINK_isDone(sink)) {
 		size_t word_len = 0;
 		char wordBuffer[1024];
 		int tmp_offs = -1;
 
 		word_len = parseNextToken(wordBuffer, sizeof(wordBuffer), next, &tmp_offs, &next);
-		if (next == NULL ) {
-			if (word_len != 0) count += PST_snprintf(buf + count, buf_len - count, "%s", wordBuffer);
-			break;
-		}
+		hiprint_token(&hp, hiprint_token_type(wordBuffer, word_len, tmp_offs, next), wordBuffer, word_len, tmp_offs);
+	}
 
-		if (tmp_offs != -1) {
-			ioffs = tmp_offs;
-			if ((int)indent + ioffs < 0) ioffs = -(int)indent;
-			else if (indent + ioffs >= rowLen) {
-				ioffs = rowLen - 1 -indent;
-			}
-			continue;
-		}
+	return hp.count;
+}
+
+int PST_HELP_TEXT_new(const char *txt, PST_HELP_TEXT **help) {
+	int res;
+	PST_HELP_TEXT *tmp = NULL;
+	const char *next = NULL;
+	char wordBuffer[1024];
+	size_t word_len = 0;
+	size_t pool_len = 0;
+	size_t count = 0;
+	size_t n = 0;
+	int pass;
 
-		/**
-		 * If word is a new line character, force the print function to change
-		 * the line and handle indentation.
-		 */
-		if (*wordBuffer == '\n') {
+	if (txt == NULL || help == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	tmp = (PST_HELP_TEXT*)malloc(sizeof(*tmp));
+	if (tmp == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
 
-			spaceNeeded = 0;
-			if (next != NULL && *next != '\0') {
-				current_row_len = rowLen + 1;
-				wordBuffer[0] = '\0';
+	tmp->token = NULL;
+	tmp->count = 0;
+	tmp->pool = NULL;
+
+	/* The first pass measures the tokens, the second one stores them. */
+	for (pass = 0; pass < 2; pass++) {
+		next = txt;
+		count = 0;
+		n = 0;
+
+		while (next != NULL) {
+			int tmp_offs = -1;
+
+			word_len = parseNextToken(wordBuffer, sizeof(wordBuffer), next, &tmp_offs, &next);
+			if (pass == 1) {
+				PST_HELP_TOKEN *token = &tmp->token[count];
+
+				memcpy(tmp->pool + n, wordBuffer, word_len);
+				tmp->pool[n + word_len] = '\0';
+				token->text = tmp->pool + n;
+				token->len = word_len;
+				token->type = hiprint_token_type(wordBuffer, word_len, tmp_offs, next);
+				token->indent = tmp_offs;
 			}
+
+			n += word_len + 1;
+			count++;
 		}
 
-		if (current_row_len + word_len + (spaceNeeded ? 1 : 0) > rowLen) {
-			c = PST_snprintf(buf + count, buf_len - count, "\n%*s%s", indent + ioffs, "", wordBuffer);
-			count += c;
-			current_row_len = c - 1;
-			/* In case of empty string, the space is not needed. */
-			if (wordBuffer[0] != '\0') spaceNeeded = 1;
-			continue;
+		if (pass == 0) {
+			pool_len = n;
+			tmp->token = (PST_HELP_TOKEN*)malloc(count * sizeof(PST_HELP_TOKEN));
+			tmp->pool = (char*)malloc(pool_len);
+			if (tmp->token == NULL || tmp->pool == NULL) {
+				res = PST_OUT_OF_MEMORY;
+				goto cleanup;
+			}
 		}
+	}
+
+	tmp->count = count;
+	*help = tmp;
+	tmp = NULL;
+	res = PST_OK;
+
+cleanup:
+
+	PST_HELP_TEXT_free(tmp);
+
+	return res;
+}
+
+void PST_HELP_TEXT_free(PST_HELP_TEXT *help) {
+	if (help == NULL) return;
+	free(help->token);
+	free(help->pool);
+	free(help);
+}
+
+size_t PST_SINK_hiprintTokens(PST_SINK *sink, unsigned indent, unsigned headerLen, unsigned rowLen, const char *paramName, const char delimiter, const PST_HELP_TEXT *help) {
+	HIPRINT hp;
+	size_t i;
 
-		c = PST_snprintf(buf + count, buf_len - count, "%s%s", spaceNeeded ? " " : "", wordBuffer);
-		spaceNeeded = 1;
-		current_row_len += c;
-		count += c;
+	if (help == NULL || !hiprint_begin(&hp, sink, indent, headerLen, rowLen, paramName, delimiter)) return 0;
+
+	for (i = 0; i < help->count && !PST_SINK_isDone(sink); i++) {
+		const PST_HELP_TOKEN *token = &help->token[i];
+		hiprint_token(&hp, token->type, token->text, token->len, token->indent);
 	}
 
-	if (description != NULL) free(description);
-	return count;
+	return hp.count;
+}
+
+size_t PST_vsnhiprintf(char *buf, size_t buf_len, unsigned indent, unsigned headerLen, unsigned rowLen, const char *paramName, const char delimiter, const char *txt, va_list va) {
+	char small[1024];
+	char *description = small;
+	PST_SINK sink;
+
+	if (buf == NULL || buf_len == 0 || txt == NULL ||
+		(indent >= rowLen) ||
+		(indent >= headerLen && paramName != NULL) ||
+		(headerLen >= rowLen && paramName != NULL)) {
+		return 0;
+	}
+
+	/* Short outputs are preformatted on the stack, only larger buffers need the heap. */
+	if (buf_len > sizeof(small)) {
+		description = (char*)malloc(buf_len * sizeof(*description));
+		if (description == NULL) return 0;
+	}
+
+	param_set_vsnprintf(description, buf_len, txt, va);
+
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	PST_SINK_hiprint(&sink, indent, headerLen, rowLen, paramName, delimiter, description);
+
+	if (description != small) free(description);
+	return (sink.count < buf_len) ? sink.count : buf_len - 1;
 }
 
 size_t PST_snhiprintf(char *buf, size_t buf_len, unsigned rowLen, unsigned indent, unsigned headerLen, const char *paramName, const char delimiter, const char *txt, ...) {
@@ -294,3 +574,14 @@ size_t PST_snhiprintf(char *buf, size_t buf_len, unsigned rowLen, unsigned inden
 	return count;
 }
 
+
+void PST_putU32(unsigned char *p, unsigned long v) {
+	p[0] = (unsigned char)(v & 0xff);
+	p[1] = (unsigned char)((v >> 8) & 0xff);
+	p[2] = (unsigned char)((v >> 16) & 0xff);
+	p[3] = (unsigned char)((v >> 24) & 0xff);
+}
+
+unsigned long PST_getU32(const unsigned char *p) {
+	return (unsigned long)p[0] | ((unsigned long)p[1] << 8) | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
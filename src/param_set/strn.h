@@ -186,6 +186,21 @@ size_t PST_snhiprintf(char *buf, size_t buf_len, unsigned rowLen, unsigned inden
  */
 size_t PST_vsnhiprintf(char *buf, size_t buf_len, unsigned indent, unsigned headerLen, unsigned rowLen, const char *paramName, const char delimiter, const char *txt, va_list va);
 
+/**
+ * Write callback for the streaming renderers (e.g. #PARAM_SET_helpToSink) that
+ * writes the output to a file.
+ *
+ * \code{.c}
+ * res = PARAM_SET_typosToSink(set, "Typo: ", PST_writeToFile, stderr, NULL);
+ * \endcode
+ *
+ * \param ctx	Pointer to \c FILE opened for writing.
+ * \param data	Data to be written.
+ * \param len	Size of the \c data.
+ * \return #PST_OK if successful, #PST_IO_ERROR if writing fails.
+ */
+int PST_writeToFile(void *ctx, const char *data, size_t len);
+
 /*
  * @}
  */
@@ -173,6 +173,8 @@ int TASK_DEFINITION_new(int id, const char *name, const char *man, const char *a
 	tmp->ignore = NULL;
 	tmp->toString = NULL;
 	tmp->isAnalyzed = 0;
+	tmp->analyzedSet = NULL;
+	tmp->analyzedVersion = 0;
 
 	/**
 	 * Initialize data structure.
@@ -247,7 +249,7 @@ int TASK_DEFINITION_analyzeConsistency(TASK_DEFINITION *def, PARAM_SET *set, dou
 		goto cleanup;
 	}
 
-	if (def->isAnalyzed) {
+	if (def->isAnalyzed && def->analyzedSet == set && def->analyzedVersion == set->changeCount) {
 		*cons = def->consistency;
 		res = PST_OK;
 		goto cleanup;
@@ -281,6 +283,8 @@ int TASK_DEFINITION_analyzeConsistency(TASK_DEFINITION *def, PARAM_SET *set, dou
 		def->isConsistent = 0;
 	}
 	def->isAnalyzed = 1;
+	def->analyzedSet = set;
+	def->analyzedVersion = set->changeCount;
 	*cons = def->consistency;
 
 	res = PST_OK;
@@ -419,18 +423,13 @@ char* TASK_DEFINITION_toString(TASK_DEFINITION *def, char *buf, size_t buf_len)
 	return buf;
 }
 
-char *TASK_DEFINITION_howToRepair_toString(TASK_DEFINITION *def, PARAM_SET *set, const char *prefix, char *buf, size_t buf_len) {
+static int task_definition_how_to_repair_to_sink(TASK_DEFINITION *def, PARAM_SET *set, const char *prefix, PST_SINK *sink) {
 	const char *pName = NULL;
 	int err_printed = 0;
-	size_t count = 0;
 	char name_buffer[1024];
 	const char *pref = NULL;
 
 
-	if (def == NULL || set == NULL || buf == NULL || buf_len == 0){
-		return NULL;
-	}
-
 	pref = (prefix == NULL) ? "" : prefix;
 
 	/**
@@ -441,18 +440,18 @@ char *TASK_DEFINITION_howToRepair_toString(TASK_DEFINITION *def, PARAM_SET *set,
 		if (strlen(name_buffer) == 0) continue;
 		if (!PARAM_SET_isSetByName(set, name_buffer)) {
 			if (!err_printed){
-				count += PST_snprintf(buf + count, buf_len - count, "%sYou have to define flag(s) '%s%s'",
+				PST_SINK_printf(sink, "%sYou have to define flag(s) '%s%s'",
 						pref,
 						strlen(name_buffer)>1 ? "--" : "-",
 						name_buffer);
 				err_printed = 1;
 			}
 			else{
-				count += PST_snprintf(buf + count, buf_len - count, ", '%s%s'", strlen(name_buffer)>1 ? "--" : "-", name_buffer);
+				PST_SINK_printf(sink, ", '%s%s'", strlen(name_buffer)>1 ? "--" : "-", name_buffer);
 			}
 		}
 	}
-	if (err_printed) count += PST_snprintf(buf + count, buf_len - count, ".\n");
+	if (err_printed) PST_SINK_printf(sink, ".\n");
 	/**
 	 * Error about AT LEAST ONE OF flags.
 	 */
@@ -461,17 +460,17 @@ char *TASK_DEFINITION_howToRepair_toString(TASK_DEFINITION *def, PARAM_SET *set,
 		pName = def->atleast_one;
 		while ((pName = category_extract_name(pName, name_buffer, sizeof(name_buffer), NULL)) != NULL){
 			if (!err_printed){
-				count += PST_snprintf(buf + count, buf_len - count, "%sYou have to define at least one of the flag(s) '%s%s'",
+				PST_SINK_printf(sink, "%sYou have to define at least one of the flag(s) '%s%s'",
 						pref,
 						strlen(name_buffer)>1 ? "--" : "-",
 						name_buffer);
 				err_printed = 1;
 			}
 			else{
-				count += PST_snprintf(buf + count, buf_len - count, ", '%s%s'", strlen(name_buffer)>1 ? "--" : "-", name_buffer);
+				PST_SINK_printf(sink, ", '%s%s'", strlen(name_buffer)>1 ? "--" : "-", name_buffer);
 			}
 		}
-		if (err_printed) count += PST_snprintf(buf + count, buf_len - count, ".\n");
+		if (err_printed) PST_SINK_printf(sink, ".\n");
 	}
 
 	/**
@@ -482,18 +481,31 @@ char *TASK_DEFINITION_howToRepair_toString(TASK_DEFINITION *def, PARAM_SET *set,
 	while ((pName = category_extract_name(pName, name_buffer, sizeof(name_buffer), NULL)) != NULL){
 		if (PARAM_SET_isSetByName(set, name_buffer)) {
 			if (!err_printed){
-				count += PST_snprintf(buf + count, buf_len - count, "%sYou must not use flag(s) '%s%s'",
+				PST_SINK_printf(sink, "%sYou must not use flag(s) '%s%s'",
 						pref,
 						strlen(name_buffer)>1 ? "--" : "-",
 						name_buffer);
 				err_printed = 1;
 			}
 			else{
-				count += PST_snprintf(buf + count, buf_len - count, ", '%s%s'", strlen(name_buffer)>1 ? "--" : "-", name_buffer);
+				PST_SINK_printf(sink, ", '%s%s'", strlen(name_buffer)>1 ? "--" : "-", name_buffer);
 			}
 		}
 	}
-	if (err_printed) PST_snprintf(buf + count, buf_len - count, ".\n");
+	if (err_printed) PST_SINK_printf(sink, ".\n");
+
+	return sink->err;
+}
+
+char *TASK_DEFINITION_howToRepair_toString(TASK_DEFINITION *def, PARAM_SET *set, const char *prefix, char *buf, size_t buf_len) {
+	PST_SINK sink;
+
+	if (def == NULL || set == NULL || buf == NULL || buf_len == 0){
+		return NULL;
+	}
+
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	if (task_definition_how_to_repair_to_sink(def, set, prefix, &sink) != PST_OK) return NULL;
 
 	return buf;
 }
@@ -557,6 +569,10 @@ int TASK_SET_new(TASK_SET **newObj) {
 	tmp->isAnalyzed = 0;
 	tmp->consistent_count = 0;
 	tmp->count = 0;
+	tmp->version = 0;
+	tmp->sensitivity = 0;
+	tmp->ref = NULL;
+	tmp->refCount = 0;
 
 	for (i = 0; i < TASK_DEFINITION_MAX_COUNT; i++) {
 		tmp->array[i] = NULL;
@@ -583,6 +599,7 @@ void TASK_SET_free(TASK_SET *task_set){
 			TASK_DEFINITION_free(task_set->array[i]);
 		}
 
+		free(task_set->ref);
 		free(task_set);
 	}
 }
@@ -606,6 +623,9 @@ int TASK_SET_add(TASK_SET *obj, int id, const char *name, const char *man, const
 
 	obj->isAnalyzed = 0;
 	obj->set_used = NULL;
+	free(obj->ref);
+	obj->ref = NULL;
+	obj->refCount = 0;
 
 	obj->array[obj->count] = tmp;
 	obj->count++;
@@ -620,104 +640,260 @@ cleanup:
 	return res;
 }
 
-int TASK_SET_analyzeConsistency(TASK_SET *task_set, PARAM_SET *set, double sensitivity){
-	int res;
-	size_t i = 0;
-	size_t j = 0;
-	double cons = 0;
-	double tmp_cons_small = 0;
-	int tmp_index_for_small = 0;
-	int smaller_index = -1;
-	int bigger_index = -1;
+static void task_set_add_refs(TASK_SET_REF *ref, size_t *count, const char *category, PARAM_SET *set, size_t task) {
+	const char *pName = category;
+	char buf[256];
+	PARAM *param = NULL;
+	size_t at;
+	size_t i;
 
+	while ((pName = category_extract_name(pName, buf, sizeof(buf), NULL)) != NULL) {
+		param = PARAM_SET_findParameter(set, buf);
+		if (param == NULL) continue;
 
-	if (task_set == NULL || set == NULL) {
-		res = PST_INVALID_ARGUMENT;
-		goto cleanup;
+		/* Insert after the last reference of the same parameter. */
+		at = *count;
+		for (i = 0; i < *count; i++) {
+			if (ref[i].param == param) at = i + 1;
+		}
+
+		memmove(ref + at + 1, ref + at, (*count - at) * sizeof(*ref));
+		ref[at].param = param;
+		ref[at].task = task;
+		(*count)++;
 	}
+}
 
-	task_set->isAnalyzed = 0;
-	task_set->consistent_count = 0;
+/**
+ * Collects the parameters that the consistency of the tasks depends on.
+ */
+static int task_set_refs_new(TASK_SET *task_set, PARAM_SET *set) {
+	TASK_SET_REF *tmp = NULL;
+	TASK_DEFINITION *def = NULL;
+	size_t count = 0;
+	size_t i;
 
-	if (task_set->count == 0) {
-		res = PST_TASK_SET_HAS_NO_DEFINITIONS;
-		goto cleanup;
+	for (i = 0; i < task_set->count; i++) {
+		def = task_set->array[i];
+		count += category_get_parameter_count(def->mandatory)
+				+ category_get_parameter_count(def->atleast_one)
+				+ category_get_parameter_count(def->forbitten);
 	}
 
-	if (task_set->set_used != NULL && task_set->set_used != set) {
-		res = PST_TASK_UNABLE_TO_ANALYZE_PARAM_SET_CHANGED;
-		goto cleanup;
+	tmp = (TASK_SET_REF*)malloc((count + 1) * sizeof(*tmp));
+	if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+	count = 0;
+	for (i = 0; i < task_set->count; i++) {
+		def = task_set->array[i];
+		task_set_add_refs(tmp, &count, def->mandatory, set, i);
+		task_set_add_refs(tmp, &count, def->atleast_one, set, i);
+		task_set_add_refs(tmp, &count, def->forbitten, set, i);
+	}
+
+	free(task_set->ref);
+	task_set->ref = tmp;
+	task_set->refCount = count;
+
+	return PST_OK;
+}
+
+/**
+ * Sorts the tasks by consistency, starting from more consistent (index == 0)
+ * and ending with less consistent. If consistency is very similar the order is
+ * analyzed in a more precise way. The tasks are inserted in the order they were
+ * added, each before the first task it is more consistent than, so equal tasks
+ * keep the order they were added in. Full and incremental analysis both use
+ * this order.
+ */
+static int task_set_sort(TASK_SET *task_set, PARAM_SET *set, double sensitivity) {
+	int res;
+	size_t i;
+	size_t j;
+	TASK_DEFINITION *def = NULL;
+	TASK_DEFINITION *A_j = NULL;
+	TASK_DEFINITION *Bigger = NULL;
+
+	for (i = 0; i < task_set->count; i++) {
+		def = task_set->array[i];
+
+		for (j = 0; j < i; j++) {
+			A_j = task_set->array[task_set->index[j]];
+
+			if (fabs(A_j->consistency - def->consistency) <= sensitivity) {
+				res = TASK_DEFINITION_getMoreConsistent(A_j, def, set, sensitivity, &Bigger);
+				if (res != PST_OK) return res;
+
+				if (Bigger == def) break;
+			} else if (A_j->consistency < def->consistency) {
+				break;
+			}
+		}
+
+		memmove(task_set->index + j + 1, task_set->index + j, (i - j) * sizeof(task_set->index[0]));
+		task_set->index[j] = i;
+	}
+
+	for (i = 0; i < task_set->count; i++) {
+		task_set->cons[i] = task_set->array[task_set->index[i]]->consistency;
 	}
 
+	return PST_OK;
+}
+
+/**
+ * Scores all the tasks and sorts them by consistency (see #task_set_sort).
+ */
+static int task_set_analyze_all(TASK_SET *task_set, PARAM_SET *set, double sensitivity, int *traced_phase) {
+	int res;
+	size_t i = 0;
+	double cons = 0;
+
+	task_set->consistent_count = 0;
 
 	/**
 	 * Analyze consistency.
 	 */
+	PST_trace(set, *traced_phase = PST_TRACE_TASK_SCORING, 0);
 	for (i = 0; i < task_set->count; i++) {
+		task_set->array[i]->isAnalyzed = 0;
 		res = TASK_DEFINITION_analyzeConsistency(task_set->array[i], set, &cons);
-		if (res != PST_OK) goto cleanup;
+		if (res != PST_OK) return res;
 
 		if (cons >= 1.0 || task_set->array[i]->isConsistent) {
 			task_set->consistent_count++;
 		}
-
-		task_set->cons[i] = cons;
-		task_set->index[i] = i;
 	}
 
+	PST_trace(set, PST_TRACE_TASK_SCORING, 1);
+
 	/**
-	 * Sort tasks consistency. Starting from more consistent (index == 0) and end
-	 * with less consistent. If consistency is very similar analyze the order
-	 * in more precise way.
+	 * Sort tasks consistency.
 	 */
+	PST_trace(set, *traced_phase = PST_TRACE_TASK_SORTING, 0);
+	return task_set_sort(task_set, set, sensitivity);
+}
+
+/**
+ * Scores again only the tasks that reference a parameter changed since the last
+ * analysis. The scores of the other tasks are still valid and are reused when
+ * the tasks are sorted again with #task_set_sort.
+ */
+static int task_set_analyze_changed(TASK_SET *task_set, PARAM_SET *set, double sensitivity, int *traced_phase) {
+	int res;
+	size_t i;
+	char isDirty[TASK_DEFINITION_MAX_COUNT];
+	PARAM *param = NULL;
+	int isParamChanged = 0;
+	TASK_DEFINITION *def = NULL;
+	double cons = 0;
+
+	memset(isDirty, 0, sizeof(isDirty));
+
+	/* References of the same parameter are together, check each parameter once. */
+	for (i = 0; i < task_set->refCount; i++) {
+		if (task_set->ref[i].param != param) {
+			param = task_set->ref[i].param;
+			isParamChanged = param->changed > task_set->version;
+		}
+		if (isParamChanged) isDirty[task_set->ref[i].task] = 1;
+	}
+
+	PST_trace(set, *traced_phase = PST_TRACE_TASK_SCORING, 0);
 	for (i = 0; i < task_set->count; i++) {
-		for (j = i + 1; j < task_set->count; j++) {
-			if (fabs(task_set->cons[i] - task_set->cons[j]) <= sensitivity) {
-				TASK_DEFINITION *A_i = task_set->array[task_set->index[i]];
-				TASK_DEFINITION *B_j = task_set->array[task_set->index[j]];
-				TASK_DEFINITION *Bigger = task_set->array[task_set->index[j]];
-
-				res = TASK_DEFINITION_getMoreConsistent(A_i, B_j, set, sensitivity, &Bigger);
-				if (res != PST_OK) goto cleanup;
-
-				if (Bigger == NULL || Bigger == A_i) {
-					smaller_index = -1;
-					bigger_index = -1;
-				} else if (Bigger == B_j) {
-					smaller_index = (int) i;
-					bigger_index = (int) j;
-				} else {
-					res = PST_UNDEFINED_BEHAVIOUR;
-					goto cleanup;
-				}
+		def = task_set->array[i];
 
-			} else if (task_set->cons[i] < task_set->cons[j]) {
-				smaller_index = (int) i;
-				bigger_index = (int) j;
-			} else {
-				smaller_index = -1;
-				bigger_index = -1;
-			}
+		if (!isDirty[i]) {
+			/* The result is still valid for the current state of the set. */
+			def->analyzedVersion = set->changeCount;
+			continue;
+		}
 
-			if (smaller_index >= 0 && bigger_index >= 0) {
-				tmp_cons_small = task_set->cons[smaller_index];
-				task_set->cons[i] = task_set->cons[bigger_index];
-				task_set->cons[j] = tmp_cons_small;
+		if (def->consistency >= 1.0 || def->isConsistent) {
+			task_set->consistent_count--;
+		}
 
-				tmp_index_for_small = (int) task_set->index[smaller_index];
-				task_set->index[i] = task_set->index[bigger_index];
-				task_set->index[j] = tmp_index_for_small;
+		def->isAnalyzed = 0;
+		res = TASK_DEFINITION_analyzeConsistency(def, set, &cons);
+		if (res != PST_OK) return res;
 
-			}
+		if (cons >= 1.0 || def->isConsistent) {
+			task_set->consistent_count++;
+		}
+	}
+
+	PST_trace(set, PST_TRACE_TASK_SCORING, 1);
+
+	PST_trace(set, *traced_phase = PST_TRACE_TASK_SORTING, 0);
+	return task_set_sort(task_set, set, sensitivity);
+}
+
+int TASK_SET_analyzeConsistency(TASK_SET *task_set, PARAM_SET *set, double sensitivity){
+	int res;
+	int traced_phase = 0;
+	int isIncremental = 0;
+
+
+	if (task_set == NULL || set == NULL) {
+		res = PST_INVALID_ARGUMENT;
+		goto cleanup;
+	}
+
+	/**
+	 * If the set is analyzed before, only the tasks that depend on the parameters
+	 * changed since then are analyzed again. Changes in the layers of the set
+	 * (see PARAM_SET_pushLayer) are not tracked.
+	 */
+	isIncremental = task_set->isAnalyzed && task_set->set_used == set && task_set->ref != NULL
+			&& set->layer == NULL && task_set->version >= set->allChanged
+			&& task_set->sensitivity == sensitivity;
+
+	task_set->isAnalyzed = 0;
+
+	if (task_set->count == 0) {
+		res = PST_TASK_SET_HAS_NO_DEFINITIONS;
+		goto cleanup;
+	}
+
+	if (task_set->set_used != NULL && task_set->set_used != set) {
+		res = PST_TASK_UNABLE_TO_ANALYZE_PARAM_SET_CHANGED;
+		goto cleanup;
+	}
+
+	if (isIncremental && task_set->version == set->changeCount) {
+		task_set->isAnalyzed = 1;
+		res = PST_OK;
+		goto cleanup;
+	}
+
+	PST_trace(set, PST_TRACE_ANALYZE_TASKS, 0);
+
+	if (isIncremental) {
+		res = task_set_analyze_changed(task_set, set, sensitivity, &traced_phase);
+		if (res != PST_OK) goto cleanup;
+	} else {
+		res = task_set_analyze_all(task_set, set, sensitivity, &traced_phase);
+		if (res != PST_OK) goto cleanup;
+
+		if (task_set->ref == NULL) {
+			res = task_set_refs_new(task_set, set);
+			if (res != PST_OK) goto cleanup;
 		}
 	}
 
 	task_set->isAnalyzed = 1;
 	task_set->set_used = set;
+	task_set->version = set->changeCount;
+	task_set->sensitivity = sensitivity;
 	res = PST_OK;
 
 cleanup:
 
+	if (traced_phase != 0) {
+		PST_trace(set, traced_phase, 1);
+		PST_trace(set, PST_TRACE_ANALYZE_TASKS, 1);
+	}
+
 	return res;
 }
 
@@ -775,10 +951,9 @@ int TASK_SET_getConsistentTask(TASK_SET *task_set, TASK **task) {
 	}
 
 	if (task_set->consistentTask != NULL) {
-		if (task_set->consistentTask->def != def_tmp) {
-			res = PST_UNDEFINED_BEHAVIOUR;
-			goto cleanup;
-		}
+		/* The consistent task may change when the set is analyzed again. */
+		task_set->consistentTask->def = def_tmp;
+		task_set->consistentTask->id = def_tmp->id;
 	} else {
 		res = TASK_new(def_tmp, task_set->set_used, &tmp);
 		if (res != PST_OK) goto cleanup;
@@ -856,46 +1031,85 @@ int TASK_SET_isOneFromSetTheTarget(TASK_SET *task_set, double diff, int *ID) {
 	return 1;
 }
 
-char* TASK_SET_howToRepair_toString(TASK_SET *task_set, PARAM_SET *set, int ID, const char *prefix, char *buf, size_t buf_len) {
+static int task_set_how_to_repair_to_sink(TASK_SET *task_set, PARAM_SET *set, int ID, const char *prefix, PST_SINK *sink) {
 	size_t i;
-	size_t count = 0;
-	char *tmp;
-
-	if (task_set == NULL || buf == NULL || buf_len == 0 || set == NULL) return NULL;
 
 	for (i = 0; i < task_set->count; i++) {
 		if (task_set->array[i]->id == ID) {
 			if (task_set->array[i]->isConsistent) {
-				count += PST_snprintf(buf + count, buf_len - count, "Task '%s' %s is OK.", task_set->array[i]->name, task_set->array[i]->toString);
+				PST_SINK_printf(sink, "Task '%s' %s is OK.", task_set->array[i]->name, task_set->array[i]->toString);
 			} else {
-				count += PST_snprintf(buf + count, buf_len - count, "Task '%s' %s is invalid:\n", task_set->array[i]->name, task_set->array[i]->toString);
-				tmp = TASK_DEFINITION_howToRepair_toString(task_set->array[i], set, prefix, buf + count, buf_len - count);
-
-				if (tmp == NULL) return NULL;
-				else return buf;
+				PST_SINK_printf(sink, "Task '%s' %s is invalid:\n", task_set->array[i]->name, task_set->array[i]->toString);
+				return task_definition_how_to_repair_to_sink(task_set->array[i], set, prefix, sink);
 			}
 
 		}
 	}
 
+	return sink->err;
+}
+
+char* TASK_SET_howToRepair_toString(TASK_SET *task_set, PARAM_SET *set, int ID, const char *prefix, char *buf, size_t buf_len) {
+	PST_SINK sink;
+
+	if (task_set == NULL || buf == NULL || buf_len == 0 || set == NULL) return NULL;
+
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	if (task_set_how_to_repair_to_sink(task_set, set, ID, prefix, &sink) != PST_OK) return NULL;
+
 	return buf;
 }
 
-char* TASK_SET_suggestions_toString(TASK_SET *task_set, int depth, char *buf, size_t buf_len) {
+int TASK_SET_howToRepairToSink(TASK_SET *task_set, PARAM_SET *set, int ID, const char *prefix, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count) {
+	int res;
+	PST_SINK sink;
+
+	if (task_set == NULL || set == NULL) return PST_INVALID_ARGUMENT;
+
+	PST_SINK_init(&sink, write, ctx);
+	res = task_set_how_to_repair_to_sink(task_set, set, ID, prefix, &sink);
+	if (count != NULL) *count = sink.count;
+
+	return res;
+}
+
+static int task_set_suggestions_to_sink(TASK_SET *task_set, int depth, PST_SINK *sink) {
 	size_t i;
 	int n;
-	size_t count = 0;
 	TASK_DEFINITION *tmp = NULL;
 
-	if (task_set == NULL || depth <= 0) return NULL;
-
 	for (i = 0, n = 0; i < task_set->count && n < depth; i++) {
 		tmp = task_set->array[task_set->index[i]];
 		if (!tmp->isConsistent) {
-			count += PST_snprintf(buf + count, buf_len - count, "Maybe you want to: %s %s\n", tmp->name, tmp->toString);
+			PST_SINK_printf(sink, "Maybe you want to: %s %s\n", tmp->name, tmp->toString);
 			n++;
+			if (PST_SINK_isDone(sink)) break;
 		}
 	}
 
+	return sink->err;
+}
+
+char* TASK_SET_suggestions_toString(TASK_SET *task_set, int depth, char *buf, size_t buf_len) {
+	PST_SINK sink;
+
+	if (task_set == NULL || depth <= 0 || buf == NULL || buf_len == 0) return NULL;
+
+	PST_SINK_initBuffer(&sink, buf, buf_len);
+	if (task_set_suggestions_to_sink(task_set, depth, &sink) != PST_OK) return NULL;
+
 	return buf;
 }
+
+int TASK_SET_suggestionsToSink(TASK_SET *task_set, int depth, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count) {
+	int res;
+	PST_SINK sink;
+
+	if (task_set == NULL || depth <= 0) return PST_INVALID_ARGUMENT;
+
+	PST_SINK_init(&sink, write, ctx);
+	res = task_set_suggestions_to_sink(task_set, depth, &sink);
+	if (count != NULL) *count = sink.count;
+
+	return res;
+}
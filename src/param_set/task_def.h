@@ -125,6 +125,13 @@ int TASK_SET_add(TASK_SET *task_set, int id, const char *name, const char *man,
  *   set_in_both - All parameter that are set in both A nd B.
  * \endcode
  *
+ * The analysis can be repeated after the values of \c set are changed. Only the
+ * tasks that refer to a parameter whose values are added or removed since the
+ * last analysis are analyzed again and moved to their new place in the order,
+ * the order of other tasks is kept. If \c sensitivity is changed or layers are
+ * pushed to \c set (see #PARAM_SET_pushLayer), all the tasks are analyzed again.
+ * A different #PARAM_SET can not be used.
+ *
  * \param task_set		#TASK_SET object.
  * \param set			#PARAM_SET object.
  * \param sensitivity	Analysis sensitivity.
@@ -135,7 +142,9 @@ int TASK_SET_analyzeConsistency(TASK_SET *task_set, PARAM_SET *set, double sensi
 
 /**
  * Extracts one single consistent task, the one that user wants to execute, from the #TASK_SET.
- * Before this #TASK_SET_analyzeConsistency must be called.
+ * Before this #TASK_SET_analyzeConsistency must be called. The same #TASK
+ * object is returned every time, if the consistent task changes after the set
+ * is analyzed again, the object is updated.
  * \param task_set		#TASK_SET object.
  * \param task			Pointer to receiving pointer to #TASK object.
  * \return #PST_OK if successful, error code otherwise. Some more common error
@@ -182,6 +191,17 @@ int TASK_SET_cleanIgnored(TASK_SET *task_set, TASK *task, int *removed);
  */
 char* TASK_SET_suggestions_toString(TASK_SET *task_set, int depth, char *buf, size_t buf_len);
 
+/**
+ * Streaming version of #TASK_SET_suggestions_toString (see #PARAM_SET_helpToSink).
+ * \param	task_set		#TASK_SET object.
+ * \param	depth			Maximum count of tasks displayed.
+ * \param	write			Write callback. If \c NULL, output is only counted.
+ * \param	ctx				Context for \c write.
+ * \param	count			Pointer to receiving count of bytes produced. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int TASK_SET_suggestionsToSink(TASK_SET *task_set, int depth, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count);
+
 /**
  * Generates suggestion message from pre-analyzed
  * #TASK_SET to help user figure out how to fix the task with \c ID
@@ -197,6 +217,19 @@ char* TASK_SET_suggestions_toString(TASK_SET *task_set, int depth, char *buf, si
  */
 char* TASK_SET_howToRepair_toString(TASK_SET *task_set, PARAM_SET *set, int ID, const char *prefix, char *buf, size_t buf_len);
 
+/**
+ * Streaming version of #TASK_SET_howToRepair_toString (see #PARAM_SET_helpToSink).
+ * \param	task_set		#TASK_SET object.
+ * \param	set				#PARAM_SET object.
+ * \param	ID				Tasks \c ID.
+ * \param	prefix			Prefix for the message. Can be \c NULL.
+ * \param	write			Write callback. If \c NULL, output is only counted.
+ * \param	ctx				Context for \c write.
+ * \param	count			Pointer to receiving count of bytes produced. Can be \c NULL.
+ * \return #PST_OK if successful, error code otherwise.
+ */
+int TASK_SET_howToRepairToSink(TASK_SET *task_set, PARAM_SET *set, int ID, const char *prefix, int (*write)(void *ctx, const char *data, size_t len), void *ctx, size_t *count);
+
 /**
  * Gets the #TASK \c ID.
  * \param task	#TASK object.
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include "param_set.h"
+#include "param_set_obj_impl.h"
+
+#ifndef _WIN32
+#  ifdef HAVE_CONFIG_H
+#    include "config.h"
+#  endif
+#endif
+
+#if defined(_WIN32)
+#  include <windows.h>
+#endif
+
+double PST_monotonicTime(void) {
+#if defined(_WIN32)
+	LARGE_INTEGER freq;
+	LARGE_INTEGER now;
+
+	if (QueryPerformanceFrequency(&freq) && QueryPerformanceCounter(&now)) {
+		return ((double)now.QuadPart * 1000000.0) / (double)freq.QuadPart;
+	}
+#elif defined(HAVE_CLOCK_GETTIME)
+	struct timespec now;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) {
+		return (double)now.tv_sec * 1000000.0 + (double)now.tv_nsec / 1000.0;
+	}
+#endif
+	/* Processor time is monotonic, but does not advance while waiting for I/O. */
+	return ((double)clock() * 1000000.0) / CLOCKS_PER_SEC;
+}
+
+void PST_trace(const PARAM_SET *set, int phase, int isEnd) {
+	if (set == NULL || set->trace == NULL) return;
+	set->trace(set->traceCtx, phase, isEnd, PST_monotonicTime());
+}
+
+int PARAM_SET_setTraceCallback(PARAM_SET *set, void (*trace)(void *ctx, int phase, int isEnd, double timestamp), void *ctx) {
+	if (set == NULL) return PST_INVALID_ARGUMENT;
+	set->trace = trace;
+	set->traceCtx = ctx;
+	return PST_OK;
+}
+
+const char* PARAM_SET_tracePhaseToString(int phase) {
+	switch (phase) {
+		case PST_TRACE_PARSE_CMD: return "PARAM_SET_parseCMD";
+		case PST_TRACE_TOKENIZE: return "tokenize";
+		case PST_TRACE_COLLECTORS: return "collectors";
+		case PST_TRACE_TYPOS: return "typo analysis";
+		case PST_TRACE_WILDCARDS: return "wildcard expansion";
+		case PST_TRACE_READ_FILE: return "PARAM_SET_readFromFile";
+		case PST_TRACE_FILE_IO: return "file I/O";
+		case PST_TRACE_FILE_PARSE: return "file parsing";
+		case PST_TRACE_VALIDATE: return "validation";
+		case PST_TRACE_ANALYZE_TASKS: return "TASK_SET_analyzeConsistency";
+		case PST_TRACE_TASK_SCORING: return "task scoring";
+		case PST_TRACE_TASK_SORTING: return "task sorting";
+		default: return "unknown";
+	}
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "param_set.h"
+#include "internal.h"
+
+#ifndef _WIN32
+#  ifdef HAVE_CONFIG_H
+#    include "config.h"
+#  endif
+#endif
+
+#if !defined(_WIN32) && defined(HAVE_SYS_INOTIFY_H)
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#  include <errno.h>
+#  define PST_WATCH_INOTIFY
+#endif
+
+typedef struct WATCH_FILE_st {
+	char *path;
+	const char *name;	/* File name in path. */
+	char *source;
+	int priority;
+	long size;
+	time_t mtime;
+	int wd;
+	int isDirty;
+} WATCH_FILE;
+
+struct WATCH_st {
+	WATCH_FILE *file;
+	size_t count;
+	size_t size;
+	int fd;
+};
+
+static char *new_string(const char *str) {
+	char *tmp = NULL;
+	if (str == NULL) return NULL;
+	tmp = (char*)malloc(strlen(str) + 1);
+	if (tmp == NULL) return NULL;
+	return strcpy(tmp, str);
+}
+
+static void watch_stat(WATCH_FILE *file) {
+	struct stat st;
+
+	if (stat(file->path, &st) == 0) {
+		file->size = (long)st.st_size;
+		file->mtime = st.st_mtime;
+	} else {
+		file->size = -1;
+		file->mtime = 0;
+	}
+}
+
+int WATCH_new(WATCH **watch) {
+	WATCH *tmp = NULL;
+
+	if (watch == NULL) return PST_INVALID_ARGUMENT;
+
+	tmp = (WATCH*)calloc(1, sizeof(*tmp));
+	if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+	tmp->fd = -1;
+#ifdef PST_WATCH_INOTIFY
+	/* If inotify can not be used, files are polled. */
+	tmp->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+	*watch = tmp;
+
+	return PST_OK;
+}
+
+void WATCH_free(WATCH *watch) {
+	size_t i;
+
+	if (watch == NULL) return;
+
+	for (i = 0; i < watch->count; i++) {
+		free(watch->file[i].path);
+		free(watch->file[i].source);
+	}
+
+#ifdef PST_WATCH_INOTIFY
+	if (watch->fd >= 0) close(watch->fd);
+#endif
+
+	free(watch->file);
+	free(watch);
+}
+
+int WATCH_add(WATCH *watch, const char *path, const char *source, int priority) {
+	WATCH_FILE *file = NULL;
+	const char *name = NULL;
+
+	if (watch == NULL || path == NULL) return PST_INVALID_ARGUMENT;
+
+	if (watch->count == watch->size) {
+		size_t new_size = (watch->size == 0) ? 4 : watch->size * 2;
+		WATCH_FILE *tmp = (WATCH_FILE*)realloc(watch->file, new_size * sizeof(*tmp));
+		if (tmp == NULL) return PST_OUT_OF_MEMORY;
+
+		watch->file = tmp;
+		watch->size = new_size;
+	}
+
+	file = &watch->file[watch->count];
+	memset(file, 0, sizeof(*file));
+	file->priority = priority;
+	file->wd = -1;
+	file->path = new_string(path);
+	file->source = new_string(source);
+	if (file->path == NULL || (source != NULL && file->source == NULL)) {
+		free(file->path);
+		free(file->source);
+		return PST_OUT_OF_MEMORY;
+	}
+
+	name = strrchr(file->path, '/');
+#ifdef _WIN32
+	if (strrchr(file->path, '\\') > name) name = strrchr(file->path, '\\');
+#endif
+	file->name = (name == NULL) ? file->path : name + 1;
+
+	watch_stat(file);
+
+#ifdef PST_WATCH_INOTIFY
+	/**
+	 * The directory is watched as editors usually replace the file. If the
+	 * watch can not be added, the file is polled.
+	 */
+	if (watch->fd >= 0) {
+		char *dir = new_string(file->path);
+
+		if (dir == NULL) {
+			free(file->path);
+			free(file->source);
+			return PST_OUT_OF_MEMORY;
+		}
+
+		if (file->name == file->path) {
+			strcpy(dir, ".");
+		} else {
+			dir[file->name - file->path - 1] = '\0';
+			if (dir[0] == '\0') strcpy(dir, "/");
+		}
+
+		file->wd = inotify_add_watch(watch->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+		free(dir);
+	}
+#endif
+
+	watch->count++;
+
+	return PST_OK;
+}
+
+int WATCH_getDescriptor(const WATCH *watch) {
+	size_t i;
+
+	if (watch == NULL || watch->fd < 0) return -1;
+
+	/* Descriptor is useless if some of the files must be polled. */
+	for (i = 0; i < watch->count; i++) {
+		if (watch->file[i].wd < 0) return -1;
+	}
+
+	return watch->fd;
+}
+
+#ifdef PST_WATCH_INOTIFY
+static void watch_read_events(WATCH *watch) {
+	char buf[4096];
+	ssize_t len;
+	size_t i;
+
+	while ((len = read(watch->fd, buf, sizeof(buf))) > 0) {
+		char *p = buf;
+
+		while (p < buf + len) {
+			struct inotify_event *ev = (struct inotify_event*)(void*)p;
+
+			for (i = 0; i < watch->count; i++) {
+				WATCH_FILE *file = &watch->file[i];
+
+				if ((ev->mask & IN_Q_OVERFLOW)
+						|| (file->wd == ev->wd && ev->len > 0 && strcmp(file->name, ev->name) == 0)) {
+					file->isDirty = 1;
+				}
+			}
+
+			p += sizeof(struct inotify_event) + ev->len;
+		}
+	}
+}
+#endif
+
+void WATCH_collect(WATCH *watch) {
+	size_t i;
+
+	if (watch == NULL) return;
+
+#ifdef PST_WATCH_INOTIFY
+	if (watch->fd >= 0) watch_read_events(watch);
+#endif
+
+	for (i = 0; i < watch->count; i++) {
+		WATCH_FILE *file = &watch->file[i];
+		long size = file->size;
+		time_t mtime = file->mtime;
+
+		if (file->wd >= 0) continue;
+
+		watch_stat(file);
+		if (file->size != size || file->mtime != mtime) file->isDirty = 1;
+	}
+}
+
+int WATCH_popChanged(WATCH *watch, const char **path, const char **source, int *priority) {
+	size_t i;
+
+	if (watch == NULL) return 0;
+
+	for (i = 0; i < watch->count; i++) {
+		WATCH_FILE *file = &watch->file[i];
+
+		if (!file->isDirty) continue;
+
+		file->isDirty = 0;
+		*path = file->path;
+		*source = file->source;
+		*priority = file->priority;
+		return 1;
+	}
+
+	return 0;
+}
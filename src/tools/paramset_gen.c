@@ -0,0 +1,216 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+/**
+ * paramset-gen compiles the parameter specification of #PARAM_SET_new into
+ * C source that defines a constant #PARAM_SET_SPEC. The generated spec is
+ * given to #PARAM_SET_newFromSpec, so that the specification is not parsed
+ * and the name lookup table is not built at runtime.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "param_set.h"
+
+static void print_usage(FILE *f, const char *name) {
+	fprintf(f,
+			"Usage:\n"
+			"  %s [-n <name>] [-o <file.c>] [-H <file.h>] <spec>\n"
+			"\n"
+			"  -n <name>  Name of the generated PARAM_SET_SPEC variable (default param_set_spec).\n"
+			"  -o <file>  Output file for the C source (default standard output).\n"
+			"  -H <file>  Output file for the header declaring the variable.\n"
+			"  <spec>     Parameter names as given to PARAM_SET_new, e.g. \"{h|help}{i}{o}\".\n",
+			name);
+}
+
+static int is_valid_name(const char *name) {
+	const char *p = name;
+
+	if (*p == '\0' || (*p >= '0' && *p <= '9')) return 0;
+
+	for (; *p != '\0'; p++) {
+		if (!((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') || *p == '_')) return 0;
+	}
+
+	return 1;
+}
+
+static void print_c_string(FILE *f, const char *str) {
+	if (str == NULL) {
+		fprintf(f, "NULL");
+		return;
+	}
+
+	fputc('"', f);
+	for (; *str != '\0'; str++) {
+		if (*str == '"' || *str == '\\') fprintf(f, "\\%c", *str);
+		else if ((unsigned char)*str < 0x20 || (unsigned char)*str >= 0x7f) fprintf(f, "\\%03o", (unsigned char)*str);
+		else fputc(*str, f);
+	}
+	fputc('"', f);
+}
+
+static int write_source(FILE *f, const char *name, const char *spec_str, const PARAM_SET_SPEC *spec) {
+	int i;
+	unsigned n;
+
+	fprintf(f, "/* Generated by paramset-gen from:\n *   ");
+	for (i = 0; spec_str[i] != '\0'; i++) {
+		/* Do not let the spec terminate the comment. */
+		if (spec_str[i] == '*' && spec_str[i + 1] == '/') fprintf(f, "* ");
+		else fputc(spec_str[i], f);
+	}
+	fprintf(f, "\n * Do not edit. */\n\n");
+	fprintf(f, "#include <param_set/param_set.h>\n\n");
+
+	fprintf(f, "static const PARAM_SET_SPEC_PARAM %s_param[%d] = {\n", name, spec->count > 0 ? spec->count : 1);
+	for (i = 0; i < spec->count; i++) {
+		fprintf(f, "\t{");
+		print_c_string(f, spec->param[i].name);
+		fprintf(f, ", ");
+		print_c_string(f, spec->param[i].alias);
+		fprintf(f, ", 0x%x, 0x%x},\n", (unsigned)spec->param[i].constraints, (unsigned)spec->param[i].parsingOptions);
+	}
+	if (spec->count == 0) fprintf(f, "\t{NULL, NULL, 0, 0}\n");
+	fprintf(f, "};\n\n");
+
+	fprintf(f, "static const unsigned short %s_displace[%u] = {", name, spec->bucketCount);
+	for (n = 0; n < spec->bucketCount; n++) {
+		fprintf(f, "%s%u", (n % 16 == 0) ? "\n\t" : " ", (unsigned)spec->displace[n]);
+		if (n + 1 < spec->bucketCount) fputc(',', f);
+	}
+	fprintf(f, "\n};\n\n");
+
+	fprintf(f, "static const short %s_hash[%u] = {", name, spec->hashSize);
+	for (n = 0; n < spec->hashSize; n++) {
+		fprintf(f, "%s%d", (n % 16 == 0) ? "\n\t" : " ", (int)spec->hash[n]);
+		if (n + 1 < spec->hashSize) fputc(',', f);
+	}
+	fprintf(f, "\n};\n\n");
+
+	fprintf(f, "const PARAM_SET_SPEC %s = {\n", name);
+	fprintf(f, "\t%d,\n", PARAM_SET_SPEC_VERSION);
+	fprintf(f, "\t%d,\n", spec->count);
+	fprintf(f, "\t%s_param,\n", name);
+	fprintf(f, "\t%luUL,\n", spec->seed);
+	fprintf(f, "\t%u,\n", spec->bucketCount);
+	fprintf(f, "\t%s_displace,\n", name);
+	fprintf(f, "\t%u,\n", spec->hashSize);
+	fprintf(f, "\t%s_hash\n", name);
+	fprintf(f, "};\n");
+
+	return ferror(f) ? 1 : 0;
+}
+
+static int write_header(FILE *f, const char *name) {
+	fprintf(f, "/* Generated by paramset-gen. Do not edit. */\n\n");
+	fprintf(f, "#ifndef PARAMSET_GEN_%s_H\n", name);
+	fprintf(f, "#define PARAMSET_GEN_%s_H\n\n", name);
+	fprintf(f, "#include <param_set/param_set.h>\n\n");
+	fprintf(f, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+	fprintf(f, "extern const PARAM_SET_SPEC %s;\n\n", name);
+	fprintf(f, "#ifdef __cplusplus\n}\n#endif\n\n");
+	fprintf(f, "#endif\n");
+
+	return ferror(f) ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+	int res;
+	int exit_code = 1;
+	const char *name = "param_set_spec";
+	const char *out_file = NULL;
+	const char *header_file = NULL;
+	const char *spec_str = NULL;
+	PARAM_SET_SPEC *spec = NULL;
+	FILE *out = NULL;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "-H") == 0) && i + 1 < argc) {
+			if (argv[i][1] == 'n') name = argv[i + 1];
+			else if (argv[i][1] == 'o') out_file = argv[i + 1];
+			else header_file = argv[i + 1];
+			i++;
+		} else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+			print_usage(stdout, argv[0]);
+			return 0;
+		} else if (argv[i][0] != '-' && spec_str == NULL) {
+			spec_str = argv[i];
+		} else {
+			print_usage(stderr, argv[0]);
+			return 1;
+		}
+	}
+
+	if (spec_str == NULL) {
+		print_usage(stderr, argv[0]);
+		return 1;
+	}
+
+	if (!is_valid_name(name)) {
+		fprintf(stderr, "Error: '%s' is not a valid C identifier.\n", name);
+		return 1;
+	}
+
+	res = PARAM_SET_SPEC_new(spec_str, &spec);
+	if (res != PST_OK) {
+		fprintf(stderr, "Error: Unable to compile the spec: %s.\n", PARAM_SET_errorToString(res));
+		goto cleanup;
+	}
+
+	out = (out_file != NULL) ? fopen(out_file, "w") : stdout;
+	if (out == NULL) {
+		fprintf(stderr, "Error: Unable to open '%s'.\n", out_file);
+		goto cleanup;
+	}
+
+	if (write_source(out, name, spec_str, spec) != 0) {
+		fprintf(stderr, "Error: Unable to write the source.\n");
+		goto cleanup;
+	}
+
+	if (header_file != NULL) {
+		FILE *h = fopen(header_file, "w");
+
+		if (h == NULL) {
+			fprintf(stderr, "Error: Unable to open '%s'.\n", header_file);
+			goto cleanup;
+		}
+
+		res = write_header(h, name);
+		if (fclose(h) != 0) res = 1;
+
+		if (res != 0) {
+			fprintf(stderr, "Error: Unable to write the header.\n");
+			goto cleanup;
+		}
+	}
+
+	exit_code = 0;
+
+cleanup:
+
+	if (out != NULL && out != stdout && fclose(out) != 0) exit_code = 1;
+	PARAM_SET_SPEC_free(spec);
+
+	return exit_code;
+}
@@ -775,6 +775,38 @@ static void Test_command_line_check_for_highest_priority_last_element_errors(CuT
 	PARAM_SET_free(set);
 }
 
+static void Test_command_line_lazy_control_skips_shadowed_values(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	char *argv[] = {
+		"<path>", "-i", "a", "-i", "b", "-i", "c", NULL};
+	int argc = 0;
+	PARAM_VAL *value = NULL;
+
+	while (argv[argc] != NULL) argc++;
+
+	res = PARAM_SET_new("{i}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_addControl(set,"{i}", control_format_i_j, NULL, NULL, NULL);
+	res += PARAM_SET_setParseOptions(set, "{i}", PST_PRSCMD_FORMAT_CONTROL_ONLY_FOR_LAST_HIGHST_PRIORITY_VALUE | PST_PRSCMD_DEFAULT);
+	res += PARAM_SET_setControlOptions(set, "{i}", PST_CONTROL_LAZY);
+	CuAssert(tc, "Unable to configure parameter set.", res == PST_OK);
+
+	res = PARAM_SET_parseCMD(set, argc, argv, NULL, 3);
+	CuAssert(tc, "Unable to parse command line.", res == PST_OK);
+
+	CuAssert(tc, "There should not be format errors.", PARAM_SET_isFormatOK(set) == 1);
+
+	/* Shadowed values must be left unchecked. */
+	value = set->parameter[0]->arg;
+	CuAssert(tc, "Value 'a' must not be checked.", value->isPending && value->formatStatus == 0);
+	CuAssert(tc, "Value 'b' must not be checked.", value->next->isPending && value->next->formatStatus == 0);
+	CuAssert(tc, "Value 'c' must be checked.", !value->next->next->isPending);
+
+	PARAM_SET_free(set);
+}
+
 static void Test_command_line_parameter_with_value_in_the_end_2(CuTest* tc) {
 	int res;
 	PARAM_SET *set = NULL;
@@ -1003,6 +1035,41 @@ static void Test_expand_WC_on_CMD_WC_configured_WC_as_input(CuTest* tc) {
 	PARAM_SET_free(set);
 }
 
+static void Test_expand_WC_on_CMD_WC_configured_no_value(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	char *data[] = {
+		"fbg", "xzy", NULL};
+	char *argv[] = {
+		"<path>", "-i", "-i", "f?g", NULL};
+	int argc = 0;
+	int count = 0;
+
+	while (argv[argc] != NULL) argc++;
+
+	res = PARAM_SET_new("{i}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_setParseOptions(set, "{i}", PST_PRSCMD_DEFAULT | PST_PRSCMD_EXPAND_WILDCARD);
+	CuAssert(tc, "Unable to set parameter set command line parsing options.", res == PST_OK);
+
+	res = PARAM_SET_setWildcardExpander(set, "i", NULL, data, NULL, expand_wildcard_len2str);
+	CuAssert(tc, "Unable to configure wildcard expander.", res == PST_OK);
+
+	/* The flag without a value is not expanded. */
+	res = PARAM_SET_parseCMD(set, argc, argv, NULL, 3);
+	CuAssert(tc, "Unable to parse command line.", res == PST_OK);
+
+	res = PARAM_SET_getValueCount(set, "{i}", NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Unable to count values set from cmd.", res == PST_OK);
+	CuAssert(tc, "Invalid value count.", count == 2);
+
+	assert_value(tc, set, "i", 0, __FILE__, __LINE__, NULL, 0);
+	assert_value(tc, set, "i", 1, __FILE__, __LINE__, "fbg", 0);
+
+	PARAM_SET_free(set);
+}
+
 static void Test_param_set_collect_befor_and_after_parsing_is_closed(CuTest* tc) {
 	int res;
 	PARAM_SET *set = NULL;
@@ -1141,8 +1208,10 @@ CuSuite* Command_LineTest_getSuite(void) {
 	SUITE_ADD_TEST(suite, Test_command_last_value_after_flag_type_parameteter);
 	SUITE_ADD_TEST(suite, Test_command_test_1);
 	SUITE_ADD_TEST(suite, Test_command_line_check_for_highest_priority_last_element_errors);
+	SUITE_ADD_TEST(suite, Test_command_line_lazy_control_skips_shadowed_values);
 	SUITE_ADD_TEST(suite, Test_expand_WC_on_CMD_WC_not_configured_no_WC_input);
 	SUITE_ADD_TEST(suite, Test_expand_WC_on_CMD_WC_configured_WC_as_input);
+	SUITE_ADD_TEST(suite, Test_expand_WC_on_CMD_WC_configured_no_value);
 	SUITE_ADD_TEST(suite, Test_param_set_collect_befor_and_after_parsing_is_closed);
 	SUITE_ADD_TEST(suite, Test_param_set_collectors_without_the_flag);
 	SUITE_ADD_TEST(suite, Test_parsing_is_closed_by_double_dash_first_double_dash_is_always_bound_with_parameter_next_generates_break_1);
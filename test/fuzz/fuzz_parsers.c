@@ -0,0 +1,414 @@
+/*
+ * Copyright 2013-2017 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+/**
+ * Algorithmic complexity fuzz target for the parsers. Every input is given to
+ * #parse_key_value_pair (line by line), #PARAM_SET_readFromFile (as the content
+ * of the configuration file) and #PARAM_SET_parseCMD (split into tokens by
+ * white space), followed by value access by index and task analysis.
+ *
+ * The work is measured with the counters of #PARAM_SET_getStats and with the
+ * processor time, once for the input and once for the input repeated
+ * #FUZZ_SCALE times. If the work or the time per input byte of the longer run
+ * grows more than PST_FUZZ_MAX_GROWTH times (2 by default), the cost of the
+ * input is superlinear and the input is saved into the current directory (or
+ * PST_FUZZ_ARTIFACT_DIR) as slow-<hash>.bin. Inputs that can not be repeated
+ * within #FUZZ_MAX_LEN are not measured.
+ *
+ * Build with -DPST_FUZZ_LIBFUZZER and -fsanitize=fuzzer to get a libFuzzer
+ * target. Otherwise the standalone driver runs every file given on the command
+ * line (or standard input) once and exits with 1 if any of the inputs was slow.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "param_set.h"
+#include "task_def.h"
+#include "param_value.h"
+#include "strn.h"
+
+#ifdef _WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+/** Default growth of the cost per byte allowed when the input is repeated. */
+#define FUZZ_MAX_GROWTH 2.0
+
+/** Count of times the input is repeated for the longer run. */
+#define FUZZ_SCALE 4
+
+/** Inputs shorter than this are measured as if they had this length. */
+#define FUZZ_MIN_LEN 64
+
+/** Processor time of the longer run below this (in microseconds) is too noisy to compare. */
+#define FUZZ_MIN_USEC 2000.0
+
+/** Inputs longer than this are ignored. */
+#define FUZZ_MAX_LEN 0x10000
+
+static char fuzz_conf_name[1024];
+static double fuzz_max_growth = FUZZ_MAX_GROWTH;
+
+/**
+ * Replaces the first wildcard character with 'a' and 'b' and inserts the
+ * results after the value.
+ */
+static int fuzz_expand_wildcard(PARAM_VAL *param_value, void *ctx, int *value_shift) {
+	int res;
+	const char *input = NULL;
+	const char *src = NULL;
+	int prio = 0;
+	char *str = NULL;
+	char *wc = NULL;
+	PARAM_VAL *tmp = NULL;
+	int i;
+
+	(void)ctx;
+
+	res = PARAM_VAL_extract(param_value, &input, &src, &prio);
+	if (res != PST_OK) goto cleanup;
+
+	str = (char*)malloc(strlen(input) + 1);
+	if (str == NULL) {
+		res = PST_OUT_OF_MEMORY;
+		goto cleanup;
+	}
+	strcpy(str, input);
+	wc = strpbrk(str, "*?");
+
+	for (i = 0; i < 2; i++) {
+		if (wc != NULL) *wc = (char)('a' + i);
+
+		res = PARAM_VAL_new(str, src, prio, &tmp);
+		if (res != PST_OK) goto cleanup;
+
+		res = PARAM_VAL_insert(param_value, NULL, PST_PRIORITY_NONE, i, tmp);
+		if (res != PST_OK) goto cleanup;
+		tmp = NULL;
+	}
+
+	*value_shift = 2;
+	res = PST_OK;
+
+cleanup:
+
+	PARAM_VAL_free(tmp);
+	free(str);
+
+	return res;
+}
+
+static int fuzz_write_file(const char *fname, const unsigned char *data, size_t size) {
+	FILE *f = NULL;
+	int ret = 0;
+
+	f = fopen(fname, "wb");
+	if (f == NULL) return 0;
+	if (size > 0 && fwrite(data, 1, size, f) != size) ret = 0;
+	else ret = 1;
+	if (fclose(f) != 0) ret = 0;
+
+	return ret;
+}
+
+static void fuzz_save_slow_input(const unsigned char *data, size_t size, double work_growth, double usec_growth) {
+	char fname[1024];
+	const char *dir = getenv("PST_FUZZ_ARTIFACT_DIR");
+	unsigned long hash = 2166136261UL;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash = (hash * 16777619UL) & 0xffffffffUL;
+	}
+
+	PST_snprintf(fname, sizeof(fname), "%s%sslow-%08lx.bin", dir != NULL ? dir : "", dir != NULL ? "/" : "", hash);
+	fprintf(stderr, "fuzz-parsers: %lu bytes, cost per byte grows %.1f times (operations) and %.1f times (time): saved as %s\n",
+			(unsigned long)size, work_growth, usec_growth, fname);
+
+	if (!fuzz_write_file(fname, data, size)) {
+		fprintf(stderr, "fuzz-parsers: unable to write %s\n", fname);
+	}
+}
+
+static void fuzz_init(void) {
+	const char *env = NULL;
+
+	env = getenv("PST_FUZZ_MAX_GROWTH");
+	if (env != NULL) fuzz_max_growth = strtod(env, NULL);
+
+#ifdef _WIN32
+	PST_snprintf(fuzz_conf_name, sizeof(fuzz_conf_name), "pst-fuzz-%d.conf", _getpid());
+#else
+	PST_snprintf(fuzz_conf_name, sizeof(fuzz_conf_name), "%s/pst-fuzz-%ld.conf",
+			getenv("TMPDIR") != NULL ? getenv("TMPDIR") : "/tmp", (long)getpid());
+#endif
+}
+
+static PARAM_SET *fuzz_new_set(void) {
+	int res;
+	PARAM_SET *set = NULL;
+
+	res = PARAM_SET_new("{h|help}{i|input}*{o|output}>{v}*{x|expand}*{log}{c|conf}{d|dump}*", &set);
+	if (res != PST_OK) return NULL;
+
+	res = PARAM_SET_setParseOptions(set, "{i}", PST_PRSCMD_HAS_VALUE | PST_PRSCMD_COLLECT_LOOSE_VALUES);
+	if (res == PST_OK) res = PARAM_SET_setParseOptions(set, "{x}", PST_PRSCMD_HAS_VALUE | PST_PRSCMD_EXPAND_WILDCARD);
+	if (res == PST_OK) res = PARAM_SET_setParseOptions(set, "{h}{v}", PST_PRSCMD_HAS_NO_VALUE);
+	if (res == PST_OK) res = PARAM_SET_setWildcardExpander(set, "{x}", NULL, NULL, NULL, fuzz_expand_wildcard);
+	if (res != PST_OK) {
+		PARAM_SET_free(set);
+		return NULL;
+	}
+
+	return set;
+}
+
+/**
+ * Reads every value by index, the way most applications do.
+ */
+static void fuzz_read_values(PARAM_SET *set) {
+	const char *names[] = {"i", "o", "v", "x", "log", "c", "d", NULL};
+	char *value = NULL;
+	int count = 0;
+	int i;
+	int n;
+
+	for (n = 0; names[n] != NULL; n++) {
+		if (PARAM_SET_getValueCount(set, names[n], NULL, PST_PRIORITY_NONE, &count) != PST_OK) continue;
+
+		for (i = 0; i < count; i++) {
+			PARAM_SET_getStr(set, names[n], NULL, PST_PRIORITY_NONE, i, &value);
+		}
+	}
+}
+
+static void fuzz_analyze_tasks(PARAM_SET *set) {
+	TASK_SET *tasks = NULL;
+
+	if (TASK_SET_new(&tasks) != PST_OK) return;
+
+	TASK_SET_add(tasks, 0, "Help", "h", NULL, NULL, NULL);
+	TASK_SET_add(tasks, 1, "Convert", "i,o", "v,log", "x", NULL);
+	TASK_SET_add(tasks, 2, "Expand", "x,o", NULL, "i", "v");
+	TASK_SET_add(tasks, 3, "Dump", "d", "c,log", NULL, NULL);
+	TASK_SET_add(tasks, 4, "Config", "c", NULL, "h", NULL);
+
+	TASK_SET_analyzeConsistency(tasks, set, 0.2);
+
+	TASK_SET_free(tasks);
+}
+
+/**
+ * Runs the input through the parsers and returns the count of the counted
+ * operations.
+ */
+static unsigned long fuzz_run(const unsigned char *data, size_t size) {
+	PARAM_SET *set = NULL;
+	PARAM_SET_STATS stats;
+	char *text = NULL;
+	char **argv = NULL;
+	char key[1024];
+	char value[1024];
+	char *p = NULL;
+	char *line = NULL;
+	int argc = 0;
+	unsigned long work = 0;
+
+	set = fuzz_new_set();
+	if (set == NULL) goto cleanup;
+
+	text = (char*)malloc(size + 1);
+	if (text == NULL) goto cleanup;
+	memcpy(text, data, size);
+	text[size] = '\0';
+
+	/* Tokens are separated, so there are at most (size + 1) / 2 of them. */
+	argv = (char**)malloc((size / 2 + 3) * sizeof(*argv));
+	if (argv == NULL) goto cleanup;
+
+	/* Every line as a key-value pair. */
+	for (line = text; *line != '\0'; line = (p != NULL) ? p + 1 : line + strlen(line)) {
+		p = strchr(line, '\n');
+		if (p != NULL) *p = '\0';
+		parse_key_value_pair(line, key, value, sizeof(key));
+		work += (unsigned long)strlen(line);
+		if (p != NULL) *p = '\n';
+	}
+
+	/* The whole input as a configuration file. */
+	if (fuzz_write_file(fuzz_conf_name, data, size)) {
+		PARAM_SET_readFromFile(set, fuzz_conf_name, "conf", 1);
+	}
+	remove(fuzz_conf_name);
+
+	/* The input as a command line, split by white space and NUL. */
+	argv[argc++] = "<fuzz>";
+	p = text;
+	for (;;) {
+		while (p < text + size && (*p == '\0' || strchr(" \t\r\n", *p) != NULL)) *p++ = '\0';
+		if (p >= text + size) break;
+		argv[argc++] = p;
+		while (p < text + size && *p != '\0' && strchr(" \t\r\n", *p) == NULL) p++;
+	}
+	argv[argc] = NULL;
+
+	PARAM_SET_parseCMD(set, argc, argv, "cmd", 2);
+	fuzz_read_values(set);
+	fuzz_analyze_tasks(set);
+
+	if (PARAM_SET_getStats(set, &stats) == PST_OK) {
+		work += (unsigned long)(stats.nameLookups + stats.editDistances + stats.valuesAllocated
+				+ stats.iteratorResets + stats.validatorCalls + stats.wildcardExpansions);
+	}
+
+cleanup:
+
+	PARAM_SET_free(set);
+	free(argv);
+	free(text);
+
+	return work;
+}
+
+/**
+ * Runs the input and returns the count of the counted operations and the
+ * processor time in microseconds.
+ */
+static unsigned long fuzz_measure(const unsigned char *data, size_t size, double *usec) {
+	unsigned long work = 0;
+	clock_t start;
+
+	start = clock();
+	work = fuzz_run(data, size);
+	*usec = (double)(clock() - start) * 1000000.0 / CLOCKS_PER_SEC;
+
+	return work;
+}
+
+/**
+ * Runs the input and the input repeated #FUZZ_SCALE times and saves the input
+ * if the cost per byte grows too much. Returns 1 if the input was slow, 0
+ * otherwise.
+ */
+static int fuzz_one(const unsigned char *data, size_t size) {
+	unsigned char *big = NULL;
+	unsigned long work = 0;
+	unsigned long big_work = 0;
+	double len = 0;
+	double usec = 0;
+	double big_usec = 0;
+	double work_growth = 0;
+	double usec_growth = 0;
+	int slow = 0;
+	int i;
+
+	if (size == 0 || size > FUZZ_MAX_LEN / FUZZ_SCALE) return 0;
+
+	big = (unsigned char*)malloc(size * FUZZ_SCALE);
+	if (big == NULL) return 0;
+	for (i = 0; i < FUZZ_SCALE; i++) memcpy(big + i * size, data, size);
+
+	len = (double)(size < FUZZ_MIN_LEN ? FUZZ_MIN_LEN : size);
+
+	work = fuzz_measure(data, size, &usec);
+	big_work = fuzz_measure(big, size * FUZZ_SCALE, &big_usec);
+
+	/* Growth of the cost per byte, the cost of the shorter run is at least one unit. */
+	work_growth = ((double)big_work / (len * FUZZ_SCALE)) / ((double)(work > 0 ? work : 1) / len);
+	usec_growth = (big_usec < FUZZ_MIN_USEC) ? 0 : (big_usec / (len * FUZZ_SCALE)) / ((usec > 1 ? usec : 1) / len);
+
+	if (work_growth > fuzz_max_growth || usec_growth > fuzz_max_growth) {
+		fuzz_save_slow_input(data, size, work_growth, usec_growth);
+		slow = 1;
+	}
+
+	free(big);
+
+	return slow;
+}
+
+#ifdef PST_FUZZ_LIBFUZZER
+
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+	(void)argc;
+	(void)argv;
+	fuzz_init();
+	return 0;
+}
+
+int LLVMFuzzerTestOneInput(const unsigned char *data, size_t size) {
+	fuzz_one(data, size);
+	return 0;
+}
+
+#else
+
+static int fuzz_file(FILE *f, const char *name) {
+	unsigned char *data = NULL;
+	size_t size = 0;
+	size_t n = 0;
+	int slow = 0;
+
+	data = (unsigned char*)malloc(FUZZ_MAX_LEN + 1);
+	if (data == NULL) return 0;
+
+	while (size <= FUZZ_MAX_LEN && (n = fread(data + size, 1, FUZZ_MAX_LEN + 1 - size, f)) > 0) size += n;
+
+	if (size > FUZZ_MAX_LEN) {
+		fprintf(stderr, "fuzz-parsers: %s is longer than %d bytes, skipped.\n", name, FUZZ_MAX_LEN);
+	} else {
+		slow = fuzz_one(data, size);
+	}
+
+	free(data);
+
+	return slow;
+}
+
+int main(int argc, char **argv) {
+	int slow = 0;
+	int i;
+	FILE *f = NULL;
+
+	fuzz_init();
+
+	if (argc < 2) {
+		slow = fuzz_file(stdin, "<stdin>");
+	}
+
+	for (i = 1; i < argc; i++) {
+		f = fopen(argv[i], "rb");
+		if (f == NULL) {
+			fprintf(stderr, "fuzz-parsers: unable to open %s\n", argv[i]);
+			continue;
+		}
+
+		if (fuzz_file(f, argv[i])) slow = 1;
+		fclose(f);
+	}
+
+	return slow ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2013-2018 Guardtime, Inc.
+ *
+ * This file is part of the Guardtime client SDK.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES, CONDITIONS, OR OTHER LICENSES OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ * "Guardtime" and "KSI" are trademarks or registered trademarks of
+ * Guardtime, Inc., and no license to trademarks is granted; Guardtime
+ * reserves and retains all trademark rights.
+ */
+
+/*
+ * Test of the header-only C++ wrapper param_set.hpp. It is a separate program
+ * as the CuTest suite is built as C.
+ */
+
+#include <cstdio>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "param_set.hpp"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+		if (!(cond)) { \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			failures++; \
+		} \
+	} while (0)
+
+#define CHECK_THROWS(expr, type) do { \
+		bool thrown = false; \
+		try { (void)(expr); } catch (const type &) { thrown = true; } \
+		CHECK(thrown); \
+	} while (0)
+
+static constexpr auto schema = paramset::Schema<>()
+		.param("h", "help")
+		.param("i", "input", paramset::Values::Multiple)
+		.param("n", paramset::Values::Multiple)
+		.param("x", paramset::Values::SinglePerPriority)
+		.param("o");
+
+static_assert(schema.view() == "{h|help}{i|input}*{n}*{x}>{o}", "Unexpected schema string.");
+
+static void test_values(void) {
+	paramset::ParamSet set(schema.c_str());
+	char arg0[] = "test";
+	char arg1[] = "--help";
+	char arg2[] = "-i";
+	char arg3[] = "a";
+	char *argv[] = {arg0, arg1, arg2, arg3};
+	std::string joined;
+
+	set.parseCmd(4, argv);
+	set.add("i", "b");
+	set.add("n", "42");
+	set.add("n", "-7", "file", PST_PRIORITY_VALID_BASE + 1);
+	set.add("n", "1.5");
+
+	CHECK(set.isSet("h"));
+	CHECK(set.isSet("help"));
+	CHECK(!set.isSet("o"));
+	CHECK(set.count("i") == 2);
+	CHECK(set.count("n") == 3);
+	CHECK(set.count("n", "file") == 1);
+
+	CHECK(set.find("h") == std::string_view());
+	CHECK(set.find("i") == std::string_view("b"));
+	CHECK(set.find("i", 0, nullptr, PST_PRIORITY_NONE) == std::string_view("a"));
+	CHECK(!set.find("o").has_value());
+	CHECK(set.str("i") == "b");
+
+	/* The value with the higher priority wins. */
+	CHECK(set.get<int>("n") == -7);
+	CHECK(set.get<long>("n", 0, nullptr, PST_PRIORITY_NONE) == 42);
+	CHECK(set.get<double>("n", 2, nullptr, PST_PRIORITY_NONE) == 1.5);
+	CHECK(set.get<std::string>("i", 0, nullptr, PST_PRIORITY_NONE) == "a");
+	CHECK(set.get<bool>("h"));
+	CHECK(!set.get<std::optional<bool> >("o").value());
+	CHECK(set.get<std::optional<int> >("n").value() == -7);
+	CHECK(!set.get<std::optional<int> >("o").has_value());
+
+	CHECK_THROWS(set.get<int>("n", 2, nullptr, PST_PRIORITY_NONE), std::invalid_argument);
+	CHECK_THROWS(set.get<int>("i"), std::invalid_argument);
+
+	paramset::ValueRange inputs = set.values("i");
+	CHECK(inputs.size() == 2);
+	CHECK(!inputs.empty());
+	for (std::string_view value : inputs) joined += value;
+	CHECK(joined == "ab");
+	CHECK(set.values("o").empty());
+}
+
+static void test_errors(void) {
+	paramset::ParamSet set(schema.c_str());
+	int code = PST_OK;
+
+	try {
+		set.add("unknown", "1");
+	} catch (const paramset::Error &e) {
+		code = e.code();
+	}
+	CHECK(code == PST_PARAMETER_IS_UNKNOWN);
+
+	code = PST_OK;
+	try {
+		(void)set.str("o");
+	} catch (const paramset::Error &e) {
+		code = e.code();
+	}
+	CHECK(code == PST_PARAMETER_EMPTY);
+
+	code = PST_OK;
+	try {
+		paramset::ParamSet invalid(static_cast<const char *>(nullptr));
+	} catch (const paramset::Error &e) {
+		code = e.code();
+	}
+	CHECK(code == PST_INVALID_ARGUMENT);
+}
+
+static void test_move(void) {
+	paramset::ParamSet set(schema.c_str());
+	PARAM_SET *raw = nullptr;
+
+	set.add("i", "moved");
+	paramset::ParamSet other(std::move(set));
+	CHECK(!set);
+	CHECK(other);
+	CHECK(other.str("i") == "moved");
+
+	set = std::move(other);
+	CHECK(set);
+	CHECK(!other);
+
+	raw = set.release();
+	CHECK(!set);
+	CHECK(raw != nullptr);
+
+	paramset::ParamSet adopted = paramset::ParamSet::adopt(raw);
+	CHECK(adopted.str("input") == "moved");
+}
+
+int main(void) {
+	try {
+		test_values();
+		test_errors();
+		test_move();
+	} catch (const std::exception &e) {
+		std::fprintf(stderr, "Unexpected exception: %s\n", e.what());
+		return 1;
+	}
+
+	if (failures == 0) std::printf("OK\n");
+	return failures == 0 ? 0 : 1;
+}
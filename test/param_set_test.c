@@ -23,11 +23,22 @@
 #include "../src/param_set/param_value.h"
 #include "../src/param_set/parameter.h"
 #include "../src/param_set/param_set.h"
+#include "../src/param_set/task_def.h"
 #include "../src/param_set/param_set_obj_impl.h"
 #include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
 
+#ifndef _WIN32
+#  ifdef HAVE_CONFIG_H
+#    include "config.h"
+#  endif
+#endif
+
+#ifdef HAVE_PTHREAD_H
+#  include <pthread.h>
+#endif
+
 static void assert_param_set_value_count(CuTest* tc,
 		PARAM_SET* set, const char* names, const char* source, int priority,
 		const char *file, int line, int C) {
@@ -325,6 +336,54 @@ static void Test_param_invalid(CuTest* tc) {
 	PARAM_SET_free(set);
 }
 
+static void Test_param_set_validate_all(CuTest* tc) {
+	int res;
+	int i = 0;
+	int count = 0;
+	PARAM_SET *set = NULL;
+	char buf[1024];
+	char expected[] = "Error: 0x2. Parameter --str '1234'.\n"
+					"Error: 0x2. Parameter --str '1234'.\n"
+					"Error: 0x1. Parameter --str_short 'toolong'.\n"
+					"Error: 0x1. Parameter --str_short 'toolong'.\n";
+
+	res = PARAM_SET_new("{str}{str_short}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_addControl(set, "{str}", controlFormat_isAlpha, NULL, NULL, NULL);
+	res += PARAM_SET_addControl(set, "{str_short}", controlFormat_isAlpha, controlContent_notOver_one_char, NULL, NULL);
+	res += PARAM_SET_setControlOptions(set, "{str}{str_short}", PST_CONTROL_LAZY);
+	CuAssert(tc, "Unable to configure parameter set.", res == PST_OK);
+
+	for (i = 0; i < 2; i++) {
+		res = PARAM_SET_add(set, "str", "abcd", NULL, 0);
+		res += PARAM_SET_add(set, "str", "1234", NULL, 0);
+		res += PARAM_SET_add(set, "str_short", "a", NULL, 0);
+		res += PARAM_SET_add(set, "str_short", "toolong", NULL, 0);
+		CuAssert(tc, "Unable to add values.", res == PST_OK);
+	}
+
+	CuAssert(tc, "Values must be pending.", set->parameter[0]->pendingCount == 4 && set->parameter[1]->pendingCount == 4);
+
+	res = PARAM_SET_validateAll(set, 4);
+	CuAssert(tc, "Unable to validate values.", res == PST_OK);
+	CuAssert(tc, "No values must be pending.", set->parameter[0]->pendingCount == 0 && set->parameter[1]->pendingCount == 0);
+
+	res = PARAM_getInvalidCount(set->parameter[0], NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Invalid count.", res == PST_OK && count == 2);
+
+	res = PARAM_getInvalidCount(set->parameter[1], NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Invalid count.", res == PST_OK && count == 2);
+
+	PARAM_SET_invalidParametersToString(set, NULL, NULL, buf, sizeof(buf));
+	CuAssert(tc, "Invalid string generated.", strcmp(buf, expected) == 0);
+
+	res = PARAM_SET_validateAll(set, 0);
+	CuAssert(tc, "Thread count must be checked.", res == PST_INVALID_ARGUMENT);
+
+	PARAM_SET_free(set);
+}
+
 static void Test_param_set_typos(CuTest* tc) {
 	int res;
 	PARAM_SET *set = NULL;
@@ -421,6 +480,45 @@ static void Test_param_set_from_cmd_flags(CuTest* tc) {
 	PARAM_SET_free(set);
 }
 
+static void Test_param_set_name_lookup(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	char *argv[] = {"<path>", "-vq", "--in", "a", "--out", "b", "-o", "c", "--inx", "--verbose", NULL};
+	int argc = 0;
+	int count = 0;
+	PARAM_ATR atr;
+
+	while (argv[argc] != NULL) argc++;
+
+	/* Names of the same length, a name reused as an alias and single character aliases. */
+	res = PARAM_SET_new("{in|i}{out|o}{verbose|v}{q}{o|x}{ino}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_parseCMD(set, argc, argv, NULL, 0);
+	CuAssert(tc, "Unable to parse command line.", res == PST_OK);
+
+	res = PARAM_SET_getValueCount(set, "{verbose}", NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Invalid value count.", res == PST_OK && count == 2);
+	res = PARAM_SET_getValueCount(set, "{q}", NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Invalid value count.", res == PST_OK && count == 1);
+	res = PARAM_SET_getValueCount(set, "{in}", NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Invalid value count.", res == PST_OK && count == 1);
+
+	/* As the name "o" is the alias of the first parameter, it refers to "out". */
+	res = PARAM_SET_getValueCount(set, "{out}", NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Invalid value count.", res == PST_OK && count == 2);
+	res = PARAM_SET_getAtr(set, "x", NULL, PST_PRIORITY_NONE, 0, &atr);
+	CuAssert(tc, "Parameter must be empty.", res == PST_PARAMETER_EMPTY);
+	res = PARAM_SET_getAtr(set, "o", NULL, PST_PRIORITY_NONE, 1, &atr);
+	CuAssert(tc, "Invalid value extracted.", res == PST_OK && strcmp(atr.name, "out") == 0 && strcmp(atr.cstr_value, "c") == 0);
+
+	CuAssert(tc, "Unknown parameter must be found.", PARAM_SET_isUnknown(set) || PARAM_SET_isTypoFailure(set));
+	CuAssert(tc, "Parameter must not exist.", PARAM_SET_getAtr(set, "inx", NULL, PST_PRIORITY_NONE, 0, &atr) == PST_PARAMETER_NOT_FOUND);
+	CuAssert(tc, "Parameter must not exist.", PARAM_SET_getAtr(set, "", NULL, PST_PRIORITY_NONE, 0, &atr) == PST_PARAMETER_NOT_FOUND);
+
+	PARAM_SET_free(set);
+}
+
 static int wrapper_return_str_append_a_value(void **extra, const char* str, void** obj){
 	int res;
 	void **extra_array = extra;
@@ -752,6 +850,253 @@ static void Test_set_read_from_invalid_file(CuTest* tc) {
 	PARAM_SET_free(set);
 }
 
+static void Test_set_read_from_file_cached(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	PST_FILE_CACHE *cache = NULL;
+	char buf[1024];
+	int i;
+	size_t hits = 0;
+	size_t diskHits = 0;
+	size_t misses = 0;
+	size_t count = 0;
+
+	char expected[] =
+				"Syntax error at line    9. Unknown character. '.sjdsdhjshdjshjdhsjhdsjdhjshdshjdjsdjhsjdhjshjdjshdjhsjdhsjd'.\n"
+				"Syntax error at line   11. Missing character '-'. 'hdhdshjds -c'.\n"
+				"Syntax error at line   14. Missing character '-'. 'x'.\n"
+				"Syntax error at line   17. Unknown character. '.'.\n";
+
+	res = PST_FILE_CACHE_new(NULL, 4, &cache);
+	CuAssert(tc, "Unable to create file cache.", res == PST_OK);
+
+	/* The second read must give the same result from the cache. */
+	for (i = 0; i < 2; i++) {
+		res = PARAM_SET_new("{a}{b}{c}{test-test}{cnstr}{x}{y}{z}", &set);
+		CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+		res = PARAM_SET_setFileCache(set, cache);
+		CuAssert(tc, "Unable to set file cache.", res == PST_OK);
+
+		res = PARAM_SET_readFromFile(set, getFullResourcePath("ok-conf.conf"), "ok", 0);
+		CuAssert(tc, "Unable to read conf file.", res == PST_OK);
+
+		res = PARAM_SET_readFromFile(set, getFullResourcePath("nok-conf.conf"), NULL, 1);
+		CuAssert(tc, "Configurations file must be invalid.", res == PST_INVALID_FORMAT);
+
+		assert_value(tc, set, "test-test", 1, __FILE__, __LINE__, "a b c d");
+		assert_value(tc, set, "test-test", 5, __FILE__, __LINE__, "\\");
+		assert_value(tc, set, "test-test", 7, __FILE__, __LINE__, "  ");
+		assert_value(tc, set, "cnstr", 0, __FILE__, __LINE__, "O=Guardtime AS");
+
+		PARAM_SET_syntaxErrorsToString(set, NULL, buf, sizeof(buf));
+		CuAssert(tc, "Unexpected error message.", strcmp(buf, expected) == 0);
+
+		res = PARAM_SET_getDiagnosticCount(set, &count);
+		CuAssert(tc, "Invalid diagnostic count.", res == PST_OK && count == 7);
+
+		res = PARAM_SET_readFromFile(set, getFullResourcePath("missing.conf"), NULL, 0);
+		CuAssert(tc, "File must not exist.", res == PST_IO_ERROR);
+
+		PARAM_SET_free(set);
+	}
+
+	res = PST_FILE_CACHE_getCounters(cache, &hits, &diskHits, &misses);
+	CuAssert(tc, "Invalid cache counters.", res == PST_OK && diskHits == 0 && misses == 2 && hits == 2);
+
+	PST_FILE_CACHE_free(cache);
+}
+
+static void write_conf_file(const char *fname, const char *content) {
+	FILE *f = fopen(fname, "wb");
+	if (f == NULL) return;
+	fputs(content, f);
+	fclose(f);
+}
+
+static void collect_changed_names(void *ctx, PARAM_SET *set, const char *name) {
+	char *buf = (char*)ctx;
+	VARIABLE_IS_NOT_USED(set);
+	strcat(buf, name);
+	strcat(buf, ";");
+}
+
+static void Test_set_reload_from_file(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	char names[256] = "";
+	int changed = 0;
+	int fd = 0;
+	const char *fname = "param_set_reload.tmp";
+
+	res = PARAM_SET_new("{a}{b}{c}{d}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	write_conf_file(fname, "--a 1\n--b x\n--b y\n--c 3\n");
+
+	res = PARAM_SET_add(set, "a", "cmd", "cmd", 1);
+	res |= PARAM_SET_readFromFile(set, fname, "conf", 0);
+	res |= PARAM_SET_add(set, "b", "cmd", "cmd", 1);
+	CuAssert(tc, "Unable to add values.", res == PST_OK);
+
+	/* Nothing is changed. */
+	res = PARAM_SET_reloadFromFile(set, fname, "conf", 0, collect_changed_names, names, &changed);
+	CuAssert(tc, "Unable to reload.", res == PST_OK && changed == 0 && names[0] == '\0');
+	assert_param_set_value_count(tc, set, "{a}{b}{c}{d}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 6);
+	assert_value(tc, set, "b", 0, __FILE__, __LINE__, "x");
+
+	/* Value of b is changed, c is removed and d is added, a is untouched. */
+	write_conf_file(fname, "--a 1\n--b x\n--b z\n--d 4\n");
+
+	res = PARAM_SET_reloadFromFile(set, fname, "conf", 0, collect_changed_names, names, &changed);
+	CuAssert(tc, "Unable to reload.", res == PST_OK && changed == 3);
+	CuAssert(tc, "Invalid change callbacks.", strcmp(names, "b;c;d;") == 0);
+
+	assert_param_set_value_count(tc, set, "{a}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 2);
+	assert_param_set_value_count(tc, set, "{b}", "conf", PST_PRIORITY_NONE, __FILE__, __LINE__, 2);
+	assert_param_set_value_count(tc, set, "{c}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 0);
+	assert_value(tc, set, "a", 0, __FILE__, __LINE__, "cmd");
+	assert_value(tc, set, "b", 0, __FILE__, __LINE__, "cmd");
+	assert_value(tc, set, "b", 2, __FILE__, __LINE__, "z");
+	assert_value(tc, set, "d", 0, __FILE__, __LINE__, "4");
+
+	/* Missing file does not change anything. */
+	res = PARAM_SET_reloadFromFile(set, "missing.conf", "conf", 0, NULL, NULL, &changed);
+	CuAssert(tc, "File must not exist.", res == PST_IO_ERROR);
+	assert_param_set_value_count(tc, set, "{a}{b}{c}{d}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 6);
+
+	/* Watched file is reloaded when it is changed. */
+	res = PARAM_SET_watchFile(set, fname, "conf", 0);
+	CuAssert(tc, "Unable to watch the file.", res == PST_OK);
+
+	res = PARAM_SET_getWatchDescriptor(set, &fd);
+	CuAssert(tc, "Unable to get the descriptor.", res == PST_OK);
+
+	res = PARAM_SET_processWatches(set, NULL, NULL, &changed);
+	CuAssert(tc, "Nothing must be changed.", res == PST_OK && changed == 0);
+
+	write_conf_file(fname, "--a 1\n--b x\n--b z\n");
+	names[0] = '\0';
+
+	res = PARAM_SET_processWatches(set, collect_changed_names, names, &changed);
+	CuAssert(tc, "Watched file must be reloaded.", res == PST_OK && changed == 1 && strcmp(names, "d;") == 0);
+	assert_param_set_value_count(tc, set, "{d}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 0);
+
+	remove(fname);
+	PARAM_SET_free(set);
+}
+
+static void Test_set_reload_diagnostics(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	PARAM_SET_STATS stats;
+	unsigned long allocated = 0;
+	char names[256] = "";
+	size_t count = 0;
+	int changed = 0;
+	const char *fname = "param_set_reload_diag.tmp";
+
+	res = PARAM_SET_new("{alpha}{beta}{gamma}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	write_conf_file(fname, "--alpha 1\nbeta 2\n--gamm 3\n--qwerty 4\n--gamma 5\n");
+
+	/* Reloading the same broken file does not add the errors again. */
+	res = PARAM_SET_reloadFromFile(set, fname, "conf", 0, NULL, NULL, &changed);
+	CuAssert(tc, "File must be invalid.", res == PST_INVALID_FORMAT);
+	res = PARAM_SET_getDiagnosticCount(set, &count);
+	CuAssert(tc, "Invalid diagnostic count.", res == PST_OK && count == 6);
+
+	res = PARAM_SET_reloadFromFile(set, fname, "conf", 0, NULL, NULL, &changed);
+	CuAssert(tc, "File must be invalid.", res == PST_INVALID_FORMAT && changed == 0);
+	res = PARAM_SET_getDiagnosticCount(set, &count);
+	CuAssert(tc, "Errors must not be added again.", res == PST_OK && count == 6);
+	CuAssert(tc, "Errors must be reported.", PARAM_SET_isSyntaxError(set) && PARAM_SET_isTypoFailure(set) && PARAM_SET_isUnknown(set));
+
+	/* Diagnostics from other sources are kept. */
+	res = PARAM_SET_add(set, "alph", NULL, "cmd", 0);
+	CuAssert(tc, "Parameter must be a typo.", res == PST_PARAMETER_IS_TYPO);
+
+	/* Only the values of the changed parameters are added again. */
+	res = PARAM_SET_getStats(set, &stats);
+	CuAssert(tc, "Unable to get stats.", res == PST_OK);
+	allocated = stats.valuesAllocated;
+
+	write_conf_file(fname, "--alpha 1\n--beta 2\n--gamma 5\n");
+
+	res = PARAM_SET_reloadFromFile(set, fname, "conf", 0, collect_changed_names, names, &changed);
+	CuAssert(tc, "Unable to reload.", res == PST_OK && changed == 1);
+	CuAssert(tc, "Only beta must be changed.", strcmp(names, "beta;") == 0);
+	res = PARAM_SET_getStats(set, &stats);
+	CuAssert(tc, "Unable to get stats.", res == PST_OK);
+#ifndef PST_DISABLE_STATS
+	CuAssert(tc, "Only beta must be added.", stats.valuesAllocated == allocated + 1);
+#else
+	VARIABLE_IS_NOT_USED(allocated);
+#endif
+
+	res = PARAM_SET_getDiagnosticCount(set, &count);
+	CuAssert(tc, "Only the typo from cmd must remain.", res == PST_OK && count == 1);
+	CuAssert(tc, "Errors must be cleared.", !PARAM_SET_isSyntaxError(set) && !PARAM_SET_isUnknown(set));
+	assert_param_set_value_count(tc, set, "{alpha}{beta}{gamma}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 3);
+	assert_value(tc, set, "beta", 0, __FILE__, __LINE__, "2");
+
+	remove(fname);
+	PARAM_SET_free(set);
+}
+
+static void Test_set_reload_keeps_other_diagnostics(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	char *argv[] = {"app", "--outpt", "x"};
+	char buf[1024];
+	size_t count = 0;
+	int changed = 0;
+	const char *fname = "param_set_reload_other.tmp";
+	const char *other = "param_set_reload_other2.tmp";
+
+	res = PARAM_SET_new("{output}{input}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	/* The command line and the files have no source, the typo and its value are recorded. */
+	res = PARAM_SET_parseCMD(set, 3, argv, NULL, 1);
+	CuAssert(tc, "Unable to parse command line.", res == PST_OK);
+	CuAssert(tc, "Typo must be detected.", PARAM_SET_isTypoFailure(set));
+
+	write_conf_file(fname, "--input a\n--qwerty 1\n");
+	write_conf_file(other, "--asdfgh 2\n");
+
+	res = PARAM_SET_readFromFile(set, other, NULL, 0);
+	CuAssert(tc, "Unable to read file.", res == PST_OK);
+	res = PARAM_SET_readFromFile(set, fname, NULL, 0);
+	CuAssert(tc, "Unable to read file.", res == PST_OK);
+	res = PARAM_SET_getDiagnosticCount(set, &count);
+	CuAssert(tc, "Invalid diagnostic count.", res == PST_OK && count == 6);
+
+	/* Only the records from the reloaded file are replaced. */
+	write_conf_file(fname, "--input a\n");
+	res = PARAM_SET_reloadFromFile(set, fname, NULL, 0, NULL, NULL, &changed);
+	CuAssert(tc, "Unable to reload.", res == PST_OK && changed == 0);
+	res = PARAM_SET_getDiagnosticCount(set, &count);
+	CuAssert(tc, "Invalid diagnostic count.", res == PST_OK && count == 4);
+	CuAssert(tc, "Typo must be kept.", PARAM_SET_isTypoFailure(set) && PARAM_SET_isUnknown(set));
+	CuAssert(tc, "Typo must be reported.", strstr(PARAM_SET_typosToString(set, NULL, buf, sizeof(buf)), "outpt") != NULL);
+
+	/* The same file read with another priority is a different input. */
+	write_conf_file(fname, "--qwerty 1\n");
+	res = PARAM_SET_readFromFile(set, fname, NULL, 1);
+	CuAssert(tc, "Unable to read file.", res == PST_OK);
+	write_conf_file(fname, "--input a\n");
+	res = PARAM_SET_reloadFromFile(set, fname, NULL, 0, NULL, NULL, &changed);
+	CuAssert(tc, "Unable to reload.", res == PST_OK && changed == 0);
+	res = PARAM_SET_getDiagnosticCount(set, &count);
+	CuAssert(tc, "Invalid diagnostic count.", res == PST_OK && count == 6);
+
+	remove(fname);
+	remove(other);
+	PARAM_SET_free(set);
+}
+
 static void Test_set_read_from_invalid_file_no_messages(CuTest* tc) {
 	int res;
 	PARAM_SET *set = NULL;
@@ -765,6 +1110,879 @@ static void Test_set_read_from_invalid_file_no_messages(CuTest* tc) {
 	PARAM_SET_free(set);
 }
 
+static void Test_set_diagnostic_records(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	PARAM_SET_DIAG diag;
+	size_t count = 0;
+
+	res = PARAM_SET_new("{a}{b}{c}{test-test}{cnstr}{x}{y}{z}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_readFromFile(set, getFullResourcePath("nok-conf.conf"), "nok-conf", 0);
+	CuAssert(tc, "Configurations file must be invalid.", res == PST_INVALID_FORMAT);
+
+	res = PARAM_SET_add(set, "test-tset", NULL, "cmd", 0);
+	CuAssert(tc, "Typo must be detected.", res == PST_PARAMETER_IS_TYPO);
+
+	res = PARAM_SET_add(set, "unknown-parameter", "value", NULL, 0);
+	CuAssert(tc, "Unknown parameter must be detected.", res == PST_PARAMETER_IS_UNKNOWN);
+
+	res = PARAM_SET_getDiagnosticCount(set, &count);
+	CuAssert(tc, "Invalid diagnostic count.", res == PST_OK && count == 10);
+
+	res = PARAM_SET_getDiagnostic(set, 0, &diag);
+	CuAssert(tc, "Unable to get diagnostic.", res == PST_OK);
+	CuAssert(tc, "Invalid syntax error record.", diag.kind == PST_DIAG_SYNTAX_UNKNOWN_CHARACTER
+			&& diag.line == 9 && diag.offset == 51 && diag.sourceId == 0 && strcmp(diag.source, "nok-conf") == 0
+			&& strncmp(diag.token, ".sjdsdhjs", 9) == 0 && diag.tokenLen == strlen(diag.token) && diag.candidateCount == 0);
+
+	res = PARAM_SET_getDiagnostic(set, 1, &diag);
+	CuAssert(tc, "Invalid syntax error record.", res == PST_OK && diag.kind == PST_DIAG_SYNTAX_MISSING_DASH
+			&& diag.line == 11 && strcmp(diag.token, "hdhdshjds -c") == 0);
+
+	res = PARAM_SET_getDiagnostic(set, 2, &diag);
+	CuAssert(tc, "Unknown parameter read from file must have a location.", res == PST_OK && diag.kind == PST_DIAG_UNKNOWN
+			&& diag.line == 11 && strcmp(diag.token, "hdhdshjds") == 0);
+
+	res = PARAM_SET_getDiagnostic(set, 7, &diag);
+	CuAssert(tc, "Invalid typo record.", res == PST_OK && diag.kind == PST_DIAG_TYPO
+			&& diag.line == 0 && diag.sourceId == 1 && strcmp(diag.source, "cmd") == 0 && strcmp(diag.token, "test-tset") == 0
+			&& diag.candidateCount == 1 && diag.candidate[0] == 3 && strcmp(diag.candidateName[0], "--test-test") == 0);
+
+	res = PARAM_SET_getDiagnostic(set, 8, &diag);
+	CuAssert(tc, "Invalid unknown record.", res == PST_OK && diag.kind == PST_DIAG_UNKNOWN
+			&& diag.source == NULL && diag.sourceId == -1 && strcmp(diag.token, "unknown-parameter") == 0);
+
+	res = PARAM_SET_getDiagnostic(set, 9, &diag);
+	CuAssert(tc, "Invalid unknown record.", res == PST_OK && diag.kind == PST_DIAG_UNKNOWN && strcmp(diag.token, "value") == 0);
+
+	res = PARAM_SET_getDiagnostic(set, 10, &diag);
+	CuAssert(tc, "Index must be out of range.", res == PST_INDEX_OVF);
+
+	PARAM_SET_free(set);
+}
+
+static void Test_set_snapshot_save_and_load(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	PARAM_SET *loaded = NULL;
+	PARAM_SET *other = NULL;
+	PARAM_ATR atr;
+	FILE *f = NULL;
+	const char *fname = "param_set_snapshot.tmp";
+
+	res = PARAM_SET_new("{a}{b}{str}{c}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_addControl(set, "{str}", controlFormat_isAlpha, NULL, NULL, NULL);
+	CuAssert(tc, "Unable to add functions.", res == PST_OK);
+
+	res = PARAM_SET_add(set, "a", "a1", "conf", 0);
+	res |= PARAM_SET_add(set, "a", "a2", "conf", 0);
+	res |= PARAM_SET_add(set, "a", "a3", "cmd", 2);
+	res |= PARAM_SET_add(set, "b", NULL, NULL, 1);
+	res |= PARAM_SET_add(set, "str", "1234", "cmd", 0);
+	CuAssert(tc, "Unable to add values.", res == PST_OK);
+
+	res = PARAM_SET_saveSnapshot(set, fname);
+	CuAssert(tc, "Unable to save snapshot.", res == PST_OK);
+
+	/* Load into a set configured the same way, but in different order. */
+	res = PARAM_SET_new("{c}{str}{b}{a}", &loaded);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_loadSnapshot(loaded, fname);
+	CuAssert(tc, "Unable to load snapshot.", res == PST_OK);
+
+	assert_param_set_value_count(tc, loaded, "{a}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 3);
+	assert_param_set_value_count(tc, loaded, "{b}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 1);
+	assert_param_set_value_count(tc, loaded, "{c}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 0);
+	assert_value(tc, loaded, "a", 0, __FILE__, __LINE__, "a1");
+	assert_value(tc, loaded, "a", 2, __FILE__, __LINE__, "a3");
+	assert_value(tc, loaded, "b", 0, __FILE__, __LINE__, NULL);
+
+	res = PARAM_SET_getAtr(loaded, "a", NULL, PST_PRIORITY_NONE, 1, &atr);
+	CuAssert(tc, "Invalid attributes.", res == PST_OK && strcmp(atr.cstr_value, "a2") == 0
+			&& strcmp(atr.source, "conf") == 0 && atr.priority == 0);
+
+	res = PARAM_SET_getAtr(loaded, "a", NULL, PST_PRIORITY_HIGHEST, 0, &atr);
+	CuAssert(tc, "Invalid attributes.", res == PST_OK && strcmp(atr.cstr_value, "a3") == 0
+			&& strcmp(atr.source, "cmd") == 0 && atr.priority == 2);
+
+	res = PARAM_SET_getAtr(loaded, "b", NULL, PST_PRIORITY_NONE, 0, &atr);
+	CuAssert(tc, "Invalid attributes.", res == PST_OK && atr.source == NULL && atr.priority == 1);
+
+	/* Check results are restored without control functions. */
+	res = PARAM_SET_getAtr(loaded, "str", NULL, PST_PRIORITY_NONE, 0, &atr);
+	CuAssert(tc, "Invalid attributes.", res == PST_OK && atr.formatStatus == ERROR_NOT_ALPHA);
+	CuAssert(tc, "Parameter set must be invalid.", !PARAM_SET_isFormatOK(loaded));
+
+	/* Snapshot values can be removed like any other. */
+	res = PARAM_SET_clearValue(loaded, "a", NULL, PST_PRIORITY_NONE, 0);
+	CuAssert(tc, "Unable to clear value.", res == PST_OK);
+	assert_value(tc, loaded, "a", 0, __FILE__, __LINE__, "a2");
+
+	/* Parameter missing from the set. */
+	res = PARAM_SET_new("{a}{b}{c}", &other);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_loadSnapshot(other, fname);
+	CuAssert(tc, "Parameter must not be found.", res == PST_PARAMETER_NOT_FOUND);
+	assert_param_set_value_count(tc, other, "{a}{b}{c}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 0);
+
+	/* Corrupted snapshot. */
+	f = fopen(fname, "r+b");
+	CuAssert(tc, "Unable to open snapshot.", f != NULL);
+	fseek(f, 8, SEEK_SET);
+	fputc(0x7f, f);
+	fclose(f);
+
+	res = PARAM_SET_loadSnapshot(other, fname);
+	CuAssert(tc, "Snapshot must be incompatible.", res == PST_SNAPSHOT_INCOMPATIBLE);
+
+	res = PARAM_SET_loadSnapshot(other, getFullResourcePath("ok-conf.conf"));
+	CuAssert(tc, "Configuration file is not a snapshot.", res == PST_SNAPSHOT_INCOMPATIBLE);
+
+	remove(fname);
+	PARAM_SET_free(set);
+	PARAM_SET_free(loaded);
+	PARAM_SET_free(other);
+}
+
+static void Test_set_new_from_spec(CuTest* tc) {
+	int res;
+	PARAM_SET_SPEC *spec = NULL;
+	PARAM_SET *set = NULL;
+	PARAM_SET *ref = NULL;
+	PARAM_SET *other = NULL;
+	PARAM_SET_SPEC invalid;
+	int count = 0;
+	int i;
+	const char *spec_str = "{h|help}{i|input}*{o|output}>{v}*{x|input}{log}";
+	const char *names[] = {"h", "help", "i", "input", "o", "output", "v", "log", NULL};
+	char *argv[] = {"<path>", "-h", "-i", "a", "--input", "b", "-o", "o1", "-v", "-v", "--log", "l", NULL};
+	int argc = 12;
+
+	res = PARAM_SET_SPEC_new(spec_str, &spec);
+	CuAssert(tc, "Unable to create spec.", res == PST_OK);
+	CuAssert(tc, "Invalid spec.", spec->count == 6 && spec->version == PARAM_SET_SPEC_VERSION);
+	CuAssert(tc, "Invalid constraints.", spec->param[0].constraints == PARAM_SINGLE_VALUE
+			&& spec->param[1].constraints == 0 && spec->param[2].constraints == PARAM_SINGLE_VALUE_FOR_PRIORITY_LEVEL);
+	CuAssert(tc, "Invalid alias.", strcmp(spec->param[1].alias, "input") == 0 && spec->param[5].alias == NULL);
+
+	res = PARAM_SET_newFromSpec(spec, &set);
+	CuAssert(tc, "Unable to create set from spec.", res == PST_OK);
+
+	res = PARAM_SET_new(spec_str, &ref);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	/* Both sets must parse the same input the same way. */
+	res = PARAM_SET_parseCMD(set, argc, argv, NULL, 0);
+	CuAssert(tc, "Unable to parse command line.", res == PST_OK);
+	res = PARAM_SET_parseCMD(ref, argc, argv, NULL, 0);
+	CuAssert(tc, "Unable to parse command line.", res == PST_OK);
+
+	for (i = 0; names[i] != NULL; i++) {
+		int ref_count = 0;
+
+		res = PARAM_SET_getValueCount(set, names[i], NULL, PST_PRIORITY_NONE, &count);
+		CuAssert(tc, "Unable to get value count.", res == PST_OK);
+		res = PARAM_SET_getValueCount(ref, names[i], NULL, PST_PRIORITY_NONE, &ref_count);
+		CuAssert(tc, "Unable to get value count.", res == PST_OK);
+		CuAssert(tc, "Value counts differ.", count == ref_count);
+	}
+
+	assert_param_set_value_count(tc, set, "{i}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 2);
+	assert_param_set_value_count(tc, set, "{v}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 2);
+	assert_value(tc, set, "input", 1, __FILE__, __LINE__, "b");
+	assert_value(tc, set, "log", 0, __FILE__, __LINE__, "l");
+
+	/* Name already used as alias of the first parameter is resolved to it. */
+	res = PARAM_SET_add(set, "x", "x1", NULL, 0);
+	CuAssert(tc, "Unable to add value.", res == PST_OK);
+	assert_param_set_value_count(tc, set, "{x}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 1);
+	assert_param_set_value_count(tc, set, "{i}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 2);
+
+	res = PARAM_SET_add(set, "unknown", "u", NULL, 0);
+	CuAssert(tc, "Parameter must be unknown.", res == PST_PARAMETER_IS_UNKNOWN && PARAM_SET_isUnknown(set));
+
+	/* Spec with lookup table not matching the parameters. */
+	invalid = *spec;
+	invalid.count = 1;
+	invalid.param = spec->param + 1;
+	res = PARAM_SET_newFromSpec(&invalid, &other);
+	CuAssert(tc, "Spec must be invalid.", res == PST_INVALID_FORMAT);
+
+	invalid = *spec;
+	invalid.version = PARAM_SET_SPEC_VERSION + 1;
+	res = PARAM_SET_newFromSpec(&invalid, &other);
+	CuAssert(tc, "Spec must be invalid.", res == PST_INVALID_FORMAT);
+
+	PARAM_SET_free(set);
+	PARAM_SET_free(ref);
+	PARAM_SET_free(other);
+	PARAM_SET_SPEC_free(spec);
+}
+
+static void Test_set_publish_frozen(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	PST_FROZEN_SET *frozen = NULL;
+	const PST_FROZEN_SET *current = NULL;
+	const PST_FROZEN_SET *other = NULL;
+	PST_PUBLISHER *pub = NULL;
+	const char *value = NULL;
+	size_t reader = 0;
+	size_t reader_2 = 0;
+	size_t pending = 0;
+	int count = 0;
+
+	res = PARAM_SET_new("{i|input}{o|output}{v}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+	res = PARAM_SET_addControl(set, "{o}", controlFormat_isAlpha, NULL, NULL, NULL);
+	CuAssert(tc, "Unable to add control.", res == PST_OK);
+
+	res = PARAM_SET_add(set, "i", "a", "conf", 1);
+	res += PARAM_SET_add(set, "i", "b", "cmd", 2);
+	res += PARAM_SET_add(set, "o", "123", NULL, 0);
+	CuAssert(tc, "Unable to add values.", res == PST_OK);
+
+	res = PST_PUBLISHER_new(2, &pub);
+	CuAssert(tc, "Unable to create publisher.", res == PST_OK);
+	res = PST_PUBLISHER_addReader(pub, &reader);
+	res += PST_PUBLISHER_addReader(pub, &reader_2);
+	CuAssert(tc, "Unable to add readers.", res == PST_OK && reader != reader_2);
+	res = PST_PUBLISHER_addReader(pub, &reader_2);
+	CuAssert(tc, "All slots must be in use.", res == PST_OUT_OF_MEMORY);
+
+	res = PST_PUBLISHER_enter(pub, reader, &current);
+	CuAssert(tc, "Nothing must be published.", res == PST_OK && current == NULL);
+	PST_PUBLISHER_leave(pub, reader);
+
+	res = PARAM_SET_freeze(set, &frozen);
+	CuAssert(tc, "Unable to freeze the set.", res == PST_OK);
+	res = PST_PUBLISHER_publish(pub, frozen);
+	CuAssert(tc, "Unable to publish.", res == PST_OK);
+	res = PST_PUBLISHER_publish(pub, frozen);
+	CuAssert(tc, "Current set must not be published again.", res == PST_INVALID_ARGUMENT);
+
+	/* The set is not referred by the frozen copy. */
+	PARAM_SET_clearParameter(set, "{i}");
+
+	res = PST_PUBLISHER_enter(pub, reader, &current);
+	CuAssert(tc, "Unable to get the current set.", res == PST_OK && current == frozen);
+
+	res = PST_FROZEN_SET_getStr(current, "input", NULL, PST_PRIORITY_HIGHEST, PST_INDEX_LAST, &value);
+	CuAssert(tc, "Unexpected value.", res == PST_OK && strcmp(value, "b") == 0);
+	res = PST_FROZEN_SET_getStr(current, "i", "conf", PST_PRIORITY_NONE, 0, &value);
+	CuAssert(tc, "Unexpected value.", res == PST_OK && strcmp(value, "a") == 0);
+	res = PST_FROZEN_SET_getValueCount(current, "i", NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Unexpected value count.", res == PST_OK && count == 2);
+	res = PST_FROZEN_SET_getStr(current, "output", NULL, PST_PRIORITY_NONE, 0, &value);
+	CuAssert(tc, "Value must be invalid.", res == PST_PARAMETER_INVALID_FORMAT && strcmp(value, "123") == 0);
+	res = PST_FROZEN_SET_getStr(current, "v", NULL, PST_PRIORITY_NONE, 0, &value);
+	CuAssert(tc, "Parameter must be empty.", res == PST_PARAMETER_EMPTY && !PST_FROZEN_SET_isSet(current, "v"));
+	res = PST_FROZEN_SET_getStr(current, "x", NULL, PST_PRIORITY_NONE, 0, &value);
+	CuAssert(tc, "Parameter must not exist.", res == PST_PARAMETER_NOT_FOUND);
+
+	/* Replaced set is kept while the reader is using it. */
+	res = PARAM_SET_freeze(set, &frozen);
+	CuAssert(tc, "Unable to freeze the set.", res == PST_OK);
+	res = PST_PUBLISHER_publish(pub, frozen);
+	CuAssert(tc, "Unable to publish.", res == PST_OK);
+
+	res = PST_PUBLISHER_enter(pub, reader_2, &other);
+	CuAssert(tc, "Unable to get the current set.", res == PST_OK && other == frozen && !PST_FROZEN_SET_isSet(other, "i"));
+	CuAssert(tc, "Old set must be readable.", PST_FROZEN_SET_isSet(current, "i"));
+
+	res = PST_PUBLISHER_reclaim(pub, &pending);
+	CuAssert(tc, "Old set must not be freed.", res == PST_OK && pending == 1);
+	res = PST_PUBLISHER_publish(pub, (PST_FROZEN_SET*)current);
+	CuAssert(tc, "Replaced set must not be published again.", res == PST_INVALID_ARGUMENT);
+
+	PST_PUBLISHER_leave(pub, reader);
+	res = PST_PUBLISHER_reclaim(pub, &pending);
+	CuAssert(tc, "Old set must be freed.", res == PST_OK && pending == 0);
+
+	PST_PUBLISHER_leave(pub, reader_2);
+	PST_PUBLISHER_removeReader(pub, reader);
+	PST_PUBLISHER_removeReader(pub, reader_2);
+
+	PST_PUBLISHER_free(pub);
+	PARAM_SET_free(set);
+}
+
+static void Test_set_frozen_same_as_set(CuTest* tc) {
+	int res;
+	int frozen_res;
+	PARAM_SET *set = NULL;
+	PST_FROZEN_SET *frozen = NULL;
+	char *value = NULL;
+	const char *frozen_value = NULL;
+	char buf[16];
+	int count = 0;
+	int frozen_count = 0;
+	int i;
+	int s;
+	int p;
+	int at;
+	const char *sources[] = {NULL, "a", "b", "c"};
+	int prio[] = {PST_PRIORITY_NONE, PST_PRIORITY_HIGHEST, PST_PRIORITY_LOWEST, 0, 1, 2, 3,
+			PST_PRIORITY_HIGHER_THAN + 0, PST_PRIORITY_HIGHER_THAN + 2, PST_PRIORITY_LOWER_THAN + 2};
+
+	res = PARAM_SET_new("{x}{y}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	for (i = 0; i < 30; i++) {
+		PST_snprintf(buf, sizeof(buf), "%i", i);
+		res = PARAM_SET_add(set, "x", buf, sources[1 + i % 3], (i * 7) % 4);
+		CuAssert(tc, "Unable to add values.", res == PST_OK);
+	}
+
+	res = PARAM_SET_add(set, "y", "1", NULL, 2);
+	CuAssert(tc, "Unable to add values.", res == PST_OK);
+
+	res = PARAM_SET_freeze(set, &frozen);
+	CuAssert(tc, "Unable to freeze the set.", res == PST_OK);
+
+	for (s = 0; s < 4; s++) {
+		for (p = 0; p < (int)(sizeof(prio) / sizeof(prio[0])); p++) {
+			res = PARAM_SET_getValueCount(set, "{x}", sources[s], prio[p], &count);
+			frozen_res = PST_FROZEN_SET_getValueCount(frozen, "x", sources[s], prio[p], &frozen_count);
+			CuAssert(tc, "Value count differs.", res == frozen_res && count == frozen_count);
+
+			for (at = PST_INDEX_LAST; at <= count; at++) {
+				res = PARAM_SET_getStr(set, "x", sources[s], prio[p], at, &value);
+				frozen_res = PST_FROZEN_SET_getStr(frozen, "x", sources[s], prio[p], at, &frozen_value);
+				CuAssert(tc, "Result differs.", res == frozen_res);
+				CuAssert(tc, "Value differs.", res != PST_OK || strcmp(value, frozen_value) == 0);
+			}
+		}
+	}
+
+	PST_FROZEN_SET_free(frozen);
+	PARAM_SET_free(set);
+}
+
+#ifdef HAVE_PTHREAD_H
+#define PUBLISH_READERS 4
+#define PUBLISH_ROUNDS 2000
+#define PUBLISH_READS 20000
+
+typedef struct {
+	PST_PUBLISHER *pub;
+	size_t reader;
+	int failures;
+} PUBLISH_READER;
+
+static void *publish_reader_thread(void *arg) {
+	PUBLISH_READER *ctx = (PUBLISH_READER*)arg;
+	const PST_FROZEN_SET *frozen = NULL;
+	const char *value = NULL;
+	int count = 0;
+	int i;
+
+	for (i = 0; i < PUBLISH_READS; i++) {
+		PST_PUBLISHER_enter(ctx->pub, ctx->reader, &frozen);
+
+		/* Every set has as many values of x as the value of n says. */
+		if (frozen != NULL) {
+			if (PST_FROZEN_SET_getStr(frozen, "n", NULL, PST_PRIORITY_NONE, 0, &value) != PST_OK
+					|| PST_FROZEN_SET_getValueCount(frozen, "x", NULL, PST_PRIORITY_NONE, &count) != PST_OK
+					|| count != atoi(value)
+					|| PST_FROZEN_SET_getStr(frozen, "x", NULL, PST_PRIORITY_NONE, PST_INDEX_LAST, &value) != PST_OK
+					|| strcmp(value, "x") != 0) {
+				ctx->failures++;
+			}
+		}
+
+		PST_PUBLISHER_leave(ctx->pub, ctx->reader);
+	}
+
+	return NULL;
+}
+
+static void Test_set_publish_threads(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	PST_FROZEN_SET *frozen = NULL;
+	PST_PUBLISHER *pub = NULL;
+	PUBLISH_READER ctx[PUBLISH_READERS];
+	pthread_t thread[PUBLISH_READERS];
+	char buf[16];
+	int i;
+
+	res = PARAM_SET_new("{n}{x}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+	res = PST_PUBLISHER_new(PUBLISH_READERS, &pub);
+	CuAssert(tc, "Unable to create publisher.", res == PST_OK);
+
+	for (i = 0; i < PUBLISH_READERS; i++) {
+		ctx[i].pub = pub;
+		ctx[i].failures = 0;
+		res = PST_PUBLISHER_addReader(pub, &ctx[i].reader);
+		CuAssert(tc, "Unable to add reader.", res == PST_OK);
+		res = pthread_create(&thread[i], NULL, publish_reader_thread, &ctx[i]);
+		CuAssert(tc, "Unable to create thread.", res == 0);
+	}
+
+	for (i = 1; i <= PUBLISH_ROUNDS; i++) {
+		PST_snprintf(buf, sizeof(buf), "%i", i);
+		PARAM_SET_clearParameter(set, "{n}");
+		res = PARAM_SET_add(set, "n", buf, NULL, 0);
+		res += PARAM_SET_add(set, "x", "x", NULL, 0);
+		if (res == PST_OK) res = PARAM_SET_freeze(set, &frozen);
+		if (res == PST_OK) res = PST_PUBLISHER_publish(pub, frozen);
+		if (res != PST_OK) break;
+	}
+
+	for (i = 0; i < PUBLISH_READERS; i++) pthread_join(thread[i], NULL);
+
+	CuAssert(tc, "Unable to publish.", res == PST_OK);
+	for (i = 0; i < PUBLISH_READERS; i++) {
+		CuAssert(tc, "Reader saw an inconsistent set.", ctx[i].failures == 0);
+		PST_PUBLISHER_removeReader(pub, ctx[i].reader);
+	}
+
+	PST_PUBLISHER_free(pub);
+	PARAM_SET_free(set);
+}
+#endif
+
+static void Test_set_layers(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	PARAM_SET *defaults = NULL;
+	PARAM_SET *user = NULL;
+	char *value = NULL;
+	PARAM_ATR atr;
+	int count = 0;
+
+	res = PARAM_SET_new("{i}{o}{v}{x}", &set);
+	res += PARAM_SET_new("{i}{o}{v}", &defaults);
+	res += PARAM_SET_new("{i}{o}{d}", &user);
+	CuAssert(tc, "Unable to create new parameter sets.", res == PST_OK);
+
+	res = PARAM_SET_add(defaults, "i", "def_i", "defaults", 0);
+	res += PARAM_SET_add(defaults, "o", "def_o", "defaults", 0);
+	res += PARAM_SET_add(user, "i", "user_i", "user", 0);
+	res += PARAM_SET_add(user, "d", "user_d", "user", 0);
+	res += PARAM_SET_add(set, "i", "cmd_i", "cmd", 2);
+	CuAssert(tc, "Unable to add values.", res == PST_OK);
+
+	res = PARAM_SET_pushLayer(set, set, 0);
+	CuAssert(tc, "A set must not be its own layer.", res == PST_INVALID_ARGUMENT);
+	res = PARAM_SET_pushLayer(set, user, -1);
+	CuAssert(tc, "Offset must not be negative.", res == PST_PRIORITY_NEGATIVE);
+	res = PARAM_SET_removeLayer(set, user);
+	CuAssert(tc, "Set is not a layer.", res == PST_INVALID_ARGUMENT);
+
+	res = PARAM_SET_pushLayer(set, defaults, 0);
+	res += PARAM_SET_pushLayer(set, user, 1);
+	CuAssert(tc, "Unable to push layers.", res == PST_OK);
+
+	/* Own values first, followed by the layers. */
+	res = PARAM_SET_getValueCount(set, "{i}", NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Unexpected value count.", res == PST_OK && count == 3);
+	res = PARAM_SET_getStr(set, "i", NULL, PST_PRIORITY_NONE, 1, &value);
+	CuAssert(tc, "Unexpected value.", res == PST_OK && strcmp(value, "def_i") == 0);
+	res = PARAM_SET_getStr(set, "i", NULL, PST_PRIORITY_NONE, PST_INDEX_LAST, &value);
+	CuAssert(tc, "Unexpected value.", res == PST_OK && strcmp(value, "user_i") == 0);
+	res = PARAM_SET_getStr(set, "i", NULL, PST_PRIORITY_NONE, 3, &value);
+	CuAssert(tc, "Value must not exist.", res == PST_PARAMETER_VALUE_NOT_FOUND);
+
+	/* Priorities are shifted by the offset of the layer. */
+	res = PARAM_SET_getStr(set, "i", NULL, PST_PRIORITY_HIGHEST, PST_INDEX_LAST, &value);
+	CuAssert(tc, "Unexpected value.", res == PST_OK && strcmp(value, "cmd_i") == 0);
+	res = PARAM_SET_getStr(set, "i", NULL, 1, 0, &value);
+	CuAssert(tc, "Unexpected value.", res == PST_OK && strcmp(value, "user_i") == 0);
+	res = PARAM_SET_getStr(set, "i", NULL, PST_PRIORITY_LOWEST, PST_INDEX_LAST, &value);
+	CuAssert(tc, "Unexpected value.", res == PST_OK && strcmp(value, "def_i") == 0);
+	res = PARAM_SET_getValueCount(set, "{i}", NULL, PST_PRIORITY_HIGHER_THAN + 0, &count);
+	CuAssert(tc, "Unexpected value count.", res == PST_OK && count == 2);
+	res = PARAM_SET_getAtr(set, "i", NULL, PST_PRIORITY_NONE, 2, &atr);
+	CuAssert(tc, "Unexpected attributes.", res == PST_OK && atr.priority == 1 && strcmp(atr.source, "user") == 0);
+
+	/* Only parameters known to the set are visible. */
+	res = PARAM_SET_getStr(set, "o", "defaults", PST_PRIORITY_NONE, 0, &value);
+	CuAssert(tc, "Unexpected value.", res == PST_OK && strcmp(value, "def_o") == 0);
+	res = PARAM_SET_getStr(set, "d", NULL, PST_PRIORITY_NONE, 0, &value);
+	CuAssert(tc, "Parameter must not exist.", res == PST_PARAMETER_NOT_FOUND);
+	res = PARAM_SET_getStr(set, "v", NULL, PST_PRIORITY_NONE, 0, &value);
+	CuAssert(tc, "Parameter must be empty.", res == PST_PARAMETER_EMPTY);
+	CuAssert(tc, "Parameter must be set.", PARAM_SET_isSetByName(set, "o") && PARAM_SET_isOneOfSetByName(set, "{x}{o}"));
+	CuAssert(tc, "Parameter must not be set.", !PARAM_SET_isSetByName(set, "v"));
+
+	/* Layers are not copied. */
+	res = PARAM_SET_add(user, "o", "user_o", "user", 0);
+	CuAssert(tc, "Unable to add values.", res == PST_OK);
+	res = PARAM_SET_getStr(set, "o", NULL, PST_PRIORITY_HIGHEST, PST_INDEX_LAST, &value);
+	CuAssert(tc, "Unexpected value.", res == PST_OK && strcmp(value, "user_o") == 0);
+
+	res = PARAM_SET_removeLayer(set, defaults);
+	CuAssert(tc, "Unable to remove layer.", res == PST_OK);
+	res = PARAM_SET_getValueCount(set, "{i}", NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Unexpected value count.", res == PST_OK && count == 2);
+	res = PARAM_SET_removeLayer(set, user);
+	CuAssert(tc, "Unable to remove layer.", res == PST_OK);
+	CuAssert(tc, "Parameter must not be set.", !PARAM_SET_isSetByName(set, "o"));
+	res = PARAM_SET_pushLayer(set, user, 0);
+	CuAssert(tc, "Unable to push layers.", res == PST_OK);
+
+	PARAM_SET_free(set);
+	PARAM_SET_free(defaults);
+	PARAM_SET_free(user);
+}
+
+static int parse_many_configure(void *ctx, PARAM_SET *set) {
+	int *fail = (int*)ctx;
+	if (*fail) return PST_INVALID_ARGUMENT;
+	return PARAM_SET_addControl(set, "{i}", controlFormat_isAlpha, NULL, NULL, NULL);
+}
+
+static void Test_set_parse_many(CuTest* tc) {
+	int res;
+	PARAM_SET_SPEC *spec = NULL;
+	PARAM_SET_CMD cmd[64];
+	char *argv_ok[] = {"<path>", "-i", "abc", "--output", "o1", NULL};
+	char *argv_bad[] = {"<path>", "-i", "123", NULL};
+	char *argv_typo[] = {"<path>", "--outpt", "o1", NULL};
+	int fail = 0;
+	size_t i;
+
+	res = PARAM_SET_SPEC_new("{h|help}{i|input}{o|output}", &spec);
+	CuAssert(tc, "Unable to create spec.", res == PST_OK);
+
+	for (i = 0; i < 64; i++) {
+		cmd[i].argc = (i % 3 == 0) ? 5 : 3;
+		cmd[i].argv = (i % 3 == 0) ? argv_ok : ((i % 3 == 1) ? argv_bad : argv_typo);
+	}
+
+	res = PARAM_SET_parseMany(spec, parse_many_configure, &fail, cmd, 64, "cmd", 0, 4);
+	CuAssert(tc, "Unable to parse command lines.", res == PST_OK);
+
+	for (i = 0; i < 64; i++) {
+		CuAssert(tc, "Unable to parse command line.", cmd[i].result == PST_OK && cmd[i].set != NULL);
+
+		if (i % 3 == 0) {
+			assert_value(tc, cmd[i].set, "input", 0, __FILE__, __LINE__, "abc");
+			assert_value(tc, cmd[i].set, "o", 0, __FILE__, __LINE__, "o1");
+			CuAssert(tc, "Format must be OK.", PARAM_SET_isFormatOK(cmd[i].set));
+		} else if (i % 3 == 1) {
+			CuAssert(tc, "Format must not be OK.", !PARAM_SET_isFormatOK(cmd[i].set));
+		} else {
+			CuAssert(tc, "Typo must be detected.", PARAM_SET_isTypoFailure(cmd[i].set));
+		}
+
+		PARAM_SET_free(cmd[i].set);
+	}
+
+	/* Configuration failure is reported for every command line. */
+	fail = 1;
+	res = PARAM_SET_parseMany(spec, parse_many_configure, &fail, cmd, 2, NULL, 0, 2);
+	CuAssert(tc, "Parsing must be performed.", res == PST_OK);
+	CuAssert(tc, "Configuration must fail.", cmd[0].result == PST_INVALID_ARGUMENT && cmd[1].result == PST_INVALID_ARGUMENT);
+	PARAM_SET_free(cmd[0].set);
+	PARAM_SET_free(cmd[1].set);
+
+	res = PARAM_SET_parseMany(spec, NULL, NULL, cmd, 1, NULL, 0, 0);
+	CuAssert(tc, "Thread count must be invalid.", res == PST_INVALID_ARGUMENT);
+
+	PARAM_SET_SPEC_free(spec);
+}
+
+static void Test_set_typo_memo(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	PARAM_SET_STATS stats;
+	unsigned long distances = 0;
+	char buf[1024];
+	const char *p = NULL;
+	int count = 0;
+
+	res = PARAM_SET_new("{str}{b}{long-name}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_add(set, "long-nam", "x", "a", 0);
+	CuAssert(tc, "Parameter must be a typo.", res == PST_PARAMETER_IS_TYPO);
+	res = PARAM_SET_getStats(set, &stats);
+	CuAssert(tc, "Unable to get stats.", res == PST_OK);
+	distances = stats.editDistances;
+
+	/* The repeated name is classified without analyzing it again. */
+	res = PARAM_SET_add(set, "long-nam", "x", "b", 0);
+	CuAssert(tc, "Parameter must be a typo.", res == PST_PARAMETER_IS_TYPO);
+	res = PARAM_SET_getStats(set, &stats);
+	CuAssert(tc, "Typo must not be analyzed again.", res == PST_OK && stats.editDistances == distances);
+	CuAssert(tc, "Unable to list typos.", PARAM_SET_typosToString(set, NULL, buf, sizeof(buf)) != NULL);
+	for (p = buf; (p = strstr(p, "'long-nam'")) != NULL; p++) count++;
+	CuAssert(tc, "Both typos must be listed.", count == 2);
+
+	/* Changing the parsing options changes the result. */
+	res = PARAM_SET_setParseOptions(set, "{long-name}", PST_PRSCMD_HAS_VALUE | PST_PRSCMD_NO_TYPOS);
+	CuAssert(tc, "Unable to set parsing options.", res == PST_OK);
+	res = PARAM_SET_add(set, "long-nam", "x", NULL, 0);
+	CuAssert(tc, "Parameter must be unknown.", res == PST_PARAMETER_IS_UNKNOWN);
+
+	PARAM_SET_free(set);
+}
+
+static void Test_set_typo_scratch_reused(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	char buf[1024];
+
+	res = PARAM_SET_new("{in|i}{output|o}{verbose|v}{long-name}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	/* Names shorter and longer than any known name use the same scratch area. */
+	res = PARAM_SET_add(set, "outpt", NULL, NULL, 0);
+	CuAssert(tc, "Parameter must be a typo.", res == PST_PARAMETER_IS_TYPO);
+	res = PARAM_SET_add(set, "a-name-that-is-longer-than-the-names-of-the-set", NULL, NULL, 0);
+	CuAssert(tc, "Parameter must be unknown.", res == PST_PARAMETER_IS_UNKNOWN);
+	res = PARAM_SET_add(set, "verbos", NULL, NULL, 0);
+	CuAssert(tc, "Parameter must be a typo.", res == PST_PARAMETER_IS_TYPO);
+	res = PARAM_SET_add(set, "long_name", NULL, NULL, 0);
+	CuAssert(tc, "Parameter must be a typo.", res == PST_PARAMETER_IS_TYPO);
+
+	CuAssert(tc, "Unable to list typos.", PARAM_SET_typosToString(set, NULL, buf, sizeof(buf)) != NULL);
+	CuAssert(tc, "Wrong typo suggestions.", strstr(buf, "'outpt'") != NULL && strstr(buf, "output") != NULL
+			&& strstr(buf, "'verbos'") != NULL && strstr(buf, "verbose") != NULL
+			&& strstr(buf, "'long_name'") != NULL && strstr(buf, "long-name") != NULL);
+
+	res = PARAM_SET_add(set, "output", "x", NULL, 0);
+	CuAssert(tc, "Unable to add value.", res == PST_OK);
+
+	PARAM_SET_free(set);
+}
+
+static void Test_set_stats(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	PARAM_SET_STATS stats;
+	char *value = NULL;
+	const char *fname = "param_set_stats.tmp";
+
+	res = PARAM_SET_new("{str}*{b}{long-name}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_addControl(set, "{str}", controlFormat_isAlpha, NULL, NULL, NULL);
+	CuAssert(tc, "Unable to add functions.", res == PST_OK);
+
+	res = PARAM_SET_add(set, "str", "abc", "src", 0);
+	res |= PARAM_SET_add(set, "str", "12", NULL, 0);
+	res |= PARAM_SET_add(set, "str", "def", NULL, 0);
+	CuAssert(tc, "Unable to add values.", res == PST_OK);
+
+	res = PARAM_SET_getStr(set, "str", NULL, PST_PRIORITY_NONE, 2, &value);
+	CuAssert(tc, "Unable to get value.", res == PST_OK && strcmp(value, "def") == 0);
+	res = PARAM_SET_getStr(set, "str", NULL, PST_PRIORITY_NONE, 0, &value);
+	CuAssert(tc, "Unable to get value.", res == PST_OK && strcmp(value, "abc") == 0);
+
+	res = PARAM_SET_add(set, "long-nam", "x", NULL, 0);
+	CuAssert(tc, "Parameter must be a typo.", res == PST_PARAMETER_IS_TYPO);
+
+	res = PARAM_SET_getStats(set, &stats);
+	CuAssert(tc, "Unable to get stats.", res == PST_OK);
+
+#ifdef PST_DISABLE_STATS
+	CuAssert(tc, "Counters must be removed.", stats.nameLookups == 0 && stats.valuesAllocated == 0);
+#else
+	CuAssert(tc, "Invalid lookup count.", stats.nameLookups == 7);
+	CuAssert(tc, "Invalid value count.", stats.valuesAllocated == 3);
+	CuAssert(tc, "Invalid string size.", stats.stringBytes == 4 + 4 + 3 + 4);
+	CuAssert(tc, "Invalid validator count.", stats.validatorCalls == 3);
+	CuAssert(tc, "Invalid iterator reset count.", stats.iteratorResets == 1);
+	CuAssert(tc, "Invalid edit distance count.", stats.editDistances == 3);
+	CuAssert(tc, "Invalid wildcard count.", stats.wildcardExpansions == 0);
+#endif
+
+	res = PARAM_SET_resetStats(set);
+	CuAssert(tc, "Unable to reset stats.", res == PST_OK);
+	res = PARAM_SET_getStats(set, &stats);
+	CuAssert(tc, "Counters must be reset.", res == PST_OK && stats.nameLookups == 0 && stats.valuesAllocated == 0);
+
+#ifndef PST_DISABLE_STATS
+	/* The strings that are still held are counted after the reset. */
+	CuAssert(tc, "String size must be kept.", stats.stringBytes == 4 + 4 + 3 + 4);
+
+	res = PARAM_SET_clearValue(set, "str", NULL, PST_PRIORITY_NONE, 0);
+	CuAssert(tc, "Unable to clear value.", res == PST_OK);
+	res = PARAM_SET_getStats(set, &stats);
+	CuAssert(tc, "Invalid string size.", res == PST_OK && stats.stringBytes == 3 + 4);
+
+	res = PARAM_SET_clearParameter(set, "str");
+	CuAssert(tc, "Unable to clear parameter.", res == PST_OK);
+	res = PARAM_SET_getStats(set, &stats);
+	CuAssert(tc, "Invalid string size.", res == PST_OK && stats.stringBytes == 0);
+
+	/* Values replaced by a reload are not counted. */
+	write_conf_file(fname, "--b 1\n");
+	res = PARAM_SET_reloadFromFile(set, fname, "conf", 0, NULL, NULL, NULL);
+	CuAssert(tc, "Unable to reload.", res == PST_OK);
+	write_conf_file(fname, "--b 22\n");
+	res = PARAM_SET_reloadFromFile(set, fname, "conf", 0, NULL, NULL, NULL);
+	CuAssert(tc, "Unable to reload.", res == PST_OK);
+	res = PARAM_SET_getStats(set, &stats);
+	CuAssert(tc, "Invalid string size.", res == PST_OK && stats.stringBytes == 3 + 5);
+	remove(fname);
+#else
+	VARIABLE_IS_NOT_USED(fname);
+#endif
+
+	PARAM_SET_free(set);
+}
+
+typedef struct TRACE_LOG_st {
+	int count;
+	int phase[64];
+	int isEnd[64];
+	double timestamp[64];
+} TRACE_LOG;
+
+static void trace_to_log(void *ctx, int phase, int isEnd, double timestamp) {
+	TRACE_LOG *log = (TRACE_LOG*)ctx;
+
+	if (log->count >= 64) return;
+	log->phase[log->count] = phase;
+	log->isEnd[log->count] = isEnd;
+	log->timestamp[log->count] = timestamp;
+	log->count++;
+}
+
+/**
+ * Returns 1 if the phases are properly nested, timestamps do not decrease and
+ * the phase is found in the log.
+ */
+static int trace_log_is_valid(const TRACE_LOG *log, int phase) {
+	int stack[64];
+	int depth = 0;
+	int i;
+	int is_found = 0;
+
+	for (i = 0; i < log->count; i++) {
+		if (i > 0 && log->timestamp[i] < log->timestamp[i - 1]) return 0;
+		if (log->phase[i] == phase) is_found = 1;
+
+		if (!log->isEnd[i]) {
+			stack[depth++] = log->phase[i];
+		} else if (depth == 0 || stack[--depth] != log->phase[i]) {
+			return 0;
+		}
+	}
+
+	return depth == 0 && is_found;
+}
+
+static void Test_set_trace_callback(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	TASK_SET *tasks = NULL;
+	TRACE_LOG log;
+	const char *fname = "param_set_trace.tmp";
+	char *argv[] = {"<path>", "-a", "1", "--bb", "x", NULL};
+	int argc = 5;
+
+	res = PARAM_SET_new("{a}{b}{c}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	memset(&log, 0, sizeof(log));
+	res = PARAM_SET_setTraceCallback(set, trace_to_log, &log);
+	CuAssert(tc, "Unable to set trace callback.", res == PST_OK);
+
+	res = PARAM_SET_parseCMD(set, argc, argv, NULL, 0);
+	CuAssert(tc, "Unable to parse command line.", res == PST_OK);
+	CuAssert(tc, "Invalid trace.", log.phase[0] == PST_TRACE_PARSE_CMD && !log.isEnd[0]
+			&& log.phase[log.count - 1] == PST_TRACE_PARSE_CMD && log.isEnd[log.count - 1]);
+	CuAssert(tc, "Invalid trace.", trace_log_is_valid(&log, PST_TRACE_TYPOS) && trace_log_is_valid(&log, PST_TRACE_WILDCARDS));
+
+	write_conf_file(fname, "--c 3\n");
+	memset(&log, 0, sizeof(log));
+	res = PARAM_SET_readFromFile(set, fname, NULL, 0);
+	remove(fname);
+	CuAssert(tc, "Unable to read file.", res == PST_OK);
+	CuAssert(tc, "Invalid trace.", log.count == 6 && log.phase[1] == PST_TRACE_FILE_IO && log.phase[3] == PST_TRACE_FILE_PARSE);
+	CuAssert(tc, "Invalid trace.", trace_log_is_valid(&log, PST_TRACE_READ_FILE));
+
+	res = TASK_SET_new(&tasks);
+	CuAssert(tc, "Unable to create task set.", res == PST_OK);
+	res = TASK_SET_add(tasks, 1, "Task 1", "a", NULL, NULL, NULL);
+	res |= TASK_SET_add(tasks, 2, "Task 2", "b", NULL, NULL, NULL);
+	CuAssert(tc, "Unable to add tasks.", res == PST_OK);
+
+	memset(&log, 0, sizeof(log));
+	res = TASK_SET_analyzeConsistency(tasks, set, 0.2);
+	CuAssert(tc, "Unable to analyze task set.", res == PST_OK);
+	CuAssert(tc, "Invalid trace.", log.count == 6 && log.phase[1] == PST_TRACE_TASK_SCORING && log.phase[3] == PST_TRACE_TASK_SORTING);
+	CuAssert(tc, "Invalid trace.", trace_log_is_valid(&log, PST_TRACE_ANALYZE_TASKS));
+
+	/* Tracing is disabled. */
+	memset(&log, 0, sizeof(log));
+	res = PARAM_SET_setTraceCallback(set, NULL, NULL);
+	res |= PARAM_SET_parseCMD(set, argc, argv, NULL, 0);
+	CuAssert(tc, "Trace must be disabled.", res == PST_OK && log.count == 0);
+	CuAssert(tc, "Invalid phase name.", strcmp(PARAM_SET_tracePhaseToString(PST_TRACE_FILE_IO), "file I/O") == 0);
+
+	TASK_SET_free(tasks);
+	PARAM_SET_free(set);
+}
+
+static void set_env(const char *name, const char *value) {
+#ifdef _WIN32
+	char buf[256];
+	PST_snprintf(buf, sizeof(buf), "%s=%s", name, value != NULL ? value : "");
+	_putenv(buf);
+#else
+	if (value != NULL) setenv(name, value, 1);
+	else unsetenv(name);
+#endif
+}
+
+static void Test_set_read_from_env(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	size_t count = 0;
+
+	res = PARAM_SET_new("{log-level}{o|output}{v}{log}{x}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_setParseOptions(set, "v", PST_PRSCMD_HAS_NO_VALUE);
+	CuAssert(tc, "Unable to set parse options.", res == PST_OK);
+
+	set_env("PSTTEST_LOG_LEVEL", "3");
+	set_env("PSTTEST_OUTPUT", "out.txt");
+	set_env("PSTTEST_V", "yes");
+	set_env("PSTTEST_LOG", "");
+	set_env("PSTTEST_LOGG", "typo");
+	set_env("PSTTEST_", "empty name");
+	set_env("PSTTESTX", "no prefix");
+
+	res = PARAM_SET_readFromEnv(set, "PSTTEST_", "env", 1);
+	CuAssert(tc, "Unable to read environment.", res == PST_OK);
+
+	assert_value(tc, set, "log-level", 0, __FILE__, __LINE__, "3");
+	assert_value(tc, set, "o", 0, __FILE__, __LINE__, "out.txt");
+	assert_value(tc, set, "v", 0, __FILE__, __LINE__, NULL);
+	assert_value(tc, set, "log", 0, __FILE__, __LINE__, "");
+	assert_param_set_value_count(tc, set, "{x}", NULL, PST_PRIORITY_NONE, __FILE__, __LINE__, 0);
+	assert_param_set_value_count(tc, set, "{log-level}{o}{v}{log}", "env", 1, __FILE__, __LINE__, 4);
+
+	/* Variables that do not match are not typos or unknowns. */
+	res = PARAM_SET_getDiagnosticCount(set, &count);
+	CuAssert(tc, "There must not be any diagnostics.", res == PST_OK && count == 0);
+
+	set_env("PSTTEST_LOG_LEVEL", NULL);
+	set_env("PSTTEST_OUTPUT", NULL);
+	set_env("PSTTEST_V", NULL);
+	set_env("PSTTEST_LOG", NULL);
+	set_env("PSTTEST_LOGG", NULL);
+	set_env("PSTTEST_", NULL);
+	set_env("PSTTESTX", NULL);
+
+	PARAM_SET_free(set);
+}
+
 static void Test_set_include_other_set(CuTest* tc) {
 	int res;
 	PARAM_SET *set_1 = NULL;
@@ -833,6 +2051,59 @@ static void Test_set_include_other_set(CuTest* tc) {
 	PARAM_SET_free(set_4);
 }
 
+static int include_check_calls = 0;
+
+static int include_check_isAlpha(const char *str) {
+	include_check_calls++;
+	return controlFormat_isAlpha(str);
+}
+
+static void Test_set_include_shares_values(CuTest* tc) {
+	int res;
+	PARAM_SET *target = NULL;
+	PARAM_SET *src = NULL;
+	char *src_value = NULL;
+	char *value = NULL;
+
+	res = PARAM_SET_new("{a}{b}", &target);
+	res += PARAM_SET_new("{a}{b}", &src);
+	CuAssert(tc, "Unable to create new parameter sets.", res == PST_OK);
+	res = PARAM_SET_addControl(target, "{a}", include_check_isAlpha, NULL, NULL, NULL);
+	res += PARAM_SET_addControl(src, "{a}", include_check_isAlpha, NULL, NULL, NULL);
+	res += PARAM_SET_addControl(target, "{b}", controlFormat_isAlpha, NULL, NULL, NULL);
+	CuAssert(tc, "Unable to add controls.", res == PST_OK);
+
+	res = PARAM_SET_add(src, "a", "abc", "src", 1);
+	res += PARAM_SET_add(src, "a", "123", NULL, 2);
+	res += PARAM_SET_add(src, "b", "456", NULL, 2);
+	CuAssert(tc, "Unable to add values.", res == PST_OK && include_check_calls == 2);
+
+	res = PARAM_SET_IncludeSet(target, target);
+	CuAssert(tc, "Set must not be included into itself.", res == PST_INVALID_ARGUMENT);
+	res = PARAM_SET_IncludeSet(target, src);
+	CuAssert(tc, "Unable to include set.", res == PST_OK);
+
+	/* Values with the same checks are shared and not checked again. */
+	CuAssert(tc, "Values must not be checked again.", include_check_calls == 2);
+	res = PARAM_SET_getStr(src, "a", NULL, PST_PRIORITY_NONE, 0, &src_value);
+	CuAssert(tc, "Unable to get value.", res == PST_OK);
+	res = PARAM_SET_getStr(target, "a", "src", 1, 0, &value);
+	CuAssert(tc, "Value must be shared.", res == PST_OK && value == src_value);
+	res = PARAM_SET_getStr(target, "a", NULL, PST_PRIORITY_HIGHEST, 0, &value);
+	CuAssert(tc, "Value must be invalid.", res == PST_PARAMETER_INVALID_FORMAT);
+
+	/* Values are checked with the checks of the target. */
+	res = PARAM_SET_getStr(target, "b", NULL, PST_PRIORITY_NONE, 0, &value);
+	CuAssert(tc, "Value must be invalid.", res == PST_PARAMETER_INVALID_FORMAT);
+
+	/* The shared values outlive the source set. */
+	PARAM_SET_free(src);
+	res = PARAM_SET_getStr(target, "a", "src", 1, 0, &value);
+	CuAssert(tc, "Unexpected value.", res == PST_OK && strcmp(value, "abc") == 0);
+
+	PARAM_SET_free(target);
+}
+
 static void Test_set_param_atr(CuTest* tc) {
 	int res;
 	PARAM_SET *set = NULL;
@@ -1264,6 +2535,48 @@ static void Test_help_text_multi_line_description(CuTest* tc) {
 	PARAM_SET_free(set);
 }
 
+static void Test_help_text_cached_per_width(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	const char *help = NULL;
+	char buf[2048];
+	char expected[2048];
+	size_t len = 0;
+	int width;
+	const char *txt = "List:\\>2\n*\\>4 item one that is long enough to wrap\\>2\n*\\>4 item\\ two\\>\ntext a b c\n";
+
+	res = PARAM_SET_new("{a|aaa}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+	res = PARAM_SET_setHelpText(set, "a", "<x>", txt);
+	CuAssert(tc, "It must be possible to add help text.", res == PST_OK);
+
+	/* The tokenized and cached rendering must match the direct rendering. */
+	for (width = 30; width <= 80; width += 5) {
+		int w = (width % 2 == 0) ? width : 110 - width;
+
+		len = PST_snhiprintf(expected, sizeof(expected), w, 2, 20, "-a, --aaa <x>", '-', "%s", txt);
+		PST_snprintf(expected + len, sizeof(expected) - len, "\n");
+
+		help = PARAM_SET_helpToString(set, "a", 2, 20, w, buf, sizeof(buf));
+		CuAssert(tc, "Unexpected help text generated!", help != NULL && strcmp(help, expected) == 0);
+		help = PARAM_SET_helpToString(set, "a", 2, 20, w, buf, sizeof(buf));
+		CuAssert(tc, "Unexpected cached help text!", help != NULL && strcmp(help, expected) == 0);
+	}
+
+	/* Changing the print name or the help text drops the cached row. */
+	res = PARAM_SET_setPrintName(set, "a", "-A", NULL);
+	CuAssert(tc, "Unable to set print name.", res == PST_OK);
+	help = PARAM_SET_helpToString(set, "a", 2, 10, 80, buf, sizeof(buf));
+	CuAssert(tc, "Unexpected help text generated!", help != NULL && strcmp(help, "  -A, --aaa <x>\n        - List:\n            * item one that is long enough to wrap\n            * item two\n          text a b c\n\n") == 0);
+
+	res = PARAM_SET_setHelpText(set, "a", NULL, "New text.");
+	CuAssert(tc, "It must be possible to add help text.", res == PST_OK);
+	help = PARAM_SET_helpToString(set, "a", 2, 10, 80, buf, sizeof(buf));
+	CuAssert(tc, "Unexpected help text generated!", help != NULL && strcmp(help, "  -A, --aaa <x>\n        - New text.\n") == 0);
+
+	PARAM_SET_free(set);
+}
+
 static void Test_help_text_multi_line_description_with_long_parameter(CuTest* tc) {
 	int res;
 	PARAM_SET *set = NULL;
@@ -1365,24 +2678,125 @@ static void Test_help_text_parsing_error(CuTest* tc) {
 	PARAM_SET_free(set);
 }
 
+typedef struct SINK_COLLECTOR_st {
+	char buf[4096];
+	size_t len;
+	int calls;
+	int fail_at;
+} SINK_COLLECTOR;
+
+static int sink_collector_write(void *ctx, const char *data, size_t len) {
+	SINK_COLLECTOR *col = (SINK_COLLECTOR*)ctx;
+
+	col->calls++;
+	if (col->fail_at != 0 && col->calls >= col->fail_at) return PST_IO_ERROR;
+	if (col->len + len >= sizeof(col->buf)) return PST_INDEX_OVF;
+
+	memcpy(col->buf + col->len, data, len);
+	col->len += len;
+	col->buf[col->len] = '\0';
+	return PST_OK;
+}
+
+static void Test_param_set_output_to_sink(CuTest* tc) {
+	int res;
+	PARAM_SET *set = NULL;
+	SINK_COLLECTOR col;
+	char buf[4096];
+	char small[16];
+	size_t count = 0;
+
+	res = PARAM_SET_new("{a}{abc}{test}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK);
+
+	res = PARAM_SET_setHelpText(set, "a,abc,test", NULL, "This is a long description string that must be formatted to multiple lines.");
+	CuAssert(tc, "It must be possible to add help text.", res == PST_OK);
+
+	PARAM_SET_add(set, "tst", NULL, NULL, 0);
+	PARAM_SET_add(set, "unknown-xyz", NULL, NULL, 0);
+	PARAM_SET_add(set, "a", "value", "src", 1);
+
+	/* Help: sink output must match the buffer output and dry-run must count the exact size. */
+	CuAssert(tc, "Help is not generated!", PARAM_SET_helpToString(set, "a,abc,test", 2, 10, 40, buf, sizeof(buf)) != NULL);
+	memset(&col, 0, sizeof(col));
+	res = PARAM_SET_helpToSink(set, "a,abc,test", 2, 10, 40, sink_collector_write, &col, &count);
+	CuAssert(tc, "Unable to stream help.", res == PST_OK);
+	CuAssert(tc, "Streamed help differs.", strcmp(col.buf, buf) == 0 && count == strlen(buf));
+	res = PARAM_SET_helpToSink(set, "a,abc,test", 2, 10, 40, NULL, NULL, &count);
+	CuAssert(tc, "Dry-run count is invalid.", res == PST_OK && count == strlen(buf));
+	res = PARAM_SET_helpToSink(set, "a,x", 2, 10, 40, NULL, NULL, &count);
+	CuAssert(tc, "Unknown parameter must fail.", res == PST_PARAMETER_NOT_FOUND);
+
+	/* Truncated buffer output is a prefix of the full output. */
+	CuAssert(tc, "Help is not generated!", PARAM_SET_helpToString(set, "a,abc,test", 2, 10, 40, small, sizeof(small)) != NULL);
+	CuAssert(tc, "Truncated help is invalid.", strlen(small) == sizeof(small) - 1 && strncmp(small, buf, sizeof(small) - 1) == 0);
+
+	/* Typos and unknowns. */
+	CuAssert(tc, "Typos are not generated!", PARAM_SET_typosToString(set, "Typo: ", buf, sizeof(buf)) != NULL);
+	memset(&col, 0, sizeof(col));
+	res = PARAM_SET_typosToSink(set, "Typo: ", sink_collector_write, &col, &count);
+	CuAssert(tc, "Streamed typos differ.", res == PST_OK && strcmp(col.buf, buf) == 0 && count == strlen(buf));
+
+	CuAssert(tc, "Unknowns are not generated!", PARAM_SET_unknownsToString(set, NULL, buf, sizeof(buf)) != NULL);
+	memset(&col, 0, sizeof(col));
+	res = PARAM_SET_unknownsToSink(set, NULL, sink_collector_write, &col, &count);
+	CuAssert(tc, "Streamed unknowns differ.", res == PST_OK && strcmp(col.buf, buf) == 0 && count == strlen(buf));
+
+	/* Debug output. */
+	CuAssert(tc, "Set string is not generated!", PARAM_SET_toString(set, buf, sizeof(buf)) != NULL);
+	res = PARAM_SET_toSink(set, NULL, NULL, &count);
+	CuAssert(tc, "Dry-run count is invalid.", res == PST_OK && count == strlen(buf));
+
+	/* Failing write callback stops the output. */
+	memset(&col, 0, sizeof(col));
+	col.fail_at = 2;
+	res = PARAM_SET_helpToSink(set, "a,abc,test", 2, 10, 40, sink_collector_write, &col, &count);
+	CuAssert(tc, "Write error must be returned.", res == PST_IO_ERROR);
+	CuAssert(tc, "Output must be stopped.", col.calls == 2 && count == col.len);
+
+	PARAM_SET_free(set);
+}
+
 CuSuite* ParamSetTest_getSuite(void) {
 	CuSuite* suite = CuSuiteNew();
 	SUITE_ADD_TEST(suite, Test_param_add_count_clear);
 	SUITE_ADD_TEST(suite, Test_param_invalid);
+	SUITE_ADD_TEST(suite, Test_param_set_validate_all);
 	SUITE_ADD_TEST(suite, Test_param_set_typos);
 	SUITE_ADD_TEST(suite, Test_param_set_typos_sub_str_middle);
 	SUITE_ADD_TEST(suite, Test_param_set_typos_substring_at_beginning);
 	SUITE_ADD_TEST(suite, Test_param_set_unknown);
 	SUITE_ADD_TEST(suite, Test_param_remove_element);
 	SUITE_ADD_TEST(suite, Test_param_set_from_cmd_flags);
+	SUITE_ADD_TEST(suite, Test_param_set_name_lookup);
 	SUITE_ADD_TEST(suite, Test_set_get_object);
 	SUITE_ADD_TEST(suite, Test_set_get_str);
 	SUITE_ADD_TEST(suite, Test_key_value_pairs);
 	SUITE_ADD_TEST(suite, Test_set_read_from_file);
 	SUITE_ADD_TEST(suite, Test_set_read_from_file_weird_format);
 	SUITE_ADD_TEST(suite, Test_set_read_from_invalid_file);
+	SUITE_ADD_TEST(suite, Test_set_read_from_file_cached);
+	SUITE_ADD_TEST(suite, Test_set_reload_from_file);
+	SUITE_ADD_TEST(suite, Test_set_reload_diagnostics);
+	SUITE_ADD_TEST(suite, Test_set_reload_keeps_other_diagnostics);
+	SUITE_ADD_TEST(suite, Test_set_read_from_env);
 	SUITE_ADD_TEST(suite, Test_set_read_from_invalid_file_no_messages);
+	SUITE_ADD_TEST(suite, Test_set_diagnostic_records);
+	SUITE_ADD_TEST(suite, Test_set_snapshot_save_and_load);
+	SUITE_ADD_TEST(suite, Test_set_new_from_spec);
+	SUITE_ADD_TEST(suite, Test_set_parse_many);
+	SUITE_ADD_TEST(suite, Test_set_publish_frozen);
+	SUITE_ADD_TEST(suite, Test_set_frozen_same_as_set);
+#ifdef HAVE_PTHREAD_H
+	SUITE_ADD_TEST(suite, Test_set_publish_threads);
+#endif
+	SUITE_ADD_TEST(suite, Test_set_layers);
+	SUITE_ADD_TEST(suite, Test_set_stats);
+	SUITE_ADD_TEST(suite, Test_set_typo_memo);
+	SUITE_ADD_TEST(suite, Test_set_typo_scratch_reused);
+	SUITE_ADD_TEST(suite, Test_set_trace_callback);
 	SUITE_ADD_TEST(suite, Test_set_include_other_set);
+	SUITE_ADD_TEST(suite, Test_set_include_shares_values);
 	SUITE_ADD_TEST(suite, Test_set_param_atr);
 	SUITE_ADD_TEST(suite, Test_param_set_read_line);
 	SUITE_ADD_TEST(suite, Test_param_set_read_line_2);
@@ -1395,10 +2809,12 @@ CuSuite* ParamSetTest_getSuite(void) {
 	SUITE_ADD_TEST(suite, Test_basic_help_text_with_arg);
 	SUITE_ADD_TEST(suite, Test_help_text_with_arg_exact_line_length);
 	SUITE_ADD_TEST(suite, Test_help_text_multi_line_description);
+	SUITE_ADD_TEST(suite, Test_help_text_cached_per_width);
 	SUITE_ADD_TEST(suite, Test_help_text_multi_line_description_with_long_parameter);
 	SUITE_ADD_TEST(suite, Test_help_text_multi_line_description_with_changed_indentation);
 	SUITE_ADD_TEST(suite, Test_help_text_with_specified_alias);
 	SUITE_ADD_TEST(suite, Test_help_text_parsing_error);
+	SUITE_ADD_TEST(suite, Test_param_set_output_to_sink);
 	return suite;
 }
 
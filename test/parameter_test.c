@@ -23,6 +23,7 @@
 
 #include "cutest/CuTest.h"
 #include "all_tests.h"
+#include "../src/param_set/strn.h"
 #include "../src/param_set/param_value.h"
 #include "../src/param_set/parameter.h"
 #include "../src/param_set/param_set_obj_impl.h"
@@ -309,6 +310,182 @@ static void Test_SetValuesAndControl(CuTest* tc) {
 	PARAM_free(p4);
 }
 
+static int lazy_control_call_count = 0;
+
+static int controlFormat_isAlpha_counted(const char *value) {
+	lazy_control_call_count++;
+	return controlFormat_isAlpha(value);
+}
+
+static void Test_LazyValueControl(CuTest* tc) {
+	int res;
+	PARAM *p1 = NULL;
+	PARAM_VAL *value = NULL;
+	int count = 0xffff;
+
+	res = PARAM_new("test1", NULL, 0, 0, &p1);
+	CuAssert(tc, "Unable to create PARAM obj.", res == PST_OK);
+
+	res = PARAM_addControl(p1, controlFormat_isAlpha_counted, NULL, NULL);
+	res += PARAM_setControlOptions(p1, PST_CONTROL_LAZY);
+	CuAssert(tc, "Unable to set control.", res == PST_OK && PARAM_isControlOptionSet(p1, PST_CONTROL_LAZY));
+
+	lazy_control_call_count = 0;
+	res = PARAM_addValue(p1, "abcd", NULL, 0);
+	res += PARAM_addValue(p1, "1234", NULL, 0);
+	res += PARAM_addValue(p1, "efgh", NULL, 0);
+	CuAssert(tc, "Unable to add values.", res == PST_OK);
+	CuAssert(tc, "Format must not be checked when value is added.", lazy_control_call_count == 0);
+
+	/* Only the value accessed is checked. */
+	res = PARAM_getValue(p1, NULL, PST_PRIORITY_NONE, 1, &value);
+	CuAssert(tc, "Unable to get value.", res == PST_OK && value->formatStatus == 1);
+	CuAssert(tc, "Only a single value must be checked.", lazy_control_call_count == 1);
+
+	res = PARAM_getValue(p1, NULL, PST_PRIORITY_NONE, 1, &value);
+	CuAssert(tc, "Value must not be checked twice.", res == PST_OK && lazy_control_call_count == 1);
+
+	/* All remaining values are checked in a batch. */
+	res = PARAM_getInvalidCount(p1, NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Invalid count.", res == PST_OK && count == 1);
+	CuAssert(tc, "All values must be checked.", lazy_control_call_count == 3);
+
+	/* Pending values are checked when lazy option is removed. */
+	res = PARAM_addValue(p1, "5678", NULL, 0);
+	CuAssert(tc, "Unable to add value.", res == PST_OK && lazy_control_call_count == 3);
+
+	res = PARAM_setControlOptions(p1, PST_CONTROL_DEFAULT);
+	CuAssert(tc, "Pending value must be checked.", res == PST_OK && lazy_control_call_count == 4);
+
+	res = PARAM_addValue(p1, "ijkl", NULL, 0);
+	CuAssert(tc, "Value must be checked when added.", res == PST_OK && lazy_control_call_count == 5);
+
+	PARAM_free(p1);
+}
+
+static void Test_ControlResultCache(CuTest* tc) {
+	int res;
+	int i = 0;
+	PARAM *p1 = NULL;
+	int count = 0xffff;
+	char buf[32];
+
+	res = PARAM_new("test1", NULL, 0, 0, &p1);
+	CuAssert(tc, "Unable to create PARAM obj.", res == PST_OK);
+
+	res = PARAM_addControl(p1, controlFormat_isAlpha_counted, NULL, NULL);
+	res += PARAM_setControlOptions(p1, PST_CONTROL_CACHE);
+	CuAssert(tc, "Unable to set control.", res == PST_OK);
+
+	/* Repeated values are checked only once. */
+	lazy_control_call_count = 0;
+	for (i = 0; i < 10; i++) {
+		res = PARAM_addValue(p1, "abcd", NULL, 0);
+		res += PARAM_addValue(p1, "1234", NULL, 0);
+		CuAssert(tc, "Unable to add values.", res == PST_OK);
+	}
+	CuAssert(tc, "Each distinct value must be checked once.", lazy_control_call_count == 2);
+
+	res = PARAM_getInvalidCount(p1, NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Invalid count.", res == PST_OK && count == 10);
+
+	/* Cache must remain bounded and keep working after eviction. */
+	for (i = 0; i < 1000; i++) {
+		PST_snprintf(buf, sizeof(buf), "%i", i);
+		res = PARAM_addValue(p1, buf, NULL, 0);
+		CuAssert(tc, "Unable to add values.", res == PST_OK);
+	}
+	CuAssert(tc, "Each distinct value must be checked.", lazy_control_call_count == 1002);
+
+	res = PARAM_getInvalidCount(p1, NULL, PST_PRIORITY_NONE, &count);
+	CuAssert(tc, "Invalid count.", res == PST_OK && count == 1010);
+
+	lazy_control_call_count = 0;
+	res = PARAM_addValue(p1, "999", NULL, 0);
+	CuAssert(tc, "Recent value must be cached.", res == PST_OK && lazy_control_call_count == 0);
+
+	/* Changing the controls must invalidate cached results. */
+	res = PARAM_addControl(p1, controlFormat_isAlpha_counted, NULL, NULL);
+	res += PARAM_addValue(p1, "999", NULL, 0);
+	CuAssert(tc, "Value must be checked again.", res == PST_OK && lazy_control_call_count == 1);
+
+	PARAM_free(p1);
+}
+
+static int convert_sized_repeat_upper(const char *value, char *buf, size_t *buf_len) {
+	size_t len = strlen(value);
+	size_t i = 0;
+
+	/* Lower case values are used as they are. */
+	if (len == 0 || islower((unsigned char)value[0])) return PST_PARAM_CONVERT_NOT_PERFORMED;
+
+	if (buf == NULL) {
+		*buf_len = len * 1000 + 1;
+		return PST_OK;
+	}
+
+	if (*buf_len < len * 1000 + 1) return PST_INVALID_ARGUMENT;
+	for (i = 0; i < 1000; i++) memcpy(buf + i * len, value, len);
+	buf[len * 1000] = '\0';
+
+	return PST_OK;
+}
+
+static int convert_sized_bad_length(const char *value, char *buf, size_t *buf_len) {
+	/* Asks for a small buffer and reports a bigger or empty result. */
+	if (buf == NULL) {
+		*buf_len = 4;
+		return PST_OK;
+	}
+
+	memcpy(buf, "abc", 4);
+	*buf_len = (value[0] == '0') ? 0 : 5000;
+
+	return PST_OK;
+}
+
+static void Test_SizedConverter(CuTest* tc) {
+	int res;
+	PARAM *p1 = NULL;
+	PARAM_VAL *value = NULL;
+	const char *str = NULL;
+
+	res = PARAM_new("test1", NULL, 0, 0, &p1);
+	CuAssert(tc, "Unable to create PARAM obj.", res == PST_OK);
+
+	res = PARAM_addControl(p1, controlFormat_isAlpha, NULL, convert_replaceNonAlpha);
+	res += PARAM_setConverter(p1, convert_sized_repeat_upper);
+	CuAssert(tc, "Unable to set converter.", res == PST_OK);
+
+	res = PARAM_addValue(p1, "ABCD", NULL, 0);
+	res += PARAM_addValue(p1, "ab1cd", NULL, 0);
+	CuAssert(tc, "Unable to add values.", res == PST_OK);
+
+	/* Converted value must not be truncated. */
+	res = PARAM_getValue(p1, NULL, PST_PRIORITY_NONE, 0, &value);
+	res += PARAM_VAL_extract(value, &str, NULL, NULL);
+	CuAssert(tc, "Unable to get value.", res == PST_OK && strlen(str) == 4000);
+	CuAssert(tc, "Invalid value.", strncmp(str, "ABCDABCD", 8) == 0 && strcmp(str + 3996, "ABCD") == 0);
+	CuAssert(tc, "Invalid format status.", value->formatStatus == 0);
+
+	/* Value passed through is not converted by the other converter. */
+	res = PARAM_getValue(p1, NULL, PST_PRIORITY_NONE, 1, &value);
+	res += PARAM_VAL_extract(value, &str, NULL, NULL);
+	CuAssert(tc, "Unable to get value.", res == PST_OK && strcmp(str, "ab1cd") == 0);
+	CuAssert(tc, "Invalid format status.", value->formatStatus == 1);
+
+	/* Length returned by the second call must fit into the buffer. */
+	res = PARAM_setConverter(p1, convert_sized_bad_length);
+	CuAssert(tc, "Unable to set converter.", res == PST_OK);
+
+	res = PARAM_addValue(p1, "1", NULL, 0);
+	CuAssert(tc, "Too long result must fail.", res == PST_PARAMETER_INVALID_FORMAT);
+	res = PARAM_addValue(p1, "0", NULL, 0);
+	CuAssert(tc, "Empty result must fail.", res == PST_PARAMETER_INVALID_FORMAT);
+
+	PARAM_free(p1);
+}
+
 static int wrapper_returnStr(void **extra, const char* str, void** obj){
 	VARIABLE_IS_NOT_USED(extra);
 	*obj = (void*)str;
@@ -774,6 +951,27 @@ static void Test_setHelpText(CuTest* tc) {
 	PARAM_free(param);
 }
 
+static void Test_coldDataAllocatedOnDemand(CuTest* tc) {
+	int res;
+	PARAM *param = NULL;
+
+	res = PARAM_new("p", "param", 0, 0, &param);
+	CuAssert(tc, "Unable to create PARAM obj.", res == PST_OK);
+	CuAssert(tc, "Cold data must not be allocated.", param->cold == NULL);
+	CuAssert(tc, "Unexpected print name.", strcmp(PARAM_getPrintName(param), "-p") == 0);
+	CuAssert(tc, "Unexpected print name.", strcmp(PARAM_getPrintNameAlias(param), "--param") == 0);
+	CuAssert(tc, "Cold data must not be allocated.", param->cold == NULL);
+
+	res = PARAM_setPrintNameAlias(param, "<param>", NULL);
+	CuAssert(tc, "Unable to set print name.", res == PST_OK);
+	CuAssert(tc, "Cold data must be allocated.", param->cold != NULL);
+	CuAssert(tc, "Unexpected print name.", strcmp(PARAM_getPrintName(param), "-p") == 0);
+	CuAssert(tc, "Unexpected print name.", strcmp(PARAM_getPrintNameAlias(param), "<param>") == 0);
+	CuAssert(tc, "Help text must be NULL.", PARAM_getHelpText(param) == NULL);
+
+	PARAM_free(param);
+}
+
 static void Test_getName(CuTest* tc) {
 	int res;
 	PARAM *param = NULL;
@@ -797,6 +995,9 @@ CuSuite* ParameterTest_getSuite(void) {
 	SUITE_ADD_TEST(suite, Test_parameterConstraints);
 	SUITE_ADD_TEST(suite, Test_parameterGetValue);
 	SUITE_ADD_TEST(suite, Test_SetValuesAndControl);
+	SUITE_ADD_TEST(suite, Test_LazyValueControl);
+	SUITE_ADD_TEST(suite, Test_ControlResultCache);
+	SUITE_ADD_TEST(suite, Test_SizedConverter);
 	SUITE_ADD_TEST(suite, Test_ObjectGetter);
 	SUITE_ADD_TEST(suite, Test_ParseOptionSetter);
 	SUITE_ADD_TEST(suite, Test_WildcarcExpander_defaultWC);
@@ -808,6 +1009,7 @@ CuSuite* ParameterTest_getSuite(void) {
 	SUITE_ADD_TEST(suite, Test_getAttributes);
 	SUITE_ADD_TEST(suite, Test_getName);
 	SUITE_ADD_TEST(suite, Test_setHelpText);
+	SUITE_ADD_TEST(suite, Test_coldDataAllocatedOnDemand);
 
 	return suite;
 }
@@ -24,6 +24,7 @@
 
 #include "cutest/CuTest.h"
 #include "all_tests.h"
+#include "../src/param_set/strn.h"
 #include "../src/param_set/param_set_obj_impl.h"
 #include "../src/param_set/param_set.h"
 #include "../src/param_set/task_def.h"
@@ -783,6 +784,156 @@ static void Test_task_set_is_one_target_single_task(CuTest* tc) {
 }
 
 
+typedef struct {
+	const char *man;
+	const char *atleast_one;
+	const char *forb;
+} TEST_TASK;
+
+static const TEST_TASK test_tasks[] = {
+	{"a", NULL, "b"},
+	{"a,b", NULL, NULL},
+	{"a,b,c", NULL, NULL},
+	{"d", "x,y", NULL},
+	/* Tasks that tie with the ones above. */
+	{"a", NULL, NULL},
+	{"d", "x,y", NULL},
+	{"b,c", NULL, "y"},
+	{"c,d", "x", NULL}
+};
+
+static void add_test_tasks(TASK_SET *tasks, size_t count) {
+	size_t i;
+	char name[32];
+
+	for (i = 0; i < count; i++) {
+		PST_snprintf(name, sizeof(name), "Task %u", (unsigned)i);
+		TASK_SET_add(tasks, (int)i, name, test_tasks[i].man, test_tasks[i].atleast_one, test_tasks[i].forb, NULL);
+	}
+}
+
+static void assert_same_as_new_analysis(CuTest* tc, TASK_SET *tasks, PARAM_SET *set, size_t count) {
+	int res;
+	TASK_SET *fresh = NULL;
+
+	res = TASK_SET_new(&fresh);
+	CuAssert(tc, "Unable to create new task set.", res == PST_OK && fresh != NULL);
+
+	add_test_tasks(fresh, count);
+
+	res = TASK_SET_analyzeConsistency(fresh, set, 0.2);
+	CuAssert(tc, "Unable to analyze.", res == PST_OK);
+
+	CuAssert(tc, "Order differs from the order of the new analysis.",
+			memcmp(tasks->index, fresh->index, count * sizeof(fresh->index[0])) == 0);
+	CuAssert(tc, "Consistent task count differs from the new analysis.",
+			tasks->consistent_count == fresh->consistent_count);
+
+	TASK_SET_free(fresh);
+}
+
+static void Test_task_set_analyze_after_change(CuTest* tc) {
+	int res;
+	TASK_SET *tasks = NULL;
+	PARAM_SET *set = NULL;
+	TASK *cons_task = NULL;
+	TASK *tmp = NULL;
+
+	res = PARAM_SET_new("{a}{b}{c}{d}{x}{y}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK && set != NULL);
+
+	param_set_add(tc, set, "a", __FILE__, __LINE__);
+
+	res = TASK_SET_new(&tasks);
+	CuAssert(tc, "Unable to create new task set.", res == PST_OK && tasks != NULL);
+
+	add_test_tasks(tasks, 4);
+
+	res = TASK_SET_analyzeConsistency(tasks, set, 0.2);
+	CuAssert(tc, "Unable to analyze.", res == PST_OK);
+
+	res = TASK_SET_getConsistentTask(tasks, &cons_task);
+	CuAssert(tc, "Task 0 must be consistent.", res == PST_OK && cons_task->id == 0);
+
+	/* Task 0 forbids b, so Task 1 becomes the consistent one. */
+	param_set_add(tc, set, "b", __FILE__, __LINE__);
+
+	res = TASK_SET_analyzeConsistency(tasks, set, 0.2);
+	CuAssert(tc, "Unable to analyze.", res == PST_OK);
+
+	res = TASK_SET_getConsistentTask(tasks, &tmp);
+	CuAssert(tc, "Task 1 must be consistent.", res == PST_OK && tmp == cons_task && tmp->id == 1);
+	assert_same_as_new_analysis(tc, tasks, set, 4);
+
+	/* Nothing has changed. */
+	res = TASK_SET_analyzeConsistency(tasks, set, 0.2);
+	CuAssert(tc, "Unable to analyze.", res == PST_OK);
+	assert_same_as_new_analysis(tc, tasks, set, 4);
+
+	param_set_add(tc, set, "d,x", __FILE__, __LINE__);
+
+	res = TASK_SET_analyzeConsistency(tasks, set, 0.2);
+	CuAssert(tc, "Unable to analyze.", res == PST_OK);
+
+	res = TASK_SET_getConsistentTask(tasks, &tmp);
+	CuAssert(tc, "There must be two consistent tasks.", res == PST_TASK_MULTIPLE_CONSISTENT_TASKS);
+	assert_same_as_new_analysis(tc, tasks, set, 4);
+
+	res = PARAM_SET_clearParameter(set, "{b}{d}");
+	CuAssert(tc, "Unable to clear parameters.", res == PST_OK);
+
+	res = TASK_SET_analyzeConsistency(tasks, set, 0.2);
+	CuAssert(tc, "Unable to analyze.", res == PST_OK);
+
+	res = TASK_SET_getConsistentTask(tasks, &tmp);
+	CuAssert(tc, "Task 0 must be consistent again.", res == PST_OK && tmp->id == 0);
+	assert_same_as_new_analysis(tc, tasks, set, 4);
+
+	PARAM_SET_free(set);
+	TASK_SET_free(tasks);
+}
+
+static void Test_task_set_analyze_after_random_changes(CuTest* tc) {
+	int res;
+	TASK_SET *tasks = NULL;
+	PARAM_SET *set = NULL;
+	const char *names[] = {"a", "b", "c", "d", "x", "y"};
+	char buf[16];
+	unsigned long seed = 12345;
+	int i;
+	int n;
+
+	res = PARAM_SET_new("{a}{b}{c}{d}{x}{y}", &set);
+	CuAssert(tc, "Unable to create new parameter set.", res == PST_OK && set != NULL);
+
+	res = TASK_SET_new(&tasks);
+	CuAssert(tc, "Unable to create new task set.", res == PST_OK && tasks != NULL);
+
+	add_test_tasks(tasks, sizeof(test_tasks) / sizeof(test_tasks[0]));
+
+	/* Random edits, each followed by incremental analysis. */
+	for (i = 0; i < 2000; i++) {
+		seed = (seed * 1103515245UL + 12345UL) & 0x7fffffffUL;
+		n = (int)((seed >> 8) % 6);
+
+		if ((seed >> 4) & 1) {
+			res = PARAM_SET_add(set, names[n], NULL, NULL, 0);
+		} else {
+			PST_snprintf(buf, sizeof(buf), "{%s}", names[n]);
+			res = PARAM_SET_clearParameter(set, buf);
+		}
+		CuAssert(tc, "Unable to change parameter.", res == PST_OK);
+
+		res = TASK_SET_analyzeConsistency(tasks, set, 0.2);
+		CuAssert(tc, "Unable to analyze.", res == PST_OK);
+		assert_same_as_new_analysis(tc, tasks, set, sizeof(test_tasks) / sizeof(test_tasks[0]));
+	}
+
+	PARAM_SET_free(set);
+	TASK_SET_free(tasks);
+}
+
+
 
 CuSuite* TaskDefTest_getSuite(void) {
 	CuSuite* suite = CuSuiteNew();
@@ -799,6 +950,8 @@ CuSuite* TaskDefTest_getSuite(void) {
 	SUITE_ADD_TEST(suite, Test_task_set_suggestions);
 	SUITE_ADD_TEST(suite, Test_task_set_is_one_target);
 	SUITE_ADD_TEST(suite, Test_task_set_is_one_target_single_task);
+	SUITE_ADD_TEST(suite, Test_task_set_analyze_after_change);
+	SUITE_ADD_TEST(suite, Test_task_set_analyze_after_random_changes);
 
 	return suite;
 }